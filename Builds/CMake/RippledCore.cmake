@@ -79,6 +79,7 @@ target_sources (xrpl_core PRIVATE
       subdir: protocol
   #]===============================]
   src/ripple/protocol/impl/AccountID.cpp
+  src/ripple/protocol/impl/BinaryXPOP.cpp
   src/ripple/protocol/impl/Book.cpp
   src/ripple/protocol/impl/BuildInfo.cpp
   src/ripple/protocol/impl/ErrorCodes.cpp
@@ -207,6 +208,7 @@ install (
   FILES
     src/ripple/protocol/AccountID.h
     src/ripple/protocol/AmountConversions.h
+    src/ripple/protocol/BinaryXPOP.h
     src/ripple/protocol/Book.h
     src/ripple/protocol/BuildInfo.h
     src/ripple/protocol/ErrorCodes.h
@@ -395,6 +397,7 @@ target_sources (rippled PRIVATE
   src/ripple/app/misc/detail/impl/WorkSSL.cpp
   src/ripple/app/misc/impl/AccountTxPaging.cpp
   src/ripple/app/misc/impl/AmendmentTable.cpp
+  src/ripple/app/misc/impl/EmittedTxnIndex.cpp
   src/ripple/app/misc/impl/LoadFeeTrack.cpp
   src/ripple/app/misc/impl/Manifest.cpp
   src/ripple/app/misc/impl/Transaction.cpp
@@ -459,11 +462,19 @@ target_sources (rippled PRIVATE
   src/ripple/app/tx/impl/SetSignerList.cpp
   src/ripple/app/tx/impl/SetTrust.cpp
   src/ripple/app/tx/impl/SignerEntries.cpp
+  src/ripple/app/tx/impl/SpeculativeApply.cpp
   src/ripple/app/tx/impl/Taker.cpp
   src/ripple/app/tx/impl/Transactor.cpp
   src/ripple/app/tx/impl/URIToken.cpp
   src/ripple/app/tx/impl/apply.cpp
   src/ripple/app/tx/impl/applySteps.cpp
+  src/ripple/app/hook/impl/HookStateMap.cpp
+  src/ripple/app/hook/impl/ModuleCache.cpp
+  src/ripple/app/hook/impl/Profiler.cpp
+  src/ripple/app/hook/impl/STOIndex.cpp
+  src/ripple/app/hook/impl/StatePrefetcher.cpp
+  src/ripple/app/hook/impl/TraceSink.cpp
+  src/ripple/app/hook/impl/ValidationCache.cpp
   src/ripple/app/hook/impl/applyHook.cpp
   src/ripple/app/tx/impl/details/NFTokenUtils.cpp
   #[===============================[
@@ -497,6 +508,7 @@ target_sources (rippled PRIVATE
   src/ripple/core/impl/SNTPClock.cpp
   src/ripple/core/impl/SociDB.cpp
   src/ripple/core/impl/TimeKeeper.cpp
+  src/ripple/core/impl/VerifyPool.cpp
   src/ripple/core/impl/Workers.cpp
   src/ripple/core/Pg.cpp
   #[===============================[
@@ -615,6 +627,8 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/FetchInfo.cpp
   src/ripple/rpc/handlers/GatewayBalances.cpp
   src/ripple/rpc/handlers/GetCounts.cpp
+  src/ripple/rpc/handlers/HookDryRun.cpp
+  src/ripple/rpc/handlers/HookProfile.cpp
   src/ripple/rpc/handlers/LedgerAccept.cpp
   src/ripple/rpc/handlers/LedgerCleanerHandler.cpp
   src/ripple/rpc/handlers/LedgerClosed.cpp
@@ -660,9 +674,11 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/ValidatorListSites.cpp
   src/ripple/rpc/handlers/Validators.cpp
   src/ripple/rpc/handlers/WalletPropose.cpp
+  src/ripple/rpc/handlers/XPOP.cpp
   src/ripple/rpc/impl/DeliveredAmount.cpp
   src/ripple/rpc/impl/Handler.cpp
   src/ripple/rpc/impl/LegacyPathFind.cpp
+  src/ripple/rpc/impl/NamespaceStream.cpp
   src/ripple/rpc/impl/RPCHandler.cpp
   src/ripple/rpc/impl/RPCHelpers.cpp
   src/ripple/rpc/impl/Role.cpp
@@ -671,6 +687,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/impl/ShardVerificationScheduler.cpp
   src/ripple/rpc/impl/Status.cpp
   src/ripple/rpc/impl/TransactionSign.cpp
+  src/ripple/rpc/impl/XPOPBuilder.cpp
   src/ripple/rpc/impl/NFTokenID.cpp
   src/ripple/rpc/impl/NFTokenOfferID.cpp
   src/ripple/rpc/impl/NFTSyntheticSerializer.cpp
@@ -717,6 +734,7 @@ if (tests)
     src/test/app/DepositAuth_test.cpp
     src/test/app/Discrepancy_test.cpp
     src/test/app/DNS_test.cpp
+    src/test/app/EmittedTxnIndex_test.cpp
     src/test/app/Escrow_test.cpp
     src/test/app/FeeVote_test.cpp
     src/test/app/Flow_test.cpp
@@ -762,9 +780,18 @@ if (tests)
     src/test/app/ValidatorList_test.cpp
     src/test/app/ValidatorSite_test.cpp
     src/test/app/SetHook_test.cpp
+    src/test/app/HookAOT_test.cpp
+    src/test/app/HookAPIModule_test.cpp
+    src/test/app/HookBench_test.cpp
+    src/test/app/HookGuard_test.cpp
+    src/test/app/HookSTOIndex_test.cpp
+    src/test/app/HookTrace_test.cpp
+    src/test/app/HookXFL_test.cpp
     src/test/app/SetHookTSH_test.cpp
+    src/test/app/SpeculativeApply_test.cpp
     src/test/app/Wildcard_test.cpp
     src/test/app/XahauGenesis_test.cpp
+    src/test/app/XPOPValidations_test.cpp
     src/test/app/tx/apply_test.cpp
     #[===============================[
        test sources:
@@ -836,6 +863,7 @@ if (tests)
     src/test/core/CryptoPRNG_test.cpp
     src/test/core/JobQueue_test.cpp
     src/test/core/SociDB_test.cpp
+    src/test/core/VerifyPool_test.cpp
     src/test/core/Workers_test.cpp
     #[===============================[
        test sources:
@@ -957,6 +985,7 @@ if (tests)
        test sources:
          subdir: protocol
     #]===============================]
+    src/test/protocol/BinaryXPOP_test.cpp
     src/test/protocol/BuildInfo_test.cpp
     src/test/protocol/InnerObjectFormats_test.cpp
     src/test/protocol/Issue_test.cpp
@@ -998,6 +1027,7 @@ if (tests)
     src/test/rpc/Feature_test.cpp
     src/test/rpc/GatewayBalances_test.cpp
     src/test/rpc/GetCounts_test.cpp
+    src/test/rpc/HookDryRun_test.cpp
     src/test/rpc/JSONRPC_test.cpp
     src/test/rpc/KeyGeneration_test.cpp
     src/test/rpc/LedgerClosed_test.cpp
@@ -1026,6 +1056,7 @@ if (tests)
     src/test/rpc/ValidatorInfo_test.cpp
     src/test/rpc/ValidatorRPC_test.cpp
     src/test/rpc/Version_test.cpp
+    src/test/rpc/XPOP_test.cpp
     #[===============================[
        test sources:
          subdir: server
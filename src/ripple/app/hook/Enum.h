@@ -1,3 +1,4 @@
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -340,8 +341,13 @@ enum ExitType : uint8_t {
     WASM_ERROR = 1,
     ROLLBACK = 2,
     ACCEPT = 3,
+    COST_LIMIT = 4,  // aborted on exhausting its instruction budget
 };
 
+// with featureHookCostLimit a hook is aborted once it executes this many times
+// the worst case instruction count the guard checker computed for it
+const uint8_t cost_limit_multiplier = 4;
+
 const uint16_t max_state_modifications = 256;
 const uint8_t max_slots = 255;
 const uint8_t max_nonce = 255;
@@ -349,10 +355,14 @@ const uint8_t max_emit = 255;
 const uint8_t max_params = 16;
 const double fee_base_multiplier = 1.1f;
 
+// api names to signatures, searchable by string_view
+using ImportWhitelist =
+    std::map<std::string, std::vector<uint8_t>, std::less<>>;
+
 // RH NOTE: Find descriptions of api functions in ./impl/applyHook.cpp and
 // hookapi.h (include for hooks) this is a map of the api name to its return
 // code (vec[0] and its parameters vec[>0]) as wasm type codes
-static const std::map<std::string, std::vector<uint8_t>> import_whitelist{
+static const ImportWhitelist import_whitelist{
     {"_g", {0x7FU, 0x7FU, 0x7FU}},
     {"accept", {0x7EU, 0x7FU, 0x7FU, 0x7EU}},
     {"rollback", {0x7EU, 0x7FU, 0x7FU, 0x7EU}},
@@ -432,7 +442,7 @@ static const std::map<std::string, std::vector<uint8_t>> import_whitelist{
     {"meta_slot", {0x7EU, 0x7FU}}};
 
 // featureHooks1
-static const std::map<std::string, std::vector<uint8_t>> import_whitelist_1{
+static const ImportWhitelist import_whitelist_1{
     {"xpop_slot", {0x7EU, 0x7FU, 0x7FU}}};
 };  // namespace hook_api
 #endif
@@ -3,8 +3,9 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
-#include <stack>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -13,6 +14,9 @@
 using GuardLog =
     std::optional<std::reference_wrapper<std::basic_ostream<char>>>;
 
+// the hook's bytes, borrowed from wherever the caller keeps them
+using GuardWasm = std::span<uint8_t const>;
+
 #define DEBUG_GUARD 0
 #define DEBUG_GUARD_VERBOSE 0
 #define DEBUG_GUARD_VERY_VERBOSE 0
@@ -28,7 +32,7 @@ using GuardLog =
 // web assembly contains a lot of run length encoding in LEB128 format
 inline uint64_t
 parseLeb128(
-    std::vector<unsigned char> const& buf,
+    GuardWasm buf,
     int start_offset,
     int* end_offset)
 {
@@ -60,7 +64,7 @@ parseLeb128(
 
 inline int64_t
 parseSignedLeb128(
-    std::vector<unsigned char> const& buf,
+    GuardWasm buf,
     int start_offset,
     int* end_offset)
 {
@@ -139,122 +143,91 @@ parseSignedLeb128(
         return {};                                                            \
     }
 
+// A block of a function body. The blocks of a body are kept in one flat
+// vector in the order they open, so that every block comes after its parent
+// and the tree is freed all at once whatever its depth.
 struct WasmBlkInf
 {
-    uint32_t sanity_check;
+    static constexpr uint32_t no_parent = 0xFFFFFFFFU;
+
     uint32_t iteration_bound;
     uint32_t instruction_count;
-    WasmBlkInf* parent;
-    std::vector<WasmBlkInf*> children;
+    uint32_t parent;  // index of the enclosing block
+    uint32_t level;   // depth below the root, which is level 0
     uint32_t start_byte;
-    bool is_root;
-
-    WasmBlkInf(
-        uint32_t iteration_bound_,
-        uint32_t instruction_count_,
-        WasmBlkInf* parent_,
-        uint32_t start_byte_,
-        bool is_root_ = false)
-        : sanity_check(0x1234ABCDU)
-        , iteration_bound(iteration_bound_)
-        , instruction_count(instruction_count_)
-        , parent(parent_)
-        , children({})
-        , start_byte(start_byte_)
-        , is_root(is_root_)
-    {
-        // all done by the above
-    }
-
-    WasmBlkInf*
-    add_child(uint32_t iteration_bound, uint32_t start_byte)
-    {
-        WasmBlkInf* child =
-            new WasmBlkInf(iteration_bound, 0, this, start_byte, false);
-        children.push_back(child);
-        return child;
-    }
-
-    ~WasmBlkInf()
-    {
-        for (WasmBlkInf* child : children)
-            delete child;
-    }
+    uint64_t children_wce;  // summed while computing the wce
 };
 
-#define PRINT_WCE(x)                                                           \
-    {                                                                          \
-        if (DEBUG_GUARD)                                                       \
-            printf(                                                            \
-                "%llx:: [%u]%.*swce=%ld | start=%x instcount=%u guard=%u, "    \
-                "parent_guard=%d, multiplier=%g parentptr=%llx\n",             \
-                &blk,                                                          \
-                x,                                                             \
-                level,                                                         \
-                "                                                            " \
-                "                      ",                                      \
-                worst_case_execution,                                          \
-                blk->start_byte,                                               \
-                blk->instruction_count,                                        \
-                blk->iteration_bound,                                          \
-                (blk->parent != 0 ? blk->parent->iteration_bound : -1),        \
-                multiplier,                                                    \
-                &(blk->parent));                                               \
+#define PRINT_WCE(x)                                                      \
+    {                                                                     \
+        if (DEBUG_GUARD)                                                  \
+            printf(                                                       \
+                "[%u] %u:%.*swce=%ld | start=%x instcount=%u guard=%u, "  \
+                "parent_guard=%d, multiplier=%g\n",                       \
+                x,                                                        \
+                n,                                                        \
+                blk.level,                                                \
+                "                                                       " \
+                "                           ",                            \
+                worst_case_execution,                                     \
+                blk.start_byte,                                           \
+                blk.instruction_count,                                    \
+                blk.iteration_bound,                                      \
+                (blk.parent != WasmBlkInf::no_parent                      \
+                     ? blocks[blk.parent].iteration_bound                 \
+                     : -1),                                               \
+                multiplier);                                              \
     }
-// compute worst case execution time
+
+// compute worst case execution time, children before their parents so that
+// no recursion is needed
 inline uint64_t
-compute_wce(const WasmBlkInf* blk, int level, bool* recursion_limit_reached)
+compute_wce(std::vector<WasmBlkInf>& blocks, bool* recursion_limit_reached)
 {
-    if (level > 16)
+    for (auto& blk : blocks)
     {
-        *recursion_limit_reached = true;
-        return 0;
+        if (blk.level > 16)
+        {
+            *recursion_limit_reached = true;
+            return 0;
+        }
+        blk.children_wce = 0;
     }
 
-    if (blk->sanity_check != 0x1234ABCDU)
+    for (uint32_t n = blocks.size(); n-- > 1;)
     {
-        printf("!!! sanity check failed\n");
-        *recursion_limit_reached = true;
-        return (uint64_t)-1;
-    }
+        auto const& blk = blocks[n];
+        auto& parent = blocks[blk.parent];
 
-    WasmBlkInf const* parent = blk->parent;
+        uint64_t worst_case_execution =
+            blk.instruction_count + blk.children_wce;
+        double multiplier = 1.0;
 
-    if (parent && parent->sanity_check != 0x1234ABCDU)
-    {
-        printf("!!! parent sanity check failed\n");
-        *recursion_limit_reached = true;
-        return (uint64_t)-1;
-    }
+        if (parent.iteration_bound ==
+            0)  // this condtion should never occur [defensively programmed]
+        {
+            PRINT_WCE(1);
+            parent.children_wce += worst_case_execution;
+            continue;
+        }
 
-    uint64_t worst_case_execution = blk->instruction_count;
-    double multiplier = 1.0;
+        // if the block has a parent then the quotient of its guard and its
+        // parent's guard gives us the loop iterations and thus the multiplier
+        // for the instruction count
+        multiplier = ((double)(blk.iteration_bound)) /
+            ((double)(parent.iteration_bound));
 
-    if (blk->children.size() > 0)
-        for (auto const& child : blk->children)
-            worst_case_execution +=
-                compute_wce(child, level + 1, recursion_limit_reached);
+        worst_case_execution *= multiplier;
+        if (worst_case_execution < 1.0)
+            worst_case_execution = 1.0;
 
-    if (parent == 0 ||
-        parent->iteration_bound ==
-            0)  // this condtion should never occur [defensively programmed]
-    {
-        PRINT_WCE(1);
-        return worst_case_execution;
+        PRINT_WCE(3);
+        parent.children_wce += worst_case_execution;
     }
 
-    // if the block has a parent then the quotient of its guard and its parent's
-    // guard gives us the loop iterations and thus the multiplier for the
-    // instruction count
-    multiplier =
-        ((double)(blk->iteration_bound)) / ((double)(parent->iteration_bound));
-
-    worst_case_execution *= multiplier;
-    if (worst_case_execution < 1.0)
-        worst_case_execution = 1.0;
-
-    PRINT_WCE(3);
-    return worst_case_execution;
+    return blocks.empty()
+        ? 0
+        : blocks[0].instruction_count + blocks[0].children_wce;
 };
 
 // checks the WASM binary for the appropriate required _g guard calls and
@@ -264,14 +237,15 @@ compute_wce(const WasmBlkInf* blk, int level, bool* recursion_limit_reached)
 // length_error
 inline std::optional<uint64_t>
 check_guard(
-    std::vector<uint8_t> const& wasm,
+    GuardWasm wasm,
     int codesec,
     int start_offset,
     int end_offset,
     int guard_func_idx,
     int last_import_idx,
     GuardLog guardLog,
-    std::string guardLogAccStr)
+    std::string_view guardLogAccStr,
+    std::vector<WasmBlkInf>& blocks)  // scratch space, reused between calls
 {
 #define MAX_GUARD_CALLS 1024
     uint32_t guard_count = 0;
@@ -291,16 +265,12 @@ check_guard(
         end_offset = wasm.size();
     int block_depth = 0;
 
-    // the root node is constructed in a unique ptr, which will cause its
-    // destructor to be called when the function exits. The destructor of the
-    // root node will recursively free all heap allocated children.
-    // WasmBlkInf(uint32_t iteration_bound_, uint32_t instruction_count_,
-    //        WasmBlkInf* parent_, uint32_t start_byte_, bool is_root_ = false)
-    //        :
-    std::unique_ptr<WasmBlkInf> root =
-        std::make_unique<WasmBlkInf>(1, 0, (WasmBlkInf*)0, start_offset, true);
+    // the root node is the function body itself
+    blocks.clear();
+    blocks.push_back(
+        {1, 0, WasmBlkInf::no_parent, 0, (uint32_t)start_offset, 0});
 
-    WasmBlkInf* current = &(*root);
+    uint32_t current = 0;
 
     if (DEBUG_GUARD)
         printf("\n\n\nstart of guard analysis for codesec %d\n", codesec);
@@ -319,7 +289,7 @@ check_guard(
         uint8_t instr = wasm[i];
         ADVANCE(1);
 
-        current->instruction_count++;
+        blocks[current].instruction_count++;
 
         // unreachable and nop instructions
         if (instr == 0x00U ||  // unreachable
@@ -357,7 +327,9 @@ check_guard(
             }
 
             uint32_t iteration_bound =
-                (current->parent == 0 ? 1 : current->iteration_bound);
+                (blocks[current].parent == WasmBlkInf::no_parent
+                     ? 1
+                     : blocks[current].iteration_bound);
             if (instr == 0x03U)
             {
                 // now look for the guard call
@@ -405,7 +377,14 @@ check_guard(
                     GUARD_ERROR("Too many guard calls! Limit is 1024");
             }
 
-            current = current->add_child(iteration_bound, i);
+            blocks.push_back(
+                {iteration_bound,
+                 0,
+                 current,
+                 blocks[current].level + 1,
+                 (uint32_t)i,
+                 0});
+            current = blocks.size() - 1;
             block_depth++;
             continue;
         }
@@ -417,10 +396,11 @@ check_guard(
                     "Guard checker - block end instruction at %d [%x]\n", i, i);
 
             block_depth--;
-            current = current->parent;
-            if (current == 0 && block_depth == -1 && (i >= end_offset))
+            current = blocks[current].parent;
+            if (current == WasmBlkInf::no_parent && block_depth == -1 &&
+                (i >= end_offset))
                 break;  // codesec end
-            else if (current == 0)
+            else if (current == WasmBlkInf::no_parent)
             {
                 GUARD_ERROR("Illegal block end (current==0)");
             }
@@ -428,11 +408,6 @@ check_guard(
             {
                 GUARD_ERROR("Illegal block end (block_depth<0)");
             }
-
-            if (current->sanity_check != 0x1234ABCDU)
-            {
-                GUARD_ERROR("Sanity check failed (bad pointer)");
-            }
             continue;
         }
 
@@ -769,7 +744,7 @@ check_guard(
     }
 
     bool recursion_limit_reached = false;
-    uint64_t wce = compute_wce(&(*root), 0, &recursion_limit_reached);
+    uint64_t wce = compute_wce(blocks, &recursion_limit_reached);
     if (recursion_limit_reached)
     {
         GUARDLOG(hook::log::NESTING_LIMIT)
@@ -796,6 +771,29 @@ check_guard(
     return wce;
 }
 
+// What validateGuards learns of a hook before its code section, kept by the
+// caller so that validating another hook reuses the space.
+struct GuardScratch
+{
+    // a function type of the type section
+    struct FuncType
+    {
+        int param_count;
+        uint32_t params;  // the first of its parameters in param_types
+        int result;
+        // the api signature and name of the first import of this type
+        std::vector<uint8_t> const* api_signature;
+        std::string_view api_name;  // points into wasm
+    };
+
+    std::vector<FuncType> types;
+    std::vector<int> param_types;
+    // the type of each function the hook defines
+    std::vector<int> func_types;
+    // the blocks of the function body under analysis
+    std::vector<WasmBlkInf> blocks;
+};
+
 // RH TODO: reprogram this function to use REQUIRE/ADVANCE
 // may throw overflow_error
 inline std::optional<  // unpopulated means invalid
@@ -804,10 +802,11 @@ inline std::optional<  // unpopulated means invalid
         uint64_t   // max instruction count for cbak()
         >>
 validateGuards(
-    std::vector<uint8_t> const& wasm,
+    GuardWasm wasm,
     GuardLog guardLog,
-    std::string guardLogAccStr,
-    uint64_t rulesVersion = 0)
+    std::string_view guardLogAccStr,
+    uint64_t rulesVersion,
+    GuardScratch& scratch)
 {
     uint64_t byteCount = wasm.size();
 
@@ -842,18 +841,146 @@ validateGuards(
     std::optional<int> hook_func_idx;
     std::optional<int> cbak_func_idx;
 
-    // this maps function ids to type ids, used for looking up the type of cbak
-    // and hook as established inside the wasm binary.
-    std::map<int, int> func_type_map;
-    std::map<
-        int /* type idx */,
-        std::map<int /* import index */, std::string /* api name */>>
-        import_type_map;
+    auto& types = scratch.types;
+    auto& param_types = scratch.param_types;
+    auto& func_type_map = scratch.func_types;
+    types.clear();
+    param_types.clear();
+    func_type_map.clear();
 
     // now we check for guards... first check if _g is imported
     int guard_import_number = -1;
     int last_import_number = -1;
     int import_count = 0;
+
+    // the sections are strictly ascending, so by the code section, or the end
+    // of the hook if it has none, every section the type checks depend on has
+    // been read
+    bool checked_types = false;
+    auto const check_types = [&]() -> bool {
+        checked_types = true;
+
+        // we must subtract import_count from the hook and cbak function in
+        // order to be able to look them up in the functions section. this is a
+        // rule of the webassembly spec
+        if (hook_func_idx)
+            *hook_func_idx -= import_count;
+
+        if (cbak_func_idx)
+            *cbak_func_idx -= import_count;
+
+        auto const has_type = [&](std::optional<int> const& func_idx) {
+            return func_idx && *func_idx >= 0 &&
+                *func_idx < static_cast<int>(func_type_map.size());
+        };
+
+        if (!has_type(hook_func_idx) ||
+            (cbak_func_idx && !has_type(cbak_func_idx)))
+        {
+            GUARDLOG(hook::log::FUNC_TYPELESS)
+                << "Malformed transaction. "
+                << "hook or cbak functions did not have a corresponding type "
+                   "in WASM binary."
+                << "\n";
+            return false;
+        }
+
+        int hook_type_idx = func_type_map[*hook_func_idx];
+
+        // cbak function is optional so if it exists it has a type otherwise
+        // it is skipped in checks
+        if (cbak_func_idx && func_type_map[*cbak_func_idx] != hook_type_idx)
+        {
+            GUARDLOG(hook::log::HOOK_CBAK_DIFF_TYPES)
+                << "Malformed transaction. "
+                << "Hook and cbak func must have the same type. int64_t "
+                   "(*)(uint32_t).\n";
+            return false;
+        }
+
+        // every type must be that of hook and cbak, or of the apis importing
+        // it
+        for (int j = 0; j < static_cast<int>(types.size()); ++j)
+        {
+            auto const& type = types[j];
+            if (j == hook_type_idx)
+            {
+                if (type.param_count != 1 ||
+                    param_types[type.params] != 0x7FU /* i32 */)
+                {
+                    GUARDLOG(hook::log::PARAM_HOOK_CBAK)
+                        << "Malformed transaction. "
+                        << "hook and cbak function definition must have "
+                           "exactly one uint32_t parameter."
+                        << "\n";
+                    return false;
+                }
+
+                if (type.result != 0x7E /* i64 */)
+                {
+                    GUARDLOG(hook::log::RETURN_HOOK_CBAK)
+                        << "Malformed transaction. "
+                        << "hook j=" << j << " "
+                        << " function definition must have exactly one "
+                           "int64_t return type. "
+                        << "resultcount=1, resulttype=" << type.result
+                        << ", "
+                        << "paramcount=" << type.param_count << "\n";
+                    return false;
+                }
+                continue;
+            }
+
+            if (!type.api_signature)
+            {
+                GUARDLOG(hook::log::FUNC_TYPE_INVALID)
+                    << "Invalid function type. Not used by any import or "
+                       "hook/cbak func. "
+                    << "Codesec: 1 "
+                    << "Local: " << j << "\n";
+                return false;
+            }
+
+            auto const& signature = *type.api_signature;
+            if (type.param_count != signature.size() - 1)
+            {
+                GUARDLOG(hook::log::FUNC_TYPE_INVALID)
+                    << "Malformed transaction. "
+                    << "Hook API: " << type.api_name
+                    << " has the wrong number of parameters.\n";
+                return false;
+            }
+
+            for (int k = 0; k < type.param_count; ++k)
+            {
+                if (signature[k + 1] != param_types[type.params + k])
+                {
+                    GUARDLOG(hook::log::FUNC_PARAM_INVALID)
+                        << "Malformed transaction. "
+                        << "Hook API: " << type.api_name
+                        << " definition parameters incorrect."
+                        << "\n";
+                    return false;
+                }
+            }
+
+            if (signature[0] != type.result)
+            {
+                GUARDLOG(hook::log::FUNC_RETURN_INVALID)
+                    << "Malformed transaction. "
+                    << "Hook API: " << type.api_name
+                    << " definition return type incorrect."
+                    << "\n";
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    int64_t maxInstrCountHook = 0;
+    int64_t maxInstrCountCbak = 0;
+
     int last_section_type = 0;
     for (int i = 8, j = 0; i < wasm.size();)
     {
@@ -906,7 +1033,107 @@ validateGuards(
 
         int next_section = i + section_length;
 
-        if (section_type == 2)  // import section
+        if (section_type == 1)  // type section
+        {
+            // the types are checked against the imports as those are read,
+            // and against hook and cbak once the exports are known
+            int type_count = parseLeb128(wasm, i, &i);
+            CHECK_SHORT_HOOK();
+            for (int j = 0; j < type_count; ++j)
+            {
+                if (wasm[i++] != 0x60)
+                {
+                    GUARDLOG(hook::log::FUNC_TYPE_INVALID)
+                        << "Invalid function type. "
+                        << "Codesec: " << section_type << " "
+                        << "Local: " << j << " "
+                        << "Offset: " << i << "\n";
+                    return {};
+                }
+                CHECK_SHORT_HOOK();
+
+                int param_count = parseLeb128(wasm, i, &i);
+                CHECK_SHORT_HOOK();
+
+                types.push_back(
+                    {param_count,
+                     static_cast<uint32_t>(param_types.size()),
+                     0,
+                     nullptr,
+                     {}});
+
+                for (int k = 0; k < param_count; ++k)
+                {
+                    int param_type = parseLeb128(wasm, i, &i);
+                    CHECK_SHORT_HOOK();
+                    if (param_type == 0x7FU || param_type == 0x7EU ||
+                        param_type == 0x7DU || param_type == 0x7CU)
+                    {
+                        // pass, this is fine
+                    }
+                    else
+                    {
+                        GUARDLOG(hook::log::FUNC_PARAM_INVALID)
+                            << "Invalid parameter type in function type. "
+                            << "Codesec: " << section_type << " "
+                            << "Local: " << j << " "
+                            << "Offset: " << i << "\n";
+                        return {};
+                    }
+
+                    if (DEBUG_GUARD)
+                        printf(
+                            "Function type idx: %d, param_count: %d "
+                            "param_type: %x\n",
+                            j,
+                            param_count,
+                            param_type);
+
+                    param_types.push_back(param_type);
+                }
+
+                int result_count = parseLeb128(wasm, i, &i);
+                CHECK_SHORT_HOOK();
+
+                // this needs a reliable hook cleaner otherwise it will catch
+                // most compilers out
+                if (result_count != 1)
+                {
+                    GUARDLOG(hook::log::FUNC_RETURN_COUNT)
+                        << "Malformed transaction. "
+                        << "Hook declares a function type that returns fewer "
+                           "or more than one value. "
+                        << "\n";
+                    return {};
+                }
+
+                int result_type = parseLeb128(wasm, i, &i);
+                CHECK_SHORT_HOOK();
+                if (result_type == 0x7F || result_type == 0x7E ||
+                    result_type == 0x7D || result_type == 0x7C)
+                {
+                    // pass, this is fine
+                }
+                else
+                {
+                    GUARDLOG(hook::log::FUNC_RETURN_INVALID)
+                        << "Invalid return type in function type. "
+                        << "Codesec: " << section_type << " "
+                        << "Local: " << j << " "
+                        << "Offset: " << i << "\n";
+                    return {};
+                }
+
+                if (DEBUG_GUARD)
+                    printf(
+                        "Function type idx: %d, result_type: %x\n",
+                        j,
+                        result_type);
+
+                types.back().result = result_type;
+            }
+        }
+        else if (section_type == 2)  // import section
         {
             // we are interested in the import section... we need to know if _g
             // is imported and which import# it is
@@ -969,7 +1196,7 @@ validateGuards(
                     return {};
                 }
 
-                std::string import_name{
+                std::string_view import_name{
                     (const char*)(wasm.data() + i), (size_t)name_length};
 
                 i += name_length;
@@ -1019,13 +1246,37 @@ validateGuards(
                     }
                 }
 
-                // add to import map
-                if (import_type_map.find(type_idx) == import_type_map.end())
-                    import_type_map[type_idx] = {
-                        {func_upto, std::move(import_name)}};
-                else
-                    import_type_map[type_idx].emplace(
-                        func_upto, std::move(import_name));
+                // every api importing a type must have the same signature
+                if (type_idx >= 0 && type_idx < static_cast<int>(types.size()))
+                {
+                    auto const& api_signature =
+                        hook_api::import_whitelist.find(import_name) !=
+                            hook_api::import_whitelist.end()
+                        ? hook_api::import_whitelist.find(import_name)->second
+                        : hook_api::import_whitelist_1.find(import_name)
+                              ->second;
+
+                    auto& type = types[type_idx];
+                    if (!type.api_signature)
+                    {
+                        type.api_signature = &api_signature;
+                        type.api_name = import_name;
+                    }
+                    else if (api_signature != *type.api_signature)
+                    {
+                        GUARDLOG(hook::log::FUNC_TYPE_INVALID)
+                            << "Function type is inconsitent across "
+                               "referenced apis. "
+                            << "This probably means one of your apis has "
+                               "the wrong signature. "
+                            << "(Either: " << type.api_name
+                            << ", or: " << import_name << ".) "
+                            << "Codesec: 1 "
+                            << "Local: " << type_idx << " "
+                            << "Offset: " << i << "\n";
+                        return {};
+                    }
+                }
 
                 func_upto++;
             }
@@ -1043,9 +1294,8 @@ validateGuards(
 
             // we have an imported guard function, so now we need to enforce the
             // guard rule: all loops must start with a guard call before any
-            // branching to enforce these rules we must do a second pass of the
-            // wasm in case the function section was placed in this wasm binary
-            // before the import section
+            // branching. the code section comes after the import section, so
+            // this is done as it is read
         }
         else if (section_type == 7)  // export section
         {
@@ -1147,291 +1397,14 @@ validateGuards(
                 CHECK_SHORT_HOOK();
                 if (DEBUG_GUARD)
                     printf("Function map: func %d -> type %d\n", j, type_idx);
-                func_type_map[j] = type_idx;
-            }
-        }
-
-        i = next_section;
-        continue;
-    }
-
-    // we must subtract import_count from the hook and cbak function in order to
-    // be able to look them up in the functions section. this is a rule of the
-    // webassembly spec note that at this point in execution we are guarenteed
-    // these are populated
-    *hook_func_idx -= import_count;
-
-    if (cbak_func_idx)
-        *cbak_func_idx -= import_count;
-
-    if (func_type_map.find(*hook_func_idx) == func_type_map.end() ||
-        (cbak_func_idx &&
-         func_type_map.find(*cbak_func_idx) == func_type_map.end()))
-    {
-        GUARDLOG(hook::log::FUNC_TYPELESS)
-            << "Malformed transaction. "
-            << "hook or cbak functions did not have a corresponding type in "
-               "WASM binary."
-            << "\n";
-        return {};
-    }
-
-    int hook_type_idx = func_type_map[*hook_func_idx];
-
-    // cbak function is optional so if it exists it has a type otherwise it is
-    // skipped in checks
-    if (cbak_func_idx && func_type_map[*cbak_func_idx] != hook_type_idx)
-    {
-        GUARDLOG(hook::log::HOOK_CBAK_DIFF_TYPES)
-            << "Malformed transaction. "
-            << "Hook and cbak func must have the same type. int64_t "
-               "(*)(uint32_t).\n";
-        return {};
-    }
-
-    int64_t maxInstrCountHook = 0;
-    int64_t maxInstrCountCbak = 0;
-
-    // second pass... where we check all the guard function calls follow the
-    // guard rules minimal other validation in this pass because first pass
-    // caught most of it
-    for (int i = 8; i < wasm.size();)
-    {
-        int section_type = wasm[i++];
-        int section_length = parseLeb128(wasm, i, &i);
-        CHECK_SHORT_HOOK();
-        // int section_start = i;
-        int next_section = i + section_length;
-
-        if (section_type == 1)  // type section
-        {
-            int type_count = parseLeb128(wasm, i, &i);
-            CHECK_SHORT_HOOK();
-            for (int j = 0; j < type_count; ++j)
-            {
-                if (wasm[i++] != 0x60)
-                {
-                    GUARDLOG(hook::log::FUNC_TYPE_INVALID)
-                        << "Invalid function type. "
-                        << "Codesec: " << section_type << " "
-                        << "Local: " << j << " "
-                        << "Offset: " << i << "\n";
-                    return {};
-                }
-                CHECK_SHORT_HOOK();
-
-                // check the consistency of the type
-                std::optional<std::string> first_name;
-                std::optional<
-                    std::reference_wrapper<std::vector<uint8_t> const>>
-                    first_signature;
-                if (auto const& usage = import_type_map.find(j);
-                    usage != import_type_map.end())
-                {
-                    for (auto const& [import_idx, api_name] : usage->second)
-                    {
-                        auto const& api_signature =
-                            hook_api::import_whitelist.find(api_name) !=
-                                hook_api::import_whitelist.end()
-                            ? hook_api::import_whitelist.find(api_name)->second
-                            : hook_api::import_whitelist_1.find(api_name)
-                                  ->second;
-
-                        if (!first_signature)
-                        {
-                            first_name = api_name;
-                            first_signature = api_signature;
-                            continue;
-                        }
-
-                        if (api_signature != (*first_signature).get())
-                        {
-                            GUARDLOG(hook::log::FUNC_TYPE_INVALID)
-                                << "Function type is inconsitent across "
-                                   "referenced apis. "
-                                << "This probably means one of your apis has "
-                                   "the wrong signature. "
-                                << "(Either: " << *first_name
-                                << ", or: " << api_name << ".) "
-                                << "Codesec: " << section_type << " "
-                                << "Local: " << j << " "
-                                << "Offset: " << i << "\n";
-                            return {};
-                        }
-                    }
-                }
-                else if (j == hook_type_idx)
-                {
-                    // pass
-                }
-                else
-                {
-                    // fail
-                    GUARDLOG(hook::log::FUNC_TYPE_INVALID)
-                        << "Invalid function type. Not used by any import or "
-                           "hook/cbak func. "
-                        << "Codesec: " << section_type << " "
-                        << "Local: " << j << " "
-                        << "Offset: " << i << "\n";
-                    return {};
-                }
-
-                int param_count = parseLeb128(wasm, i, &i);
-                CHECK_SHORT_HOOK();
-                if (j == hook_type_idx)
-                {
-                    if (param_count != 1)
-                    {
-                        GUARDLOG(hook::log::PARAM_HOOK_CBAK)
-                            << "Malformed transaction. "
-                            << "hook and cbak function definition must have "
-                               "exactly one parameter (uint32_t)."
-                            << "\n";
-                        return {};
-                    }
-                }
-                else if (param_count != (*first_signature).get().size() - 1)
-                {
-                    GUARDLOG(hook::log::FUNC_TYPE_INVALID)
-                        << "Malformed transaction. "
-                        << "Hook API: " << *first_name
-                        << " has the wrong number of parameters.\n";
-                    return {};
-                }
-
-                for (int k = 0; k < param_count; ++k)
-                {
-                    int param_type = parseLeb128(wasm, i, &i);
-                    CHECK_SHORT_HOOK();
-                    if (param_type == 0x7FU || param_type == 0x7EU ||
-                        param_type == 0x7DU || param_type == 0x7CU)
-                    {
-                        // pass, this is fine
-                    }
-                    else
-                    {
-                        GUARDLOG(hook::log::FUNC_PARAM_INVALID)
-                            << "Invalid parameter type in function type. "
-                            << "Codesec: " << section_type << " "
-                            << "Local: " << j << " "
-                            << "Offset: " << i << "\n";
-                        return {};
-                    }
-
-                    if (DEBUG_GUARD)
-                        printf(
-                            "Function type idx: %d, hook_func_idx: %d, "
-                            "cbak_func_idx: %d "
-                            "param_count: %d param_type: %x\n",
-                            j,
-                            *hook_func_idx,
-                            *cbak_func_idx,
-                            param_count,
-                            param_type);
-
-                    // hook and cbak parameter check here
-                    if (j == hook_type_idx)
-                    {
-                        if (param_type != 0x7FU /* i32 */)
-                        {
-                            GUARDLOG(hook::log::PARAM_HOOK_CBAK)
-                                << "Malformed transaction. "
-                                << "hook and cbak function definition must "
-                                   "have exactly one uint32_t parameter."
-                                << "\n";
-                            return {};
-                        }
-                    }
-                    else if ((*first_signature).get()[k + 1] != param_type)
-                    {
-                        GUARDLOG(hook::log::FUNC_PARAM_INVALID)
-                            << "Malformed transaction. "
-                            << "Hook API: " << *first_name
-                            << " definition parameters incorrect."
-                            << "\n";
-                        return {};
-                    }
-                }
-
-                int result_count = parseLeb128(wasm, i, &i);
-                CHECK_SHORT_HOOK();
-
-                // this needs a reliable hook cleaner otherwise it will catch
-                // most compilers out
-                if (result_count != 1)
-                {
-                    GUARDLOG(hook::log::FUNC_RETURN_COUNT)
-                        << "Malformed transaction. "
-                        << "Hook declares a function type that returns fewer "
-                           "or more than one value. "
-                        << "\n";
-                    return {};
-                }
-
-                // this can only ever be 1 in production, but in testing it may
-                // also be 0 or >1 so for completeness this loop is here but can
-                // be taken out in prod
-                for (int k = 0; k < result_count; ++k)
-                {
-                    int result_type = parseLeb128(wasm, i, &i);
-                    CHECK_SHORT_HOOK();
-                    if (result_type == 0x7F || result_type == 0x7E ||
-                        result_type == 0x7D || result_type == 0x7C)
-                    {
-                        // pass, this is fine
-                    }
-                    else
-                    {
-                        GUARDLOG(hook::log::FUNC_RETURN_INVALID)
-                            << "Invalid return type in function type. "
-                            << "Codesec: " << section_type << " "
-                            << "Local: " << j << " "
-                            << "Offset: " << i << "\n";
-                        return {};
-                    }
-
-                    if (DEBUG_GUARD)
-                        printf(
-                            "Function type idx: %d, hook_func_idx: %d, "
-                            "cbak_func_idx: %d "
-                            "result_count: %d result_type: %x\n",
-                            j,
-                            *hook_func_idx,
-                            *cbak_func_idx,
-                            result_count,
-                            result_type);
-
-                    // hook and cbak return type check here
-                    if (j == hook_type_idx)
-                    {
-                        if (result_count != 1 || result_type != 0x7E /* i64 */)
-                        {
-                            GUARDLOG(hook::log::RETURN_HOOK_CBAK)
-                                << "Malformed transaction. "
-                                << (j == hook_type_idx ? "hook" : "cbak")
-                                << " j=" << j << " "
-                                << " function definition must have exactly one "
-                                   "int64_t return type. "
-                                << "resultcount=" << result_count
-                                << ", resulttype=" << result_type << ", "
-                                << "paramcount=" << param_count << "\n";
-                            return {};
-                        }
-                    }
-                    else if ((*first_signature).get()[0] != result_type)
-                    {
-                        GUARDLOG(hook::log::FUNC_RETURN_INVALID)
-                            << "Malformed transaction. "
-                            << "Hook API: " << *first_name
-                            << " definition return type incorrect."
-                            << "\n";
-                        return {};
-                    }
-                }
+                func_type_map.push_back(type_idx);
             }
         }
         else if (section_type == 10)  // code section
         {
+            if (!check_types())
+                return {};
+
             // RH TODO: parse anywhere else an expr is allowed in wasm and
             // enforce rules there too these are the functions
             int func_count = parseLeb128(wasm, i, &i);
@@ -1477,7 +1450,8 @@ validateGuards(
                     guard_import_number,
                     last_import_number,
                     guardLog,
-                    guardLogAccStr);
+                    guardLogAccStr,
+                    scratch.blocks);
 
                 if (!valid)
                     return {};
@@ -1500,10 +1474,28 @@ validateGuards(
                 i = code_end;
             }
         }
+
         i = next_section;
+        continue;
     }
 
+    if (!checked_types && !check_types())
+        return {};
+
     // execution to here means guards are installed correctly
 
     return std::pair<uint64_t, uint64_t>{maxInstrCountHook, maxInstrCountCbak};
 }
+
+// validateGuards with scratch space of the calling thread's own
+inline std::optional<std::pair<uint64_t, uint64_t>>
+validateGuards(
+    GuardWasm wasm,
+    GuardLog guardLog,
+    std::string_view guardLogAccStr,
+    uint64_t rulesVersion = 0)
+{
+    thread_local GuardScratch scratch;
+    return validateGuards(
+        wasm, guardLog, guardLogAccStr, rulesVersion, scratch);
+}
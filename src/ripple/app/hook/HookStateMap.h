@@ -0,0 +1,256 @@
+#ifndef HOOK_STATEMAP_INCLUDED
+#define HOOK_STATEMAP_INCLUDED 1
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/protocol/AccountID.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace hook {
+
+namespace detail {
+
+// Open addressing (linear probing) table whose slots live in a memory
+// resource. Keys are never removed. Hashes are computed by the owner so that
+// one seeded hasher can serve several tables.
+template <class Key, class Value>
+class FlatTable
+{
+public:
+    struct Slot
+    {
+        Key key{};
+        Value value{};
+        std::size_t hash = 0;
+        bool used = false;
+    };
+
+private:
+    std::pmr::vector<Slot> slots_;
+    std::size_t size_ = 0;
+
+    void
+    grow()
+    {
+        std::pmr::vector<Slot> old(
+            slots_.empty() ? 16 : slots_.size() * 2,
+            slots_.get_allocator());
+        old.swap(slots_);
+        for (auto& s : old)
+        {
+            if (!s.used)
+                continue;
+            auto i = s.hash & (slots_.size() - 1);
+            while (slots_[i].used)
+                i = (i + 1) & (slots_.size() - 1);
+            slots_[i] = std::move(s);
+        }
+    }
+
+public:
+    explicit FlatTable(std::pmr::memory_resource* mr) : slots_(mr)
+    {
+    }
+
+    Value*
+    find(Key const& key, std::size_t hash)
+    {
+        if (slots_.empty())
+            return nullptr;
+        for (auto i = hash & (slots_.size() - 1); slots_[i].used;
+             i = (i + 1) & (slots_.size() - 1))
+        {
+            if (slots_[i].hash == hash && slots_[i].key == key)
+                return &slots_[i].value;
+        }
+        return nullptr;
+    }
+
+    // the returned pointer is only valid until the next insertion
+    Value&
+    insert(Key const& key, std::size_t hash, Value value)
+    {
+        if ((size_ + 1) * 2 > slots_.size())
+            grow();
+
+        auto i = hash & (slots_.size() - 1);
+        while (slots_[i].used)
+            i = (i + 1) & (slots_.size() - 1);
+
+        slots_[i] = Slot{key, std::move(value), hash, true};
+        ++size_;
+        return slots_[i].value;
+    }
+
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    template <class F>
+    void
+    forEach(F&& f) const
+    {
+        for (auto const& s : slots_)
+            if (s.used)
+                f(s.key, s.value);
+    }
+};
+
+}  // namespace detail
+
+/**
+ * This map acts as both a read and write cache for hook execution and is
+ * preserved across the execution of the set of hook chains being executed in
+ * the current transaction. It is committed to the ledger only upon tesSuccess
+ * for the otxn.
+ *
+ * Entries are kept in a flat hash table keyed by (account, namespace, key)
+ * and their values are copied into an arena owned by the map, so the whole
+ * map is released at once when the transaction is done with it.
+ */
+class HookStateMap
+{
+public:
+    struct AccountInfo
+    {
+        int64_t availableForReserves = 0;  // remaining available ownercount
+        int64_t namespaceCount = 0;        // total namespace count
+    };
+
+    struct Entry
+    {
+        bool modified = false;  // is modified from ledger value
+        std::uint8_t* data = nullptr;
+        std::uint32_t size = 0;
+        std::uint32_t capacity = 0;
+
+        ripple::Slice
+        value() const
+        {
+            return {data, size};
+        }
+    };
+
+    struct Key
+    {
+        ripple::AccountID acc;
+        ripple::uint256 ns;
+        ripple::uint256 key;
+
+        friend bool
+        operator==(Key const& a, Key const& b)
+        {
+            return a.key == b.key && a.ns == b.ns && a.acc == b.acc;
+        }
+
+        // the order state is committed in
+        friend bool
+        operator<(Key const& a, Key const& b)
+        {
+            return std::tie(a.acc, a.ns, a.key) < std::tie(b.acc, b.ns, b.key);
+        }
+
+        template <class Hasher>
+        friend void
+        hash_append(Hasher& h, Key const& k) noexcept
+        {
+            using beast::hash_append;
+            hash_append(h, k.acc, k.ns, k.key);
+        }
+    };
+
+private:
+    struct NamespaceKey
+    {
+        ripple::AccountID acc;
+        ripple::uint256 ns;
+
+        friend bool
+        operator==(NamespaceKey const& a, NamespaceKey const& b)
+        {
+            return a.ns == b.ns && a.acc == b.acc;
+        }
+
+        template <class Hasher>
+        friend void
+        hash_append(Hasher& h, NamespaceKey const& k) noexcept
+        {
+            using beast::hash_append;
+            hash_append(h, k.acc, k.ns);
+        }
+    };
+
+    // most transactions touch little state, serve those from the stack
+    std::array<std::byte, 4096> initialBuffer_;
+    std::pmr::monotonic_buffer_resource arena_;
+
+    ripple::hardened_hash<> hasher_;
+    detail::FlatTable<ripple::AccountID, AccountInfo> accounts_;
+    detail::FlatTable<NamespaceKey, bool> namespaces_;
+    detail::FlatTable<Key, Entry> entries_;
+
+    void
+    store(Entry& entry, ripple::Slice const& value);
+
+public:
+    uint32_t modified_entry_count = 0;  // track the number of total modified
+
+    HookStateMap();
+
+    HookStateMap(HookStateMap const&) = delete;
+    HookStateMap&
+    operator=(HookStateMap const&) = delete;
+
+    AccountInfo*
+    findAccount(ripple::AccountID const& acc);
+
+    void
+    insertAccount(ripple::AccountID const& acc, AccountInfo info);
+
+    // has anything been cached for this namespace of this account
+    bool
+    hasNamespace(ripple::AccountID const& acc, ripple::uint256 const& ns);
+
+    Entry*
+    find(
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key);
+
+    void
+    insert(
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key,
+        bool modified,
+        ripple::Slice const& value);
+
+    // replace the value of an entry returned by find
+    void
+    assign(Entry& entry, ripple::Slice const& value)
+    {
+        store(entry, value);
+    }
+
+    std::size_t
+    size() const
+    {
+        return entries_.size();
+    }
+
+    /** The modified entries in (account, namespace, key) order. */
+    std::vector<std::pair<Key const*, Entry const*>>
+    modifiedEntries() const;
+};
+
+}  // namespace hook
+
+#endif
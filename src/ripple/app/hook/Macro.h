@@ -124,7 +124,10 @@
         int _stack = 0;                                             \
         FOR_VARS(VAR_ASSIGN, 2, __VA_ARGS__);                       \
         hook::HookContext* hookCtx =                                \
-            reinterpret_cast<hook::HookContext*>(data_ptr);         \
+            *reinterpret_cast<hook::HookContext**>(data_ptr);       \
+        static std::size_t const _profileId =                       \
+            hook::Profiler::functionId(#F);                         \
+        hook::Profiler::Call _profile{_profileId};                  \
         R return_code = hook_api::F(                                \
             *hookCtx,                                               \
             *const_cast<WasmEdge_CallingFrameContext*>(frameCtx),   \
@@ -159,7 +162,9 @@
         WasmEdge_Value* out)                                                 \
     {                                                                        \
         hook::HookContext* hookCtx =                                         \
-            reinterpret_cast<hook::HookContext*>(data_ptr);                  \
+            *reinterpret_cast<hook::HookContext**>(data_ptr);                \
+        static std::size_t const _profileId = hook::Profiler::functionId(#F); \
+        hook::Profiler::Call _profile{_profileId};                           \
         R return_code = hook_api::F(                                         \
             *hookCtx, *const_cast<WasmEdge_CallingFrameContext*>(frameCtx)); \
         if (return_code == RC_ROLLBACK || return_code == RC_ACCEPT)          \
@@ -229,6 +234,7 @@
                 bytes_to_write)))                                           \
             return INTERNAL_ERROR;                                          \
         bytes_written += bytes_to_write;                                    \
+        hook::Profiler::addBytes(bytes_to_write);                           \
     }
 
 #define WRITE_WASM_MEMORY_AND_RETURN( \
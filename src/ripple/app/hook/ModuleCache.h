@@ -0,0 +1,253 @@
+#ifndef HOOK_MODULECACHE_INCLUDED
+#define HOOK_MODULECACHE_INCLUDED 1
+#include <ripple/basics/Expected.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <wasmedge/wasmedge.h>
+
+namespace ripple {
+class JobQueue;
+}
+
+namespace hook {
+
+/**
+ * A hook's web assembly after it has been parsed and validated by wasmedge.
+ * The underlying AST module can be instantiated into any number of VMs.
+ */
+class HookModule
+{
+private:
+    WasmEdge_ASTModuleContext* ast_;
+    bool const native_;
+
+public:
+    // wasmedge re-validates (and annotates) the AST on every instantiation
+    // so instantiations of the same module are serialized through this mutex.
+    // It is held only while a vm instantiates the module, never while the
+    // instance runs.
+    std::mutex mutable instantiateMutex;
+
+    explicit HookModule(WasmEdge_ASTModuleContext* ast, bool native = false)
+        : ast_(ast), native_(native)
+    {
+    }
+
+    HookModule(HookModule const&) = delete;
+    HookModule&
+    operator=(HookModule const&) = delete;
+
+    ~HookModule()
+    {
+        if (ast_)
+            WasmEdge_ASTModuleDelete(ast_);
+    }
+
+    WasmEdge_ASTModuleContext const*
+    ast() const
+    {
+        return ast_;
+    }
+
+    // true if the module was loaded from an ahead-of-time compiled artifact
+    bool
+    native() const
+    {
+        return native_;
+    }
+
+    /**
+     * Parse and validate a web assembly blob, returning either the resulting
+     * module or a description of why wasmedge rejected it.
+     */
+    static ripple::Expected<std::shared_ptr<HookModule const>, std::string>
+    load(ripple::Slice const& wasm);
+
+    /**
+     * Load a module previously written by compile(). Such a module runs as
+     * native code but counts instructions exactly as the interpreter does.
+     */
+    static ripple::Expected<std::shared_ptr<HookModule const>, std::string>
+    loadNative(boost::filesystem::path const& path);
+
+    /**
+     * Compile a web assembly blob to a native shared object at path.
+     * Returns a description of the failure, if any.
+     */
+    static std::optional<std::string>
+    compile(ripple::Slice const& wasm, boost::filesystem::path const& path);
+};
+
+/**
+ * Process-wide cache of loaded and validated hook modules keyed by HookHash.
+ *
+ * Without it every hook execution would parse and validate the same
+ * sfCreateCode bytes again. The cache is bounded to a fixed number of
+ * modules and evicts the least recently used one when full. Entries are
+ * also evicted when the HookDefinition they were loaded from is deleted.
+ *
+ * When an AOT path is configured hooks are additionally compiled to native
+ * code in the background and stored there keyed by HookHash. Once compiled
+ * the native module replaces the interpreted one, both in the cache and on
+ * any later miss. Each artifact is stored with a tag naming the digest of the
+ * code and the compiler version and configuration it was built with, and is
+ * only loaded if that tag is the one the code would be compiled with now.
+ */
+class ModuleCache
+{
+private:
+    using lru_list = std::list<ripple::uint256>;
+
+    struct Entry
+    {
+        std::shared_ptr<HookModule const> module;
+        lru_list::iterator lruPos;
+    };
+
+    std::mutex mutable mutex_;
+    std::size_t targetSize_;
+    lru_list lru_;  // most recently used at the front
+    ripple::hash_map<ripple::uint256, Entry> entries_;
+
+    boost::filesystem::path const aotPath_;
+    bool const aotOnInstall_;
+    std::set<ripple::uint256> compiling_;
+
+    // hooks whose artifact didn't match their tag and was discarded
+    std::set<ripple::uint256> stale_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+
+    beast::Journal const j_;
+
+public:
+    ModuleCache(
+        std::size_t targetSize,
+        std::string const& aotPath,
+        bool aotOnInstall,
+        beast::Journal j);
+
+    /**
+     * Return the module for hookHash, loading it from wasm on a miss.
+     * The wasm must be the CreateCode that hashes to hookHash.
+     */
+    ripple::Expected<std::shared_ptr<HookModule const>, std::string>
+    fetch(ripple::uint256 const& hookHash, ripple::Slice const& wasm);
+
+    /**
+     * Compile hookHash to native code and make the cache use it. This blocks
+     * for as long as the compiler takes, prefer compileAsync.
+     * Returns false if AOT is disabled or compilation failed.
+     */
+    bool
+    compile(ripple::uint256 const& hookHash, ripple::Slice const& wasm);
+
+    /**
+     * Schedule compile() on the job queue unless the hook is already
+     * compiled or being compiled.
+     */
+    void
+    compileAsync(
+        ripple::JobQueue& jobQueue,
+        ripple::uint256 const& hookHash,
+        ripple::Slice const& wasm);
+
+    bool
+    aotEnabled() const
+    {
+        return !aotPath_.empty();
+    }
+
+    // should new HookDefinitions be compiled by SetHook, or on execution
+    bool
+    aotOnInstall() const
+    {
+        return aotEnabled() && aotOnInstall_;
+    }
+
+    bool
+    aotOnExecution() const
+    {
+        return aotEnabled() && !aotOnInstall_;
+    }
+
+    /**
+     * Whether the compiled artifact for hookHash was found not to match its
+     * code and discarded. Such a hook should be compiled again whether AOT
+     * compilation happens on install or on execution.
+     */
+    bool
+    stale(ripple::uint256 const& hookHash) const;
+
+    /** Drop the module for hookHash, if cached. */
+    void
+    erase(ripple::uint256 const& hookHash);
+
+    void
+    setTargetSize(std::size_t size);
+
+    std::size_t
+    size() const;
+
+    std::uint64_t
+    hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    evictions() const
+    {
+        return evictions_.load(std::memory_order_relaxed);
+    }
+
+    float
+    getHitRate() const;
+
+private:
+    boost::filesystem::path
+    nativePath(ripple::uint256 const& hookHash) const;
+
+    boost::filesystem::path
+    tagPath(ripple::uint256 const& hookHash) const;
+
+    // is the artifact for hookHash tagged as compiled from wasm by this
+    // compiler with this configuration
+    bool
+    verified(ripple::uint256 const& hookHash, ripple::Slice const& wasm) const;
+
+    // cache module for hookHash, replacing any existing entry if replace
+    // is set. Returns the module now cached
+    std::shared_ptr<HookModule const>
+    insert(
+        ripple::uint256 const& hookHash,
+        std::shared_ptr<HookModule const> const& module,
+        bool replace);
+
+    // must be called with mutex_ held
+    void
+    trim();
+};
+
+}  // namespace hook
+
+#endif
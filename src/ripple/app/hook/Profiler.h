@@ -0,0 +1,173 @@
+#ifndef HOOK_PROFILER_INCLUDED
+#define HOOK_PROFILER_INCLUDED 1
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hook {
+
+/**
+ * Opt-in profiling of hook execution.
+ *
+ * Wall time, counts and bytes written into hook memory are aggregated per
+ * HookHash (around executeWasm) and per Hook API host function (around
+ * every DEFINE_HOOK_FUNCTION body). Each thread that executes hooks owns a
+ * shard of counters it updates without taking a lock; readers sum the shards.
+ *
+ * When profiling is off the only cost left is a thread local load per host
+ * function call.
+ */
+class Profiler
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // more than the number of functions the Hook API has
+    static constexpr std::size_t maxFunctions = 256;
+
+private:
+    struct FunctionCounters
+    {
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> ns{0};
+        std::atomic<std::uint64_t> bytes{0};
+    };
+
+    struct HookCounters
+    {
+        std::atomic<std::uint64_t> executions{0};
+        std::atomic<std::uint64_t> ns{0};
+        std::atomic<std::uint64_t> instructions{0};
+        std::atomic<std::uint64_t> hostCalls{0};
+        std::atomic<std::uint64_t> hostNs{0};
+        std::atomic<std::uint64_t> bytes{0};
+    };
+
+    // Only the owning thread writes to a shard. It also inserts into hooks,
+    // which it does under mutex so that readers can walk the map.
+    struct Shard
+    {
+        std::thread::id owner;
+        std::array<FunctionCounters, maxFunctions> functions;
+        std::mutex mutable mutex;
+        ripple::hash_map<ripple::uint256, std::unique_ptr<HookCounters>> hooks;
+    };
+
+    // what the host functions of the running hook have added up to so far
+    struct Accumulator
+    {
+        Shard* shard;
+        std::uint64_t calls = 0;
+        std::uint64_t ns = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    static thread_local Accumulator* current_;
+
+    bool const enabled_;
+    std::uint64_t const instance_;
+
+    std::mutex mutable mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard&
+    shard();
+
+public:
+    explicit Profiler(bool enabled);
+
+    Profiler(Profiler const&) = delete;
+    Profiler&
+    operator=(Profiler const&) = delete;
+
+    bool
+    enabled() const
+    {
+        return enabled_;
+    }
+
+    /** The id a host function's counters are kept under. */
+    static std::size_t
+    functionId(char const* name);
+
+    /** Record bytes the running host function wrote into hook memory. */
+    static void
+    addBytes(std::uint64_t bytes)
+    {
+        if (auto* acc = current_)
+            acc->bytes += bytes;
+    }
+
+    /** Profiles one execution of a hook, for the lifetime of the object. */
+    class Execution
+    {
+        Profiler* profiler_ = nullptr;
+        ripple::uint256 const& hookHash_;
+        std::uint64_t const& instructions_;
+        Accumulator acc_{nullptr};
+        Accumulator* previous_ = nullptr;
+        clock_type::time_point start_;
+
+    public:
+        // instructions is read when the execution ends
+        Execution(
+            Profiler& profiler,
+            ripple::uint256 const& hookHash,
+            std::uint64_t const& instructions);
+
+        Execution(Execution const&) = delete;
+        Execution&
+        operator=(Execution const&) = delete;
+
+        ~Execution();
+    };
+
+    /** Profiles one host function call, for the lifetime of the object. */
+    class Call
+    {
+        Accumulator* acc_;
+        std::size_t const id_;
+        std::uint64_t bytes_ = 0;
+        clock_type::time_point start_;
+
+    public:
+        explicit Call(std::size_t id) : acc_(current_), id_(id)
+        {
+            if (acc_)
+            {
+                bytes_ = acc_->bytes;
+                start_ = clock_type::now();
+            }
+        }
+
+        Call(Call const&) = delete;
+        Call&
+        operator=(Call const&) = delete;
+
+        ~Call()
+        {
+            if (acc_)
+                finish();
+        }
+
+    private:
+        void
+        finish();
+    };
+
+    /** The counters summed over all threads. */
+    Json::Value
+    json() const;
+};
+
+}  // namespace hook
+
+#endif
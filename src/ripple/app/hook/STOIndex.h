@@ -0,0 +1,170 @@
+#ifndef HOOK_STOINDEX_INCLUDED
+#define HOOK_STOINDEX_INCLUDED 1
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hook {
+
+/**
+ * The top level fields of a serialized object, parsed once.
+ *
+ * The scan is the one the sto_* Hook APIs have always made: fields are read
+ * in order from the start of the buffer until the end is reached, a field
+ * fails to parse or 1024 fields have been read. Every field read before the
+ * scan stopped is kept with its offsets, so that looking fields up by id or
+ * by position no longer walks the buffer from the start each time.
+ */
+class STOIndex
+{
+public:
+    // negative results of parseField
+    enum ParseError : int32_t {
+        unexpectedEnd = -1,
+        unknownTypeEarly = -2,  // detected early
+        unknownTypeLate = -3,   // end of function
+        excessiveNesting = -4,
+        excessiveSize = -5
+    };
+
+    struct Field
+    {
+        std::uint32_t id;             // type << 16 | field
+        std::uint32_t offset;         // of the field's header
+        std::uint32_t length;         // header, payload and any end marker
+        std::uint32_t payloadOffset;  // from the start of the object
+        std::uint32_t payloadLength;
+    };
+
+    // the most fields a scan reads
+    static constexpr std::size_t maxFields = 1024;
+
+private:
+    std::vector<Field> fields_;
+    // (id, position) in order, the first of equal ids is the earliest field
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> byId_;
+    // the largest id among the fields up to and including each position
+    std::vector<std::uint32_t> maxId_;
+    std::size_t size_ = 0;
+    std::size_t end_ = 0;
+    bool parseError_ = false;
+
+public:
+    STOIndex() = default;
+
+    STOIndex(std::uint8_t const* data, std::size_t size);
+
+    /**
+     * Parse the field whose header is at start. Returns the length of the
+     * field including its header (and end marker for objects and arrays) or
+     * a ParseError. The payload is at start + payloadStart.
+     */
+    static std::int32_t
+    parseField(
+        std::uint8_t const* start,
+        std::uint8_t const* end,
+        int& type,
+        int& field,
+        int& payloadStart,
+        int& payloadLength,
+        int depth = 0);
+
+    /** The fields read, in serialized order. */
+    std::vector<Field> const&
+    fields() const
+    {
+        return fields_;
+    }
+
+    /** The first field with the id, if any was read. */
+    Field const*
+    find(std::uint32_t id) const;
+
+    /** The first field whose id is not less than id, if any was read. */
+    Field const*
+    lowerBound(std::uint32_t id) const;
+
+    /**
+     * What sto_subfield returns for the first field with the id: the offset
+     * and length of its payload, or of the whole field for arrays, joined as
+     * offset << 32 | length. PARSE_ERROR if the field wasn't read and the
+     * scan didn't end cleanly at the end of the buffer, else DOESNT_EXIST.
+     */
+    std::int64_t
+    subfield(std::uint32_t id) const;
+
+    /**
+     * What sto_subarray returns for the entry at position of an array whose
+     * skip leading bytes were left out of the index: the offset and length
+     * of the whole entry joined as for subfield, or the same errors.
+     */
+    std::int64_t
+    subarray(std::uint32_t position, std::uint32_t skip = 0) const;
+
+    /** Whether the scan stopped at a field that did not parse. */
+    bool
+    parseError() const
+    {
+        return parseError_;
+    }
+
+    /**
+     * The offset the scan stopped at. The last field read may claim more
+     * bytes than the buffer has, leaving this past the end.
+     */
+    std::size_t
+    end() const
+    {
+        return end_;
+    }
+
+    /** Whether the fields read make up exactly the whole buffer. */
+    bool
+    valid() const
+    {
+        return !parseError_ && end_ == size_;
+    }
+};
+
+/**
+ * The indexes built for the buffers a hook passed to the sto_* APIs during
+ * one execution, so that repeated calls on the same buffer parse it once.
+ *
+ * An index is found again by the buffer's location in hook memory and a hash
+ * of its content. The content is also compared in full, a buffer that was
+ * rewritten in place is indexed again.
+ */
+class STOIndexCache
+{
+private:
+    struct Entry
+    {
+        std::uint32_t ptr;
+        std::size_t hash;
+        std::vector<std::uint8_t> bytes;
+        STOIndex index;
+    };
+
+    // how many buffers are remembered, the oldest is replaced first
+    static constexpr std::size_t maxEntries = 8;
+
+    // larger buffers are indexed for the call but not remembered
+    static constexpr std::size_t maxBytes = 16384;
+
+    std::vector<Entry> entries_;
+    std::size_t next_ = 0;
+    STOIndex uncached_;
+
+public:
+    /**
+     * The index of the len bytes at data, which hooks see at ptr in their
+     * memory. The reference is valid until the next call.
+     */
+    STOIndex const&
+    get(std::uint32_t ptr, std::uint8_t const* data, std::size_t len);
+};
+
+}  // namespace hook
+
+#endif
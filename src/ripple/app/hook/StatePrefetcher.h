@@ -0,0 +1,114 @@
+#ifndef HOOK_STATEPREFETCHER_INCLUDED
+#define HOOK_STATEPREFETCHER_INCLUDED 1
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/protocol/AccountID.h>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+class Ledger;
+}
+
+namespace hook {
+
+/**
+ * Warms the node store for the hook state a hook chain is about to read.
+ *
+ * For every (account, namespace) whose state hooks have reached for, the
+ * most recently touched keys are remembered. Before a chain executes, the
+ * SHAMap paths to the namespace's directory and to those keys are requested
+ * from the node store in the background, so that the hooks find them in
+ * memory instead of waiting on a synchronous fetch for each one.
+ *
+ * A touched key counts as a hit if it was among the remembered keys, that is
+ * if it would have been prefetched, and as a miss otherwise.
+ */
+class StatePrefetcher
+{
+private:
+    using NamespaceID = std::pair<ripple::AccountID, ripple::uint256>;
+
+    struct Namespace
+    {
+        NamespaceID id;
+        std::vector<ripple::uint256> keys;  // most recently touched first
+    };
+
+    using lru_list = std::list<Namespace>;
+
+    // bounds the memory spent on namespaces that are no longer used
+    static constexpr std::size_t maxNamespaces = 4096;
+
+    std::size_t const keysPerNamespace_;
+
+    std::mutex mutable mutex_;
+    lru_list lru_;  // most recently touched at the front
+    ripple::hash_map<NamespaceID, lru_list::iterator> index_;
+
+    std::atomic<std::uint64_t> prefetches_{0};
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+
+public:
+    // 0 keys per namespace disables prefetching
+    explicit StatePrefetcher(std::size_t keysPerNamespace);
+
+    StatePrefetcher(StatePrefetcher const&) = delete;
+    StatePrefetcher&
+    operator=(StatePrefetcher const&) = delete;
+
+    bool
+    enabled() const
+    {
+        return keysPerNamespace_ != 0;
+    }
+
+    /**
+     * Request the paths for the namespace's directory and its remembered
+     * keys in the state map of ledger. Returns without waiting for them.
+     */
+    void
+    prefetch(
+        std::shared_ptr<ripple::Ledger const> const& ledger,
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns);
+
+    /** Record that a hook read or created the state entry at key. */
+    void
+    touched(
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key);
+
+    // the number of paths requested
+    std::uint64_t
+    prefetches() const
+    {
+        return prefetches_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    float
+    getHitRate() const;
+};
+
+}  // namespace hook
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef HOOK_TRACESINK_INCLUDED
+#define HOOK_TRACESINK_INCLUDED 1
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/AccountID.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace hook {
+
+/**
+ * Where the trace, trace_num and trace_float Hook APIs write to.
+ *
+ * A trace is wanted when the View journal logs at trace level, or when an
+ * admin is subscribed to the hook_traces stream. When neither is the case
+ * the host functions return before touching the hook's arguments.
+ *
+ * Otherwise the host function copies the raw message and payload into a
+ * fixed size ring buffer, without locking, allocating or formatting. A
+ * background thread drains the buffer, formats each record the way the host
+ * functions used to and writes it to the journal and the stream. If the
+ * buffer is full the record is dropped and counted; applying a ledger never
+ * waits on a trace.
+ *
+ * A dry run writes nothing here. Its traces are kept by the Capture on its
+ * thread, if there is one, and dropped otherwise.
+ */
+class TraceSink
+{
+public:
+    enum class Kind : std::uint8_t {
+        text,    // trace
+        number,  // trace_num
+        xfl,     // trace_float
+    };
+
+    // the most the host functions keep of a message and a payload
+    static constexpr std::size_t maxMessage = 128;
+    static constexpr std::size_t maxData = 1023;
+
+    struct Record
+    {
+        ripple::uint256 hookHash;
+        ripple::AccountID account;
+        ripple::AccountID otxnAccount;
+        ripple::uint256 txID;
+
+        Kind kind = Kind::text;
+        // trace: the hook passed a message, even if it was only a \0
+        bool hasMessage = false;
+        // trace: render data as hex
+        bool asHex = false;
+        std::uint8_t messageSize = 0;
+        std::uint16_t dataSize = 0;
+        // trace_num: the number; trace_float: the XFL
+        std::int64_t number = 0;
+
+        std::array<char, maxMessage> message;
+        std::array<std::uint8_t, maxData> data;
+
+        std::string_view
+        messageView() const
+        {
+            return {message.data(), messageSize};
+        }
+    };
+
+    using Publish = std::function<void(Json::Value const&)>;
+
+    // records held before the drain thread catches up, a power of two
+    static constexpr std::size_t capacity = 2048;
+
+    /** While alive, the records written on the thread which made it are
+        kept here instead of being queued, up to capacity of them. Tracing
+        is enabled on that thread meanwhile.
+    */
+    class Capture
+    {
+        Capture* const previous_;
+        std::vector<Record> records_;
+
+        friend class TraceSink;
+
+    public:
+        Capture();
+
+        Capture(Capture const&) = delete;
+        Capture&
+        operator=(Capture const&) = delete;
+
+        ~Capture();
+
+        std::vector<Record> const&
+        records() const
+        {
+            return records_;
+        }
+
+        std::vector<Record>
+        release()
+        {
+            return std::move(records_);
+        }
+    };
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        Record record;
+    };
+
+    beast::Journal const j_;
+    std::unique_ptr<Cell[]> const cells_;
+
+    // producers claim cells here
+    std::atomic<std::size_t> enqueuePos_{0};
+    // the consumer, under consumerMutex_
+    std::size_t dequeuePos_ = 0;
+    std::mutex consumerMutex_;
+
+    std::atomic<bool> streaming_{false};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t reportedDropped_ = 0;
+
+    Publish publish_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+
+    static thread_local Capture* capture_;
+
+    void
+    run();
+
+    // hand out the next free cell, or nullptr when the buffer is full
+    Cell*
+    claim();
+
+public:
+    explicit TraceSink(beast::Journal j);
+
+    TraceSink(TraceSink const&) = delete;
+    TraceSink&
+    operator=(TraceSink const&) = delete;
+
+    ~TraceSink();
+
+    /** Whether a trace host function should record anything. */
+    bool
+    enabled() const
+    {
+        return capture_ || streaming_.load(std::memory_order_relaxed) ||
+            j_.trace();
+    }
+
+    /** Whether a Capture is keeping the records written on this thread. */
+    static bool
+    capturing()
+    {
+        return capture_;
+    }
+
+    /** Set while the hook_traces stream has subscribers. */
+    void
+    setStreaming(bool streaming)
+    {
+        streaming_.store(streaming, std::memory_order_relaxed);
+    }
+
+    /** Start the drain thread, which passes each record to publish while
+        streaming. Until then records are drained by the thread writing them.
+    */
+    void
+    start(Publish publish);
+
+    /** Drain what is left and join the drain thread. */
+    void
+    stop();
+
+    /** Fill in and queue one record.
+
+        @param fill Called with the record to write, in the buffer itself.
+        @return false if the buffer was full and the trace was dropped.
+    */
+    template <class F>
+    bool
+    write(F&& fill)
+    {
+        if (auto* capture = capture_)
+        {
+            if (capture->records_.size() >= capacity)
+                return false;
+            fill(capture->records_.emplace_back());
+            return true;
+        }
+
+        Cell* cell = claim();
+        if (!cell)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto const pos = cell->sequence.load(std::memory_order_relaxed);
+
+        // cells are reused, but only the sizes say how much of the buffers
+        // a record holds
+        Record& record = cell->record;
+        record.kind = Kind::text;
+        record.hasMessage = false;
+        record.asHex = false;
+        record.messageSize = 0;
+        record.dataSize = 0;
+        record.number = 0;
+        fill(record);
+
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        if (!running_.load(std::memory_order_acquire))
+            drain();
+        else if ((pos & (capacity / 4 - 1)) == 0)
+            // a burst of traces: wake the drain thread well before the
+            // buffer fills, once per quarter of it
+            cv_.notify_one();
+        return true;
+    }
+
+    /** Queue records a Capture kept, as if they were written now. */
+    void
+    replay(std::vector<Record> const& records)
+    {
+        for (auto const& r : records)
+            write([&](Record& record) { record = r; });
+    }
+
+    /** Format, log and publish every record written so far.
+
+        @return The number of records drained.
+    */
+    std::size_t
+    drain();
+
+    /** The number of traces dropped because the buffer was full. */
+    std::uint64_t
+    dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /** The line the host functions wrote to the journal for a record,
+        or an empty string if they wrote nothing.
+    */
+    static std::string
+    text(Record const& record);
+
+    /** The record, as sent to the hook_traces stream. */
+    static Json::Value
+    json(Record const& record);
+};
+
+}  // namespace hook
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef HOOK_VALIDATIONCACHE_INCLUDED
+#define HOOK_VALIDATIONCACHE_INCLUDED 1
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace hook {
+
+/** What validating a hook's CreateCode found. */
+struct CodeValidation
+{
+    // the worst case instruction counts of hook() and cbak(), unpopulated if
+    // the guard checker rejected the code
+    std::optional<std::pair<uint64_t, uint64_t>> wce;
+
+    // why wasmedge rejected the code, if it did
+    std::optional<std::string> wasmError;
+};
+
+/**
+ * Process-wide cache of CreateCode validation results keyed by HookHash and
+ * the guard rules version the code was checked under.
+ *
+ * SetHook checks the guards of, and instantiates, every CreateCode in
+ * preflight and again when the definition is created. Validation only
+ * depends on the code and the rules version, so each popular hook, installed
+ * by many accounts and seen on every reapply, is only validated once.
+ * The least recently used entry is evicted when the cache is full.
+ */
+class ValidationCache
+{
+private:
+    using Key = std::pair<ripple::uint256, uint64_t>;
+
+    struct Entry
+    {
+        Key key;
+        CodeValidation validation;
+    };
+
+    using lru_list = std::list<Entry>;
+
+    // an entry is a few dozen bytes, so this bounds the cache at well under
+    // a megabyte
+    static constexpr std::size_t maxEntries = 4096;
+
+    std::mutex mutable mutex_;
+    lru_list lru_;  // most recently used at the front
+    ripple::hash_map<Key, lru_list::iterator> index_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+
+public:
+    ValidationCache() = default;
+
+    ValidationCache(ValidationCache const&) = delete;
+    ValidationCache&
+    operator=(ValidationCache const&) = delete;
+
+    /** Return what validating hookHash under rulesVersion found, if known. */
+    std::optional<CodeValidation>
+    get(ripple::uint256 const& hookHash, uint64_t rulesVersion);
+
+    void
+    insert(
+        ripple::uint256 const& hookHash,
+        uint64_t rulesVersion,
+        CodeValidation const& validation);
+
+    std::size_t
+    size() const;
+
+    std::uint64_t
+    hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    float
+    getHitRate() const;
+};
+
+}  // namespace hook
+
+#endif
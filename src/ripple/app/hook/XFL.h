@@ -0,0 +1,814 @@
+#ifndef HOOK_XFL_INCLUDED
+#define HOOK_XFL_INCLUDED 1
+#include <ripple/app/hook/Enum.h>
+#include <ripple/basics/IOUAmount.h>
+#include <ripple/basics/Number.h>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/**
+ * Kernels of the float_* Hook APIs.
+ *
+ * An XFL is a positive int64 holding a sign bit, an exponent and a mantissa
+ * which is always normalized to 16 significant digits. The kernels below
+ * return exactly what the Hook APIs have always returned, bit for bit and
+ * error code for error code, but work on the packed mantissa and exponent
+ * with fixed width integer arithmetic instead of going through cpp_int,
+ * IOUAmount and Number, and without loops whose length depends on the
+ * operands. HookXFL compares each kernel with the previous implementation.
+ */
+namespace hook_float {
+
+using namespace hook_api;
+
+// power of 10 LUT for fast integer math
+inline constexpr int64_t power_of_ten[19] = {
+    1LL,
+    10LL,
+    100LL,
+    1000LL,
+    10000LL,
+    100000LL,
+    1000000LL,
+    10000000LL,
+    100000000LL,
+    1000000000LL,
+    10000000000LL,
+    100000000000LL,
+    1000000000000LL,
+    10000000000000LL,
+    100000000000000LL,
+    1000000000000000LL,  // 15
+    10000000000000000LL,
+    100000000000000000LL,
+    1000000000000000000LL,
+};
+
+// the same, extended to the largest power that fits a uint64
+inline constexpr uint64_t power_of_ten_u64[20] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,  // 15
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+inline constexpr int64_t minMantissa = 1000000000000000ull;
+inline constexpr int64_t maxMantissa = 9999999999999999ull;
+inline constexpr int32_t minExponent = -96;
+inline constexpr int32_t maxExponent = 80;
+
+inline constexpr int32_t
+get_exponent(int64_t float1)
+{
+    if (float1 < 0)
+        return INVALID_FLOAT;
+    if (float1 == 0)
+        return 0;
+    uint64_t float_in = (uint64_t)float1;
+    float_in >>= 54U;
+    float_in &= 0xFFU;
+    return ((int32_t)float_in) - 97;
+}
+
+inline constexpr int64_t
+get_mantissa(int64_t float1)
+{
+    if (float1 < 0)
+        return INVALID_FLOAT;
+    if (float1 == 0)
+        return 0;
+    float1 -= ((((uint64_t)float1) >> 54U) << 54U);
+    return float1;
+}
+
+inline constexpr bool
+is_negative(int64_t float1)
+{
+    return ((float1 >> 62U) & 1ULL) == 0;
+}
+
+inline constexpr int64_t
+invert_sign(int64_t float1)
+{
+    int64_t r = (int64_t)(((uint64_t)float1) ^ (1ULL << 62U));
+    return r;
+}
+
+inline constexpr int64_t
+set_sign(int64_t float1, bool set_negative)
+{
+    bool neg = is_negative(float1);
+    if ((neg && set_negative) || (!neg && !set_negative))
+        return float1;
+
+    return invert_sign(float1);
+}
+
+inline constexpr int64_t
+set_mantissa(int64_t float1, uint64_t mantissa)
+{
+    if (mantissa > maxMantissa)
+        return MANTISSA_OVERSIZED;
+    if (mantissa < minMantissa)
+        return MANTISSA_UNDERSIZED;
+    return float1 - get_mantissa(float1) + mantissa;
+}
+
+inline constexpr int64_t
+set_exponent(int64_t float1, int32_t exponent)
+{
+    if (exponent > maxExponent)
+        return EXPONENT_OVERSIZED;
+    if (exponent < minExponent)
+        return EXPONENT_UNDERSIZED;
+
+    uint64_t exp = (exponent + 97);
+    exp <<= 54U;
+    float1 &= ~(0xFFLL << 54);
+    float1 += (int64_t)exp;
+    return float1;
+}
+
+// the XFL of an IOUAmount's signed mantissa and exponent, including the
+// error codes set_mantissa and set_exponent give for zero and out of range
+// amounts
+inline constexpr int64_t
+make_float(int64_t man_out, int32_t exponent)
+{
+    int64_t float_out = 0;
+    bool neg = man_out < 0;
+    if (neg)
+        man_out *= -1;
+
+    float_out = set_sign(float_out, neg);
+    float_out = set_mantissa(float_out, (uint64_t)man_out);
+    float_out = set_exponent(float_out, exponent);
+    return float_out;
+}
+
+inline int64_t
+make_float(ripple::IOUAmount& amt)
+{
+    return make_float(amt.mantissa(), amt.exponent());
+}
+
+inline constexpr int64_t
+make_float(uint64_t mantissa, int32_t exponent, bool neg)
+{
+    if (mantissa == 0)
+        return 0;
+    if (mantissa > maxMantissa)
+        return MANTISSA_OVERSIZED;
+    if (mantissa < minMantissa)
+        return MANTISSA_UNDERSIZED;
+    if (exponent > maxExponent)
+        return EXPONENT_OVERSIZED;
+    if (exponent < minExponent)
+        return EXPONENT_UNDERSIZED;
+    int64_t out = 0;
+    out = set_mantissa(out, mantissa);
+    out = set_exponent(out, exponent);
+    out = set_sign(out, neg);
+    return out;
+}
+
+inline constexpr bool
+is_valid_float(int64_t float1)
+{
+    if (float1 < 0)
+        return false;
+    if (float1 == 0)
+        return true;
+    uint64_t mantissa = get_mantissa(float1);
+    int32_t exponent = get_exponent(float1);
+    return mantissa >= minMantissa && mantissa <= maxMantissa &&
+        exponent <= maxExponent && exponent >= minExponent;
+}
+
+inline constexpr int64_t float_one_internal =
+    make_float(1000000000000000ull, -15, false);
+
+// floor(log10(man)) for a non-zero man
+inline constexpr int32_t
+decimal_order(uint64_t man)
+{
+    // 1233 / 4096 is just above log10(2), so this is exact or one too big
+    int32_t const order = (std::bit_width(man) * 1233) >> 12;
+    return order - (man < power_of_ten_u64[order]);
+}
+
+/**
+ * The order of a non-zero mantissa as (int32_t)log10(man), which is how
+ * normalize_xfl has always found it. Away from the powers of ten that is
+ * decimal_order exactly. Right next to them the conversion to double and
+ * the rounding of log10 decide which way it falls, so there log10 is still
+ * what answers.
+ */
+inline int32_t
+mantissa_order(uint64_t man)
+{
+    constexpr uint64_t margin = 1000000000000ULL;  // relative 1e-12
+
+    int32_t const order = decimal_order(man);
+    uint64_t const below = power_of_ten_u64[order];
+    if (man - below <= below / margin)
+        return (int32_t)log10(man);
+    if (order < 19)
+    {
+        uint64_t const above = power_of_ten_u64[order + 1];
+        if (above - man <= above / margin)
+            return (int32_t)log10(man);
+    }
+    return order;
+}
+
+/**
+ * This function normalizes the mantissa and exponent passed, if it can.
+ * It returns the XFL and mutates the supplied manitssa and exponent.
+ * If a negative mantissa is provided then the returned XFL has the negative
+ * flag set. If there is an overflow error return XFL_OVERFLOW. On underflow
+ * returns canonical 0
+ */
+template <typename T>
+inline int64_t
+normalize_xfl(T& man, int32_t& exp, bool neg = false)
+{
+    if (man == 0)
+        return 0;
+
+    if (man == std::numeric_limits<int64_t>::min())
+        man++;
+
+    constexpr bool sman = std::is_same<T, int64_t>::value;
+    static_assert(sman || std::is_same<T, uint64_t>());
+
+    if constexpr (sman)
+    {
+        if (man < 0)
+        {
+            man *= -1LL;
+            neg = true;
+        }
+    }
+
+    // mantissa order
+    int32_t mo = mantissa_order(man);
+
+    // mo is at most 19 so the defensive checks on adjust made when it came
+    // from log10 directly can no longer fail
+    int32_t adjust = 15 - mo;
+
+    if (adjust > 0)
+    {
+        man *= power_of_ten[adjust];
+        exp -= adjust;
+    }
+    else if (adjust < 0)
+    {
+        man /= power_of_ten[-adjust];
+        exp -= adjust;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    // even after adjustment the mantissa can be outside the range by one place
+    // when log10 rounded across a power of ten
+    if (man < minMantissa)
+    {
+        if (man == minMantissa - 1LL)
+            man += 1LL;
+        else
+        {
+            man *= 10LL;
+            exp--;
+        }
+    }
+
+    if (man > maxMantissa)
+    {
+        if (man == maxMantissa + 1LL)
+            man -= 1LL;
+        else
+        {
+            man /= 10LL;
+            exp++;
+        }
+    }
+
+    if (exp < minExponent)
+    {
+        man = 0;
+        exp = 0;
+        return 0;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    if (exp > maxExponent)
+        return XFL_OVERFLOW;
+
+    int64_t ret = make_float((uint64_t)man, exp, neg);
+    if constexpr (sman)
+    {
+        if (neg)
+            man *= -1LL;
+    }
+
+    return ret;
+}
+
+inline int64_t
+float_multiply_internal_parts(
+    uint64_t man1,
+    int32_t exp1,
+    bool neg1,
+    uint64_t man2,
+    int32_t exp2,
+    bool neg2)
+{
+    // mantissas are below 2^54 so the product fits comfortably
+    unsigned __int128 const mult =
+        (unsigned __int128)man1 * man2 / power_of_ten_u64[15];
+    if (mult > std::numeric_limits<uint64_t>::max())
+        return XFL_OVERFLOW;
+    uint64_t man_out = (uint64_t)mult;
+
+    int32_t exp_out = exp1 + exp2 + 15;
+    bool neg_out = (neg1 && !neg2) || (!neg1 && neg2);
+    int64_t ret = normalize_xfl(man_out, exp_out, neg_out);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+    if (ret == EXPONENT_OVERSIZED)
+        return XFL_OVERFLOW;
+    return ret;
+}
+
+inline int64_t
+float_multiply_internal(int64_t float1, int64_t float2)
+{
+    if (!is_valid_float(float1) || !is_valid_float(float2))
+        return INVALID_FLOAT;
+
+    if (float1 == 0 || float2 == 0)
+        return 0;
+
+    return float_multiply_internal_parts(
+        get_mantissa(float1),
+        get_exponent(float1),
+        is_negative(float1),
+        get_mantissa(float2),
+        get_exponent(float2),
+        is_negative(float2));
+}
+
+inline int64_t
+float_divide_internal(int64_t float1, int64_t float2, bool hasFix)
+{
+    if (!is_valid_float(float1) || !is_valid_float(float2))
+        return INVALID_FLOAT;
+    if (float2 == 0)
+        return DIVISION_BY_ZERO;
+    if (float1 == 0)
+        return 0;
+
+    // special case: division by 1
+    // RH TODO: add more special cases (division by power of 10)
+    if (float2 == float_one_internal)
+        return float1;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    bool neg1 = is_negative(float1);
+    uint64_t man2 = get_mantissa(float2);
+    int32_t exp2 = get_exponent(float2);
+    bool neg2 = is_negative(float2);
+
+    int64_t tmp1 = normalize_xfl(man1, exp1);
+    int64_t tmp2 = normalize_xfl(man2, exp2);
+
+    if (tmp1 < 0 || tmp2 < 0)
+        return INVALID_FLOAT;
+
+    if (tmp1 == 0)
+        return 0;
+
+    while (man2 > man1)
+    {
+        man2 /= 10;
+        exp2++;
+    }
+
+    if (man2 == 0)
+        return DIVISION_BY_ZERO;
+
+    while (man2 < man1)
+    {
+        if (man2 * 10 > man1)
+            break;
+        man2 *= 10;
+        exp2--;
+    }
+
+    uint64_t man3 = 0;
+    int32_t exp3 = exp1 - exp2;
+
+    // long division in which the divisor, rather than the remainder, is
+    // shifted each step. Each digit is what repeatedly subtracting the divisor
+    // used to count: while the remainder is at least the divisor, or before
+    // fixFloatDivide while it is strictly greater
+    while (man2 > 0)
+    {
+        uint64_t i = hasFix ? man1 / man2
+                            : (man1 > man2 ? (man1 - 1) / man2 : 0);
+        man1 -= i * man2;
+
+        man3 *= 10;
+        man3 += i;
+        man2 /= 10;
+        if (man2 == 0)
+            break;
+        exp3--;
+    }
+
+    bool neg3 = !((neg1 && neg2) || (!neg1 && !neg2));
+
+    return normalize_xfl(man3, exp3, neg3);
+}
+
+// The guard digits Number keeps while adding, see Number::Guard
+class SumGuard
+{
+    uint64_t digits_ = 0;  // 16 decimal guard digits
+    bool xbit_ = false;    // has a non-zero digit been shifted off the end
+    bool sbit_ = false;    // the sign of the guard digits
+
+public:
+    void
+    set_negative()
+    {
+        sbit_ = true;
+    }
+
+    void
+    push(unsigned d)
+    {
+        xbit_ = xbit_ || (digits_ & 0xFULL) != 0;
+        digits_ >>= 4;
+        digits_ |= (d & 0xFULL) << 60;
+    }
+
+    // push n zeros
+    void
+    shift(int n)
+    {
+        if (n >= 16)
+        {
+            xbit_ = xbit_ || digits_ != 0;
+            digits_ = 0;
+        }
+        else if (n > 0)
+        {
+            xbit_ = xbit_ || (digits_ & ((1ULL << (4 * n)) - 1)) != 0;
+            digits_ >>= 4 * n;
+        }
+    }
+
+    unsigned
+    pop()
+    {
+        unsigned d = (digits_ & 0xF000'0000'0000'0000ULL) >> 60;
+        digits_ <<= 4;
+        return d;
+    }
+
+    int
+    round() const
+    {
+        auto const mode = ripple::Number::getround();
+
+        if (mode == ripple::Number::towards_zero)
+            return -1;
+
+        if (mode == ripple::Number::downward)
+            return sbit_ && (digits_ > 0 || xbit_) ? 1 : -1;
+
+        if (mode == ripple::Number::upward)
+            return !sbit_ && (digits_ > 0 || xbit_) ? 1 : -1;
+
+        if (digits_ > 0x5000'0000'0000'0000ULL)
+            return 1;
+        if (digits_ < 0x5000'0000'0000'0000ULL)
+            return -1;
+        return xbit_ ? 1 : 0;
+    }
+};
+
+// shift a mantissa right by n digits into the guard, as Number does one
+// digit at a time
+inline void
+shift_into_guard(int64_t& m, int32_t n, SumGuard& g)
+{
+    // a mantissa of 16 digits is gone after 17 shifts
+    int32_t const digits = n < 17 ? n : 17;
+    for (int32_t k = 0; k < digits; ++k)
+    {
+        g.push(m % 10);
+        m /= 10;
+    }
+    g.shift(n - digits);
+}
+
+// IOUAmount addition once STNumberSwitchover is on: Number addition of the
+// two normalized operands, then the range of IOUAmount. Number normalizes its
+// mantissa to the same 16 digits as XFL, only its exponent range is wider.
+inline int64_t
+float_sum_number(int64_t xm, int32_t xe, int64_t ym, int32_t ye)
+{
+    if (xm == -ym && xe == ye)
+        return 0;
+
+    int xn = 1;
+    if (xm < 0)
+    {
+        xm = -xm;
+        xn = -1;
+    }
+    int yn = 1;
+    if (ym < 0)
+    {
+        ym = -ym;
+        yn = -1;
+    }
+
+    SumGuard g;
+    if (xe < ye)
+    {
+        if (xn == -1)
+            g.set_negative();
+        shift_into_guard(xm, ye - xe, g);
+        xe = ye;
+    }
+    else if (xe > ye)
+    {
+        if (yn == -1)
+            g.set_negative();
+        shift_into_guard(ym, xe - ye, g);
+        ye = xe;
+    }
+
+    if (xn == yn)
+    {
+        xm += ym;
+        if (xm > maxMantissa)
+        {
+            g.push(xm % 10);
+            xm /= 10;
+            ++xe;
+        }
+        auto r = g.round();
+        if (r == 1 || (r == 0 && (xm & 1) == 1))
+        {
+            ++xm;
+            if (xm > maxMantissa)
+            {
+                xm /= 10;
+                ++xe;
+            }
+        }
+    }
+    else
+    {
+        if (xm > ym)
+        {
+            xm = xm - ym;
+        }
+        else
+        {
+            xm = ym - xm;
+            xe = ye;
+            xn = yn;
+        }
+        while (xm < minMantissa)
+        {
+            xm *= 10;
+            xm -= g.pop();
+            --xe;
+        }
+        auto r = g.round();
+        if (r == 1 || (r == 0 && (xm & 1) == 1))
+        {
+            --xm;
+            if (xm < minMantissa)
+            {
+                xm *= 10;
+                --xe;
+            }
+        }
+    }
+
+    if (xe > maxExponent)
+        return XFL_OVERFLOW;
+    if (xe < minExponent)
+        return 0;
+    return make_float(xm * xn, xe);
+}
+
+// IOUAmount addition before STNumberSwitchover, of two normalized operands
+inline int64_t
+float_sum_legacy(int64_t m1, int32_t e1, int64_t m2, int32_t e2)
+{
+    // dividing once truncates the same as dividing by 10 repeatedly
+    if (e1 < e2)
+    {
+        m1 = e2 - e1 > 18 ? 0 : m1 / power_of_ten[e2 - e1];
+        e1 = e2;
+    }
+    else if (e2 < e1)
+    {
+        m2 = e1 - e2 > 18 ? 0 : m2 / power_of_ten[e1 - e2];
+        e2 = e1;
+    }
+
+    // This addition cannot overflow an std::int64_t
+    m1 += m2;
+
+    if (m1 >= -10 && m1 <= 10)
+        return 0;
+
+    bool const negative = m1 < 0;
+    if (negative)
+        m1 = -m1;
+
+    if (m1 < minMantissa && e1 > minExponent)
+    {
+        int32_t scale = 15 - decimal_order(m1);
+        if (scale > e1 - minExponent)
+            scale = e1 - minExponent;
+        m1 *= power_of_ten[scale];
+        e1 -= scale;
+    }
+
+    // the sum of two mantissas has at most one digit too many
+    if (m1 > maxMantissa)
+    {
+        if (e1 >= maxExponent)
+            return XFL_OVERFLOW;
+        m1 /= 10;
+        ++e1;
+    }
+
+    if (e1 < minExponent || m1 < minMantissa)
+        return 0;
+
+    if (e1 > maxExponent)
+        return XFL_OVERFLOW;
+
+    return make_float(negative ? -m1 : m1, e1);
+}
+
+inline int64_t
+float_sum_internal(int64_t float1, int64_t float2)
+{
+    if (!is_valid_float(float1) || !is_valid_float(float2))
+        return INVALID_FLOAT;
+
+    if (float1 == 0)
+        return float2;
+    if (float2 == 0)
+        return float1;
+
+    int64_t man1 =
+        (int64_t)(get_mantissa(float1)) * (is_negative(float1) ? -1LL : 1LL);
+    int32_t exp1 = get_exponent(float1);
+    int64_t man2 =
+        (int64_t)(get_mantissa(float2)) * (is_negative(float2) ? -1LL : 1LL);
+    int32_t exp2 = get_exponent(float2);
+
+    if (ripple::getSTNumberSwitchover())
+        return float_sum_number(man1, exp1, man2, exp2);
+    return float_sum_legacy(man1, exp1, man2, exp2);
+}
+
+inline int64_t
+double_to_xfl(double x)
+{
+    if ((x) == 0)
+        return 0;
+    bool neg = x < 0;
+    double absresult = neg ? -x : x;
+
+    // first compute the base 10 order of the float
+    int32_t exp_out = (int32_t)log10(absresult);
+
+    // next adjust it into the valid mantissa range (this means dividing by its
+    // order and multiplying by 10**15)
+    absresult *= pow(10, -exp_out + 15);
+
+    // after adjustment the value may still fall below the minMantissa
+    int64_t result = (int64_t)absresult;
+    if (result < minMantissa)
+    {
+        if (result == minMantissa - 1LL)
+            result += 1LL;
+        else
+        {
+            result *= 10LL;
+            exp_out--;
+        }
+    }
+
+    // likewise the value can fall above the maxMantissa
+    if (result > maxMantissa)
+    {
+        if (result == maxMantissa + 1LL)
+            result -= 1LL;
+        else
+        {
+            result /= 10LL;
+            exp_out++;
+        }
+    }
+
+    exp_out -= 15;
+    int64_t ret = make_float(result, exp_out, neg);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+
+    return ret;
+}
+
+// log and root are computed in double precision, as they always have been,
+// so their results stay whatever the platform's libm makes them
+inline int64_t
+float_log_internal(int64_t float1)
+{
+    if (!is_valid_float(float1))
+        return INVALID_FLOAT;
+
+    if (float1 == 0)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1);
+    double result = log10(inp) + exp1;
+
+    return double_to_xfl(result);
+}
+
+inline int64_t
+float_root_internal(int64_t float1, uint32_t n)
+{
+    if (!is_valid_float(float1))
+        return INVALID_FLOAT;
+    if (float1 == 0)
+        return 0;
+
+    if (n < 2)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1)*pow(10, exp1);
+    double result = pow(inp, ((double)1.0f) / ((double)(n)));
+
+    return double_to_xfl(result);
+}
+
+}  // namespace hook_float
+#endif
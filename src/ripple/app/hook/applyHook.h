@@ -2,7 +2,11 @@
 #define APPLY_HOOK_INCLUDED 1
 #include <ripple/app/hook/Enum.h>
 #include <ripple/app/hook/Macro.h>
+#include <ripple/app/hook/HookStateMap.h>
 #include <ripple/app/hook/Misc.h>
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/app/hook/Profiler.h>
+#include <ripple/app/hook/STOIndex.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/tx/impl/ApplyContext.h>
 #include <ripple/basics/Blob.h>
@@ -23,27 +27,6 @@ struct HookResult;
 bool
 isEmittedTxn(ripple::STTx const& tx);
 
-// This map type acts as both a read and write cache for hook execution
-// and is preserved across the execution of the set of hook chains
-// being executed in the current transaction. It is committed to lgr
-// only upon tesSuccess for the otxn.
-class HookStateMap : public std::map<
-                         ripple::AccountID,  // account that owns the state
-                         std::tuple<
-                             int64_t,  // remaining available ownercount
-                             int64_t,  // total namespace count
-                             std::map<
-                                 ripple::uint256,  // namespace
-                                 std::map<
-                                     ripple::uint256,  // key
-                                     std::pair<
-                                         bool,  // is modified from ledger value
-                                         ripple::Blob>>>>>  // the value
-{
-public:
-    uint32_t modified_entry_count = 0;  // track the number of total modified
-};
-
 using namespace ripple;
 std::vector<std::pair<AccountID, bool>>
 getTransactionalStakeHolders(STTx const& tx, ReadView const& rv);
@@ -430,18 +413,31 @@ canHook(ripple::TxType txType, ripple::uint256 hookOn);
 
 struct HookResult;
 
+/**
+ * The parameters a hook executes with, name to value. Both borrow from the
+ * HookDefinition and Hook ledger entries they were gathered from, which must
+ * outlive the map.
+ */
+using HookParameters = std::map<ripple::Slice, ripple::Slice>;
+
+/**
+ * A view of a blob field of obj that borrows from it instead of copying.
+ * The field must be present.
+ */
+inline ripple::Slice
+peekFieldVL(ripple::STObject const& obj, ripple::SF_VL const& field)
+{
+    return obj.peekAtField(field).downcast<ripple::STBlob>().value();
+}
+
 HookResult
 apply(
-    ripple::uint256 const& hookSetTxnID, /* this is the txid of the sethook,
-                                            used for caching (one day) */
-    ripple::uint256 const&
-        hookHash, /* hash of the actual hook byte code, used for metadata */
+    ripple::uint256 const& hookSetTxnID, /* this is the txid of the sethook */
+    ripple::uint256 const& hookHash, /* hash of the actual hook byte code,
+                                        used for metadata and module caching */
     ripple::uint256 const& hookNamespace,
-    ripple::Blob const& wasm,
-    std::map<
-        std::vector<uint8_t>, /* param name  */
-        std::vector<uint8_t>  /* param value */
-        > const& hookParams,
+    ripple::Slice const& wasm, /* borrowed from the hook definition */
+    HookParameters const& hookParams,
     std::map<
         ripple::uint256, /* hook hash */
         std::map<std::vector<uint8_t>, std::vector<uint8_t>>> const&
@@ -491,7 +487,7 @@ struct HookResult
             >>
         hookParamOverrides;
 
-    std::map<std::vector<uint8_t>, std::vector<uint8_t>> const& hookParams;
+    HookParameters const& hookParams;
     std::set<ripple::uint256> hookSkips;
     hook_api::ExitType exitType = hook_api::ExitType::ROLLBACK;
     std::string exitReason{""};
@@ -518,6 +514,38 @@ struct SlotEntry
     std::shared_ptr<const ripple::STObject> storage;
     const ripple::STBase* entry;  // raw pointer into the storage, that can be
                                   // freely pointed around inside
+
+    // the serialization of entry, made the first time the hook copies or
+    // sizes the slot and shared with the slots copied from this one
+    std::shared_ptr<ripple::Blob const> serialized{};
+    const ripple::STBase* serializedEntry = nullptr;  // what was serialized
+
+    // entry serialized, which is only done again if entry has moved
+    ripple::Slice
+    serialize();
+};
+
+// The serialized form of every field present at the top level of an object,
+// made in one pass when the first of them is asked for.
+class SerializedFields
+{
+    struct Field
+    {
+        int fieldCode;
+        ripple::SerializedTypeID type;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    ripple::Blob bytes_;
+    std::vector<Field> fields_;  // by field code
+
+public:
+    explicit SerializedFields(ripple::STObject const& obj);
+
+    // what STBase::add writes for the field, if it is present
+    std::optional<std::pair<ripple::Slice, ripple::SerializedTypeID>>
+    find(int fieldCode) const;
 };
 
 struct HookContext
@@ -550,6 +578,12 @@ struct HookContext
                       // emitted txn then this optional becomes
                       // populated with the SLE
     const HookExecutor* module = 0;
+    // abort execution after this many instructions (featureHookCostLimit)
+    std::optional<uint64_t> costLimit{};
+    // buffers the sto_* functions were called on, parsed once
+    STOIndexCache stoIndexes{};
+    // the fields of the originating transaction, for otxn_field
+    std::optional<SerializedFields> otxnFields{};
 };
 
 bool
@@ -589,20 +623,19 @@ bool /* retval of true means an error */
 gatherHookParameters(
     std::shared_ptr<ripple::STLedgerEntry> const& hookDef,
     ripple::STObject const& hookObj,
-    std::map<std::vector<uint8_t>, std::vector<uint8_t>>& parameters,
+    HookParameters& parameters,
     beast::Journal const& j_);
 
-// RH TODO: call destruct for these on rippled shutdown
-#define ADD_HOOK_FUNCTION(F, ctx)                          \
-    {                                                      \
-        WasmEdge_FunctionInstanceContext* hf =             \
-            WasmEdge_FunctionInstanceCreate(               \
-                hook_api::WasmFunctionType##F,             \
-                hook_api::WasmFunction##F,                 \
-                (void*)(&ctx),                             \
-                0);                                        \
-        WasmEdge_ModuleInstanceAddFunction(                \
-            importObj, hook_api::WasmFunctionName##F, hf); \
+#define ADD_HOOK_FUNCTION(F, ctx)                           \
+    {                                                       \
+        WasmEdge_FunctionInstanceContext* hf =              \
+            WasmEdge_FunctionInstanceCreate(                \
+                hook_api::WasmFunctionType##F,              \
+                hook_api::WasmFunction##F,                  \
+                (void*)(&ctx),                              \
+                0);                                         \
+        WasmEdge_ModuleInstanceAddFunction(                 \
+            importObj_, hook_api::WasmFunctionName##F, hf); \
     }
 
 #define HR_ACC() hookResult.account << "-" << hookResult.otxnAccount
@@ -625,10 +658,67 @@ static WasmEdge_String hookFunctionName =
 // see: lib/system/allocator.cpp
 #define WasmEdge_kPageSize 65536ULL
 
+/**
+ * The "env" module hooks import the Hook Api from, along with a table and a
+ * memory. Creating it means creating and adding a function instance for every
+ * Hook Api so rather than build one per execution each thread keeps one and
+ * binds the executing hook's context to it for the duration of the execution.
+ * All of the host functions are created with a pointer to boundCtx as their
+ * data, see DEFINE_HOOK_FUNCTION.
+ */
+class HookAPIModule
+{
+private:
+    WasmEdge_ModuleInstanceContext* importObj_;
+    WasmEdge_TableInstanceContext* hostTable_;
+    WasmEdge_MemoryInstanceContext* hostMem_;
+
+    HookContext* boundCtx = nullptr;
+
+    // clear anything a previous execution left in the table or memory,
+    // returns false if that is not possible (the table has grown)
+    bool
+    reset();
+
+public:
+    HookAPIModule();
+    ~HookAPIModule();
+
+    HookAPIModule(HookAPIModule const&) = delete;
+    HookAPIModule&
+    operator=(HookAPIModule const&) = delete;
+
+    /**
+     * Binds a hook context to this thread's module, for the lifetime of the
+     * Binding. Should the thread's module already be bound (re-entrant
+     * execution) a private module is built instead.
+     */
+    class Binding
+    {
+    private:
+        std::unique_ptr<HookAPIModule> owned_;
+        HookAPIModule* module_;
+
+    public:
+        explicit Binding(HookContext& ctx);
+        ~Binding();
+
+        Binding(Binding const&) = delete;
+        Binding&
+        operator=(Binding const&) = delete;
+
+        WasmEdge_ModuleInstanceContext*
+        importObj() const
+        {
+            return module_->importObj_;
+        }
+    };
+};
+
 /**
  * HookExecutor is effectively a two-part function:
- * The first part sets up the Hook Api inside the wasm import, ready for use
- * (this is done during object construction.)
+ * The first part binds the hook context to the Hook Api import module
+ * (this is done at the start of executeWasm.)
  * The second part is actually executing webassembly instructions
  * this is done during execteWasm function.
  * The instance is single use.
@@ -640,7 +730,6 @@ private:
 
 public:
     HookContext& hookCtx;
-    WasmEdge_ModuleInstanceContext* importObj;
 
     class WasmEdgeVM
     {
@@ -648,12 +737,16 @@ public:
         WasmEdge_ConfigureContext* conf = NULL;
         WasmEdge_VMContext* ctx = NULL;
 
-        WasmEdgeVM()
+        explicit WasmEdgeVM(bool costMeasuring = false)
         {
             conf = WasmEdge_ConfigureCreate();
             if (!conf)
                 return;
             WasmEdge_ConfigureStatisticsSetInstructionCounting(conf, true);
+            // every instruction costs 1 with the default cost table, so the
+            // cost limit is an instruction limit
+            if (costMeasuring)
+                WasmEdge_ConfigureStatisticsSetCostMeasuring(conf, true);
             ctx = WasmEdge_VMCreate(conf, NULL);
         }
 
@@ -710,15 +803,14 @@ public:
     }
 
     /**
-     * Execute web assembly byte code against the constructed Hook Context
+     * Execute a loaded hook module against the constructed Hook Context
      * Once execution has occured the exector is spent and cannot be used again
      * and should be destructed Information about the execution is populated
      * into hookCtx
      */
     void
     executeWasm(
-        const void* wasm,
-        size_t len,
+        HookModule const& module,
         bool callback,
         uint32_t wasmParam,
         beast::Journal const& j)
@@ -733,7 +825,18 @@ public:
 
         WasmEdge_LogOff();
 
-        WasmEdgeVM vm;
+        // a dry run is not part of the profile
+        std::optional<Profiler::Execution> profile;
+        if (!(hookCtx.applyCtx.flags() & tapDRY_RUN))
+            profile.emplace(
+                hookCtx.applyCtx.app.getHookProfiler(),
+                hookCtx.result.hookHash,
+                hookCtx.result.instructionCount);
+
+        // bound before the vm is created so it is released after it is gone
+        HookAPIModule::Binding api{hookCtx};
+
+        WasmEdgeVM vm{hookCtx.costLimit.has_value()};
 
         if (!vm.sane())
         {
@@ -744,8 +847,12 @@ public:
             return;
         }
 
+        auto* statsCtx = WasmEdge_VMGetStatisticsContext(vm.ctx);
+        if (hookCtx.costLimit)
+            WasmEdge_StatisticsSetCostLimit(statsCtx, *hookCtx.costLimit);
+
         WasmEdge_Result res =
-            WasmEdge_VMRegisterModuleFromImport(vm.ctx, this->importObj);
+            WasmEdge_VMRegisterModuleFromImport(vm.ctx, api.importObj());
 
         if (auto err = getWasmError("Import phase failed", res); err)
         {
@@ -754,19 +861,46 @@ public:
             return;
         }
 
+        // the module is instantiated into this execution's own vm, only that
+        // reads the shared AST, so only that is serialized
+        {
+            std::lock_guard lock(module.instantiateMutex);
+            res = WasmEdge_VMLoadWasmFromASTModule(vm.ctx, module.ast());
+            if (WasmEdge_ResultOK(res))
+                res = WasmEdge_VMValidate(vm.ctx);
+            if (WasmEdge_ResultOK(res))
+                res = WasmEdge_VMInstantiate(vm.ctx);
+        }
+
+        if (auto err = getWasmError("Instantiation failed", res); err)
+        {
+            hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
+            JLOG(j.warn()) << "HookError[" << HC_ACC() << "]: " << *err;
+            return;
+        }
+
         WasmEdge_Value params[1] = {WasmEdge_ValueGenI32((int64_t)wasmParam)};
         WasmEdge_Value returns[1];
 
-        res = WasmEdge_VMRunWasmFromBuffer(
+        res = WasmEdge_VMExecute(
             vm.ctx,
-            reinterpret_cast<const uint8_t*>(wasm),
-            len,
             callback ? cbakFunctionName : hookFunctionName,
             params,
             1,
             returns,
             1);
 
+        if (hookCtx.costLimit &&
+            WasmEdge_ResultGetCode(res) == WasmEdge_ErrCode_CostLimitExceeded)
+        {
+            JLOG(j.debug()) << "HookInfo[" << HC_ACC()
+                            << "]: Instruction budget of " << *hookCtx.costLimit
+                            << " exhausted";
+            hookCtx.result.exitType = hook_api::ExitType::COST_LIMIT;
+            hookCtx.result.instructionCount = *hookCtx.costLimit;
+            return;
+        }
+
         if (auto err = getWasmError("WASM VM error", res); err)
         {
             JLOG(j.warn()) << "HookError[" << HC_ACC() << "]: " << *err;
@@ -774,124 +908,18 @@ public:
             return;
         }
 
-        auto* statsCtx = WasmEdge_VMGetStatisticsContext(vm.ctx);
         hookCtx.result.instructionCount =
             WasmEdge_StatisticsGetInstrCount(statsCtx);
 
         // RH NOTE: stack unwind will clean up WasmEdgeVM
     }
 
-    HookExecutor(HookContext& ctx)
-        : hookCtx(ctx), importObj(WasmEdge_ModuleInstanceCreate(exportName))
+    HookExecutor(HookContext& ctx) : hookCtx(ctx)
     {
         ctx.module = this;
 
         WasmEdge_LogSetDebugLevel();
-
-        ADD_HOOK_FUNCTION(_g, ctx);
-        ADD_HOOK_FUNCTION(accept, ctx);
-        ADD_HOOK_FUNCTION(rollback, ctx);
-        ADD_HOOK_FUNCTION(util_raddr, ctx);
-        ADD_HOOK_FUNCTION(util_accid, ctx);
-        ADD_HOOK_FUNCTION(util_verify, ctx);
-        ADD_HOOK_FUNCTION(util_sha512h, ctx);
-        ADD_HOOK_FUNCTION(sto_validate, ctx);
-        ADD_HOOK_FUNCTION(sto_subfield, ctx);
-        ADD_HOOK_FUNCTION(sto_subarray, ctx);
-        ADD_HOOK_FUNCTION(sto_emplace, ctx);
-        ADD_HOOK_FUNCTION(sto_erase, ctx);
-        ADD_HOOK_FUNCTION(util_keylet, ctx);
-
-        ADD_HOOK_FUNCTION(emit, ctx);
-        ADD_HOOK_FUNCTION(etxn_burden, ctx);
-        ADD_HOOK_FUNCTION(etxn_fee_base, ctx);
-        ADD_HOOK_FUNCTION(etxn_details, ctx);
-        ADD_HOOK_FUNCTION(etxn_reserve, ctx);
-        ADD_HOOK_FUNCTION(etxn_generation, ctx);
-        ADD_HOOK_FUNCTION(etxn_nonce, ctx);
-
-        ADD_HOOK_FUNCTION(float_set, ctx);
-        ADD_HOOK_FUNCTION(float_multiply, ctx);
-        ADD_HOOK_FUNCTION(float_mulratio, ctx);
-        ADD_HOOK_FUNCTION(float_negate, ctx);
-        ADD_HOOK_FUNCTION(float_compare, ctx);
-        ADD_HOOK_FUNCTION(float_sum, ctx);
-        ADD_HOOK_FUNCTION(float_sto, ctx);
-        ADD_HOOK_FUNCTION(float_sto_set, ctx);
-        ADD_HOOK_FUNCTION(float_invert, ctx);
-
-        ADD_HOOK_FUNCTION(float_divide, ctx);
-        ADD_HOOK_FUNCTION(float_one, ctx);
-        ADD_HOOK_FUNCTION(float_mantissa, ctx);
-        ADD_HOOK_FUNCTION(float_sign, ctx);
-        ADD_HOOK_FUNCTION(float_int, ctx);
-        ADD_HOOK_FUNCTION(float_log, ctx);
-        ADD_HOOK_FUNCTION(float_root, ctx);
-
-        ADD_HOOK_FUNCTION(otxn_burden, ctx);
-        ADD_HOOK_FUNCTION(otxn_generation, ctx);
-        ADD_HOOK_FUNCTION(otxn_field, ctx);
-        ADD_HOOK_FUNCTION(otxn_id, ctx);
-        ADD_HOOK_FUNCTION(otxn_type, ctx);
-        ADD_HOOK_FUNCTION(otxn_slot, ctx);
-        ADD_HOOK_FUNCTION(otxn_param, ctx);
-
-        ADD_HOOK_FUNCTION(hook_account, ctx);
-        ADD_HOOK_FUNCTION(hook_hash, ctx);
-        ADD_HOOK_FUNCTION(hook_again, ctx);
-        ADD_HOOK_FUNCTION(fee_base, ctx);
-        ADD_HOOK_FUNCTION(ledger_seq, ctx);
-        ADD_HOOK_FUNCTION(ledger_last_hash, ctx);
-        ADD_HOOK_FUNCTION(ledger_last_time, ctx);
-        ADD_HOOK_FUNCTION(ledger_nonce, ctx);
-        ADD_HOOK_FUNCTION(ledger_keylet, ctx);
-
-        ADD_HOOK_FUNCTION(hook_param, ctx);
-        ADD_HOOK_FUNCTION(hook_param_set, ctx);
-        ADD_HOOK_FUNCTION(hook_skip, ctx);
-        ADD_HOOK_FUNCTION(hook_pos, ctx);
-
-        ADD_HOOK_FUNCTION(state, ctx);
-        ADD_HOOK_FUNCTION(state_foreign, ctx);
-        ADD_HOOK_FUNCTION(state_set, ctx);
-        ADD_HOOK_FUNCTION(state_foreign_set, ctx);
-
-        ADD_HOOK_FUNCTION(slot, ctx);
-        ADD_HOOK_FUNCTION(slot_clear, ctx);
-        ADD_HOOK_FUNCTION(slot_count, ctx);
-        ADD_HOOK_FUNCTION(slot_set, ctx);
-        ADD_HOOK_FUNCTION(slot_size, ctx);
-        ADD_HOOK_FUNCTION(slot_subarray, ctx);
-        ADD_HOOK_FUNCTION(slot_subfield, ctx);
-        ADD_HOOK_FUNCTION(slot_type, ctx);
-        ADD_HOOK_FUNCTION(slot_float, ctx);
-
-        ADD_HOOK_FUNCTION(trace, ctx);
-        ADD_HOOK_FUNCTION(trace_num, ctx);
-        ADD_HOOK_FUNCTION(trace_float, ctx);
-
-        ADD_HOOK_FUNCTION(meta_slot, ctx);
-        ADD_HOOK_FUNCTION(xpop_slot, ctx);
-
-        /*
-        ADD_HOOK_FUNCTION(str_find, ctx);
-        ADD_HOOK_FUNCTION(str_replace, ctx);
-        ADD_HOOK_FUNCTION(str_compare, ctx);
-        ADD_HOOK_FUNCTION(str_concat, ctx);
-        */
-
-        WasmEdge_TableInstanceContext* hostTable =
-            WasmEdge_TableInstanceCreate(tableType);
-        WasmEdge_ModuleInstanceAddTable(importObj, tableName, hostTable);
-        WasmEdge_MemoryInstanceContext* hostMem =
-            WasmEdge_MemoryInstanceCreate(memType);
-        WasmEdge_ModuleInstanceAddMemory(importObj, memName, hostMem);
     }
-
-    ~HookExecutor()
-    {
-        WasmEdge_ModuleInstanceDelete(importObj);
-    };
 };
 
 }  // namespace hook
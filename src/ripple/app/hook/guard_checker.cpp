@@ -1,4 +1,5 @@
 #include "Guard.h"
+#include <chrono>
 #include <fcntl.h>
 #include <iostream>
 #include <optional>
@@ -6,6 +7,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <string>
 #include <string_view>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
@@ -17,14 +19,27 @@ main(int argc, char** argv)
 {
     const char* fin = 0;
 
-    if (argc > 2)
+    // when given, validate this many more times without logging and report
+    // the throughput of the validator
+    long iterations = 0;
+
+    if (argc > 3)
         return fprintf(
-            stderr, "Guard Checker\n\tUsage: %s somefile.wasm\n", argv[0]);
+            stderr,
+            "Guard Checker\n\tUsage: %s somefile.wasm [iterations]\n",
+            argv[0]);
     else if (argc == 1)
         fin = "-";
     else
         fin = argv[1];
 
+    if (argc == 3)
+    {
+        iterations = strtol(argv[2], nullptr, 10);
+        if (iterations <= 0)
+            return fprintf(stderr, "Invalid iterations: `%s`\n", argv[2]);
+    }
+
     int fd = 0;
     if (strcmp(fin, "-") != 0)
         fd = open(fin, O_RDONLY);
@@ -79,7 +94,8 @@ main(int argc, char** argv)
 
     close(fd);
 
-    auto result = validateGuards(hook, std::cout, "", 1);
+    GuardScratch scratch;
+    auto result = validateGuards(hook, std::cout, "", 1, scratch);
 
     if (!result)
     {
@@ -89,5 +105,28 @@ main(int argc, char** argv)
 
     printf("\nHook validation successful!\n");
 
+    if (iterations > 0)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        for (long n = 0; n < iterations; ++n)
+        {
+            if (!validateGuards(hook, {}, "", 1, scratch))
+                return fprintf(
+                    stderr, "Validation failed on iteration %ld\n", n);
+        }
+        double const secs = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+
+        printf(
+            "Validated %ld bytes %ld times in %.3f s: %.1f us each, %.1f "
+            "MB/s\n",
+            upto,
+            iterations,
+            secs,
+            secs * 1e6 / iterations,
+            (double)upto * iterations / secs / 1e6);
+    }
+
     return 0;
 }
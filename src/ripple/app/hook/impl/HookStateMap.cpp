@@ -0,0 +1,94 @@
+#include <ripple/app/hook/HookStateMap.h>
+#include <algorithm>
+#include <cstring>
+
+namespace hook {
+
+HookStateMap::HookStateMap()
+    : arena_(initialBuffer_.data(), initialBuffer_.size())
+    , accounts_(&arena_)
+    , namespaces_(&arena_)
+    , entries_(&arena_)
+{
+}
+
+void
+HookStateMap::store(Entry& entry, ripple::Slice const& value)
+{
+    // the arena can't free, so reuse the entry's storage when it fits
+    if (value.size() > entry.capacity)
+    {
+        entry.data =
+            static_cast<std::uint8_t*>(arena_.allocate(value.size(), 1));
+        entry.capacity = value.size();
+    }
+
+    if (!value.empty())
+        std::memcpy(entry.data, value.data(), value.size());
+    entry.size = value.size();
+}
+
+HookStateMap::AccountInfo*
+HookStateMap::findAccount(ripple::AccountID const& acc)
+{
+    return accounts_.find(acc, hasher_(acc));
+}
+
+void
+HookStateMap::insertAccount(ripple::AccountID const& acc, AccountInfo info)
+{
+    accounts_.insert(acc, hasher_(acc), info);
+}
+
+bool
+HookStateMap::hasNamespace(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns)
+{
+    NamespaceKey const k{acc, ns};
+    return namespaces_.find(k, hasher_(k)) != nullptr;
+}
+
+HookStateMap::Entry*
+HookStateMap::find(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key)
+{
+    Key const k{acc, ns, key};
+    return entries_.find(k, hasher_(k));
+}
+
+void
+HookStateMap::insert(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key,
+    bool modified,
+    ripple::Slice const& value)
+{
+    if (NamespaceKey const nk{acc, ns}; !namespaces_.find(nk, hasher_(nk)))
+        namespaces_.insert(nk, hasher_(nk), true);
+
+    Key const k{acc, ns, key};
+    Entry& entry = entries_.insert(k, hasher_(k), Entry{modified});
+    store(entry, value);
+}
+
+std::vector<std::pair<HookStateMap::Key const*, HookStateMap::Entry const*>>
+HookStateMap::modifiedEntries() const
+{
+    std::vector<std::pair<Key const*, Entry const*>> ret;
+    entries_.forEach([&](Key const& k, Entry const& e) {
+        if (e.modified)
+            ret.emplace_back(&k, &e);
+    });
+
+    std::sort(ret.begin(), ret.end(), [](auto const& a, auto const& b) {
+        return *a.first < *b.first;
+    });
+
+    return ret;
+}
+
+}  // namespace hook
@@ -0,0 +1,437 @@
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/protocol/digest.h>
+#include <fstream>
+#include <iterator>
+
+namespace hook {
+
+namespace {
+
+// how HookModule::compile configures the compiler, part of every tag
+char const* const compilerConfig =
+    "native instruction-counting cost-measuring";
+
+// what an artifact compiled from wasm now is tagged with
+std::string
+artifactTag(ripple::Slice const& wasm)
+{
+    return to_string(ripple::sha512Half(wasm)) + " wasmedge-" +
+        WasmEdge_VersionGet() + " " + compilerConfig;
+}
+
+std::string
+wasmError(std::string prefix, WasmEdge_Result& res)
+{
+    const char* msg = WasmEdge_ResultGetMessage(res);
+    return prefix + ": " + (msg ? msg : "unknown error");
+}
+
+// parse with `parse` (which is handed a loader and must fill in the AST) and
+// validate the result
+template <class F>
+ripple::Expected<std::shared_ptr<HookModule const>, std::string>
+loadModule(bool native, F&& parse)
+{
+    WasmEdge_ConfigureContext* conf = WasmEdge_ConfigureCreate();
+    if (!conf)
+        return ripple::Unexpected(
+            std::string("Could not create WASMEDGE configuration"));
+
+    WasmEdge_LoaderContext* loader = WasmEdge_LoaderCreate(conf);
+    WasmEdge_ValidatorContext* validator = WasmEdge_ValidatorCreate(conf);
+
+    auto cleanup = [&]() {
+        if (validator)
+            WasmEdge_ValidatorDelete(validator);
+        if (loader)
+            WasmEdge_LoaderDelete(loader);
+        WasmEdge_ConfigureDelete(conf);
+    };
+
+    if (!loader || !validator)
+    {
+        cleanup();
+        return ripple::Unexpected(
+            std::string("Could not create WASMEDGE loader"));
+    }
+
+    WasmEdge_ASTModuleContext* ast = nullptr;
+    WasmEdge_Result res = parse(loader, &ast);
+
+    if (!WasmEdge_ResultOK(res))
+    {
+        cleanup();
+        return ripple::Unexpected(wasmError("LoaderParse failed", res));
+    }
+
+    // the module takes ownership of the AST from here
+    auto module = std::make_shared<HookModule const>(ast, native);
+
+    res = WasmEdge_ValidatorValidate(validator, ast);
+    cleanup();
+
+    if (!WasmEdge_ResultOK(res))
+        return ripple::Unexpected(wasmError("ValidatorValidate failed", res));
+
+    return module;
+}
+
+}  // namespace
+
+ripple::Expected<std::shared_ptr<HookModule const>, std::string>
+HookModule::load(ripple::Slice const& wasm)
+{
+    return loadModule(
+        false,
+        [&](WasmEdge_LoaderContext* loader, WasmEdge_ASTModuleContext** ast) {
+            return WasmEdge_LoaderParseFromBuffer(
+                loader, ast, wasm.data(), static_cast<uint32_t>(wasm.size()));
+        });
+}
+
+ripple::Expected<std::shared_ptr<HookModule const>, std::string>
+HookModule::loadNative(boost::filesystem::path const& path)
+{
+    return loadModule(
+        true,
+        [&](WasmEdge_LoaderContext* loader, WasmEdge_ASTModuleContext** ast) {
+            return WasmEdge_LoaderParseFromFile(
+                loader, ast, path.string().c_str());
+        });
+}
+
+std::optional<std::string>
+HookModule::compile(
+    ripple::Slice const& wasm,
+    boost::filesystem::path const& path)
+{
+    WasmEdge_ConfigureContext* conf = WasmEdge_ConfigureCreate();
+    if (!conf)
+        return "Could not create WASMEDGE configuration";
+
+    // the compiled code must meter exactly as HookExecutor's interpreter does,
+    // including honouring a cost limit
+    WasmEdge_ConfigureCompilerSetOutputFormat(
+        conf, WasmEdge_CompilerOutputFormat_Native);
+    WasmEdge_ConfigureCompilerSetInstructionCounting(conf, true);
+    WasmEdge_ConfigureCompilerSetCostMeasuring(conf, true);
+
+    WasmEdge_CompilerContext* compiler = WasmEdge_CompilerCreate(conf);
+    if (!compiler)
+    {
+        WasmEdge_ConfigureDelete(conf);
+        return "Could not create WASMEDGE compiler";
+    }
+
+    WasmEdge_Result res = WasmEdge_CompilerCompileFromBuffer(
+        compiler, wasm.data(), wasm.size(), path.string().c_str());
+
+    WasmEdge_CompilerDelete(compiler);
+    WasmEdge_ConfigureDelete(conf);
+
+    if (!WasmEdge_ResultOK(res))
+        return wasmError("CompilerCompileFromBuffer failed", res);
+
+    return {};
+}
+
+ModuleCache::ModuleCache(
+    std::size_t targetSize,
+    std::string const& aotPath,
+    bool aotOnInstall,
+    beast::Journal j)
+    : targetSize_(targetSize)
+    , aotPath_(aotPath)
+    , aotOnInstall_(aotOnInstall)
+    , j_(j)
+{
+}
+
+boost::filesystem::path
+ModuleCache::nativePath(ripple::uint256 const& hookHash) const
+{
+    // the suffix changes whenever the compiler configuration does, so that
+    // artifacts compiled differently are never loaded
+    return aotPath_ / (to_string(hookHash) + ".v1.so");
+}
+
+boost::filesystem::path
+ModuleCache::tagPath(ripple::uint256 const& hookHash) const
+{
+    return aotPath_ / (to_string(hookHash) + ".v1.tag");
+}
+
+bool
+ModuleCache::verified(
+    ripple::uint256 const& hookHash,
+    ripple::Slice const& wasm) const
+{
+    std::ifstream in(tagPath(hookHash).string(), std::ios::binary);
+    if (!in)
+        return false;
+
+    std::string const tag{
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    return tag == artifactTag(wasm);
+}
+
+ripple::Expected<std::shared_ptr<HookModule const>, std::string>
+ModuleCache::fetch(ripple::uint256 const& hookHash, ripple::Slice const& wasm)
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = entries_.find(hookHash); it != entries_.end())
+        {
+            lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second.module;
+        }
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+
+    // parsing is by far the most expensive part so do it without the lock,
+    // if two threads race to load the same hook the first insert wins
+    using Loaded =
+        ripple::Expected<std::shared_ptr<HookModule const>, std::string>;
+    std::optional<Loaded> loaded;
+
+    if (aotEnabled())
+    {
+        boost::system::error_code ec;
+        auto const path = nativePath(hookHash);
+        bool const compiled = boost::filesystem::exists(path, ec);
+
+        if (compiled && !verified(hookHash, wasm))
+        {
+            // compiled from other code, or by another compiler or
+            // configuration, so interpret the hook until compile() replaces
+            // the artifact
+            JLOG(j_.warn()) << "HookModuleCache: ignoring stale compiled "
+                            << path.string();
+
+            std::lock_guard lock(mutex_);
+            stale_.insert(hookHash);
+        }
+        else if (compiled)
+        {
+            loaded = HookModule::loadNative(path);
+            if (!*loaded)
+            {
+                JLOG(j_.warn()) << "HookModuleCache: ignoring compiled "
+                                << path.string() << ": " << loaded->error();
+                loaded.reset();
+            }
+        }
+    }
+
+    if (!loaded)
+        loaded = HookModule::load(wasm);
+
+    if (!*loaded)
+    {
+        JLOG(j_.debug()) << "HookModuleCache: could not load " << hookHash
+                         << ": " << loaded->error();
+        return *loaded;
+    }
+
+    return insert(hookHash, **loaded, false);
+}
+
+bool
+ModuleCache::compile(ripple::uint256 const& hookHash, ripple::Slice const& wasm)
+{
+    if (!aotEnabled())
+        return false;
+
+    auto const path = nativePath(hookHash);
+
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(path, ec) || !verified(hookHash, wasm))
+    {
+        // an artifact is never left tagged as something it isn't
+        boost::filesystem::remove(tagPath(hookHash), ec);
+
+        boost::filesystem::create_directories(aotPath_, ec);
+        if (ec)
+        {
+            JLOG(j_.warn()) << "HookModuleCache: cannot create "
+                            << aotPath_.string() << ": " << ec.message();
+            return false;
+        }
+
+        // compile beside the final artifact and rename it into place so a
+        // partially written file is never picked up by fetch
+        auto const tmp = aotPath_ /
+            boost::filesystem::unique_path(
+                to_string(hookHash) + ".%%%%%%.tmp");
+
+        if (auto const err = HookModule::compile(wasm, tmp))
+        {
+            boost::filesystem::remove(tmp, ec);
+            JLOG(j_.warn()) << "HookModuleCache: could not compile "
+                            << hookHash << ": " << *err;
+            return false;
+        }
+
+        boost::filesystem::rename(tmp, path, ec);
+        if (ec)
+        {
+            boost::filesystem::remove(tmp, ec);
+            JLOG(j_.warn()) << "HookModuleCache: could not store " << hookHash
+                            << ": " << ec.message();
+            return false;
+        }
+
+        // tag the artifact once it is in place, the same way
+        auto const tagTmp = aotPath_ /
+            boost::filesystem::unique_path(
+                to_string(hookHash) + ".%%%%%%.tmp");
+        {
+            std::ofstream out(tagTmp.string(), std::ios::binary);
+            out << artifactTag(wasm);
+        }
+
+        boost::filesystem::rename(tagTmp, tagPath(hookHash), ec);
+        if (ec)
+        {
+            boost::filesystem::remove(tagTmp, ec);
+            JLOG(j_.warn()) << "HookModuleCache: could not tag " << hookHash
+                            << ": " << ec.message();
+            return false;
+        }
+
+        JLOG(j_.debug()) << "HookModuleCache: compiled " << hookHash;
+    }
+
+    auto const module = HookModule::loadNative(path);
+    if (!module)
+    {
+        JLOG(j_.warn()) << "HookModuleCache: could not load compiled "
+                        << hookHash << ": " << module.error();
+        return false;
+    }
+
+    insert(hookHash, *module, true);
+
+    std::lock_guard lock(mutex_);
+    stale_.erase(hookHash);
+    return true;
+}
+
+void
+ModuleCache::compileAsync(
+    ripple::JobQueue& jobQueue,
+    ripple::uint256 const& hookHash,
+    ripple::Slice const& wasm)
+{
+    if (!aotEnabled())
+        return;
+
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = entries_.find(hookHash);
+            it != entries_.end() && it->second.module->native())
+            return;
+
+        if (!compiling_.insert(hookHash).second)
+            return;
+    }
+
+    ripple::Blob blob(wasm.begin(), wasm.end());
+    auto job = [this, hookHash, blob = std::move(blob)]() {
+        compile(hookHash, ripple::makeSlice(blob));
+
+        std::lock_guard lock(mutex_);
+        compiling_.erase(hookHash);
+    };
+
+    if (!jobQueue.addJob(
+            ripple::jtHOOK_COMPILE, "HookCompile", std::move(job)))
+    {
+        std::lock_guard lock(mutex_);
+        compiling_.erase(hookHash);
+    }
+}
+
+std::shared_ptr<HookModule const>
+ModuleCache::insert(
+    ripple::uint256 const& hookHash,
+    std::shared_ptr<HookModule const> const& module,
+    bool replace)
+{
+    std::lock_guard lock(mutex_);
+    if (targetSize_ == 0)
+        return module;
+
+    if (auto it = entries_.find(hookHash); it != entries_.end())
+    {
+        if (replace)
+            it->second.module = module;
+        return it->second.module;
+    }
+
+    lru_.push_front(hookHash);
+    entries_.emplace(hookHash, Entry{module, lru_.begin()});
+    trim();
+
+    return module;
+}
+
+bool
+ModuleCache::stale(ripple::uint256 const& hookHash) const
+{
+    std::lock_guard lock(mutex_);
+    return stale_.count(hookHash) != 0;
+}
+
+void
+ModuleCache::erase(ripple::uint256 const& hookHash)
+{
+    std::lock_guard lock(mutex_);
+    if (auto it = entries_.find(hookHash); it != entries_.end())
+    {
+        lru_.erase(it->second.lruPos);
+        entries_.erase(it);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void
+ModuleCache::setTargetSize(std::size_t size)
+{
+    std::lock_guard lock(mutex_);
+    targetSize_ = size;
+    trim();
+}
+
+std::size_t
+ModuleCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+float
+ModuleCache::getHitRate() const
+{
+    auto const h = hits();
+    auto const total = h + misses();
+    return total ? (static_cast<float>(h) * 100) / total : 0.0f;
+}
+
+void
+ModuleCache::trim()
+{
+    while (entries_.size() > targetSize_ && !lru_.empty())
+    {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace hook
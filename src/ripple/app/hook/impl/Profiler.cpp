@@ -0,0 +1,229 @@
+#include <ripple/app/hook/Profiler.h>
+#include <ripple/protocol/jss.h>
+#include <map>
+#include <string>
+
+namespace hook {
+
+namespace {
+
+std::atomic<std::uint64_t> nextInstance{0};
+
+// host function names by id, registered as each function is first called
+std::mutex functionsMutex;
+std::array<std::atomic<char const*>, Profiler::maxFunctions> functionNames{};
+std::size_t functionCount = 0;
+
+std::string
+durationUs(std::uint64_t ns)
+{
+    return std::to_string(ns / 1000);
+}
+
+}  // namespace
+
+thread_local Profiler::Accumulator* Profiler::current_ = nullptr;
+
+Profiler::Profiler(bool enabled)
+    : enabled_(enabled), instance_(nextInstance.fetch_add(1))
+{
+}
+
+std::size_t
+Profiler::functionId(char const* name)
+{
+    std::lock_guard lock(functionsMutex);
+
+    // the last id is shared by anything past the limit
+    if (functionCount == maxFunctions - 1)
+    {
+        functionNames[functionCount].store("other", std::memory_order_release);
+        return functionCount;
+    }
+
+    functionNames[functionCount].store(name, std::memory_order_release);
+    return functionCount++;
+}
+
+Profiler::Shard&
+Profiler::shard()
+{
+    // a thread may execute hooks for several applications, as in tests, so
+    // remember which profiler the cached shard belongs to
+    struct Cached
+    {
+        std::uint64_t instance = 0;
+        Shard* shard = nullptr;
+    };
+    static thread_local Cached cached;
+
+    if (cached.shard && cached.instance == instance_)
+        return *cached.shard;
+
+    auto const id = std::this_thread::get_id();
+
+    std::lock_guard lock(mutex_);
+    Shard* found = nullptr;
+    for (auto const& s : shards_)
+    {
+        if (s->owner == id)
+        {
+            found = s.get();
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        shards_.push_back(std::make_unique<Shard>());
+        found = shards_.back().get();
+        found->owner = id;
+    }
+
+    cached = {instance_, found};
+    return *found;
+}
+
+Profiler::Execution::Execution(
+    Profiler& profiler,
+    ripple::uint256 const& hookHash,
+    std::uint64_t const& instructions)
+    : hookHash_(hookHash), instructions_(instructions)
+{
+    if (!profiler.enabled())
+        return;
+
+    profiler_ = &profiler;
+    acc_.shard = &profiler.shard();
+    previous_ = current_;
+    current_ = &acc_;
+    start_ = clock_type::now();
+}
+
+Profiler::Execution::~Execution()
+{
+    if (!profiler_)
+        return;
+
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock_type::now() - start_)
+                        .count();
+    current_ = previous_;
+
+    auto& shard = *acc_.shard;
+    HookCounters* counters = nullptr;
+    if (auto it = shard.hooks.find(hookHash_); it != shard.hooks.end())
+    {
+        counters = it->second.get();
+    }
+    else
+    {
+        auto c = std::make_unique<HookCounters>();
+        counters = c.get();
+
+        std::lock_guard lock(shard.mutex);
+        shard.hooks.emplace(hookHash_, std::move(c));
+    }
+
+    constexpr auto relaxed = std::memory_order_relaxed;
+    counters->executions.fetch_add(1, relaxed);
+    counters->ns.fetch_add(ns, relaxed);
+    counters->instructions.fetch_add(instructions_, relaxed);
+    counters->hostCalls.fetch_add(acc_.calls, relaxed);
+    counters->hostNs.fetch_add(acc_.ns, relaxed);
+    counters->bytes.fetch_add(acc_.bytes, relaxed);
+}
+
+void
+Profiler::Call::finish()
+{
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        clock_type::now() - start_)
+                        .count();
+    auto const bytes = acc_->bytes - bytes_;
+
+    acc_->calls++;
+    acc_->ns += ns;
+
+    constexpr auto relaxed = std::memory_order_relaxed;
+    auto& counters = acc_->shard->functions[id_];
+    counters.calls.fetch_add(1, relaxed);
+    counters.ns.fetch_add(ns, relaxed);
+    counters.bytes.fetch_add(bytes, relaxed);
+}
+
+Json::Value
+Profiler::json() const
+{
+    struct Totals
+    {
+        std::uint64_t calls = 0;
+        std::uint64_t ns = 0;
+        std::uint64_t instructions = 0;
+        std::uint64_t hostCalls = 0;
+        std::uint64_t hostNs = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    constexpr auto relaxed = std::memory_order_relaxed;
+    std::array<Totals, maxFunctions> functions{};
+    std::map<ripple::uint256, Totals> hooks;
+
+    {
+        std::lock_guard lock(mutex_);
+        for (auto const& shard : shards_)
+        {
+            for (std::size_t i = 0; i < maxFunctions; ++i)
+            {
+                auto const& f = shard->functions[i];
+                functions[i].calls += f.calls.load(relaxed);
+                functions[i].ns += f.ns.load(relaxed);
+                functions[i].bytes += f.bytes.load(relaxed);
+            }
+
+            std::lock_guard shardLock(shard->mutex);
+            for (auto const& [hash, h] : shard->hooks)
+            {
+                auto& t = hooks[hash];
+                t.calls += h->executions.load(relaxed);
+                t.ns += h->ns.load(relaxed);
+                t.instructions += h->instructions.load(relaxed);
+                t.hostCalls += h->hostCalls.load(relaxed);
+                t.hostNs += h->hostNs.load(relaxed);
+                t.bytes += h->bytes.load(relaxed);
+            }
+        }
+    }
+
+    Json::Value ret{Json::objectValue};
+    ret[ripple::jss::enabled] = enabled_;
+
+    Json::Value& fobj = ret[ripple::jss::functions] = Json::objectValue;
+    for (std::size_t i = 0; i < maxFunctions; ++i)
+    {
+        auto const* name = functionNames[i].load(std::memory_order_acquire);
+        if (!name || !functions[i].calls)
+            continue;
+
+        Json::Value& f = fobj[name] = Json::objectValue;
+        f[ripple::jss::calls] = std::to_string(functions[i].calls);
+        f[ripple::jss::duration_us] = durationUs(functions[i].ns);
+        f[ripple::jss::bytes] = std::to_string(functions[i].bytes);
+    }
+
+    Json::Value& hobj = ret[ripple::jss::hooks] = Json::objectValue;
+    for (auto const& [hash, t] : hooks)
+    {
+        Json::Value& h = hobj[to_string(hash)] = Json::objectValue;
+        h[ripple::jss::executions] = std::to_string(t.calls);
+        h[ripple::jss::duration_us] = durationUs(t.ns);
+        h[ripple::jss::instructions] = std::to_string(t.instructions);
+        h[ripple::jss::host_calls] = std::to_string(t.hostCalls);
+        h[ripple::jss::host_duration_us] = durationUs(t.hostNs);
+        h[ripple::jss::bytes] = std::to_string(t.bytes);
+    }
+
+    return ret;
+}
+
+}  // namespace hook
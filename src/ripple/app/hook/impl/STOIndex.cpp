@@ -0,0 +1,314 @@
+#include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/STOIndex.h>
+#include <ripple/beast/hash/xxhasher.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace hook {
+
+namespace {
+
+enum class Kind : std::uint8_t { unknown, fixed, vl, amount, container };
+
+struct TypeInfo
+{
+    Kind kind;
+    std::int8_t size;  // of the payload, for the fixed size types
+};
+
+// serialized types by type code, the codes past the end are unknown
+constexpr std::array<TypeInfo, 20> types{{
+    {Kind::unknown, -1},
+    {Kind::fixed, 2},      // UINT16
+    {Kind::fixed, 4},      // UINT32
+    {Kind::fixed, 8},      // UINT64
+    {Kind::fixed, 16},     // UINT128
+    {Kind::fixed, 32},     // UINT256
+    {Kind::amount, -1},    // AMOUNT
+    {Kind::vl, -1},        // VL
+    {Kind::vl, -1},        // ACCOUNT
+    {Kind::unknown, -1},
+    {Kind::unknown, -1},
+    {Kind::unknown, -1},
+    {Kind::unknown, -1},
+    {Kind::unknown, -1},
+    {Kind::container, -1},  // OBJECT
+    {Kind::container, -1},  // ARRAY
+    {Kind::fixed, 1},       // UINT8
+    {Kind::fixed, 20},      // UINT160
+    {Kind::vl, -1},         // PATHSET
+    {Kind::vl, -1},         // VECTOR256
+}};
+
+}  // namespace
+
+// RH NOTE this is a light-weight stobject parsing function for drilling into a
+// provided serialized object. Any change to what it accepts changes what the
+// sto_* Hook APIs return.
+std::int32_t
+STOIndex::parseField(
+    std::uint8_t const* start,
+    std::uint8_t const* end,
+    int& type,
+    int& field,
+    int& payloadStart,
+    int& payloadLength,
+    int depth)
+{
+    if (depth > 10)
+        return excessiveNesting;
+
+    std::uint8_t const* upto = start;
+    int high = *upto >> 4;
+    int low = *upto & 0xF;
+
+    upto++;
+    if (upto >= end)
+        return unexpectedEnd;
+    if (high > 0 && low > 0)
+    {
+        // common type common field
+        type = high;
+        field = low;
+    }
+    else if (high > 0)
+    {
+        // common type, uncommon field
+        type = high;
+        field = *upto++;
+    }
+    else if (low > 0)
+    {
+        // common field, uncommon type
+        field = low;
+        type = *upto++;
+    }
+    else
+    {
+        // uncommon type and field
+        type = *upto++;
+        if (upto >= end)
+            return unexpectedEnd;
+        field = *upto++;
+    }
+
+    if (upto >= end)
+        return unexpectedEnd;
+
+    if (type < 0 || type >= static_cast<int>(types.size()) ||
+        types[type].kind == Kind::unknown)
+        return unknownTypeEarly;
+
+    auto const& info = types[type];
+
+    int length = -1;
+    switch (info.kind)
+    {
+        case Kind::fixed:
+            length = info.size;
+            break;
+
+        case Kind::amount:
+            length = (*upto >> 6 == 1) ? 8 : 48;
+            break;
+
+        case Kind::vl:
+            length = *upto++;
+            if (upto >= end)
+                return unexpectedEnd;
+
+            if (length < 193)
+            {
+                // do nothing
+            }
+            else if (length < 241)
+            {
+                length -= 193;
+                length *= 256;
+                length += *upto++ + 193;
+                if (upto > end)
+                    return unexpectedEnd;
+            }
+            else
+            {
+                int b2 = *upto++;
+                if (upto >= end)
+                    return unexpectedEnd;
+                length -= 241;
+                length *= 65536;
+                length += 12481 + (b2 * 256) + *upto++;
+                if (upto >= end)
+                    return unexpectedEnd;
+            }
+            break;
+
+        case Kind::container: {
+            payloadStart = upto - start;
+
+            for (int i = 0; i < 1024; ++i)
+            {
+                int subfield = -1, subtype = -1, subStart = -1,
+                    subLength = -1;
+                std::int32_t sublength = parseField(
+                    upto, end, subtype, subfield, subStart, subLength, depth + 1);
+                if (sublength < 0)
+                    return unexpectedEnd;
+                upto += sublength;
+                if (upto >= end)
+                    return unexpectedEnd;
+
+                if ((*upto == 0xE1U && type == 0xEU) ||
+                    (*upto == 0xF1U && type == 0xFU))
+                {
+                    payloadLength = upto - start - payloadStart;
+                    upto++;
+                    return (upto - start);
+                }
+            }
+            return excessiveSize;
+        }
+
+        case Kind::unknown:
+            break;
+    }
+
+    if (length > -1)
+    {
+        payloadStart = upto - start;
+        payloadLength = length;
+        return length + (upto - start);
+    }
+
+    return unknownTypeLate;
+}
+
+STOIndex::STOIndex(std::uint8_t const* data, std::size_t size) : size_(size)
+{
+    std::uint8_t const* const end = data + size;
+
+    while (fields_.size() < maxFields && end_ < size_)
+    {
+        int type = -1, field = -1, payloadStart = -1, payloadLength = -1;
+        std::int32_t length = parseField(
+            data + end_, end, type, field, payloadStart, payloadLength);
+        if (length < 0)
+        {
+            parseError_ = true;
+            break;
+        }
+
+        std::uint32_t const id = (type << 16) + field;
+        std::uint32_t const offset = end_;
+        fields_.push_back(
+            {id,
+             offset,
+             static_cast<std::uint32_t>(length),
+             offset + payloadStart,
+             static_cast<std::uint32_t>(payloadLength)});
+
+        end_ += length;
+    }
+
+    byId_.reserve(fields_.size());
+    maxId_.reserve(fields_.size());
+    for (std::uint32_t i = 0; i < fields_.size(); ++i)
+    {
+        byId_.emplace_back(fields_[i].id, i);
+        maxId_.push_back(std::max(fields_[i].id, i ? maxId_.back() : 0));
+    }
+
+    // objects are usually in canonical order already
+    if (!std::is_sorted(byId_.begin(), byId_.end()))
+        std::sort(byId_.begin(), byId_.end());
+}
+
+STOIndex::Field const*
+STOIndex::find(std::uint32_t id) const
+{
+    auto const it = std::lower_bound(
+        byId_.begin(), byId_.end(), std::make_pair(id, std::uint32_t{0}));
+    if (it == byId_.end() || it->first != id)
+        return nullptr;
+    return &fields_[it->second];
+}
+
+STOIndex::Field const*
+STOIndex::lowerBound(std::uint32_t id) const
+{
+    // the running maximum first reaches id at the first field not less
+    // than it
+    auto const it = std::lower_bound(maxId_.begin(), maxId_.end(), id);
+    if (it == maxId_.end())
+        return nullptr;
+    return &fields_[it - maxId_.begin()];
+}
+
+std::int64_t
+STOIndex::subfield(std::uint32_t id) const
+{
+    if (auto const* f = find(id))
+    {
+        if ((f->id >> 16) == 0xF)  // we return arrays fully formed
+            return (((std::int64_t)f->offset) << 32) + f->length;
+
+        // return pointers to all other objects as payloads
+        return (((std::int64_t)f->payloadOffset) << 32) + f->payloadLength;
+    }
+
+    if (!valid())
+        return hook_api::PARSE_ERROR;
+
+    return hook_api::DOESNT_EXIST;
+}
+
+std::int64_t
+STOIndex::subarray(std::uint32_t position, std::uint32_t skip) const
+{
+    if (position < fields_.size())
+    {
+        auto const& f = fields_[position];
+        return (((std::int64_t)(f.offset + skip)) << 32) + f.length;
+    }
+
+    if (!valid())
+        return hook_api::PARSE_ERROR;
+
+    return hook_api::DOESNT_EXIST;
+}
+
+STOIndex const&
+STOIndexCache::get(std::uint32_t ptr, std::uint8_t const* data, std::size_t len)
+{
+    if (len > maxBytes)
+    {
+        uncached_ = STOIndex{data, len};
+        return uncached_;
+    }
+
+    beast::xxhasher hasher;
+    hasher(data, len);
+    auto const hash = static_cast<std::size_t>(hasher);
+
+    for (auto const& e : entries_)
+    {
+        if (e.ptr == ptr && e.hash == hash && e.bytes.size() == len &&
+            std::memcmp(e.bytes.data(), data, len) == 0)
+            return e.index;
+    }
+
+    Entry entry{ptr, hash, {data, data + len}, STOIndex{data, len}};
+
+    if (entries_.size() < maxEntries)
+    {
+        entries_.push_back(std::move(entry));
+        return entries_.back().index;
+    }
+
+    auto& slot = entries_[next_];
+    next_ = (next_ + 1) % maxEntries;
+    slot = std::move(entry);
+    return slot.index;
+}
+
+}  // namespace hook
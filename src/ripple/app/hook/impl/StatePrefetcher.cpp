@@ -0,0 +1,90 @@
+#include <ripple/app/hook/StatePrefetcher.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/protocol/Indexes.h>
+#include <algorithm>
+
+namespace hook {
+
+StatePrefetcher::StatePrefetcher(std::size_t keysPerNamespace)
+    : keysPerNamespace_(keysPerNamespace)
+{
+}
+
+void
+StatePrefetcher::prefetch(
+    std::shared_ptr<ripple::Ledger const> const& ledger,
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns)
+{
+    if (!enabled() || !ledger)
+        return;
+
+    std::vector<ripple::uint256> keys;
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = index_.find({acc, ns}); it != index_.end())
+            keys = it->second->keys;
+    }
+
+    auto const& map = ledger->stateMap();
+
+    map.prefetchPath(ripple::keylet::hookStateDir(acc, ns).key, ledger);
+    for (auto const& key : keys)
+        map.prefetchPath(ripple::keylet::hookState(acc, key, ns).key, ledger);
+
+    prefetches_.fetch_add(keys.size() + 1, std::memory_order_relaxed);
+}
+
+void
+StatePrefetcher::touched(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key)
+{
+    if (!enabled())
+        return;
+
+    std::lock_guard lock(mutex_);
+
+    NamespaceID const id{acc, ns};
+    auto it = index_.find(id);
+    if (it == index_.end())
+    {
+        lru_.push_front(Namespace{id, {}});
+        it = index_.emplace(id, lru_.begin()).first;
+
+        if (lru_.size() > maxNamespaces)
+        {
+            index_.erase(lru_.back().id);
+            lru_.pop_back();
+        }
+    }
+    else
+    {
+        lru_.splice(lru_.begin(), lru_, it->second);
+    }
+
+    auto& keys = it->second->keys;
+    if (auto pos = std::find(keys.begin(), keys.end(), key); pos != keys.end())
+    {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        std::rotate(keys.begin(), pos, pos + 1);
+        return;
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    if (keys.size() < keysPerNamespace_)
+        keys.emplace_back();
+    std::move_backward(keys.begin(), keys.end() - 1, keys.end());
+    keys.front() = key;
+}
+
+float
+StatePrefetcher::getHitRate() const
+{
+    auto const h = hits();
+    auto const total = h + misses();
+    return total ? (static_cast<float>(h) * 100) / total : 0.0f;
+}
+
+}  // namespace hook
@@ -0,0 +1,287 @@
+#include <ripple/app/hook/TraceSink.h>
+#include <ripple/app/hook/XFL.h>
+#include <ripple/basics/Log.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/protocol/jss.h>
+#include <chrono>
+#include <sstream>
+
+namespace hook {
+
+namespace {
+
+static_assert((TraceSink::capacity & (TraceSink::capacity - 1)) == 0);
+constexpr std::size_t mask = TraceSink::capacity - 1;
+
+// every second byte of a buffer which is all zero except for those
+bool
+is_UTF16LE(std::uint8_t const* buffer, std::size_t len)
+{
+    if (len % 2 != 0 || len == 0)
+        return false;
+
+    for (std::size_t i = 0; i < len; i += 2)
+        if (buffer[i + 0] == 0 || buffer[i + 1] != 0)
+            return false;
+
+    return true;
+}
+
+// what follows the message of a trace
+std::string
+renderData(TraceSink::Record const& r)
+{
+    std::string out;
+    auto const* data = r.data.data();
+
+    if (r.asHex)
+    {
+        out.resize(r.dataSize * 2);
+        for (std::size_t i = 0; i < r.dataSize; ++i)
+        {
+            std::uint8_t high = (data[i] >> 4) & 0xFU;
+            std::uint8_t low = (data[i] & 0xFU);
+            out[i * 2 + 0] = high + (high < 10U ? '0' : 'A' - 10);
+            out[i * 2 + 1] = low + (low < 10U ? '0' : 'A' - 10);
+        }
+    }
+    else if (is_UTF16LE(data, r.dataSize))
+    {
+        out.resize(r.dataSize / 2);
+        for (std::size_t i = 0; i < r.dataSize / 2; ++i)
+            out[i] = data[i * 2];
+    }
+    else
+    {
+        out.assign(reinterpret_cast<char const*>(data), r.dataSize);
+    }
+
+    return out;
+}
+
+std::string
+renderFloat(std::int64_t float1)
+{
+    using namespace hook_float;
+
+    if (float1 == 0)
+        return "Float 0*10^(0) <ZERO>";
+
+    uint64_t man = get_mantissa(float1);
+    int32_t exp = get_exponent(float1);
+    bool neg = is_negative(float1);
+    if (man < minMantissa || man > maxMantissa || exp < minExponent ||
+        exp > maxExponent)
+        return "Float <INVALID>";
+
+    std::ostringstream out;
+    out << "Float " << (neg ? "-" : "") << man << "*10^(" << exp << ")";
+    return out.str();
+}
+
+}  // namespace
+
+thread_local TraceSink::Capture* TraceSink::capture_ = nullptr;
+
+TraceSink::Capture::Capture() : previous_(capture_)
+{
+    capture_ = this;
+}
+
+TraceSink::Capture::~Capture()
+{
+    capture_ = previous_;
+}
+
+TraceSink::TraceSink(beast::Journal j)
+    : j_(j), cells_(std::make_unique<Cell[]>(capacity))
+{
+    for (std::size_t i = 0; i < capacity; ++i)
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+TraceSink::~TraceSink()
+{
+    stop();
+}
+
+auto
+TraceSink::claim() -> Cell*
+{
+    auto pos = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Cell* cell = &cells_[pos & mask];
+        auto const seq = cell->sequence.load(std::memory_order_acquire);
+        auto const diff =
+            static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+        if (diff == 0)
+        {
+            if (enqueuePos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed))
+                return cell;
+        }
+        else if (diff < 0)
+        {
+            // the drain thread has not freed this cell yet
+            return nullptr;
+        }
+        else
+        {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void
+TraceSink::start(Publish publish)
+{
+    std::lock_guard lock(mutex_);
+    if (running_)
+        return;
+
+    publish_ = std::move(publish);
+    stopping_ = false;
+    thread_ = std::thread(&TraceSink::run, this);
+    running_.store(true, std::memory_order_release);
+}
+
+void
+TraceSink::stop()
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (!running_)
+            return;
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+
+    running_.store(false, std::memory_order_release);
+    drain();
+}
+
+void
+TraceSink::run()
+{
+    beast::setCurrentThreadName("hook traces");
+
+    using namespace std::chrono_literals;
+    std::unique_lock lock(mutex_);
+    while (!stopping_)
+    {
+        lock.unlock();
+        drain();
+        lock.lock();
+
+        // writers only signal once per quarter of the buffer, so that a
+        // trace costs them little more than the copy
+        if (!stopping_)
+            cv_.wait_for(lock, 100ms);
+    }
+}
+
+std::size_t
+TraceSink::drain()
+{
+    std::lock_guard lock(consumerMutex_);
+
+    std::size_t drained = 0;
+    bool const streaming = streaming_.load(std::memory_order_relaxed);
+    for (;; ++drained)
+    {
+        Cell& cell = cells_[dequeuePos_ & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1)
+            break;
+
+        auto const& record = cell.record;
+        if (auto const line = text(record); !line.empty())
+            JLOG(j_.trace()) << line;
+
+        if (streaming && publish_)
+            publish_(json(record));
+
+        cell.sequence.store(dequeuePos_ + capacity, std::memory_order_release);
+        ++dequeuePos_;
+    }
+
+    if (auto const dropped = dropped_.load(std::memory_order_relaxed);
+        dropped != reportedDropped_)
+    {
+        JLOG(j_.warn()) << "HookTrace: " << (dropped - reportedDropped_)
+                        << " traces dropped, the trace buffer was full";
+        reportedDropped_ = dropped;
+    }
+
+    return drained;
+}
+
+std::string
+TraceSink::text(Record const& r)
+{
+    std::ostringstream out;
+    out << "HookTrace[" << r.account << "-" << r.otxnAccount << "]:";
+
+    switch (r.kind)
+    {
+        case Kind::text: {
+            std::string payload;
+            if (r.hasMessage)
+            {
+                payload.append(r.messageView());
+                payload.append(": ");
+            }
+            payload.append(renderData(r));
+
+            if (payload.empty())
+                return {};
+
+            out << " " << payload;
+            break;
+        }
+
+        case Kind::number:
+            out << " ";
+            if (r.messageSize > 0)
+                out << r.messageView() << ": ";
+            out << r.number;
+            break;
+
+        case Kind::xfl:
+            out << r.messageView() << ": " << renderFloat(r.number);
+            break;
+    }
+
+    return out.str();
+}
+
+Json::Value
+TraceSink::json(Record const& r)
+{
+    Json::Value jv{Json::objectValue};
+    jv[ripple::jss::type] = "hookTrace";
+    jv[ripple::jss::hook_hash] = to_string(r.hookHash);
+    jv[ripple::jss::account] = toBase58(r.account);
+    jv[ripple::jss::otxn_account] = toBase58(r.otxnAccount);
+    jv[ripple::jss::hash] = to_string(r.txID);
+    jv[ripple::jss::message] = std::string(r.messageView());
+
+    switch (r.kind)
+    {
+        case Kind::text:
+            jv[ripple::jss::value] = renderData(r);
+            break;
+        case Kind::number:
+            jv[ripple::jss::value] = std::to_string(r.number);
+            break;
+        case Kind::xfl:
+            jv[ripple::jss::value] = renderFloat(r.number);
+            break;
+    }
+
+    return jv;
+}
+
+}  // namespace hook
@@ -0,0 +1,63 @@
+#include <ripple/app/hook/ValidationCache.h>
+
+namespace hook {
+
+std::optional<CodeValidation>
+ValidationCache::get(ripple::uint256 const& hookHash, uint64_t rulesVersion)
+{
+    std::lock_guard lock(mutex_);
+
+    auto const it = index_.find({hookHash, rulesVersion});
+    if (it == index_.end())
+    {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->validation;
+}
+
+void
+ValidationCache::insert(
+    ripple::uint256 const& hookHash,
+    uint64_t rulesVersion,
+    CodeValidation const& validation)
+{
+    std::lock_guard lock(mutex_);
+
+    Key const key{hookHash, rulesVersion};
+    if (auto const it = index_.find(key); it != index_.end())
+    {
+        it->second->validation = validation;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.push_front(Entry{key, validation});
+    index_.emplace(key, lru_.begin());
+
+    if (lru_.size() > maxEntries)
+    {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+}
+
+std::size_t
+ValidationCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return lru_.size();
+}
+
+float
+ValidationCache::getHitRate() const
+{
+    auto const h = hits();
+    auto const total = h + misses();
+    return total ? (static_cast<float>(h) * 100) / total : 0.0f;
+}
+
+}  // namespace hook
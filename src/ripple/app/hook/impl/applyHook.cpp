@@ -1,3 +1,6 @@
+#include <ripple/app/hook/StatePrefetcher.h>
+#include <ripple/app/hook/TraceSink.h>
+#include <ripple/app/hook/XFL.h>
 #include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/TransactionMaster.h>
@@ -5,6 +8,7 @@
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/TxQ.h>
+#include <ripple/app/tx/SpeculativeApply.h>
 #include <ripple/app/tx/impl/Import.h>
 #include <ripple/app/tx/impl/details/NFTokenUtils.h>
 #include <ripple/basics/Log.h>
@@ -14,8 +18,9 @@
 #include <ripple/protocol/st.h>
 #include <ripple/protocol/tokens.h>
 #include <boost/multiprecision/cpp_dec_float.hpp>
+#include <algorithm>
 #include <any>
-#include <cfenv>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <string>
@@ -509,257 +514,6 @@ getTransactionalStakeHolders(STTx const& tx, ReadView const& rv)
 
 }  // namespace hook
 
-namespace hook_float {
-
-// power of 10 LUT for fast integer math
-static int64_t power_of_ten[19] = {
-    1LL,
-    10LL,
-    100LL,
-    1000LL,
-    10000LL,
-    100000LL,
-    1000000LL,
-    10000000LL,
-    100000000LL,
-    1000000000LL,
-    10000000000LL,
-    100000000000LL,
-    1000000000000LL,
-    10000000000000LL,
-    100000000000000LL,
-    1000000000000000LL,  // 15
-    10000000000000000LL,
-    100000000000000000LL,
-    1000000000000000000LL,
-};
-
-using namespace hook_api;
-static int64_t const minMantissa = 1000000000000000ull;
-static int64_t const maxMantissa = 9999999999999999ull;
-static int32_t const minExponent = -96;
-static int32_t const maxExponent = 80;
-inline int32_t
-get_exponent(int64_t float1)
-{
-    if (float1 < 0)
-        return INVALID_FLOAT;
-    if (float1 == 0)
-        return 0;
-    uint64_t float_in = (uint64_t)float1;
-    float_in >>= 54U;
-    float_in &= 0xFFU;
-    return ((int32_t)float_in) - 97;
-}
-
-inline int64_t
-get_mantissa(int64_t float1)
-{
-    if (float1 < 0)
-        return INVALID_FLOAT;
-    if (float1 == 0)
-        return 0;
-    float1 -= ((((uint64_t)float1) >> 54U) << 54U);
-    return float1;
-}
-
-inline bool
-is_negative(int64_t float1)
-{
-    return ((float1 >> 62U) & 1ULL) == 0;
-}
-
-inline int64_t
-invert_sign(int64_t float1)
-{
-    int64_t r = (int64_t)(((uint64_t)float1) ^ (1ULL << 62U));
-    return r;
-}
-
-inline int64_t
-set_sign(int64_t float1, bool set_negative)
-{
-    bool neg = is_negative(float1);
-    if ((neg && set_negative) || (!neg && !set_negative))
-        return float1;
-
-    return invert_sign(float1);
-}
-
-inline int64_t
-set_mantissa(int64_t float1, uint64_t mantissa)
-{
-    if (mantissa > maxMantissa)
-        return MANTISSA_OVERSIZED;
-    if (mantissa < minMantissa)
-        return MANTISSA_UNDERSIZED;
-    return float1 - get_mantissa(float1) + mantissa;
-}
-
-inline int64_t
-set_exponent(int64_t float1, int32_t exponent)
-{
-    if (exponent > maxExponent)
-        return EXPONENT_OVERSIZED;
-    if (exponent < minExponent)
-        return EXPONENT_UNDERSIZED;
-
-    uint64_t exp = (exponent + 97);
-    exp <<= 54U;
-    float1 &= ~(0xFFLL << 54);
-    float1 += (int64_t)exp;
-    return float1;
-}
-
-inline int64_t
-make_float(ripple::IOUAmount& amt)
-{
-    int64_t man_out = amt.mantissa();
-    int64_t float_out = 0;
-    bool neg = man_out < 0;
-    if (neg)
-        man_out *= -1;
-
-    float_out = set_sign(float_out, neg);
-    float_out = set_mantissa(float_out, (uint64_t)man_out);
-    float_out = set_exponent(float_out, amt.exponent());
-    return float_out;
-}
-
-inline int64_t
-make_float(uint64_t mantissa, int32_t exponent, bool neg)
-{
-    if (mantissa == 0)
-        return 0;
-    if (mantissa > maxMantissa)
-        return MANTISSA_OVERSIZED;
-    if (mantissa < minMantissa)
-        return MANTISSA_UNDERSIZED;
-    if (exponent > maxExponent)
-        return EXPONENT_OVERSIZED;
-    if (exponent < minExponent)
-        return EXPONENT_UNDERSIZED;
-    int64_t out = 0;
-    out = set_mantissa(out, mantissa);
-    out = set_exponent(out, exponent);
-    out = set_sign(out, neg);
-    return out;
-}
-
-/**
- * This function normalizes the mantissa and exponent passed, if it can.
- * It returns the XFL and mutates the supplied manitssa and exponent.
- * If a negative mantissa is provided then the returned XFL has the negative
- * flag set. If there is an overflow error return XFL_OVERFLOW. On underflow
- * returns canonical 0
- */
-template <typename T>
-inline int64_t
-normalize_xfl(T& man, int32_t& exp, bool neg = false)
-{
-    if (man == 0)
-        return 0;
-
-    if (man == std::numeric_limits<int64_t>::min())
-        man++;
-
-    constexpr bool sman = std::is_same<T, int64_t>::value;
-    static_assert(sman || std::is_same<T, uint64_t>());
-
-    if constexpr (sman)
-    {
-        if (man < 0)
-        {
-            man *= -1LL;
-            neg = true;
-        }
-    }
-
-    // mantissa order
-    std::feclearexcept(FE_ALL_EXCEPT);
-    int32_t mo = log10(man);
-    // defensively ensure log10 produces a sane result; we'll borrow the
-    // overflow error code if it didn't
-    if (std::fetestexcept(FE_INVALID))
-        return XFL_OVERFLOW;
-
-    int32_t adjust = 15 - mo;
-
-    if (adjust > 0)
-    {
-        // defensive check
-        if (adjust > 18)
-            return 0;
-        man *= power_of_ten[adjust];
-        exp -= adjust;
-    }
-    else if (adjust < 0)
-    {
-        // defensive check
-        if (-adjust > 18)
-            return XFL_OVERFLOW;
-        man /= power_of_ten[-adjust];
-        exp -= adjust;
-    }
-
-    if (man == 0)
-    {
-        exp = 0;
-        return 0;
-    }
-
-    // even after adjustment the mantissa can be outside the range by one place
-    // improving the math above would probably alleviate the need for these
-    // branches
-    if (man < minMantissa)
-    {
-        if (man == minMantissa - 1LL)
-            man += 1LL;
-        else
-        {
-            man *= 10LL;
-            exp--;
-        }
-    }
-
-    if (man > maxMantissa)
-    {
-        if (man == maxMantissa + 1LL)
-            man -= 1LL;
-        else
-        {
-            man /= 10LL;
-            exp++;
-        }
-    }
-
-    if (exp < minExponent)
-    {
-        man = 0;
-        exp = 0;
-        return 0;
-    }
-
-    if (man == 0)
-    {
-        exp = 0;
-        return 0;
-    }
-
-    if (exp > maxExponent)
-        return XFL_OVERFLOW;
-
-    int64_t ret = make_float((uint64_t)man, exp, neg);
-    if constexpr (sman)
-    {
-        if (neg)
-            man *= -1LL;
-    }
-
-    return ret;
-}
-
-}  // namespace hook_float
 using namespace hook_float;
 inline int32_t
 no_free_slots(hook::HookContext& hookCtx)
@@ -932,19 +686,24 @@ data_as_int64(void const* ptr_raw, uint32_t len)
     return (int64_t)output;
 }
 
-/* returns true iff every even char is ascii and every odd char is 00
- * only a hueristic, may be inaccurate in edgecases */
-inline bool
-is_UTF16LE(const uint8_t* buffer, size_t len)
+// queue a trace made by the running hook, see TraceSink
+template <class F>
+inline void
+writeTrace(hook::HookContext& hookCtx, F&& fill)
 {
-    if (len % 2 != 0 || len == 0)
-        return false;
-
-    for (int i = 0; i < len; i += 2)
-        if (buffer[i + 0] == 0 || buffer[i + 1] != 0)
-            return false;
-
-    return true;
+    // a dry run publishes nothing, its traces only go to a capture
+    if ((hookCtx.applyCtx.flags() & tapDRY_RUN) &&
+        !hook::TraceSink::capturing())
+        return;
+
+    hookCtx.applyCtx.app.getHookTraceSink().write(
+        [&](hook::TraceSink::Record& record) {
+            record.hookHash = hookCtx.result.hookHash;
+            record.account = hookCtx.result.account;
+            record.otxnAccount = hookCtx.result.otxnAccount;
+            record.txID = hookCtx.applyCtx.tx.getTransactionID();
+            fill(record);
+        });
 }
 
 // return true if sleAccount has been modified as a result of the call
@@ -1173,18 +932,166 @@ hook::setHookState(
     return tesSUCCESS;
 }
 
+hook::HookAPIModule::HookAPIModule()
+    : importObj_(WasmEdge_ModuleInstanceCreate(exportName))
+    , hostTable_(WasmEdge_TableInstanceCreate(tableType))
+    , hostMem_(WasmEdge_MemoryInstanceCreate(memType))
+{
+    ADD_HOOK_FUNCTION(_g, boundCtx);
+    ADD_HOOK_FUNCTION(accept, boundCtx);
+    ADD_HOOK_FUNCTION(rollback, boundCtx);
+    ADD_HOOK_FUNCTION(util_raddr, boundCtx);
+    ADD_HOOK_FUNCTION(util_accid, boundCtx);
+    ADD_HOOK_FUNCTION(util_verify, boundCtx);
+    ADD_HOOK_FUNCTION(util_sha512h, boundCtx);
+    ADD_HOOK_FUNCTION(sto_validate, boundCtx);
+    ADD_HOOK_FUNCTION(sto_subfield, boundCtx);
+    ADD_HOOK_FUNCTION(sto_subarray, boundCtx);
+    ADD_HOOK_FUNCTION(sto_emplace, boundCtx);
+    ADD_HOOK_FUNCTION(sto_erase, boundCtx);
+    ADD_HOOK_FUNCTION(util_keylet, boundCtx);
+
+    ADD_HOOK_FUNCTION(emit, boundCtx);
+    ADD_HOOK_FUNCTION(etxn_burden, boundCtx);
+    ADD_HOOK_FUNCTION(etxn_fee_base, boundCtx);
+    ADD_HOOK_FUNCTION(etxn_details, boundCtx);
+    ADD_HOOK_FUNCTION(etxn_reserve, boundCtx);
+    ADD_HOOK_FUNCTION(etxn_generation, boundCtx);
+    ADD_HOOK_FUNCTION(etxn_nonce, boundCtx);
+
+    ADD_HOOK_FUNCTION(float_set, boundCtx);
+    ADD_HOOK_FUNCTION(float_multiply, boundCtx);
+    ADD_HOOK_FUNCTION(float_mulratio, boundCtx);
+    ADD_HOOK_FUNCTION(float_negate, boundCtx);
+    ADD_HOOK_FUNCTION(float_compare, boundCtx);
+    ADD_HOOK_FUNCTION(float_sum, boundCtx);
+    ADD_HOOK_FUNCTION(float_sto, boundCtx);
+    ADD_HOOK_FUNCTION(float_sto_set, boundCtx);
+    ADD_HOOK_FUNCTION(float_invert, boundCtx);
+
+    ADD_HOOK_FUNCTION(float_divide, boundCtx);
+    ADD_HOOK_FUNCTION(float_one, boundCtx);
+    ADD_HOOK_FUNCTION(float_mantissa, boundCtx);
+    ADD_HOOK_FUNCTION(float_sign, boundCtx);
+    ADD_HOOK_FUNCTION(float_int, boundCtx);
+    ADD_HOOK_FUNCTION(float_log, boundCtx);
+    ADD_HOOK_FUNCTION(float_root, boundCtx);
+
+    ADD_HOOK_FUNCTION(otxn_burden, boundCtx);
+    ADD_HOOK_FUNCTION(otxn_generation, boundCtx);
+    ADD_HOOK_FUNCTION(otxn_field, boundCtx);
+    ADD_HOOK_FUNCTION(otxn_id, boundCtx);
+    ADD_HOOK_FUNCTION(otxn_type, boundCtx);
+    ADD_HOOK_FUNCTION(otxn_slot, boundCtx);
+    ADD_HOOK_FUNCTION(otxn_param, boundCtx);
+
+    ADD_HOOK_FUNCTION(hook_account, boundCtx);
+    ADD_HOOK_FUNCTION(hook_hash, boundCtx);
+    ADD_HOOK_FUNCTION(hook_again, boundCtx);
+    ADD_HOOK_FUNCTION(fee_base, boundCtx);
+    ADD_HOOK_FUNCTION(ledger_seq, boundCtx);
+    ADD_HOOK_FUNCTION(ledger_last_hash, boundCtx);
+    ADD_HOOK_FUNCTION(ledger_last_time, boundCtx);
+    ADD_HOOK_FUNCTION(ledger_nonce, boundCtx);
+    ADD_HOOK_FUNCTION(ledger_keylet, boundCtx);
+
+    ADD_HOOK_FUNCTION(hook_param, boundCtx);
+    ADD_HOOK_FUNCTION(hook_param_set, boundCtx);
+    ADD_HOOK_FUNCTION(hook_skip, boundCtx);
+    ADD_HOOK_FUNCTION(hook_pos, boundCtx);
+
+    ADD_HOOK_FUNCTION(state, boundCtx);
+    ADD_HOOK_FUNCTION(state_foreign, boundCtx);
+    ADD_HOOK_FUNCTION(state_set, boundCtx);
+    ADD_HOOK_FUNCTION(state_foreign_set, boundCtx);
+
+    ADD_HOOK_FUNCTION(slot, boundCtx);
+    ADD_HOOK_FUNCTION(slot_clear, boundCtx);
+    ADD_HOOK_FUNCTION(slot_count, boundCtx);
+    ADD_HOOK_FUNCTION(slot_set, boundCtx);
+    ADD_HOOK_FUNCTION(slot_size, boundCtx);
+    ADD_HOOK_FUNCTION(slot_subarray, boundCtx);
+    ADD_HOOK_FUNCTION(slot_subfield, boundCtx);
+    ADD_HOOK_FUNCTION(slot_type, boundCtx);
+    ADD_HOOK_FUNCTION(slot_float, boundCtx);
+
+    ADD_HOOK_FUNCTION(trace, boundCtx);
+    ADD_HOOK_FUNCTION(trace_num, boundCtx);
+    ADD_HOOK_FUNCTION(trace_float, boundCtx);
+
+    ADD_HOOK_FUNCTION(meta_slot, boundCtx);
+    ADD_HOOK_FUNCTION(xpop_slot, boundCtx);
+
+    /*
+    ADD_HOOK_FUNCTION(str_find, boundCtx);
+    ADD_HOOK_FUNCTION(str_replace, boundCtx);
+    ADD_HOOK_FUNCTION(str_compare, boundCtx);
+    ADD_HOOK_FUNCTION(str_concat, boundCtx);
+    */
+
+    WasmEdge_ModuleInstanceAddTable(importObj_, tableName, hostTable_);
+    WasmEdge_ModuleInstanceAddMemory(importObj_, memName, hostMem_);
+}
+
+hook::HookAPIModule::~HookAPIModule()
+{
+    // the module owns the functions, table and memory added to it
+    WasmEdge_ModuleInstanceDelete(importObj_);
+}
+
+bool
+hook::HookAPIModule::reset()
+{
+    // function references from a previous execution's module would dangle
+    uint32_t const tableSize = WasmEdge_TableInstanceGetSize(hostTable_);
+    if (tableSize != WasmEdge_TableTypeGetLimit(tableType).Min)
+        return false;
+
+    for (uint32_t i = 0; i < tableSize; ++i)
+        WasmEdge_TableInstanceSetData(
+            hostTable_, WasmEdge_ValueGenNullRef(WasmEdge_RefType_FuncRef), i);
+
+    // the memory can't grow (max 1 page), it only needs to be zeroed
+    uint64_t const memSize =
+        WasmEdge_MemoryInstanceGetPageSize(hostMem_) * WasmEdge_kPageSize;
+    if (uint8_t* mem = WasmEdge_MemoryInstanceGetPointer(hostMem_, 0, memSize))
+        std::memset(mem, 0, memSize);
+
+    return true;
+}
+
+hook::HookAPIModule::Binding::Binding(HookContext& ctx)
+{
+    static thread_local std::unique_ptr<HookAPIModule> threadModule;
+
+    if (threadModule && threadModule->boundCtx)
+    {
+        owned_ = std::make_unique<HookAPIModule>();
+        module_ = owned_.get();
+    }
+    else
+    {
+        if (!threadModule || !threadModule->reset())
+            threadModule = std::make_unique<HookAPIModule>();
+        module_ = threadModule.get();
+    }
+
+    module_->boundCtx = &ctx;
+}
+
+hook::HookAPIModule::Binding::~Binding()
+{
+    module_->boundCtx = nullptr;
+}
+
 hook::HookResult
 hook::apply(
-    ripple::uint256 const& hookSetTxnID, /* this is the txid of the sethook,
-                                            used for caching (one day) */
-    ripple::uint256 const&
-        hookHash, /* hash of the actual hook byte code, used for metadata */
+    ripple::uint256 const& hookSetTxnID, /* this is the txid of the sethook */
+    ripple::uint256 const& hookHash, /* hash of the actual hook byte code,
+                                        used for metadata and module caching */
     ripple::uint256 const& hookNamespace,
-    ripple::Blob const& wasm,
-    std::map<
-        std::vector<uint8_t>, /* param name  */
-        std::vector<uint8_t>  /* param value */
-        > const& hookParams,
+    ripple::Slice const& wasm,
+    HookParameters const& hookParams,
     std::map<
         ripple::uint256, /* hook hash */
         std::map<std::vector<uint8_t>, std::vector<uint8_t>>> const&
@@ -1238,23 +1145,62 @@ hook::apply(
 
     auto const& j = applyCtx.app.journal("View");
 
+    // the budget is what the transaction paid for this hook: the worst case
+    // instruction count the guard checker computed when it was installed
+    if (applyCtx.view().rules().enabled(featureHookCostLimit))
+    {
+        if (auto const hookDef =
+                applyCtx.view().read(keylet::hookDefinition(hookHash)))
+        {
+            auto const& feeField = isCallback ? sfHookCallbackFee : sfFee;
+            if (hookDef->isFieldPresent(feeField))
+            {
+                auto const wce = hookDef->getFieldAmount(feeField).xrp().drops();
+                if (wce > 0)
+                    hookCtx.costLimit =
+                        static_cast<uint64_t>(wce) * cost_limit_multiplier;
+            }
+        }
+    }
+
+    auto& moduleCache = applyCtx.app.getHookModuleCache();
+    auto const module = moduleCache.fetch(hookHash, wasm);
+
+    if (!module)
+    {
+        JLOG(j.warn()) << "HookError[" << HC_ACC() << "]: " << module.error();
+        hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
+        return hookCtx.result;
+    }
+
+    // the interpreted module is used until the native one is ready
+    if (!(*module)->native() &&
+        (moduleCache.aotOnExecution() || moduleCache.stale(hookHash)))
+        moduleCache.compileAsync(
+            applyCtx.app.getJobQueue(),
+            hookHash,
+            wasm);
+
     HookExecutor executor{hookCtx};
 
-    executor.executeWasm(
-        wasm.data(), (size_t)wasm.size(), isCallback, wasmParam, j);
+    executor.executeWasm(**module, isCallback, wasmParam, j);
 
     JLOG(j.trace()) << "HookInfo[" << HC_ACC() << "]: "
-                    << (hookCtx.result.exitType == hook_api::ExitType::ROLLBACK
-                            ? "ROLLBACK"
-                            : "ACCEPT")
+                    << (hookCtx.result.exitType == hook_api::ExitType::ACCEPT
+                            ? "ACCEPT"
+                            : hookCtx.result.exitType ==
+                                    hook_api::ExitType::COST_LIMIT
+                                ? "COST_LIMIT"
+                                : "ROLLBACK")
                     << " RS: '" << hookCtx.result.exitReason.c_str()
                     << "' RC: " << hookCtx.result.exitCode;
 
     return hookCtx.result;
 }
 
-/* If XRPLD is running with trace log level hooks may produce debugging output
- * to the trace log specifying both a string and an integer to output */
+/* If XRPLD is running with trace log level, or an admin is subscribed to the
+ * hook_traces stream, hooks may produce debugging output specifying both a
+ * string and an integer to output */
 DEFINE_HOOK_FUNCTION(
     int64_t,
     trace_num,
@@ -1267,30 +1213,24 @@ DEFINE_HOOK_FUNCTION(
     if (NOT_IN_BOUNDS(read_ptr, read_len, memory_length))
         return OUT_OF_BOUNDS;
 
-    if (!j.trace())
+    if (!applyCtx.app.getHookTraceSink().enabled())
         return 0;
 
     if (read_len > 128)
         read_len = 128;
 
-    if (read_len > 0)
-    {
-        // skip \0 if present at the end
-        if (*((const char*)memory + read_ptr + read_len - 1) == '\0')
-            read_len--;
+    // skip \0 if present at the end
+    if (read_len > 0 &&
+        *((const char*)memory + read_ptr + read_len - 1) == '\0')
+        read_len--;
 
-        if (read_len > 0)
-        {
-            j.trace() << "HookTrace[" << HC_ACC() << "]: "
-                      << std::string_view(
-                             (const char*)memory + read_ptr, read_len)
-                      << ": " << number;
+    writeTrace(hookCtx, [&](hook::TraceSink::Record& record) {
+        record.kind = hook::TraceSink::Kind::number;
+        record.number = number;
+        record.messageSize = read_len;
+        memcpy(record.message.data(), memory + read_ptr, read_len);
+    });
 
-            return 0;
-        }
-    }
-
-    j.trace() << "HookTrace[" << HC_ACC() << "]: " << number;
     return 0;
     HOOK_TEARDOWN();
 }
@@ -1310,7 +1250,7 @@ DEFINE_HOOK_FUNCTION(
         NOT_IN_BOUNDS(dread_ptr, dread_len, memory_length))
         return OUT_OF_BOUNDS;
 
-    if (!j.trace())
+    if (!applyCtx.app.getHookTraceSink().enabled())
         return 0;
 
     if (mread_len > 128)
@@ -1319,60 +1259,22 @@ DEFINE_HOOK_FUNCTION(
     if (dread_len > 1023)
         dread_len = 1023;
 
-    uint8_t output_storage[2200];
-    size_t out_len = 0;
-
-    uint8_t* output = output_storage;
-
-    if (mread_len > 0)
-    {
-        memcpy(output, memory + mread_ptr, mread_len);
-        out_len += mread_len;
-
-        // detect and skip \0 if it appears at the end
-        if (output[out_len - 1] == '\0')
-            out_len--;
+    bool const hasMessage = mread_len > 0;
 
-        output[out_len++] = ':';
-        output[out_len++] = ' ';
-    }
+    // detect and skip \0 if it appears at the end
+    if (mread_len > 0 && memory[mread_ptr + mread_len - 1] == '\0')
+        mread_len--;
 
-    output = output_storage + out_len;
-
-    if (dread_len > 0)
-    {
-        if (as_hex)
-        {
-            out_len += dread_len * 2;
-            for (int i = 0; i < dread_len && i < memory_length; ++i)
-            {
-                uint8_t high = (memory[dread_ptr + i] >> 4) & 0xFU;
-                uint8_t low = (memory[dread_ptr + i] & 0xFU);
-                high += (high < 10U ? '0' : 'A' - 10);
-                low += (low < 10U ? '0' : 'A' - 10);
-                output[i * 2 + 0] = high;
-                output[i * 2 + 1] = low;
-            }
-        }
-        else if (is_UTF16LE(memory + dread_ptr, dread_len))
-        {
-            out_len += dread_len /
-                2;  // is_UTF16LE will only return true if read_len is even
-            for (int i = 0; i < (dread_len / 2); ++i)
-                output[i] = memory[dread_ptr + i * 2];
-        }
-        else
-        {
-            out_len += dread_len;
-            memcpy(output, memory + dread_ptr, dread_len);
-        }
-    }
-
-    if (out_len > 0)
-    {
-        j.trace() << "HookTrace[" << HC_ACC() << "]: "
-                  << std::string_view((const char*)output_storage, out_len);
-    }
+    // the payload is rendered as hex, UTF-16 or as is by the drain thread
+    writeTrace(hookCtx, [&](hook::TraceSink::Record& record) {
+        record.kind = hook::TraceSink::Kind::text;
+        record.hasMessage = hasMessage;
+        record.asHex = as_hex != 0;
+        record.messageSize = mread_len;
+        memcpy(record.message.data(), memory + mread_ptr, mread_len);
+        record.dataSize = dread_len;
+        memcpy(record.data.data(), memory + dread_ptr, dread_len);
+    });
 
     return 0;
     HOOK_TEARDOWN();
@@ -1403,30 +1305,31 @@ std::optional<ripple::uint256> inline make_state_key(std::string_view source)
 }
 
 // check the state cache
-inline std::optional<
-    std::reference_wrapper<std::pair<bool, ripple::Blob> const>>
+inline hook::HookStateMap::Entry const*
 lookup_state_cache(
     hook::HookContext& hookCtx,
     ripple::AccountID const& acc,
     ripple::uint256 const& ns,
     ripple::uint256 const& key)
 {
-    auto& stateMap = hookCtx.result.stateMap;
-    if (stateMap.find(acc) == stateMap.end())
-        return std::nullopt;
-
-    auto& stateMapAcc = std::get<2>(stateMap[acc]);
-    if (stateMapAcc.find(ns) == stateMapAcc.end())
-        return std::nullopt;
-
-    auto& stateMapNs = stateMapAcc[ns];
-
-    auto const& ret = stateMapNs.find(key);
+    return hookCtx.result.stateMap.find(acc, ns, key);
+}
 
-    if (ret == stateMapNs.end())
-        return std::nullopt;
+// remember that the hook reached for state of its own account which it had not
+// touched before, the next execution of the chain will prefetch it
+inline void
+note_state_access(
+    hook::HookContext& hookCtx,
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key)
+{
+    auto& prefetcher = hookCtx.applyCtx.app.getHookStatePrefetcher();
+    if (!prefetcher.enabled() || acc != hookCtx.result.account ||
+        hookCtx.result.stateMap.find(acc, ns, key))
+        return;
 
-    return std::cref(ret->second);
+    prefetcher.touched(acc, ns, key);
 }
 
 // update the state cache
@@ -1436,7 +1339,7 @@ set_state_cache(
     ripple::AccountID const& acc,
     ripple::uint256 const& ns,
     ripple::uint256 const& key,
-    ripple::Blob& data,
+    ripple::Slice const& data,
     bool modified)
 {
     auto& stateMap = hookCtx.result.stateMap;
@@ -1445,10 +1348,14 @@ set_state_cache(
     if (modified && stateMap.modified_entry_count >= max_state_modifications)
         return TOO_MANY_STATE_MODIFICATIONS;
 
+    if (modified)
+        note_state_access(hookCtx, acc, ns, key);
+
     bool const createNamespace = view.rules().enabled(fixXahauV1) &&
         !view.exists(keylet::hookStateDir(acc, ns));
 
-    if (stateMap.find(acc) == stateMap.end())
+    auto* accInfo = stateMap.findAccount(acc);
+    if (!accInfo)
     {
         // if this is the first time this account has been interacted with
         // we will compute how many available reserve positions there are
@@ -1490,19 +1397,17 @@ set_state_cache(
 
         stateMap.modified_entry_count++;
 
-        stateMap[acc] = {
-            availableForReserves - 1,
-            namespaceCount,
-            {{ns, {{key, {modified, data}}}}}};
+        stateMap.insertAccount(
+            acc, {availableForReserves - 1, namespaceCount});
+        stateMap.insert(acc, ns, key, modified, data);
         return 1;
     }
 
-    auto& availableForReserves = std::get<0>(stateMap[acc]);
-    auto& namespaceCount = std::get<1>(stateMap[acc]);
-    auto& stateMapAcc = std::get<2>(stateMap[acc]);
+    auto& availableForReserves = accInfo->availableForReserves;
+    auto& namespaceCount = accInfo->namespaceCount;
     bool const canReserveNew = availableForReserves > 0;
 
-    if (stateMapAcc.find(ns) == stateMapAcc.end())
+    if (!stateMap.hasNamespace(acc, ns))
     {
         if (modified)
         {
@@ -1525,13 +1430,13 @@ set_state_cache(
             stateMap.modified_entry_count++;
         }
 
-        stateMapAcc[ns] = {{key, {modified, data}}};
+        stateMap.insert(acc, ns, key, modified, data);
 
         return 1;
     }
 
-    auto& stateMapNs = stateMapAcc[ns];
-    if (stateMapNs.find(key) == stateMapNs.end())
+    auto* entry = stateMap.find(acc, ns, key);
+    if (!entry)
     {
         if (modified)
         {
@@ -1541,21 +1446,21 @@ set_state_cache(
             stateMap.modified_entry_count++;
         }
 
-        stateMapNs[key] = {modified, data};
+        stateMap.insert(acc, ns, key, modified, data);
         hookCtx.result.changedStateCount++;
         return 1;
     }
 
     if (modified)
     {
-        if (!stateMapNs[key].first)
+        if (!entry->modified)
             hookCtx.result.changedStateCount++;
 
         stateMap.modified_entry_count++;
-        stateMapNs[key].first = true;
+        entry->modified = true;
     }
 
-    stateMapNs[key].second = data;
+    stateMap.assign(*entry, data);
     return 1;
 }
 
@@ -1659,7 +1564,7 @@ DEFINE_HOOK_FUNCTION(
     if (!key)
         return INTERNAL_ERROR;
 
-    ripple::Blob data{memory + read_ptr, memory + read_ptr + read_len};
+    ripple::Slice const data{memory + read_ptr, read_len};
 
     // local modifications are always allowed
     if (aread_len == 0 || acc == hookCtx.result.account)
@@ -1677,7 +1582,7 @@ DEFINE_HOOK_FUNCTION(
 
     // first check if we've already modified this state
     auto cacheEntry = lookup_state_cache(hookCtx, acc, ns, *key);
-    if (cacheEntry && cacheEntry->get().first)
+    if (cacheEntry && cacheEntry->modified)
     {
         // if a cache entry already exists and it has already been modified
         // don't check grants again
@@ -1765,6 +1670,145 @@ DEFINE_HOOK_FUNCTION(
     HOOK_TEARDOWN();
 }
 
+namespace {
+
+// a change to a state entry, with the entry as it is on the ledger and the
+// counts of the account once the change is written
+struct StateChange
+{
+    hook::HookStateMap::Key const* key;
+    ripple::Slice data;
+    std::shared_ptr<ripple::SLE> sle;
+    std::uint32_t stateCount;
+    std::uint32_t ownerCount;
+
+    // whether this or an earlier change of the account creates or deletes
+    // a state entry
+    bool counted;
+};
+
+using StateChanges = std::vector<StateChange>;
+
+// write the changes to one namespace of acc, the removals and insertions of
+// each run of them page by page. Returns the first change of the run the
+// directory could not take, with nothing of that run written, or last.
+StateChanges::const_iterator
+commitNamespaceState(
+    ripple::ApplyView& view,
+    ripple::SLE& sleAccount,
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    StateChanges::const_iterator first,
+    StateChanges::const_iterator last)
+{
+    auto const hookStateDirKeylet = ripple::keylet::hookStateDir(acc, ns);
+
+    auto const modification = [](StateChange const& c) {
+        return c.sle && !c.data.empty();
+    };
+
+    auto const modify = [&view](StateChange const& c) {
+        c.sle->setFieldVL(sfHookStateData, c.data);
+        c.sle->setFieldH256(sfHookStateKey, c.key->key);
+        view.update(c.sle);
+    };
+
+    for (auto c = first; c != last;)
+    {
+        // modifications leave the directory alone
+        if (modification(*c))
+        {
+            modify(*c++);
+            continue;
+        }
+
+        // the run of removals or insertions c starts, modifications aside
+        bool const removing = !!c->sle;
+        auto end = c;
+        while (end != last &&
+               (modification(*end) || !!end->sle == removing))
+            ++end;
+
+        if (removing)
+        {
+            if (!view.peek(hookStateDirKeylet))
+                return c;
+
+            std::vector<std::pair<std::uint64_t, ripple::uint256>> entries;
+            for (auto it = c; it != end; ++it)
+                if (!modification(*it))
+                    entries.emplace_back(
+                        (*it->sle)[sfOwnerNode], it->sle->key());
+
+            // Remove the nodes from the namespace directory
+            if (!view.dirRemove(hookStateDirKeylet, entries, false))
+                return c;
+
+            // remove the actual hook state objs
+            for (auto it = c; it != end; ++it)
+            {
+                if (modification(*it))
+                    modify(*it);
+                else
+                    view.erase(it->sle);
+            }
+
+            if (!view.peek(hookStateDirKeylet))
+                hook::removeHookNamespaceEntry(sleAccount, ns);
+        }
+        else
+        {
+            bool const nsExists = !!view.peek(hookStateDirKeylet);
+
+            std::vector<ripple::uint256> keys;
+            for (auto it = c; it != end; ++it)
+                if (!it->sle)
+                    keys.push_back(
+                        ripple::keylet::hookState(acc, it->key->key, ns).key);
+
+            auto const pages = view.dirInsert(
+                hookStateDirKeylet, keys, describeOwnerDir(acc));
+            if (!pages)
+                return c;
+
+            // add new data to ledger
+            auto page = pages->begin();
+            for (auto it = c; it != end; ++it)
+            {
+                if (it->sle)
+                {
+                    modify(*it);
+                    continue;
+                }
+
+                auto hookState = std::make_shared<SLE>(
+                    ripple::keylet::hookState(acc, it->key->key, ns));
+                hookState->setFieldVL(sfHookStateData, it->data);
+                hookState->setFieldH256(sfHookStateKey, it->key->key);
+                hookState->setFieldU64(sfOwnerNode, *page++);
+                view.insert(hookState);
+            }
+
+            // update namespace vector where necessary
+            if (!nsExists)
+                hook::addHookNamespaceEntry(sleAccount, ns);
+        }
+
+        c = end;
+    }
+
+    return last;
+}
+
+}  // namespace
+
+// Commits the changes of each account at once, leaving the ledger just as
+// calling setHookState for each in order would, up to and including the
+// change that fails: every check setHookState makes before writing is made
+// first, then the changes before the first that fails are written and the
+// owner count and state count of the account are set once. Should a
+// directory not take a run of changes, the rest of the account's changes
+// are left to setHookState, which writes what it writes before failing.
 ripple::TER
 hook::finalizeHookState(
     HookStateMap const& stateMap,
@@ -1772,50 +1816,185 @@ hook::finalizeHookState(
     ripple::uint256 const& txnID)
 {
     auto const& j = applyCtx.app.journal("View");
+    auto& view = applyCtx.view();
     uint16_t changeCount = 0;
 
-    // write all changes to state, if in "apply" mode
-    for (const auto& accEntry : stateMap)
+    auto const failed = [&](TER result, StateChange const& c) {
+        JLOG(j.warn()) << "HookError[TX:" << txnID
+                       << "]: SetHookState failed: " << result
+                       << " Key: " << c.key->key << " Value: " << c.data;
+        return result;
+    };
+
+    // the entries are in (account, namespace, key) order
+    auto const entries = stateMap.modifiedEntries();
+    for (auto first = entries.begin(); first != entries.end();)
     {
-        const auto& acc = accEntry.first;
-        for (const auto& nsEntry : std::get<2>(accEntry.second))
+        auto const acc = first->first->acc;
+        auto const last =
+            std::find_if(first, entries.end(), [&acc](auto const& entry) {
+                return entry.first->acc != acc;
+            });
+
+        auto const sleAccount = view.peek(ripple::keylet::account(acc));
+
+        std::uint32_t const oldOwnerCount =
+            sleAccount ? (*sleAccount)[sfOwnerCount] : 0;
+
+        // the result of the first change setHookState would fail before
+        // writing anything for
+        TER result = tesSUCCESS;
+
+        StateChanges changes;
+        changes.reserve(std::distance(first, last));
+
+        for (auto it = first; it != last; ++it)
         {
-            const auto& ns = nsEntry.first;
-            for (const auto& cacheEntry : nsEntry.second)
+            auto const& [entryKey, entry] = *it;
+
+            changeCount++;
+            if (changeCount > max_state_modifications + 1)
             {
-                bool is_modified = cacheEntry.second.first;
-                const auto& key = cacheEntry.first;
-                const auto& blob = cacheEntry.second.second;
-                if (is_modified)
-                {
-                    changeCount++;
-                    if (changeCount > max_state_modifications + 1)
-                    {
-                        // overflow
-                        JLOG(j.warn())
-                            << "HooKError[TX:" << txnID
-                            << "]: SetHooKState failed: Too many state changes";
-                        return tecHOOK_REJECTED;
-                    }
+                // overflow
+                JLOG(j.warn())
+                    << "HooKError[TX:" << txnID
+                    << "]: SetHooKState failed: Too many state changes";
+                result = tecHOOK_REJECTED;
+                break;
+            }
 
-                    // this entry isn't just cached, it was actually modified
-                    auto slice = Slice(blob.data(), blob.size());
+            // this entry isn't just cached, it was actually modified
+            StateChange change{entryKey, entry->value(), nullptr, 0, 0, false};
 
-                    TER result = setHookState(applyCtx, acc, ns, key, slice);
+            if (!sleAccount)
+            {
+                result = failed(tefINTERNAL, change);
+                break;
+            }
+
+            if (changes.empty())
+            {
+                change.stateCount = sleAccount->getFieldU32(sfHookStateCount);
+                change.ownerCount = oldOwnerCount;
+            }
+            else
+            {
+                change.stateCount = changes.back().stateCount;
+                change.ownerCount = changes.back().ownerCount;
+                change.counted = changes.back().counted;
+            }
+
+            // if the blob is too large don't set it
+            if (change.data.size() > hook::maxHookStateDataSize())
+            {
+                result = failed(temHOOK_DATA_TOO_LARGE, change);
+                break;
+            }
+
+            change.sle = view.peek(ripple::keylet::hookState(
+                acc, entryKey->key, entryKey->ns));
+
+            auto const oldStateReserve =
+                computeHookStateOwnerCount(change.stateCount);
 
-                    if (!isTesSuccess(result))
+            // if the blob is nil then delete the entry if it exists
+            if (change.data.empty())
+            {
+                // a request to remove a non-existent entry is defined as
+                // success
+                if (!change.sle)
+                    continue;
+
+                // guard this because in the "impossible" event it is
+                // already 0 we'll wrap back to int_max
+                if (change.stateCount > 0)
+                    --change.stateCount;
+
+                // if removing this state entry would destroy the allotment
+                // then reduce the owner count
+                if (computeHookStateOwnerCount(change.stateCount) <
+                        oldStateReserve &&
+                    change.ownerCount > 0)
+                    --change.ownerCount;
+
+                change.counted = true;
+            }
+            else if (!change.sle)
+            {
+                ++change.stateCount;
+
+                // the hook used its allocated allotment of state entries for
+                // its previous ownercount increment ownercount and give it
+                // another allotment
+                if (computeHookStateOwnerCount(change.stateCount) >
+                    oldStateReserve)
+                {
+                    ++change.ownerCount;
+                    XRPAmount const newReserve{
+                        view.fees().accountReserve(change.ownerCount)};
+
+                    if (STAmount((*sleAccount)[sfBalance]).xrp() < newReserve)
                     {
-                        JLOG(j.warn())
-                            << "HookError[TX:" << txnID
-                            << "]: SetHookState failed: " << result
-                            << " Key: " << key << " Value: " << slice;
-                        return result;
+                        result = failed(tecINSUFFICIENT_RESERVE, change);
+                        break;
                     }
-                    // ^ should not fail... checks were done before map insert
                 }
+
+                change.counted = true;
             }
+
+            changes.push_back(std::move(change));
         }
+
+        auto c = changes.cbegin();
+        while (c != changes.cend())
+        {
+            auto const& ns = c->key->ns;
+            auto const end =
+                std::find_if(c, changes.cend(), [&ns](auto const& change) {
+                    return change.key->ns != ns;
+                });
+
+            auto const unwritten =
+                commitNamespaceState(view, *sleAccount, acc, ns, c, end);
+
+            c = unwritten;
+            if (unwritten != end)
+                break;
+        }
+
+        // set the counts the changes written so far leave the account with
+        if (c != changes.cbegin() && std::prev(c)->counted)
+        {
+            auto const& written = *std::prev(c);
+
+            if (written.ownerCount != oldOwnerCount)
+                adjustOwnerCount(
+                    view,
+                    sleAccount,
+                    static_cast<std::int32_t>(written.ownerCount) -
+                        static_cast<std::int32_t>(oldOwnerCount),
+                    j);
+
+            // update state count
+            sleAccount->setFieldU32(sfHookStateCount, written.stateCount);
+            view.update(sleAccount);
+        }
+
+        for (; c != changes.cend(); ++c)
+        {
+            if (TER const r = setHookState(
+                    applyCtx, acc, c->key->ns, c->key->key, c->data);
+                !isTesSuccess(r))
+                return failed(r, *c);
+        }
+
+        if (!isTesSuccess(result))
+            return result;
+
+        first = last;
     }
+
     return tesSUCCESS;
 }
 
@@ -1823,7 +2002,7 @@ bool /* retval of true means an error */
 hook::gatherHookParameters(
     std::shared_ptr<ripple::STLedgerEntry> const& hookDef,
     ripple::STObject const& hookObj,
-    std::map<std::vector<uint8_t>, std::vector<uint8_t>>& parameters,
+    HookParameters& parameters,
     beast::Journal const& j_)
 {
     if (!hookDef->isFieldPresent(sfHookParameters))
@@ -1833,27 +2012,80 @@ hook::gatherHookParameters(
         return true;
     }
 
+    // names and values are not copied, they point into the ledger entries
+    auto const add = [&parameters](STObject const& hookParameterObj) {
+        parameters[peekFieldVL(hookParameterObj, sfHookParameterName)] =
+            hookParameterObj.isFieldPresent(sfHookParameterValue)
+            ? peekFieldVL(hookParameterObj, sfHookParameterValue)
+            : Slice{};
+    };
+
     // first defaults
     auto const& defaultParameters = hookDef->getFieldArray(sfHookParameters);
     for (auto const& hookParameterObj : defaultParameters)
-    {
-        parameters[hookParameterObj.getFieldVL(sfHookParameterName)] =
-            hookParameterObj.getFieldVL(sfHookParameterValue);
-    }
+        add(hookParameterObj);
 
     // and then custom
     if (hookObj.isFieldPresent(sfHookParameters))
     {
         auto const& hookParameters = hookObj.getFieldArray(sfHookParameters);
         for (auto const& hookParameterObj : hookParameters)
-        {
-            parameters[hookParameterObj.getFieldVL(sfHookParameterName)] =
-                hookParameterObj.getFieldVL(sfHookParameterValue);
-        }
+            add(hookParameterObj);
     }
     return false;
 }
 
+ripple::Slice
+hook::SlotEntry::serialize()
+{
+    if (!serialized || serializedEntry != entry)
+    {
+        Serializer s;
+        entry->add(s);
+        serialized = std::make_shared<Blob const>(std::move(s.modData()));
+        serializedEntry = entry;
+    }
+    return makeSlice(*serialized);
+}
+
+hook::SerializedFields::SerializedFields(ripple::STObject const& obj)
+{
+    Serializer s;
+    fields_.reserve(obj.getCount());
+    for (auto const& field : obj)
+    {
+        if (field.getSType() == STI_NOTPRESENT)
+            continue;
+
+        auto const offset = s.size();
+        field.add(s);
+        fields_.push_back(
+            {field.getFName().fieldCode,
+             field.getSType(),
+             static_cast<uint32_t>(offset),
+             static_cast<uint32_t>(s.size() - offset)});
+    }
+
+    std::sort(fields_.begin(), fields_.end(), [](auto const& a, auto const& b) {
+        return a.fieldCode < b.fieldCode;
+    });
+    bytes_ = std::move(s.modData());
+}
+
+std::optional<std::pair<ripple::Slice, ripple::SerializedTypeID>>
+hook::SerializedFields::find(int fieldCode) const
+{
+    auto const it = std::lower_bound(
+        fields_.begin(),
+        fields_.end(),
+        fieldCode,
+        [](Field const& f, int code) { return f.fieldCode < code; });
+    if (it == fields_.end() || it->fieldCode != fieldCode)
+        return std::nullopt;
+    return std::make_pair(
+        Slice{bytes_.data() + it->offset, it->length}, it->type);
+}
+
 ripple::TER
 hook::removeEmissionEntry(ripple::ApplyContext& applyCtx)
 {
@@ -1879,6 +2111,8 @@ hook::removeEmissionEntry(ripple::ApplyContext& applyCtx)
     }
 
     applyCtx.view().erase(sle);
+    if (!(applyCtx.flags() & tapDRY_RUN))
+        applyCtx.app.getTxQ().emittedTxns().erase(key.key);
     return tesSUCCESS;
 }
 
@@ -1899,6 +2133,9 @@ hook::finalizeHookResult(
     ApplyViewImpl& avi = dynamic_cast<ApplyViewImpl&>(applyCtx.view());
 
     uint16_t exec_index = avi.nextHookExecutionIndex();
+
+    // a dry run leaves the emissions in its view and nowhere else
+    bool const dryRun = applyCtx.flags() & tapDRY_RUN;
     // apply emitted transactions to the ledger (by adding them to the emitted
     // directory) if we are allowed to
     std::vector<std::pair<uint256 /* txnid */, uint256 /* emit nonce */>>
@@ -1913,7 +2150,8 @@ hook::finalizeHookResult(
             auto& id = tpTrans->getID();
             JLOG(j.trace()) << "HookEmit[" << HR_ACC() << "]: " << id;
 
-            applyCtx.app.getHashRouter().setFlags(id, SF_EMITTED);
+            if (!dryRun)
+                applyCtx.app.getHashRouter().setFlags(id, SF_EMITTED);
 
             std::shared_ptr<const ripple::STTx> ptr =
                 tpTrans->getSTransaction();
@@ -1947,6 +2185,9 @@ hook::finalizeHookResult(
                 {
                     (*sleEmitted)[sfOwnerNode] = *page;
                     applyCtx.view().insert(sleEmitted);
+                    if (!dryRun)
+                        applyCtx.app.getTxQ().emittedTxns().insert(
+                            emittedId.key, ptr);
                 }
                 else
                 {
@@ -2114,25 +2355,25 @@ DEFINE_HOOK_FUNCTION(
         return INVALID_ARGUMENT;
 
     // first check if the requested state was previously cached this session
-    auto cacheEntryLookup = lookup_state_cache(hookCtx, acc, ns, *key);
-    if (cacheEntryLookup)
+    if (auto const cacheEntry = lookup_state_cache(hookCtx, acc, ns, *key))
     {
-        auto const& cacheEntry = cacheEntryLookup->get();
-
         WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
             write_ptr,
             write_len,
-            cacheEntry.second.data(),
-            cacheEntry.second.size(),
+            cacheEntry->data,
+            cacheEntry->size,
             false);
     }
 
+    note_state_access(hookCtx, acc, ns, *key);
+
     auto hsSLE = view.peek(keylet::hookState(acc, *key, ns));
 
     if (!hsSLE)
         return DOESNT_EXIST;
 
-    Blob b = hsSLE->getFieldVL(sfHookStateData);
+    auto const b =
+        hsSLE->peekAtField(sfHookStateData).downcast<STBlob>().value();
 
     // it exists add it to cache and return it
     if (set_state_cache(hookCtx, acc, ns, *key, b, false) < 0)
@@ -2403,9 +2644,28 @@ DEFINE_HOOK_FUNCTION(
     if (!applyCtx.tx.isFieldPresent(fieldType))
         return DOESNT_EXIST;
 
-    auto const& field = hookCtx.emitFailure
-        ? hookCtx.emitFailure->getField(fieldType)
-        : const_cast<ripple::STTx&>(applyCtx.tx).getField(fieldType);
+    STObject const& otxn = hookCtx.emitFailure
+        ? *hookCtx.emitFailure
+        : static_cast<STObject const&>(applyCtx.tx);
+
+    // all of the fields are serialized the first time one is asked for
+    if (!hookCtx.otxnFields)
+        hookCtx.otxnFields.emplace(otxn);
+
+    if (auto const found = hookCtx.otxnFields->find(fieldType.fieldCode))
+    {
+        auto const& [bytes, type] = *found;
+        WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
+            write_ptr,
+            write_len,
+            bytes.data(),
+            bytes.size(),
+            type == STI_ACCOUNT);
+    }
+
+    // the ledger entry of a failed emitted transaction need not have the
+    // field the transaction has
+    auto const& field = otxn.peekAtField(fieldType);
 
     Serializer s;
     field.add(s);
@@ -2445,21 +2705,22 @@ DEFINE_HOOK_FUNCTION(
             return TOO_SMALL;
     }
 
-    if (hookCtx.slot.find(slot_no) == hookCtx.slot.end())
+    auto const it = hookCtx.slot.find(slot_no);
+    if (it == hookCtx.slot.end())
         return DOESNT_EXIST;
 
-    if (hookCtx.slot[slot_no].entry == 0)
+    auto& slot = it->second;
+    if (slot.entry == 0)
         return INTERNAL_ERROR;
 
-    Serializer s;
-    hookCtx.slot[slot_no].entry->add(s);
+    auto const bytes = slot.serialize();
 
     WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
         write_ptr,
         write_len,
-        s.getDataPtr(),
-        s.getDataLength(),
-        hookCtx.slot[slot_no].entry->getSType() == STI_ACCOUNT);
+        bytes.data(),
+        bytes.size(),
+        slot.entry->getSType() == STI_ACCOUNT);
 
     HOOK_TEARDOWN();
 }
@@ -2546,6 +2807,8 @@ DEFINE_HOOK_FUNCTION(
 
         ripple::error_code_i ec{ripple::error_code_i::rpcUNKNOWN};
 
+        // the transaction database is not part of the view
+        SpeculativeApply::unrecorded();
         auto hTx = applyCtx.app.getMasterTransaction().fetch(hash, ec);
 
         if (auto const* p = std::get_if<std::pair<
@@ -2583,16 +2846,14 @@ DEFINE_HOOK_FUNCTION(int64_t, slot_size, uint32_t slot_no)
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    if (hookCtx.slot.find(slot_no) == hookCtx.slot.end())
+    auto const it = hookCtx.slot.find(slot_no);
+    if (it == hookCtx.slot.end())
         return DOESNT_EXIST;
 
-    if (hookCtx.slot[slot_no].entry == 0)
+    if (it->second.entry == 0)
         return INTERNAL_ERROR;
 
-    // RH TODO: this is a very expensive way of computing size, cache it
-    Serializer s;
-    hookCtx.slot[slot_no].entry->add(s);
-    return s.getDataLength();
+    return it->second.serialize().size();
 
     HOOK_TEARDOWN();
 }
@@ -2607,13 +2868,14 @@ DEFINE_HOOK_FUNCTION(
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    if (hookCtx.slot.find(parent_slot) == hookCtx.slot.end())
+    auto const parent = hookCtx.slot.find(parent_slot);
+    if (parent == hookCtx.slot.end())
         return DOESNT_EXIST;
 
-    if (hookCtx.slot[parent_slot].entry == 0)
+    if (parent->second.entry == 0)
         return INTERNAL_ERROR;
 
-    if (hookCtx.slot[parent_slot].entry->getSType() != STI_ARRAY)
+    if (parent->second.entry->getSType() != STI_ARRAY)
         return NOT_AN_ARRAY;
 
     if (new_slot == 0 && no_free_slots(hookCtx))
@@ -2622,43 +2884,29 @@ DEFINE_HOOK_FUNCTION(
     if (new_slot > hook_api::max_slots)
         return INVALID_ARGUMENT;
 
-    bool copied = false;
-    try
-    {
-        ripple::STArray& parent_obj =
-            const_cast<ripple::STBase&>(*hookCtx.slot[parent_slot].entry)
-                .downcast<ripple::STArray>();
-
-        if (parent_obj.size() <= array_id)
-            return DOESNT_EXIST;
+    auto const* parent_obj =
+        dynamic_cast<ripple::STArray const*>(parent->second.entry);
+    if (!parent_obj)
+        return NOT_AN_ARRAY;
 
-        if (new_slot == 0)
-        {
-            if (auto found = get_free_slot(hookCtx); found)
-                new_slot = *found;
-            else
-                return NO_FREE_SLOTS;
-        }
+    if (parent_obj->size() <= array_id)
+        return DOESNT_EXIST;
 
-        // copy
-        if (new_slot != parent_slot)
-        {
-            copied = true;
-            hookCtx.slot[new_slot] = hookCtx.slot[parent_slot];
-        }
-        hookCtx.slot[new_slot].entry = &(parent_obj[array_id]);
-        return new_slot;
-    }
-    catch (const std::bad_cast& e)
+    if (new_slot == 0)
     {
-        if (copied)
-        {
-            hookCtx.slot.erase(new_slot);
-            hookCtx.slot_free.push(new_slot);
-        }
-        return NOT_AN_ARRAY;
+        if (auto found = get_free_slot(hookCtx); found)
+            new_slot = *found;
+        else
+            return NO_FREE_SLOTS;
     }
 
+    // copy, the parent's storage keeps the element alive
+    auto& slot = hookCtx.slot[new_slot];
+    if (new_slot != parent_slot)
+        slot = parent->second;
+    slot.entry = &((*parent_obj)[array_id]);
+    return new_slot;
+
     HOOK_TEARDOWN();
 }
 
@@ -2672,7 +2920,8 @@ DEFINE_HOOK_FUNCTION(
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    if (hookCtx.slot.find(parent_slot) == hookCtx.slot.end())
+    auto const parent = hookCtx.slot.find(parent_slot);
+    if (parent == hookCtx.slot.end())
         return DOESNT_EXIST;
 
     if (new_slot == 0 && no_free_slots(hookCtx))
@@ -2686,48 +2935,34 @@ DEFINE_HOOK_FUNCTION(
     if (fieldCode == sfInvalid)
         return INVALID_FIELD;
 
-    if (hookCtx.slot[parent_slot].entry == 0)
+    if (parent->second.entry == 0)
         return INTERNAL_ERROR;
 
-    bool copied = false;
-
-    try
-    {
-        ripple::STObject& parent_obj =
-            const_cast<ripple::STBase&>(*hookCtx.slot[parent_slot].entry)
-                .downcast<ripple::STObject>();
-
-        if (!parent_obj.isFieldPresent(fieldCode))
-            return DOESNT_EXIST;
-
-        if (new_slot == 0)
-        {
-            if (auto found = get_free_slot(hookCtx); found)
-                new_slot = *found;
-            else
-                return NO_FREE_SLOTS;
-        }
+    auto const* parent_obj =
+        dynamic_cast<ripple::STObject const*>(parent->second.entry);
+    if (!parent_obj)
+        return NOT_AN_OBJECT;
 
-        // copy
-        if (new_slot != parent_slot)
-        {
-            copied = true;
-            hookCtx.slot[new_slot] = hookCtx.slot[parent_slot];
-        }
+    // one lookup, through the object's template where it has one
+    auto const* field = parent_obj->peekAtPField(fieldCode);
+    if (!field || field->getSType() == STI_NOTPRESENT)
+        return DOESNT_EXIST;
 
-        hookCtx.slot[new_slot].entry = &(parent_obj.getField(fieldCode));
-        return new_slot;
-    }
-    catch (const std::bad_cast& e)
+    if (new_slot == 0)
     {
-        if (copied)
-        {
-            hookCtx.slot.erase(new_slot);
-            hookCtx.slot_free.push(new_slot);
-        }
-        return NOT_AN_OBJECT;
+        if (auto found = get_free_slot(hookCtx); found)
+            new_slot = *found;
+        else
+            return NO_FREE_SLOTS;
     }
 
+    // copy, the parent's storage keeps the field alive
+    auto& slot = hookCtx.slot[new_slot];
+    if (new_slot != parent_slot)
+        slot = parent->second;
+    slot.entry = field;
+    return new_slot;
+
     HOOK_TEARDOWN();
 }
 
@@ -3838,207 +4073,6 @@ DEFINE_HOOK_FUNCTION(
     HOOK_TEARDOWN();
 }
 
-// these are only used by get_stobject_length below
-enum parse_error : int32_t {
-    pe_unexpected_end = -1,
-    pe_unknown_type_early = -2,  // detected early
-    pe_unknown_type_late = -3,   // end of function
-    pe_excessive_nesting = -4,
-    pe_excessive_size = -5
-};
-
-// RH NOTE this is a light-weight stobject parsing function for drilling into a
-// provided serialzied object however it could probably be replaced by an
-// existing class or routine or set of routines in XRPLD Returns object length
-// including header bytes (and footer bytes in the event of array or object)
-// negative indicates error
-inline int32_t
-get_stobject_length(
-    unsigned char* start,   // in - begin iterator
-    unsigned char* maxptr,  // in - end iterator
-    int& type,              // out - populated by serialized type code
-    int& field,             // out - populated by serialized field code
-    int& payload_start,  // out - the start of actual payload data for this type
-    int& payload_length,  // out - the length of actual payload data for this
-                          // type
-    int recursion_depth = 0)  // used internally
-{
-    if (recursion_depth > 10)
-        return pe_excessive_nesting;
-
-    unsigned char* end = maxptr;
-    unsigned char* upto = start;
-    int high = *upto >> 4;
-    int low = *upto & 0xF;
-
-    upto++;
-    if (upto >= end)
-        return pe_unexpected_end;
-    if (high > 0 && low > 0)
-    {
-        // common type common field
-        type = high;
-        field = low;
-    }
-    else if (high > 0)
-    {
-        // common type, uncommon field
-        type = high;
-        field = *upto++;
-    }
-    else if (low > 0)
-    {
-        // common field, uncommon type
-        field = low;
-        type = *upto++;
-    }
-    else
-    {
-        // uncommon type and field
-        type = *upto++;
-        if (upto >= end)
-            return pe_unexpected_end;
-        field = *upto++;
-    }
-
-    DBG_PRINTF(
-        "%d get_st_object found field %d type %d\n",
-        recursion_depth,
-        field,
-        type);
-
-    if (upto >= end)
-        return pe_unexpected_end;
-
-    // RH TODO: link this to rippled's internal STObject constants
-    // E.g.:
-    /*
-    int field_code = (safe_cast<int>(type) << 16) | field;
-    auto const& fieldObj = ripple::SField::getField;
-    */
-
-    if (type < 1 || type > 19 || (type >= 9 && type <= 13))
-        return pe_unknown_type_early;
-
-    bool is_vl = (type == 8 /*ACCID*/ || type == 7 || type == 18 || type == 19);
-
-    int length = -1;
-    if (is_vl)
-    {
-        length = *upto++;
-        if (upto >= end)
-            return pe_unexpected_end;
-
-        if (length < 193)
-        {
-            // do nothing
-        }
-        else if (length > 192 && length < 241)
-        {
-            length -= 193;
-            length *= 256;
-            length += *upto++ + 193;
-            if (upto > end)
-                return pe_unexpected_end;
-        }
-        else
-        {
-            int b2 = *upto++;
-            if (upto >= end)
-                return pe_unexpected_end;
-            length -= 241;
-            length *= 65536;
-            length += 12481 + (b2 * 256) + *upto++;
-            if (upto >= end)
-                return pe_unexpected_end;
-        }
-    }
-    else if ((type >= 1 && type <= 5) || type == 16 || type == 17)
-    {
-        length =
-            (type == 1
-                 ? 2
-                 : (type == 2
-                        ? 4
-                        : (type == 3
-                               ? 8
-                               : (type == 4
-                                      ? 16
-                                      : (type == 5
-                                             ? 32
-                                             : (type == 16
-                                                    ? 1
-                                                    : (type == 17 ? 20
-                                                                  : -1)))))));
-    }
-    else if (type == 6) /* AMOUNT */
-    {
-        length = (*upto >> 6 == 1) ? 8 : 48;
-        if (upto >= end)
-            return pe_unexpected_end;
-    }
-
-    if (length > -1)
-    {
-        payload_start = upto - start;
-        payload_length = length;
-        DBG_PRINTF(
-            "%d get_stobject_length field: %d Type: %d VL: %s Len: %d "
-            "Payload_Start: %d Payload_Len: %d\n",
-            recursion_depth,
-            field,
-            type,
-            (is_vl ? "yes" : "no"),
-            length,
-            payload_start,
-            payload_length);
-        return length + (upto - start);
-    }
-
-    if (type == 15 || type == 14) /* Object / Array */
-    {
-        payload_start = upto - start;
-
-        for (int i = 0; i < 1024; ++i)
-        {
-            int subfield = -1, subtype = -1, payload_start_ = -1,
-                payload_length_ = -1;
-            int32_t sublength = get_stobject_length(
-                upto,
-                end,
-                subtype,
-                subfield,
-                payload_start_,
-                payload_length_,
-                recursion_depth + 1);
-            DBG_PRINTF(
-                "%d get_stobject_length i %d %d-%d, upto %d sublength %d\n",
-                recursion_depth,
-                i,
-                subtype,
-                subfield,
-                upto - start,
-                sublength);
-            if (sublength < 0)
-                return pe_unexpected_end;
-            upto += sublength;
-            if (upto >= end)
-                return pe_unexpected_end;
-
-            if ((*upto == 0xE1U && type == 0xEU) ||
-                (*upto == 0xF1U && type == 0xFU))
-            {
-                payload_length = upto - start - payload_start;
-                upto++;
-                return (upto - start);
-            }
-        }
-        return pe_excessive_size;
-    }
-
-    return pe_unknown_type_late;
-}
-
 // Given an serialized object in memory locate and return the offset and length
 // of the payload of a subfield of that object. Arrays are returned fully
 // formed. If successful returns offset and length joined as int64_t. Use
@@ -4059,55 +4093,13 @@ DEFINE_HOOK_FUNCTION(
     if (read_len < 2)
         return TOO_SMALL;
 
-    unsigned char* start = (unsigned char*)(memory + read_ptr);
-    unsigned char* upto = start;
-    unsigned char* end = start + read_len;
-
     DBG_PRINTF(
         "sto_subfield called, looking for field %u type %u\n",
         field_id & 0xFFFF,
         (field_id >> 16));
-    for (int j = -5; j < 5; ++j)
-        DBG_PRINTF((j == 0 ? " >%02X< " : "  %02X  "), *(start + j));
-    DBG_PRINTF("\n");
 
-    //    if ((*upto & 0xF0) == 0xE0)
-    //        upto++;
-
-    for (int i = 0; i < 1024 && upto < end; ++i)
-    {
-        int type = -1, field = -1, payload_start = -1, payload_length = -1;
-        int32_t length = get_stobject_length(
-            upto, end, type, field, payload_start, payload_length, 0);
-        if (length < 0)
-            return PARSE_ERROR;
-        if ((type << 16) + field == field_id)
-        {
-            DBG_PRINTF(
-                "sto_subfield returned for field %u type %u\n",
-                field_id & 0xFFFF,
-                (field_id >> 16));
-            for (int j = -5; j < 5; ++j)
-                DBG_PRINTF((j == 0 ? " [%02X] " : "  %02X  "), *(upto + j));
-            DBG_PRINTF("\n");
-
-            if (type == 0xF)  // we return arrays fully formed
-                return (((int64_t)(upto - start))
-                        << 32) /* start of the object */
-                    + (uint32_t)(length);
-
-            // return pointers to all other objects as payloads
-            return (((int64_t)(upto - start + payload_start))
-                    << 32U) /* start of the object */
-                + (uint32_t)(payload_length);
-        }
-        upto += length;
-    }
-
-    if (upto != end)
-        return PARSE_ERROR;
-
-    return DOESNT_EXIST;
+    return hookCtx.stoIndexes.get(read_ptr, memory + read_ptr, read_len)
+        .subfield(field_id);
 
     HOOK_TEARDOWN();
 }
@@ -4129,53 +4121,22 @@ DEFINE_HOOK_FUNCTION(
     if (read_len < 2)
         return TOO_SMALL;
 
-    unsigned char* start = (unsigned char*)(memory + read_ptr);
-    unsigned char* upto = start;
-    unsigned char* end = start + read_len;
-
     // unwrap the array if it is wrapped,
     // by removing a byte from the start and end
-    if ((*upto & 0xF0U) == 0xF0U)
-    {
-        upto++;
-        end--;
-    }
+    uint32_t unwrapped = 0;
+    if ((*(memory + read_ptr) & 0xF0U) == 0xF0U)
+        unwrapped = 1;
+
+    uint32_t const ptr = read_ptr + unwrapped;
+    uint32_t const len = read_len - unwrapped * 2;
 
-    if (upto >= end)
+    if (len == 0)
         return PARSE_ERROR;
 
-    /*
     DBG_PRINTF("sto_subarray called, looking for index %u\n", index_id);
-    for (int j = -5; j < 5; ++j)
-        printf(( j == 0 ? " >%02X< " : "  %02X  "), *(start + j));
-    DBG_PRINTF("\n");
-    */
-    for (int i = 0; i < 1024 && upto < end; ++i)
-    {
-        int type = -1, field = -1, payload_start = -1, payload_length = -1;
-        int32_t length = get_stobject_length(
-            upto, end, type, field, payload_start, payload_length, 0);
-        if (length < 0)
-            return PARSE_ERROR;
-
-        if (i == index_id)
-        {
-            DBG_PRINTF("sto_subarray returned for index %u\n", index_id);
-            for (int j = -5; j < 5; ++j)
-                DBG_PRINTF(
-                    (j == 0 ? " [%02X] " : "  %02X  "), *(upto + j + length));
-            DBG_PRINTF("\n");
-
-            return (((int64_t)(upto - start)) << 32U) /* start of the object */
-                + (int64_t)(length);
-        }
-        upto += length;
-    }
-
-    if (upto != end)
-        return PARSE_ERROR;
 
-    return DOESNT_EXIST;
+    return hookCtx.stoIndexes.get(ptr, memory + ptr, len)
+        .subarray(index_id, unwrapped);
 
     HOOK_TEARDOWN();
 }
@@ -4374,7 +4335,6 @@ DEFINE_HOOK_FUNCTION(
     // we must inject the field at the canonical location....
     // so find that location
     unsigned char* start = (unsigned char*)(memory + sread_ptr);
-    unsigned char* upto = start;
     unsigned char* end = start + sread_len;
     unsigned char* inject_start = end;
     unsigned char* inject_end = end;
@@ -4383,39 +4343,25 @@ DEFINE_HOOK_FUNCTION(
         "sto_emplace called, looking for field %u type %u\n",
         field_id & 0xFFFF,
         (field_id >> 16));
-    for (int j = -5; j < 5; ++j)
-        DBG_PRINTF((j == 0 ? " >%02X< " : "  %02X  "), *(start + j));
-    DBG_PRINTF("\n");
-
-    for (int i = 0; i < 1024 && upto < end; ++i)
-    {
-        int type = -1, field = -1, payload_start = -1, payload_length = -1;
-        int32_t length = get_stobject_length(
-            upto, end, type, field, payload_start, payload_length, 0);
-        if (length < 0)
-            return PARSE_ERROR;
-        if ((type << 16) + field == field_id)
-        {
-            inject_start = upto;
-            inject_end = upto + length;
-            break;
-        }
-        else if ((type << 16) + field > field_id)
-        {
-            inject_start = upto;
-            inject_end = upto;
-            break;
-        }
-        upto += length;
-    }
 
-    // if the scan loop ends past the end of the source object
-    // then the source object is invalid/corrupt, so we must
-    // return an error
-    if (upto > end)
+    auto const& index = hookCtx.stoIndexes.get(sread_ptr, start, sread_len);
+
+    if (auto const* f = index.lowerBound(field_id))
+    {
+        // replace the field if it is present, otherwise insert it before the
+        // first field that sorts after it
+        inject_start = start + f->offset;
+        inject_end = f->id == field_id ? inject_start + f->length : inject_start;
+    }
+    else if (index.parseError() || index.end() > sread_len)
+    {
+        // if the scan ends past the end of the source object
+        // then the source object is invalid/corrupt, so we must
+        // return an error
         return PARSE_ERROR;
+    }
 
-    // upto is injection point
+    // inject_start is injection point
     int64_t bytes_written = 0;
 
     // part 1
@@ -4508,21 +4454,10 @@ DEFINE_HOOK_FUNCTION(
     if (read_len < 2)
         return TOO_SMALL;
 
-    unsigned char* start = (unsigned char*)(memory + read_ptr);
-    unsigned char* upto = start;
-    unsigned char* end = start + read_len;
-
-    for (int i = 0; i < 1024 && upto < end; ++i)
-    {
-        int type = -1, field = -1, payload_start = -1, payload_length = -1;
-        int32_t length = get_stobject_length(
-            upto, end, type, field, payload_start, payload_length, 0);
-        if (length < 0)
-            return 0;
-        upto += length;
-    }
+    auto const& index =
+        hookCtx.stoIndexes.get(read_ptr, memory + read_ptr, read_len);
 
-    return upto == end ? 1 : 0;
+    return index.valid() ? 1 : 0;
 
     HOOK_TEARDOWN();
 }
@@ -4611,6 +4546,8 @@ DEFINE_HOOK_FUNCTION(
         std::unique_ptr<STTx const> stpTrans;
         stpTrans = std::make_unique<STTx const>(std::ref(sitTrans));
 
+        // the open ledger is not part of the view
+        SpeculativeApply::unrecorded();
         return Transactor::calculateBaseFee(
                    *(applyCtx.app.openLedger().current()), *stpTrans)
             .drops();
@@ -4777,7 +4714,7 @@ DEFINE_HOOK_FUNCTION(
     if (NOT_IN_BOUNDS(read_ptr, read_len, memory_length))
         return OUT_OF_BOUNDS;
 
-    if (!j.trace())
+    if (!applyCtx.app.getHookTraceSink().enabled())
         return 0;
 
     if (read_len > 128)
@@ -4788,37 +4725,13 @@ DEFINE_HOOK_FUNCTION(
         *((const char*)memory + read_ptr + read_len - 1) == '\0')
         read_len--;
 
-    if (float1 == 0)
-    {
-        j.trace() << "HookTrace[" << HC_ACC() << "]:"
-                  << (read_len == 0
-                          ? ""
-                          : std::string_view(
-                                (const char*)memory + read_ptr, read_len))
-                  << ": Float 0*10^(0) <ZERO>";
-        return 0;
-    }
-
-    uint64_t man = get_mantissa(float1);
-    int32_t exp = get_exponent(float1);
-    bool neg = is_negative(float1);
-    if (man < minMantissa || man > maxMantissa || exp < minExponent ||
-        exp > maxExponent)
-    {
-        j.trace() << "HookTrace[" << HC_ACC() << "]:"
-                  << (read_len == 0
-                          ? ""
-                          : std::string_view(
-                                (const char*)memory + read_ptr, read_len))
-                  << ": Float <INVALID>";
-        return 0;
-    }
+    writeTrace(hookCtx, [&](hook::TraceSink::Record& record) {
+        record.kind = hook::TraceSink::Kind::xfl;
+        record.number = float1;
+        record.messageSize = read_len;
+        memcpy(record.message.data(), memory + read_ptr, read_len);
+    });
 
-    j.trace() << "HookTrace[" << HC_ACC() << "]:"
-              << (read_len == 0 ? ""
-                                : std::string_view(
-                                      (const char*)memory + read_ptr, read_len))
-              << ": Float " << (neg ? "-" : "") << man << "*10^(" << exp << ")";
     return 0;
 
     HOOK_TEARDOWN();
@@ -4867,33 +4780,6 @@ mulratio_internal(
     }
 }
 
-inline int64_t
-float_multiply_internal_parts(
-    uint64_t man1,
-    int32_t exp1,
-    bool neg1,
-    uint64_t man2,
-    int32_t exp2,
-    bool neg2)
-{
-    using namespace boost::multiprecision;
-    cpp_int mult = cpp_int(man1) * cpp_int(man2);
-    mult /= power_of_ten[15];
-    uint64_t man_out = static_cast<uint64_t>(mult);
-    if (mult > man_out)
-        return XFL_OVERFLOW;
-
-    int32_t exp_out = exp1 + exp2 + 15;
-    bool neg_out = (neg1 && !neg2) || (!neg1 && neg2);
-    int64_t ret = normalize_xfl(man_out, exp_out, neg_out);
-
-    if (ret == EXPONENT_UNDERSIZED)
-        return 0;
-    if (ret == EXPONENT_OVERSIZED)
-        return XFL_OVERFLOW;
-    return ret;
-}
-
 DEFINE_HOOK_FUNCTION(
     int64_t,
     float_int,
@@ -4941,20 +4827,7 @@ DEFINE_HOOK_FUNCTION(int64_t, float_multiply, int64_t float1, int64_t float2)
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    RETURN_IF_INVALID_FLOAT(float1);
-    RETURN_IF_INVALID_FLOAT(float2);
-
-    if (float1 == 0 || float2 == 0)
-        return 0;
-
-    uint64_t man1 = get_mantissa(float1);
-    int32_t exp1 = get_exponent(float1);
-    bool neg1 = is_negative(float1);
-    uint64_t man2 = get_mantissa(float2);
-    int32_t exp2 = get_exponent(float2);
-    bool neg2 = is_negative(float2);
-
-    return float_multiply_internal_parts(man1, exp1, neg1, man2, exp2, neg2);
+    return float_multiply_internal(float1, float2);
 
     HOOK_TEARDOWN();
 }
@@ -5066,39 +4939,7 @@ DEFINE_HOOK_FUNCTION(int64_t, float_sum, int64_t float1, int64_t float2)
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    RETURN_IF_INVALID_FLOAT(float1);
-    RETURN_IF_INVALID_FLOAT(float2);
-
-    if (float1 == 0)
-        return float2;
-    if (float2 == 0)
-        return float1;
-
-    int64_t man1 =
-        (int64_t)(get_mantissa(float1)) * (is_negative(float1) ? -1LL : 1LL);
-    int32_t exp1 = get_exponent(float1);
-    int64_t man2 =
-        (int64_t)(get_mantissa(float2)) * (is_negative(float2) ? -1LL : 1LL);
-    int32_t exp2 = get_exponent(float2);
-
-    try
-    {
-        ripple::IOUAmount amt1{man1, exp1};
-        ripple::IOUAmount amt2{man2, exp2};
-        amt1 += amt2;
-        int64_t result = make_float(amt1);
-        if (result == EXPONENT_UNDERSIZED)
-        {
-            // this is an underflow e.g. as a result of subtracting an xfl from
-            // itself and thus not an error, just return canonical 0
-            return 0;
-        }
-        return result;
-    }
-    catch (std::overflow_error& e)
-    {
-        return XFL_OVERFLOW;
-    }
+    return float_sum_internal(float1, float2);
 
     HOOK_TEARDOWN();
 }
@@ -5401,86 +5242,6 @@ DEFINE_HOOK_FUNCTION(
     HOOK_TEARDOWN();
 }
 
-const int64_t float_one_internal = make_float(1000000000000000ull, -15, false);
-
-inline int64_t
-float_divide_internal(int64_t float1, int64_t float2, bool hasFix)
-{
-    RETURN_IF_INVALID_FLOAT(float1);
-    RETURN_IF_INVALID_FLOAT(float2);
-    if (float2 == 0)
-        return DIVISION_BY_ZERO;
-    if (float1 == 0)
-        return 0;
-
-    // special case: division by 1
-    // RH TODO: add more special cases (division by power of 10)
-    if (float2 == float_one_internal)
-        return float1;
-
-    uint64_t man1 = get_mantissa(float1);
-    int32_t exp1 = get_exponent(float1);
-    bool neg1 = is_negative(float1);
-    uint64_t man2 = get_mantissa(float2);
-    int32_t exp2 = get_exponent(float2);
-    bool neg2 = is_negative(float2);
-
-    int64_t tmp1 = normalize_xfl(man1, exp1);
-    int64_t tmp2 = normalize_xfl(man2, exp2);
-
-    if (tmp1 < 0 || tmp2 < 0)
-        return INVALID_FLOAT;
-
-    if (tmp1 == 0)
-        return 0;
-
-    while (man2 > man1)
-    {
-        man2 /= 10;
-        exp2++;
-    }
-
-    if (man2 == 0)
-        return DIVISION_BY_ZERO;
-
-    while (man2 < man1)
-    {
-        if (man2 * 10 > man1)
-            break;
-        man2 *= 10;
-        exp2--;
-    }
-
-    uint64_t man3 = 0;
-    int32_t exp3 = exp1 - exp2;
-
-    while (man2 > 0)
-    {
-        int i = 0;
-        if (hasFix)
-        {
-            for (; man1 >= man2; man1 -= man2, ++i)
-                ;
-        }
-        else
-        {
-            for (; man1 > man2; man1 -= man2, ++i)
-                ;
-        }
-
-        man3 *= 10;
-        man3 += i;
-        man2 /= 10;
-        if (man2 == 0)
-            break;
-        exp3--;
-    }
-
-    bool neg3 = !((neg1 && neg2) || (!neg1 && !neg2));
-
-    return normalize_xfl(man3, exp3, neg3);
-}
-
 DEFINE_HOOK_FUNCTION(int64_t, float_divide, int64_t float1, int64_t float2)
 {
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
@@ -5539,74 +5300,12 @@ DEFINE_HOOK_FUNCTION(int64_t, float_sign, int64_t float1)
     HOOK_TEARDOWN();
 }
 
-inline int64_t
-double_to_xfl(double x)
-{
-    if ((x) == 0)
-        return 0;
-    bool neg = x < 0;
-    double absresult = neg ? -x : x;
-
-    // first compute the base 10 order of the float
-    int32_t exp_out = (int32_t)log10(absresult);
-
-    // next adjust it into the valid mantissa range (this means dividing by its
-    // order and multiplying by 10**15)
-    absresult *= pow(10, -exp_out + 15);
-
-    // after adjustment the value may still fall below the minMantissa
-    int64_t result = (int64_t)absresult;
-    if (result < minMantissa)
-    {
-        if (result == minMantissa - 1LL)
-            result += 1LL;
-        else
-        {
-            result *= 10LL;
-            exp_out--;
-        }
-    }
-
-    // likewise the value can fall above the maxMantissa
-    if (result > maxMantissa)
-    {
-        if (result == maxMantissa + 1LL)
-            result -= 1LL;
-        else
-        {
-            result /= 10LL;
-            exp_out++;
-        }
-    }
-
-    exp_out -= 15;
-    int64_t ret = make_float(result, exp_out, neg);
-
-    if (ret == EXPONENT_UNDERSIZED)
-        return 0;
-
-    return ret;
-}
-
 DEFINE_HOOK_FUNCTION(int64_t, float_log, int64_t float1)
 {
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    RETURN_IF_INVALID_FLOAT(float1);
-
-    if (float1 == 0)
-        return INVALID_ARGUMENT;
-
-    uint64_t man1 = get_mantissa(float1);
-    int32_t exp1 = get_exponent(float1);
-    if (is_negative(float1))
-        return COMPLEX_NOT_SUPPORTED;
-
-    double inp = (double)(man1);
-    double result = log10(inp) + exp1;
-
-    return double_to_xfl(result);
+    return float_log_internal(float1);
 
     HOOK_TEARDOWN();
 }
@@ -5616,22 +5315,7 @@ DEFINE_HOOK_FUNCTION(int64_t, float_root, int64_t float1, uint32_t n)
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    RETURN_IF_INVALID_FLOAT(float1);
-    if (float1 == 0)
-        return 0;
-
-    if (n < 2)
-        return INVALID_ARGUMENT;
-
-    uint64_t man1 = get_mantissa(float1);
-    int32_t exp1 = get_exponent(float1);
-    if (is_negative(float1))
-        return COMPLEX_NOT_SUPPORTED;
-
-    double inp = (double)(man1)*pow(10, exp1);
-    double result = pow(inp, ((double)1.0f) / ((double)(n)));
-
-    return double_to_xfl(result);
+    return float_root_internal(float1, n);
 
     HOOK_TEARDOWN();
 }
@@ -5720,17 +5404,17 @@ DEFINE_HOOK_FUNCTION(
     if (read_len > 32)
         return TOO_BIG;
 
-    std::vector<uint8_t> paramName{
-        read_ptr + memory, read_ptr + read_len + memory};
+    Slice const paramName{read_ptr + memory, read_len};
 
     // first check for overrides set by prior hooks in the chain
     auto const& overrides = hookCtx.result.hookParamOverrides;
     if (overrides.find(hookCtx.result.hookHash) != overrides.end())
     {
         auto const& params = overrides.at(hookCtx.result.hookHash);
-        if (params.find(paramName) != params.end())
+        std::vector<uint8_t> const name{paramName.begin(), paramName.end()};
+        if (params.find(name) != params.end())
         {
-            auto const& param = params.at(paramName);
+            auto const& param = params.at(name);
             if (param.size() == 0)
                 return DOESNT_EXIST;  // allow overrides to "delete" parameters
 
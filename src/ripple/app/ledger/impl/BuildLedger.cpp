@@ -23,6 +23,7 @@
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/app/tx/SpeculativeApply.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/protocol/Feature.h>
 
@@ -103,6 +104,19 @@ applyTransactions(
     bool certainRetry = true;
     std::size_t count = 0;
 
+    // Run the transactions which execute hooks ahead of their turn, all at
+    // once, keeping each result which still holds when its turn comes
+    std::optional<SpeculativeApply> speculation;
+    if (app.config().HOOK_SPECULATIVE_THREADS)
+    {
+        std::vector<std::shared_ptr<STTx const>> batch;
+        batch.reserve(txns.size());
+        for (auto const& [_, tx] : txns)
+            if (!built->txExists(tx->getTransactionID()))
+                batch.push_back(tx);
+        speculation.emplace(app, view, batch, tapRETRY, j);
+    }
+
     // Attempt to apply all of the retriable transactions
     for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
     {
@@ -127,7 +141,13 @@ applyTransactions(
                 }
 
                 switch (applyTransaction(
-                    app, view, *it->second, certainRetry, tapNONE, j))
+                    app,
+                    view,
+                    *it->second,
+                    certainRetry,
+                    tapNONE,
+                    j,
+                    speculation ? &*speculation : nullptr))
                 {
                     case ApplyResult::Success:
                         it = txns.erase(it);
@@ -169,6 +189,11 @@ applyTransactions(
             certainRetry = false;
     }
 
+    if (speculation)
+        JLOG(j.debug()) << "Speculative results committed: "
+                        << speculation->committed()
+                        << ", applied again: " << speculation->reapplied();
+
     // If there are any transactions left, we must have
     // tried them in at least one final pass
     assert(txns.empty() || !certainRetry);
@@ -18,6 +18,11 @@
 //==============================================================================
 
 #include <ripple/app/consensus/RCLValidations.h>
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/app/hook/Profiler.h>
+#include <ripple/app/hook/StatePrefetcher.h>
+#include <ripple/app/hook/TraceSink.h>
+#include <ripple/app/hook/ValidationCache.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/InboundTransactions.h>
 #include <ripple/app/ledger/LedgerCleaner.h>
@@ -49,6 +54,7 @@
 #include <ripple/app/rdb/backend/PostgresDatabase.h>
 #include <ripple/app/reporting/ReportingETL.h>
 #include <ripple/app/tx/apply.h>
+#include <ripple/app/tx/impl/Import.h>
 #include <ripple/basics/ByteUtilities.h>
 #include <ripple/basics/PerfLog.h>
 #include <ripple/basics/ResolverAsio.h>
@@ -57,6 +63,7 @@
 #include <ripple/beast/asio/io_latency_probe.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/core/DatabaseCon.h>
+#include <ripple/core/VerifyPool.h>
 #include <ripple/crypto/csprng.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/nodestore/DatabaseShard.h>
@@ -81,6 +88,7 @@
 
 #include <date/date.h>
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <cstring>
@@ -185,6 +193,15 @@ public:
 
     NodeCache m_tempNodeCache;
     CachedSLEs cachedSLEs_;
+    VerifiedUNLCache verifiedUNLs_;
+    VerifiedXPOPCache verifiedXPOPs_;
+    VerifyPool verifyPool_;
+    VerifyPool speculationPool_;
+    hook::ModuleCache hookModuleCache_;
+    hook::StatePrefetcher hookStatePrefetcher_;
+    hook::Profiler hookProfiler_;
+    hook::TraceSink hookTraceSink_;
+    hook::ValidationCache hookValidationCache_;
     std::pair<PublicKey, SecretKey> nodeIdentity_;
     ValidatorKeys const validatorKeys_;
 
@@ -349,6 +366,44 @@ public:
               stopwatch(),
               logs_->journal("CachedSLEs"))
 
+        , verifiedUNLs_(
+              "Verified UNLs",
+              16,
+              std::chrono::minutes(10),
+              stopwatch(),
+              logs_->journal("TaggedCache"))
+
+        , verifiedXPOPs_(
+              "Verified XPOPs",
+              256,
+              std::chrono::minutes(2),
+              stopwatch(),
+              logs_->journal("TaggedCache"))
+
+        // the thread verifying an XPOP helps, so a few are plenty
+        , verifyPool_(
+              std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u) - 1,
+              "XPOP verify")
+
+        // the thread building the ledger helps too
+        , speculationPool_(
+              config_->HOOK_SPECULATIVE_THREADS
+                  ? config_->HOOK_SPECULATIVE_THREADS - 1
+                  : 0,
+              "Speculate")
+
+        , hookModuleCache_(
+              config_->HOOK_MODULE_CACHE_SIZE,
+              config_->HOOK_AOT_PATH,
+              config_->HOOK_AOT_ON_INSTALL,
+              logs_->journal("HookModuleCache"))
+
+        , hookStatePrefetcher_(config_->HOOK_STATE_PREFETCH_KEYS)
+
+        , hookProfiler_(config_->HOOK_PROFILE)
+
+        , hookTraceSink_(logs_->journal("View"))
+
         , validatorKeys_(*config_, m_journal)
 
         , m_resourceManager(Resource::make_Manager(
@@ -783,6 +838,60 @@ public:
         return cachedSLEs_;
     }
 
+    VerifiedUNLCache&
+    getVerifiedUNLs() override
+    {
+        return verifiedUNLs_;
+    }
+
+    VerifiedXPOPCache&
+    getVerifiedXPOPs() override
+    {
+        return verifiedXPOPs_;
+    }
+
+    VerifyPool&
+    getVerifyPool() override
+    {
+        return verifyPool_;
+    }
+
+    VerifyPool&
+    getSpeculationPool() override
+    {
+        return speculationPool_;
+    }
+
+    hook::ModuleCache&
+    getHookModuleCache() override
+    {
+        return hookModuleCache_;
+    }
+
+    hook::StatePrefetcher&
+    getHookStatePrefetcher() override
+    {
+        return hookStatePrefetcher_;
+    }
+
+    hook::Profiler&
+    getHookProfiler() override
+    {
+        return hookProfiler_;
+    }
+
+    hook::TraceSink&
+    getHookTraceSink() override
+    {
+        return hookTraceSink_;
+    }
+
+    hook::ValidationCache&
+    getHookValidationCache() override
+    {
+        return hookValidationCache_;
+    }
+
     AmendmentTable&
     getAmendmentTable() override
     {
@@ -1072,6 +1181,8 @@ public:
         getLedgerReplayer().sweep();
         m_acceptedLedgerCache.sweep();
         cachedSLEs_.sweep();
+        verifiedUNLs_.sweep();
+        verifiedXPOPs_.sweep();
 
 #ifdef RIPPLED_REPORTING
         if (auto pg = dynamic_cast<PostgresDatabase*>(&*mRelationalDatabase))
@@ -1547,6 +1658,8 @@ ApplicationImp::start(bool withTimers)
     grpcServer_->start();
     ledgerCleaner_->start();
     perfLog_->start();
+    hookTraceSink_.start(
+        [this](Json::Value const& jv) { m_networkOPs->pubHookTrace(jv); });
 }
 
 void
@@ -1636,6 +1749,7 @@ ApplicationImp::run()
     if (shardStore_)
         shardStore_->stop();
     grpcServer_->stop();
+    hookTraceSink_.stop();
     m_networkOPs->stop();
     serverHandler_->stop();
     m_ledgerReplayer->stop();
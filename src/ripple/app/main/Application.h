@@ -31,6 +31,14 @@
 #include <memory>
 #include <mutex>
 
+namespace hook {
+class ModuleCache;
+class Profiler;
+class StatePrefetcher;
+class TraceSink;
+class ValidationCache;
+}  // namespace hook
+
 namespace ripple {
 
 namespace unl {
@@ -64,6 +72,10 @@ class TaggedCache;
 class STLedgerEntry;
 using SLE = STLedgerEntry;
 using CachedSLEs = TaggedCache<uint256, SLE const>;
+struct VerifiedUNL;
+struct VerifiedXPOP;
+using VerifiedUNLCache = TaggedCache<uint256, VerifiedUNL const>;
+using VerifiedXPOPCache = TaggedCache<uint256, VerifiedXPOP const>;
 
 class CollectorManager;
 class Family;
@@ -96,6 +108,7 @@ class TxQ;
 
 class ValidatorList;
 class ValidatorSite;
+class VerifyPool;
 class Cluster;
 
 class RelationalDatabase;
@@ -180,6 +193,24 @@ public:
     getTempNodeCache() = 0;
     virtual CachedSLEs&
     cachedSLEs() = 0;
+    virtual VerifiedUNLCache&
+    getVerifiedUNLs() = 0;
+    virtual VerifiedXPOPCache&
+    getVerifiedXPOPs() = 0;
+    virtual VerifyPool&
+    getVerifyPool() = 0;
+    virtual VerifyPool&
+    getSpeculationPool() = 0;
+    virtual hook::ModuleCache&
+    getHookModuleCache() = 0;
+    virtual hook::StatePrefetcher&
+    getHookStatePrefetcher() = 0;
+    virtual hook::Profiler&
+    getHookProfiler() = 0;
+    virtual hook::TraceSink&
+    getHookTraceSink() = 0;
+    virtual hook::ValidationCache&
+    getHookValidationCache() = 0;
     virtual AmendmentTable&
     getAmendmentTable() = 0;
     virtual HashRouter&
@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_EMITTEDTXNINDEX_H_INCLUDED
+#define RIPPLE_APP_MISC_EMITTEDTXNINDEX_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/Serializer.h>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace ripple {
+
+/**
+    The emitted transactions waiting in the emitted directory, parsed once.
+
+    Each ledger, TxQ::accept inserts the emitted transactions whose
+    FirstLedgerSequence has arrived and an EmitFailure for each one whose
+    LastLedgerSequence has passed. Rather than reading and deserializing
+    every ltEMITTED_TXN in the directory each ledger to find them, this
+    index keeps each entry's transaction and ledger window, ordered by the
+    ledgers the entry becomes eligible and expires in.
+
+    The ledger remains the authority. Each update() is given the closed
+    ledger the view is built on, and only looks at the entries which may
+    have changed since the last one: those the closed ledger's metadata
+    shows were created or deleted, and those insert() and erase() were told
+    of, which may have been added to or removed from views that were then
+    discarded. The whole directory is only read when the closed ledger is
+    not a child of the last one, which covers startup.
+*/
+class EmittedTxnIndex
+{
+public:
+    struct Emission
+    {
+        uint256 txnID;
+        LedgerIndex firstLedger;  // sfFirstLedgerSequence
+        LedgerIndex lastLedger;   // sfLastLedgerSequence
+        std::shared_ptr<STTx const> txn;
+        std::shared_ptr<Serializer const> blob;  // txn, serialized
+    };
+
+    /** What a ledger has to do with the emitted directory. */
+    struct Due
+    {
+        /// Emissions whose FirstLedgerSequence is this ledger
+        std::vector<std::shared_ptr<Emission const>> ready;
+        /// Emissions whose LastLedgerSequence has passed
+        std::vector<std::shared_ptr<Emission const>> expired;
+        /// The ids of the emissions indexed by this update
+        std::vector<uint256> added;
+    };
+
+    explicit EmittedTxnIndex(beast::Journal j);
+
+    /** Note an ltEMITTED_TXN added to the emitted directory of some view.
+
+        @param key The key of the ltEMITTED_TXN
+        @param txn The emitted transaction it holds
+    */
+    void
+    insert(uint256 const& key, std::shared_ptr<STTx const> const& txn);
+
+    /** Note an ltEMITTED_TXN removed from the emitted directory of some
+        view.
+    */
+    void
+    erase(uint256 const& key);
+
+    /** Bring the index in line with the emitted directory in a view and
+        return what the view's ledger has to do.
+
+        @param view The view to bring the index in line with
+        @param closed The closed ledger view is built on, if known
+    */
+    Due
+    update(ReadView const& view, ReadView const* closed);
+
+    /** The number of entries known, including those that did not parse. */
+    std::size_t
+    size() const;
+
+    /** The number of updates which read the whole directory. */
+    std::uint64_t
+    resyncs() const;
+
+private:
+    struct Entry
+    {
+        // unset for an entry that does not hold a valid emitted transaction
+        std::shared_ptr<Emission const> emission;
+        // the last full read of the directory which saw the entry
+        std::uint64_t seen = 0;
+    };
+
+    std::shared_ptr<Emission const>
+    parse(ReadView const& view, uint256 const& key) const;
+
+    // the emission of an entry known to be in view
+    std::shared_ptr<Emission const>
+    emission(ReadView const& view, uint256 const& key) const;
+
+    void
+    add(uint256 const& key,
+        std::shared_ptr<Emission const> emission,
+        Due& due);
+
+    void
+    remove(hash_map<uint256, Entry>::iterator it);
+
+    // read the whole directory
+    void
+    resync(ReadView const& view, Due& due);
+
+    // bring a single entry in line with view
+    void
+    check(ReadView const& view, uint256 const& key, Due& due);
+
+    beast::Journal const j_;
+
+    std::mutex mutable mutex_;
+    // by the key of the ltEMITTED_TXN
+    hash_map<uint256, Entry> entries_;
+    // keys by the ledgers the entries fall due in
+    std::multimap<LedgerIndex, uint256> byFirstLedger_;
+    std::multimap<LedgerIndex, uint256> byLastLedger_;
+
+    // the keys insert() and erase() were told of since the last update,
+    // with the emission if insert() was
+    hash_map<uint256, std::shared_ptr<Emission const>> notified_;
+    // the keys notified before the last update, which the view it was given
+    // may hold where the next closed ledger does not
+    hash_set<uint256> carried_;
+    // the closed ledger the last update was given
+    std::optional<uint256> synced_;
+
+    std::uint64_t generation_ = 0;
+    std::uint64_t resyncs_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <ripple/app/consensus/RCLConsensus.h>
 #include <ripple/app/consensus/RCLValidations.h>
+#include <ripple/app/hook/TraceSink.h>
 #include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
@@ -557,6 +558,13 @@ public:
     bool
     unsubConsensus(std::uint64_t uListener) override;
 
+    bool
+    subHookTraces(InfoSub::ref ispListener) override;
+    bool
+    unsubHookTraces(std::uint64_t uListener) override;
+    void
+    pubHookTrace(Json::Value const& jvObj) override;
+
     InfoSub::pointer
     findRpcSub(std::string const& strUrl) override;
     InfoSub::pointer
@@ -754,9 +762,10 @@ private:
         sPeerStatus,      // Peer status changes.
         sConsensusPhase,  // Consensus phase
         sBookChanges,     // Per-ledger order book changes
+        sHookTraces,      // Hook trace output
 
-        sLastEntry = sBookChanges  // as this name implies, any new entry
-                                   // must be ADDED ABOVE this one
+        sLastEntry = sHookTraces  // as this name implies, any new entry
+                                  // must be ADDED ABOVE this one
     };
     std::array<SubMapType, SubTypes::sLastEntry + 1> mStreamMaps;
 
@@ -2193,6 +2202,29 @@ NetworkOPsImp::pubConsensus(ConsensusPhase phase)
     }
 }
 
+void
+NetworkOPsImp::pubHookTrace(Json::Value const& jvObj)
+{
+    std::lock_guard sl(mSubLock);
+
+    auto& streamMap = mStreamMaps[sHookTraces];
+    for (auto i = streamMap.begin(); i != streamMap.end();)
+    {
+        if (auto p = i->second.lock())
+        {
+            p->send(jvObj, true);
+            ++i;
+        }
+        else
+        {
+            i = streamMap.erase(i);
+        }
+    }
+
+    if (streamMap.empty())
+        app_.getHookTraceSink().setStreaming(false);
+}
+
 void
 NetworkOPsImp::pubValidation(std::shared_ptr<STValidation> const& val)
 {
@@ -4237,6 +4269,29 @@ NetworkOPsImp::unsubConsensus(std::uint64_t uSeq)
     return mStreamMaps[sConsensusPhase].erase(uSeq);
 }
 
+// <-- bool: true=added, false=already there
+bool
+NetworkOPsImp::subHookTraces(InfoSub::ref isrListener)
+{
+    std::lock_guard sl(mSubLock);
+    app_.getHookTraceSink().setStreaming(true);
+    return mStreamMaps[sHookTraces]
+        .emplace(isrListener->getSeq(), isrListener)
+        .second;
+}
+
+// <-- bool: true=erased, false=was not there
+bool
+NetworkOPsImp::unsubHookTraces(std::uint64_t uSeq)
+{
+    std::lock_guard sl(mSubLock);
+    auto& streamMap = mStreamMaps[sHookTraces];
+    auto const erased = streamMap.erase(uSeq);
+    if (streamMap.empty())
+        app_.getHookTraceSink().setStreaming(false);
+    return erased;
+}
+
 InfoSub::pointer
 NetworkOPsImp::findRpcSub(std::string const& strUrl)
 {
@@ -20,6 +20,7 @@
 #ifndef RIPPLE_TXQ_H_INCLUDED
 #define RIPPLE_TXQ_H_INCLUDED
 
+#include <ripple/app/misc/EmittedTxnIndex.h>
 #include <ripple/app/tx/applySteps.h>
 #include <ripple/ledger/ApplyView.h>
 #include <ripple/ledger/OpenView.h>
@@ -371,6 +372,17 @@ public:
         Application& app,
         std::optional<XRPAmount> hookFeeUnits = std::nullopt) const;
 
+    /** The emitted transactions waiting in the emitted directory.
+
+        Emissions are noted here as they are added to and removed from
+        the directory, so that accept() need only look at those.
+    */
+    EmittedTxnIndex&
+    emittedTxns()
+    {
+        return emitted_;
+    }
+
 private:
     // Implementation for nextQueuableSeq().  The passed lock must be held.
     SeqProxy
@@ -797,6 +809,10 @@ private:
         locked mutex_
     */
     std::optional<size_t> maxSize_;
+    /** The emitted transactions waiting in the emitted directory.
+        Has its own lock.
+    */
+    EmittedTxnIndex emitted_;
 
 #if !NDEBUG
     /**
@@ -0,0 +1,340 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/misc/EmittedTxnIndex.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/safe_cast.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/st.h>
+
+namespace ripple {
+
+namespace {
+
+// the emission of a transaction, if it carries the fields every emitted
+// transaction must
+std::shared_ptr<EmittedTxnIndex::Emission const>
+makeEmission(
+    std::shared_ptr<STTx const> const& txn,
+    std::shared_ptr<Serializer const> blob)
+{
+    if (!txn->isFieldPresent(sfEmitDetails) ||
+        !txn->isFieldPresent(sfFirstLedgerSequence) ||
+        !txn->isFieldPresent(sfLastLedgerSequence))
+        return {};
+
+    return std::make_shared<EmittedTxnIndex::Emission const>(
+        EmittedTxnIndex::Emission{
+            txn->getTransactionID(),
+            txn->getFieldU32(sfFirstLedgerSequence),
+            txn->getFieldU32(sfLastLedgerSequence),
+            txn,
+            std::move(blob)});
+}
+
+void
+eraseKey(
+    std::multimap<LedgerIndex, uint256>& byLedger,
+    LedgerIndex ledger,
+    uint256 const& key)
+{
+    auto [it, end] = byLedger.equal_range(ledger);
+    for (; it != end; ++it)
+    {
+        if (it->second == key)
+        {
+            byLedger.erase(it);
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+EmittedTxnIndex::EmittedTxnIndex(beast::Journal j) : j_(j)
+{
+}
+
+void
+EmittedTxnIndex::insert(
+    uint256 const& key,
+    std::shared_ptr<STTx const> const& txn)
+{
+    auto blob = std::make_shared<Serializer>();
+    txn->add(*blob);
+
+    auto emission = makeEmission(txn, std::move(blob));
+
+    std::lock_guard lock(mutex_);
+    if (emission)
+        notified_[key] = std::move(emission);
+    else
+        notified_.try_emplace(key);
+}
+
+void
+EmittedTxnIndex::erase(uint256 const& key)
+{
+    std::lock_guard lock(mutex_);
+    notified_.try_emplace(key);
+}
+
+std::shared_ptr<EmittedTxnIndex::Emission const>
+EmittedTxnIndex::parse(ReadView const& view, uint256 const& key) const
+{
+    auto const sleItem = view.read(Keylet{ltCHILD, key});
+    if (!sleItem)
+        return {};
+
+    LedgerEntryType const nodeType{
+        safe_cast<LedgerEntryType>((*sleItem)[sfLedgerEntryType])};
+
+    if (nodeType != ltEMITTED_TXN)
+    {
+        JLOG(j_.warn()) << "EmittedTxn processing: emitted directory contained "
+                           "non ltEMITTED_TXN type";
+        return {};
+    }
+
+    try
+    {
+        auto const& emitted = const_cast<ripple::STLedgerEntry&>(*sleItem)
+                                  .getField(sfEmittedTxn)
+                                  .downcast<STObject>();
+
+        // the bytes in the ledger are the bytes that go into the open ledger
+        auto s = std::make_shared<Serializer>();
+        emitted.add(*s);
+        SerialIter sitTrans(s->slice());
+        auto emission = makeEmission(
+            std::make_shared<STTx const>(std::ref(sitTrans)), std::move(s));
+
+        if (!emission)
+            JLOG(j_.warn()) << "Hook: Emission failure: "
+                            << "sfEmitDetails or "
+                               "sfFirst/LastLedgerSeq missing.";
+
+        return emission;
+    }
+    catch (std::exception& e)
+    {
+        JLOG(j_.warn()) << "EmittedTxn Processing: Failure: " << e.what()
+                        << "\n";
+        return {};
+    }
+}
+
+std::shared_ptr<EmittedTxnIndex::Emission const>
+EmittedTxnIndex::emission(ReadView const& view, uint256 const& key) const
+{
+    // an emission insert() was told of is what the entry holds, as the key
+    // is the emitted transaction's
+    if (auto const it = notified_.find(key);
+        it != notified_.end() && it->second)
+        return it->second;
+
+    return parse(view, key);
+}
+
+void
+EmittedTxnIndex::add(
+    uint256 const& key,
+    std::shared_ptr<Emission const> emission,
+    Due& due)
+{
+    if (emission)
+    {
+        byFirstLedger_.emplace(emission->firstLedger, key);
+        byLastLedger_.emplace(emission->lastLedger, key);
+        due.added.push_back(emission->txnID);
+    }
+    entries_[key] = {std::move(emission), generation_};
+}
+
+void
+EmittedTxnIndex::remove(hash_map<uint256, Entry>::iterator it)
+{
+    if (auto const& emission = it->second.emission)
+    {
+        eraseKey(byFirstLedger_, emission->firstLedger, it->first);
+        eraseKey(byLastLedger_, emission->lastLedger, it->first);
+    }
+    entries_.erase(it);
+}
+
+void
+EmittedTxnIndex::resync(ReadView const& view, Due& due)
+{
+    ++resyncs_;
+    ++generation_;
+
+    // the directory's pages list every key, without reading the entries
+    Keylet const emittedDir{keylet::emittedDir()};
+    std::uint64_t page = 0;
+    do
+    {
+        auto const node = view.read(keylet::page(emittedDir, page));
+        if (!node)
+            break;
+
+        for (auto const& key : node->getFieldV256(sfIndexes))
+        {
+            auto it = entries_.find(key);
+            if (it == entries_.end())
+            {
+                if (!view.exists(Keylet{ltCHILD, key}))
+                {
+                    // Directory node has an invalid index. Leave it out of
+                    // the index.
+                    JLOG(j_.warn())
+                        << "EmittedTxn processing: directory node in ledger "
+                        << view.info().seq
+                        << " has index to object that is missing: "
+                        << to_string(key);
+                    continue;
+                }
+
+                add(key, emission(view, key), due);
+                it = entries_.find(key);
+            }
+
+            it->second.seen = generation_;
+        }
+
+        page = node->getFieldU64(sfIndexNext);
+    } while (page != 0);
+
+    // whatever the directory no longer holds has been applied, failed or
+    // was emitted into a ledger that never closed
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        auto next = std::next(it);
+        if (it->second.seen != generation_)
+            remove(it);
+        it = next;
+    }
+}
+
+void
+EmittedTxnIndex::check(ReadView const& view, uint256 const& key, Due& due)
+{
+    auto const it = entries_.find(key);
+    if (view.exists(Keylet{ltCHILD, key}))
+    {
+        if (it == entries_.end())
+            add(key, emission(view, key), due);
+    }
+    else if (it != entries_.end())
+    {
+        remove(it);
+    }
+}
+
+auto
+EmittedTxnIndex::update(ReadView const& view, ReadView const* closed) -> Due
+{
+    Due due;
+    auto const seq = view.info().seq;
+
+    std::lock_guard lock(mutex_);
+
+    // the entries which may differ between the view the last update was
+    // given and this one: those added to or removed from any view since,
+    // and those added to or removed from that last view, which the closed
+    // ledger need not have kept
+    hash_set<uint256> changed = std::move(carried_);
+    carried_.clear();
+    for (auto const& [key, _] : notified_)
+    {
+        changed.insert(key);
+        carried_.insert(key);
+    }
+
+    bool incremental = closed && synced_ &&
+        view.info().parentHash == closed->info().hash &&
+        (closed->info().hash == *synced_ ||
+         closed->info().parentHash == *synced_);
+
+    // and those the transactions of a new closed ledger created or deleted
+    if (incremental && closed->info().hash != *synced_)
+    {
+        for (auto const& [tx, meta] : closed->txs)
+        {
+            if (!meta)
+            {
+                incremental = false;
+                break;
+            }
+
+            for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+            {
+                if (node.getFieldU16(sfLedgerEntryType) == ltEMITTED_TXN &&
+                    node.getFName() != sfModifiedNode)
+                    changed.insert(node.getFieldH256(sfLedgerIndex));
+            }
+        }
+    }
+
+    if (incremental)
+    {
+        for (auto const& key : changed)
+            check(view, key, due);
+    }
+    else
+    {
+        resync(view, due);
+    }
+
+    notified_.clear();
+    if (closed)
+        synced_ = closed->info().hash;
+    else
+        synced_.reset();
+
+    for (auto it = byLastLedger_.begin();
+         it != byLastLedger_.end() && it->first < seq;
+         ++it)
+        due.expired.push_back(entries_.at(it->second).emission);
+
+    auto const [first, last] = byFirstLedger_.equal_range(seq);
+    for (auto it = first; it != last; ++it)
+    {
+        auto const& emission = entries_.at(it->second).emission;
+        if (emission->lastLedger >= seq)
+            due.ready.push_back(emission);
+    }
+
+    return due;
+}
+
+std::size_t
+EmittedTxnIndex::size() const
+{
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+std::uint64_t
+EmittedTxnIndex::resyncs() const
+{
+    std::lock_guard lock(mutex_);
+    return resyncs_;
+}
+
+}  // namespace ripple
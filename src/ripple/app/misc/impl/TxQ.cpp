@@ -17,6 +17,7 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/HashRouter.h>
@@ -370,7 +371,11 @@ TxQ::TxQAccount::remove(SeqProxy seqProx)
 //////////////////////////////////////////////////////////////////////////
 
 TxQ::TxQ(Setup const& setup, beast::Journal j)
-    : setup_(setup), j_(j), feeMetrics_(setup, j), maxSize_(std::nullopt)
+    : setup_(setup)
+    , j_(j)
+    , feeMetrics_(setup, j)
+    , maxSize_(std::nullopt)
+    , emitted_(j)
 {
 }
 
@@ -1479,154 +1484,55 @@ TxQ::accept(Application& app, OpenView& view)
 
     // Inject emitted transactions if any
     if (view.rules().enabled(featureHooks))
-        do
-        {
-            Keylet const emittedDirKeylet{keylet::emittedDir()};
-            if (dirIsEmpty(view, emittedDirKeylet))
-                break;
-
-            std::shared_ptr<SLE const> sleDirNode{};
-            unsigned int uDirEntry{0};
-            uint256 dirEntry{beast::zero};
-
-            if (!cdirFirst(
-                    view,
-                    emittedDirKeylet.key,
-                    sleDirNode,
-                    uDirEntry,
-                    dirEntry))
-                break;
-
-            do
-            {
-                Keylet const itemKeylet{ltCHILD, dirEntry};
-                auto sleItem = view.read(itemKeylet);
-                if (!sleItem)
-                {
-                    // Directory node has an invalid index.  Bail out.
-                    JLOG(j_.warn())
-                        << "EmittedTxn processing: directory node in ledger "
-                        << view.seq()
-                        << " has index to object that is missing: "
-                        << to_string(dirEntry);
-
-                    // RH TODO: if this ever happens the entry should be
-                    // gracefully removed (somehow)
-                    continue;
-                }
-
-                LedgerEntryType const nodeType{
-                    safe_cast<LedgerEntryType>((*sleItem)[sfLedgerEntryType])};
-
-                if (nodeType != ltEMITTED_TXN)
-                {
-                    JLOG(j_.warn())
-                        << "EmittedTxn processing: emitted directory contained "
-                           "non ltEMITTED_TXN type";
-                    // RH TODO: if this ever happens the entry should be
-                    // gracefully removed (somehow)
-                    continue;
-                }
-
-                JLOG(j_.info()) << "Processing emitted txn: " << *sleItem;
-
-                auto const& emitted =
-                    const_cast<ripple::STLedgerEntry&>(*sleItem)
-                        .getField(sfEmittedTxn)
-                        .downcast<STObject>();
-
-                auto s = std::make_shared<ripple::Serializer>();
-                emitted.add(*s);
-                SerialIter sitTrans(s->slice());  // do we need slice?
-                try
-                {
-                    auto const& stpTrans =
-                        std::make_shared<STTx const>(std::ref(sitTrans));
-
-                    if (!stpTrans->isFieldPresent(sfEmitDetails) ||
-                        !stpTrans->isFieldPresent(sfFirstLedgerSequence) ||
-                        !stpTrans->isFieldPresent(sfLastLedgerSequence))
-                    {
-                        JLOG(j_.warn()) << "Hook: Emission failure: "
-                                        << "sfEmitDetails or "
-                                           "sfFirst/LastLedgerSeq missing.";
-                        // RH TODO: if this ever happens the entry should be
-                        // gracefully removed (somehow)
-                        continue;
-                    }
-
-                    auto seq = view.info().seq;
-                    auto txnHash = stpTrans->getTransactionID();
+    {
+        auto const seq = view.info().seq;
+        auto const closed =
+            app.getLedgerMaster().getLedgerByHash(view.info().parentHash);
+        auto const due = emitted_.update(view, closed.get());
 
-                    app.getHashRouter().setFlags(txnHash, SF_EMITTED);
+        for (auto const& txnHash : due.added)
+            app.getHashRouter().setFlags(txnHash, SF_EMITTED);
 
-                    if (stpTrans->getFieldU32(sfLastLedgerSequence) < seq)
-                    {
-                        JLOG(j_.trace()) << "Hook: Emission failure, adding "
-                                            "cleanup pseudotxn to ledger "
-                                         << seq;
-
-                        auto const& emitDetails =
-                            const_cast<ripple::STTx&>(*stpTrans)
-                                .getField(sfEmitDetails)
-                                .downcast<STObject>();
-
-                        STTx efTx(
-                            ttEMIT_FAILURE,
-                            [seq, txnHash, emitDetails](auto& obj) {
-                                obj[sfLedgerSequence] = seq;
-                                obj[sfTransactionHash] = txnHash;
-                                obj.emplace_back(emitDetails);
-                                /*std::unique_ptr<STBase> ed =
-                                    std::make_unique<STBase>(emitDetails);
-                                ed->setFName(sfEmitDetails);
-                                obj.set(std::move(ed));*/
-                            });
-
-                        uint256 txID = efTx.getTransactionID();
-
-                        auto s = std::make_shared<ripple::Serializer>();
-                        efTx.add(*s);
-                        app.getHashRouter().setFlags(txID, SF_PRIVATE2);
-                        app.getHashRouter().setFlags(txID, SF_EMITTED);
-                        view.rawTxInsert(txID, std::move(s), nullptr);
-                        ledgerChanged = true;
-
-                        continue;
-                    }
-
-                    auto fls = stpTrans->getFieldU32(sfFirstLedgerSequence);
-                    if (fls > view.info().seq)
-                    {
-                        JLOG(j_.info())
-                            << "Holding TX " << stpTrans->getTransactionID()
-                            << " for future ledger.";
-                        continue;
-                    }
-
-                    // execution to here means we are adding the tx to the local
-                    // set
-                    if (fls >= view.info().seq)
-                    {
-                        app.getHashRouter().setFlags(txnHash, SF_PRIVATE2);
-                        view.rawTxInsert(
-                            stpTrans->getTransactionID(),
-                            std::move(s),
-                            nullptr);
-                        ledgerChanged = true;
-                    }
-                }
-                catch (std::exception& e)
-                {
-                    JLOG(j_.warn())
-                        << "EmittedTxn Processing: Failure: " << e.what()
-                        << "\n";
-                }
+        for (auto const& emission : due.expired)
+        {
+            JLOG(j_.trace()) << "Hook: Emission failure, adding "
+                                "cleanup pseudotxn to ledger "
+                             << seq;
+
+            auto const& emitDetails =
+                const_cast<ripple::STTx&>(*emission->txn)
+                    .getField(sfEmitDetails)
+                    .downcast<STObject>();
+
+            auto const& txnHash = emission->txnID;
+            app.getHashRouter().setFlags(txnHash, SF_EMITTED);
+            STTx efTx(ttEMIT_FAILURE, [seq, txnHash, emitDetails](auto& obj) {
+                obj[sfLedgerSequence] = seq;
+                obj[sfTransactionHash] = txnHash;
+                obj.emplace_back(emitDetails);
+            });
+
+            uint256 txID = efTx.getTransactionID();
+
+            auto s = std::make_shared<ripple::Serializer>();
+            efTx.add(*s);
+            app.getHashRouter().setFlags(txID, SF_PRIVATE2);
+            app.getHashRouter().setFlags(txID, SF_EMITTED);
+            view.rawTxInsert(txID, std::move(s), nullptr);
+            ledgerChanged = true;
+        }
 
-            } while (cdirNext(
-                view, emittedDirKeylet.key, sleDirNode, uDirEntry, dirEntry));
+        // emissions for a later ledger are held where they are
+        for (auto const& emission : due.ready)
+        {
+            JLOG(j_.info()) << "Processing emitted txn: " << emission->txnID;
 
-        } while (0);
+            app.getHashRouter().setFlags(emission->txnID, SF_EMITTED);
+            app.getHashRouter().setFlags(emission->txnID, SF_PRIVATE2);
+            view.rawTxInsert(emission->txnID, emission->blob, nullptr);
+            ledgerChanged = true;
+        }
+    }
 
     for (auto candidateIter = byFee_.begin(); candidateIter != byFee_.end();)
     {
@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_TX_SPECULATIVEAPPLY_H_INCLUDED
+#define RIPPLE_APP_TX_SPECULATIVEAPPLY_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/ledger/ApplyView.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/TER.h>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+
+/**
+    Applies a batch of transactions to a view one after another, as apply
+    would, having first applied those which run hooks in parallel, each
+    alone against a snapshot of the view.
+
+    Every speculative run records what it read from the snapshot: the keys
+    of the entries, the ranges it walked in key order and the transactions
+    it looked up. When the transaction's turn comes, its speculative result
+    is committed as-is if
+    - it was run with the flags it is now applied with,
+    - it lands at the index it was run for, and
+    - nothing applied since the snapshot wrote an entry it read or wrote,
+      or created or deleted an entry in a range it walked.
+    Otherwise the transaction is applied again. Either way the view ends up
+    exactly as applying the batch serially would leave it.
+
+    Speculative runs apply with tapDRY_RUN, so they leave nothing outside
+    their view. The emitted transaction bookkeeping finalizeHookResult
+    would have done is done when a result is committed, and the hook traces
+    of the run are published then. Speculative runs are not profiled.
+
+    Only views which record metadata, that is closed ones, are supported:
+    the metadata is what tells which entries a transaction wrote. Applying
+    to an open view just applies.
+*/
+class SpeculativeApply
+{
+public:
+    /** The most transactions run speculatively per batch. Each holds a
+        view of its own until its turn.
+    */
+    static constexpr std::size_t maxSpeculations = 256;
+
+    /** Run the transactions of a batch which would execute hooks.
+
+        Returns once every run is over.
+
+        @param view The view the batch will be applied to, before any of it
+        @param txs The batch, in the order it will be applied in
+        @param flags The flags the transactions will first be applied with
+    */
+    SpeculativeApply(
+        Application& app,
+        OpenView const& view,
+        std::vector<std::shared_ptr<STTx const>> const& txs,
+        ApplyFlags flags,
+        beast::Journal j);
+
+    ~SpeculativeApply();
+
+    SpeculativeApply(SpeculativeApply const&) = delete;
+    SpeculativeApply&
+    operator=(SpeculativeApply const&) = delete;
+
+    /** Apply a transaction to the view, as apply would.
+
+        Every change to the view from the snapshot on must be made through
+        here.
+    */
+    std::pair<TER, bool>
+    apply(OpenView& view, STTx const& tx, ApplyFlags flags);
+
+    /** Note that the transaction being applied on this thread read
+        something which is not in its view, such as the open ledger.
+
+        A speculative run which does so is applied again at its turn, as
+        what it read may have changed by then. Outside a speculative run
+        this does nothing.
+    */
+    static void
+    unrecorded();
+
+    /** The number of speculative results committed. */
+    std::size_t
+    committed() const
+    {
+        return committed_;
+    }
+
+    /** The number of speculative results dropped for applying again. */
+    std::size_t
+    reapplied() const
+    {
+        return reapplied_;
+    }
+
+private:
+    class Recorder;
+    struct Speculation;
+
+    Application& app_;
+    beast::Journal const j_;
+    OpenView const snapshot_;
+
+    hash_map<uint256, std::unique_ptr<Speculation>> speculations_;
+
+    // what was applied since the snapshot
+    hash_set<uint256> written_;
+    std::set<uint256> structural_;  // entries created or deleted
+    hash_set<uint256> appliedTxs_;
+    // an applied transaction's writes are not known
+    bool blind_ = false;
+
+    std::size_t committed_ = 0;
+    std::size_t reapplied_ = 0;
+
+    void
+    run(Speculation& s, STTx const& tx);
+
+    bool
+    valid(Speculation const& s, OpenView const& view, ApplyFlags flags) const;
+
+    // note what the transaction applied to view wrote
+    void
+    applied(OpenView const& view, uint256 const& txID);
+
+    // what finalizeHookResult leaves outside the view for a committed
+    // transaction's emissions
+    void
+    emitted(OpenView const& view, uint256 const& txID);
+};
+
+}  // namespace ripple
+
+#endif
@@ -31,6 +31,7 @@
 namespace ripple {
 
 class Application;
+class SpeculativeApply;
 class HashRouter;
 
 /** Describes the pre-processing validity of a transaction.
@@ -146,6 +147,9 @@ enum class ApplyResult {
     Provides more detailed logging and decodes the
     correct behavior based on the `TER` type
 
+    @param speculation If set, applies the transaction through it, so a
+        speculative result for it may be committed.
+
     @see ApplyResult
 */
 ApplyResult
@@ -155,7 +159,8 @@ applyTransaction(
     STTx const& tx,
     bool retryAssured,
     ApplyFlags flags,
-    beast::Journal journal);
+    beast::Journal journal,
+    SpeculativeApply* speculation = nullptr);
 
 }  // namespace ripple
 
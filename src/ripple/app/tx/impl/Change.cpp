@@ -23,6 +23,7 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/TxQ.h>
 #include <ripple/app/tx/impl/Change.h>
 #include <ripple/app/tx/impl/SetSignerList.h>
 #include <ripple/app/tx/impl/XahauGenesis.h>
@@ -1049,6 +1050,7 @@ Change::applyEmitFailure()
         }
 
         view().erase(sle);
+        ctx_.app.getTxQ().emittedTxns().erase(key.key);
     } while (0);
     return tesSUCCESS;
 }
@@ -17,11 +17,13 @@
 */
 //==============================================================================
 
+#include <ripple/app/main/Application.h>
 #include <ripple/app/misc/Manifest.h>
 #include <ripple/app/tx/impl/Import.h>
 #include <ripple/app/tx/impl/SetSignerList.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/base64.h>
+#include <ripple/core/VerifyPool.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/json_value.h>
 #include <ripple/json/to_string.h>
@@ -30,6 +32,7 @@
 #include <ripple/protocol/Import.h>
 #include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/STBlob.h>
 #include <ripple/protocol/STTx.h>
 #include <ripple/protocol/STValidation.h>
 #include <ripple/protocol/st.h>
@@ -40,11 +43,488 @@
 
 namespace ripple {
 
+namespace {
+
+// the key of an Import's XPOP in the verified XPOP cache
+uint256
+xpopKey(STTx const& tx)
+{
+    return sha512Half(
+        static_cast<STBlob const&>(tx.peekAtField(sfBlob)).value());
+}
+
+// the XPOP of an Import as preflight verified it, if it is still cached
+std::shared_ptr<VerifiedXPOP const>
+findVerified(Application& app, STTx const& tx)
+{
+    if (!tx.isFieldPresent(sfBlob))
+        return {};
+
+    return app.getVerifiedXPOPs().fetch(xpopKey(tx));
+}
+
+std::shared_ptr<XPOPFields const>
+parseXPOP(STTx const& tx, beast::Journal const& j)
+{
+    auto xpop = readXPOP(tx.getFieldVL(sfBlob), j);
+    if (!xpop)
+        return {};
+
+    return std::make_shared<XPOPFields const>(std::move(*xpop));
+}
+
+// the checks on the inner txn which depend on the outer txn or on the network
+// this server is on
+NotTEC
+checkInnerTxn(PreflightContext const& ctx, STTx const& stpTrans)
+{
+    auto const& tx = ctx.tx;
+
+    // check if the account matches the account in the xpop, if not bail early
+    if (stpTrans.getAccountID(sfAccount) != tx.getAccountID(sfAccount))
+    {
+        JLOG(ctx.j.warn()) << "Import: import and txn inside xpop must be "
+                              "signed by the same account "
+                           << tx.getTransactionID();
+        return temMALFORMED;
+    }
+
+    if (stpTrans.getFieldU32(sfOperationLimit) != ctx.app.config().NETWORK_ID)
+    {
+        JLOG(ctx.j.warn()) << "Import: Wrong network ID for OperationLimit in "
+                              "inner txn. outer txid: "
+                           << tx.getTransactionID();
+        return telWRONG_NETWORK;
+    }
+
+    // check if the inner transaction is signed using the same keying as the
+    // outer txn
+    auto outer = tx.getSigningPubKey();
+    auto inner = stpTrans.getSigningPubKey();
+
+    if (outer.empty() && inner.empty())
+    {
+        // check signer list
+        bool const outerHasSigners = tx.isFieldPresent(sfSigners);
+        bool const innerHasSigners = stpTrans.isFieldPresent(sfSigners);
+
+        if (outerHasSigners && innerHasSigners)
+        {
+            auto const& outerSigners = tx.getFieldArray(sfSigners);
+            auto const& innerSigners = stpTrans.getFieldArray(sfSigners);
+
+            bool ok = outerSigners.size() == innerSigners.size() &&
+                innerSigners.size() > 1;
+            for (uint64_t i = 0; ok && i < outerSigners.size(); ++i)
+            {
+                if (outerSigners[i].getAccountID(sfAccount) !=
+                        innerSigners[i].getAccountID(sfAccount) ||
+                    outerSigners[i].getFieldVL(sfSigningPubKey) !=
+                        innerSigners[i].getFieldVL(sfSigningPubKey))
+                    ok = false;
+            }
+
+            if (!ok)
+            {
+                JLOG(ctx.j.warn()) << "Import: outer and inner txns were "
+                                      "(multi) signed with different keys. "
+                                   << tx.getTransactionID();
+                return temMALFORMED;
+            }
+        }
+        else
+        {
+            JLOG(ctx.j.warn())
+                << "Import: outer or inner txn was missing signers. "
+                << tx.getTransactionID();
+            return temMALFORMED;
+        }
+    }
+    else if (outer != inner)
+    {
+        JLOG(ctx.j.warn()) << "Import: outer and inner txns were signed "
+                              "with different keys. "
+                           << tx.getTransactionID();
+        return temMALFORMED;
+    }
+
+    return tesSUCCESS;
+}
+
+NotTEC
+checkUNLValidity(
+    PreflightContext const& ctx,
+    TimeKeeper::time_point validFrom,
+    TimeKeeper::time_point validUntil)
+{
+    auto const now = ctx.app.timeKeeper().now();
+    if (validUntil <= validFrom)
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob validUntil <= validFrom "
+                           << ctx.tx.getTransactionID();
+        return temMALFORMED;
+    }
+
+    if (validUntil <= now)
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob expired "
+                           << ctx.tx.getTransactionID();
+        return temMALFORMED;
+    }
+
+    if (validFrom > now)
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob not yet valid "
+                           << ctx.tx.getTransactionID();
+        return temMALFORMED;
+    }
+
+    return tesSUCCESS;
+}
+
+NotTEC
+checkQuorum(
+    PreflightContext const& ctx,
+    uint64_t quorum,
+    uint64_t validationCount)
+{
+    // check if the validation count is adequate
+    bool const hasInsufficientQuorum = ctx.rules.enabled(fixXahauV1)
+        ? quorum > validationCount
+        : quorum >= validationCount;
+
+    if (hasInsufficientQuorum)
+    {
+        JLOG(ctx.j.warn()) << "Import: xpop did not contain an 80% quorum for "
+                              "the txn it purports to prove. "
+                           << ctx.tx.getTransactionID();
+        return temMALFORMED;
+    }
+
+    return tesSUCCESS;
+}
+
+// The UNL section of an XPOP. Most XPOPs carry one of a few UNL blobs, so the
+// publisher manifest, the blob and the validator manifests in it are checked
+// once and shared by every XPOP which carries them. Null if the section is not
+// valid.
+std::shared_ptr<VerifiedUNL const>
+verifyUNL(
+    PreflightContext const& ctx,
+    XPOPFields const& xpop,
+    PublicKey const& masterVLKey)
+{
+    auto const& tx = ctx.tx;
+    auto& cache = ctx.app.getVerifiedUNLs();
+
+    // the blob is part of the key: a signature checked against one blob says
+    // nothing about another
+    auto const key =
+        sha512Half(xpop.unlManifest, xpop.unlBlob, xpop.unlSignature);
+    if (auto const verified = cache.fetch(key))
+    {
+        if (verified->masterKey != masterVLKey)
+        {
+            JLOG(ctx.j.warn()) << "Import: manifest master key did not match "
+                                  "top level master key in unl section of xpop "
+                               << tx.getTransactionID();
+            return {};
+        }
+
+        if (!isTesSuccess(checkUNLValidity(
+                ctx, verified->validFrom, verified->validUntil)))
+        {
+            // an expired list will not be valid again
+            if (verified->validUntil <= ctx.app.timeKeeper().now())
+                cache.del(key, false);
+            return {};
+        }
+
+        return verified;
+    }
+
+    // check it was used to sign over the manifest
+    auto const m = deserializeManifest(xpop.unlManifest);
+
+    if (!m)
+    {
+        JLOG(ctx.j.warn()) << "Import: failed to deserialize manifest on txid "
+                           << tx.getTransactionID();
+        return {};
+    }
+
+    // we will check the master key matches a known one in preclaim, because the
+    // import vl key might be from the on-ledger object
+    if (m->masterKey != masterVLKey)
+    {
+        JLOG(ctx.j.warn()) << "Import: manifest master key did not match top "
+                              "level master key in unl section of xpop "
+                           << tx.getTransactionID();
+        return {};
+    }
+
+    if (!m->verify())
+    {
+        JLOG(ctx.j.warn()) << "Import: manifest signature invalid "
+                           << tx.getTransactionID();
+        return {};
+    }
+
+    // manifest signing (ephemeral) key
+    auto const signingKey = m->signingKey;
+
+    auto const& data = xpop.unlBlob;
+
+    Json::Reader r;
+    Json::Value list;
+    if (!r.parse(data, list))
+    {
+        JLOG(ctx.j.warn())
+            << "Import: unl blob was not valid json (after base64 decoding) "
+            << tx.getTransactionID();
+        return {};
+    }
+
+    if (!list.isMember(jss::sequence) || !list[jss::sequence].isInt())
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
+                              "lacked required field (sequence) and/or types "
+                           << tx.getTransactionID();
+        return {};
+    }
+    if (!list.isMember(jss::expiration) || !list[jss::expiration].isInt())
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
+                              "lacked required field (expiration) and/or types "
+                           << tx.getTransactionID();
+        return {};
+    }
+    if (list.isMember(jss::effective) && !list[jss::effective].isInt())
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
+                              "lacked required field (effective) and/or types "
+                           << tx.getTransactionID();
+        return {};
+    }
+    if (!list.isMember(jss::validators) || !list[jss::validators].isArray())
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
+                              "lacked required field (validators) and/or types "
+                           << tx.getTransactionID();
+        return {};
+    }
+
+    auto const validFrom = TimeKeeper::time_point{TimeKeeper::duration{
+        list.isMember(jss::effective) ? list[jss::effective].asUInt() : 0}};
+    auto const validUntil = TimeKeeper::time_point{
+        TimeKeeper::duration{list[jss::expiration].asUInt()}};
+    if (!isTesSuccess(checkUNLValidity(ctx, validFrom, validUntil)))
+        return {};
+
+    if (!ripple::verify(
+            signingKey, makeSlice(data), makeSlice(xpop.unlSignature)))
+    {
+        JLOG(ctx.j.warn()) << "Import: unl blob not signed correctly "
+                           << tx.getTransactionID();
+        return {};
+    }
+
+    auto verified = std::make_shared<VerifiedUNL>(
+        VerifiedUNL{m->masterKey, validFrom, validUntil});
+
+    // parse the validator list
+    for (auto const& val : list[jss::validators])
+    {
+        verified->validatorCount++;
+
+        if (!val.isObject() || !val.isMember(jss::validation_public_key) ||
+            !val[jss::validation_public_key].isString() ||
+            !val.isMember(jss::manifest) || !val[jss::manifest].isString())
+        {
+            JLOG(ctx.j.warn()) << "Import: unl blob contained invalid "
+                                  "validator entry, skipping "
+                               << tx.getTransactionID();
+            continue;
+        }
+
+        std::optional<Blob> const ret =
+            strUnHex(val[jss::validation_public_key].asString());
+
+        if (!ret || !publicKeyType(makeSlice(*ret)))
+        {
+            JLOG(ctx.j.warn()) << "Import: unl blob contained an invalid "
+                                  "validator key, skipping "
+                               << val[jss::validation_public_key].asString()
+                               << " " << tx.getTransactionID();
+            continue;
+        }
+
+        auto const m =
+            deserializeManifest(base64_decode(val[jss::manifest].asString()));
+
+        if (!m)
+        {
+            JLOG(ctx.j.warn())
+                << "Import: unl blob contained an invalid manifest, skipping "
+                << tx.getTransactionID();
+            continue;
+        }
+
+        if (strHex(m->masterKey) != val[jss::validation_public_key])
+        {
+            JLOG(ctx.j.warn()) << "Import: unl blob list entry manifest master "
+                                  "key did not match master key, skipping "
+                               << tx.getTransactionID();
+            continue;
+        }
+
+        if (!m->verify())
+        {
+            JLOG(ctx.j.warn()) << "Import: unl blob list entry manifest "
+                                  "signature invalid, skipping "
+                               << tx.getTransactionID();
+            continue;
+        }
+
+        std::string const nodepub =
+            toBase58(TokenType::NodePublic, m->signingKey);
+        std::string const nodemaster =
+            toBase58(TokenType::NodePublic, m->masterKey);
+        verified->validators[nodepub] = strHex(m->signingKey);
+        verified->validatorsMaster[nodemaster] = nodepub;
+    }
+
+    std::shared_ptr<VerifiedUNL const> result = std::move(verified);
+    cache.canonicalize_replace_client(key, result);
+    return result;
+}
+
+}  // namespace
+
+std::uint64_t
+countXPOPValidations(
+    std::vector<std::pair<std::string, Blob>> const& data,
+    VerifiedUNL const& unl,
+    uint256 const& ledgerHash,
+    VerifyPool& pool,
+    beast::Journal const& j,
+    uint256 const& txID)
+{
+    // the validations left once everything but the signature checks out,
+    // with the nodepub they are listed against
+    std::vector<std::pair<std::string, std::unique_ptr<STValidation>>>
+        candidates;
+
+    std::set<std::string> used_key;
+    for (auto const& [key, valBlob] : data)
+    {
+        auto nodepub = key;
+
+        // if the specified node address (nodepub) is in the master address
+        // => regular address list then make a note and replace it with the
+        // regular address
+        auto regular = unl.validatorsMaster.find(nodepub);
+        if (regular != unl.validatorsMaster.end() &&
+            unl.validators.find(regular->second) != unl.validators.end())
+        {
+            used_key.emplace(nodepub);
+            nodepub = regular->second;
+        }
+
+        auto const signingKey = unl.validators.find(nodepub);
+        if (signingKey == unl.validators.end())
+        {
+            JLOG(j.trace()) << "Import: validator nodepub " << nodepub
+                            << " did not appear in validator list but "
+                               "did appear in data section "
+                            << txID;
+            continue;
+        }
+
+        if (used_key.find(nodepub) != used_key.end())
+        {
+            JLOG(j.trace()) << "Import: validator nodepub " << nodepub
+                            << " key appears more than once in data section "
+                            << txID;
+            continue;
+        }
+
+        used_key.emplace(nodepub);
+
+        // process the validation message
+        try
+        {
+            std::unique_ptr<STValidation> val;
+            SerialIter sit(makeSlice(valBlob));
+            val = std::make_unique<STValidation>(
+                std::ref(sit),
+                [](PublicKey const& pk) { return calcNodeID(pk); },
+                false);
+
+            if (val->getLedgerHash() != ledgerHash)
+            {
+                JLOG(j.warn()) << "Import: validation message was not "
+                                  "for computed ledger hash "
+                               << ledgerHash << " it was for "
+                               << val->getLedgerHash();
+                continue;
+            }
+
+            if (!(strHex(val->getSignerPublic()) == signingKey->second))
+            {
+                JLOG(j.warn())
+                    << "Import: validation inside xpop was not signed with "
+                       "a signing key we recognise "
+                    << "despite being listed against a nodepub we "
+                       "recognise. "
+                    << "nodepub: " << nodepub << ". txid: " << txID;
+                continue;
+            }
+
+            candidates.emplace_back(nodepub, std::move(val));
+        }
+        catch (...)
+        {
+            JLOG(j.warn()) << "Import: validation inside xpop was not "
+                              "able to be parsed "
+                           << "nodepub: " << nodepub << " txid: " << txID;
+            continue;
+        }
+    }
+
+    // signature checks are expensive hence done after checking everything
+    // else, and together; each writes only its own flag
+    std::vector<std::uint8_t> valid(candidates.size(), 0);
+    pool.forEach(candidates.size(), [&](std::size_t i) {
+        valid[i] = candidates[i].second->isValid();
+    });
+
+    std::uint64_t validationCount = 0;
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (!valid[i])
+        {
+            JLOG(j.warn()) << "Import: validation inside xpop was "
+                              "not correctly signed "
+                           << "nodepub: " << candidates[i].first
+                           << " txid: " << txID;
+            continue;
+        }
+
+        validationCount++;
+    }
+
+    return validationCount;
+}
+
 TxConsequences
 Import::makeTxConsequences(PreflightContext const& ctx)
 {
     auto calculate = [](PreflightContext const& ctx) -> XRPAmount {
-        auto const [inner, meta] = getInnerTxn(ctx.tx, ctx.j);
+        auto const verified = findVerified(ctx.app, ctx.tx);
+        auto const [inner, meta] = verified
+            ? std::make_pair(verified->txn, verified->meta)
+            : getInnerTxn(ctx.tx, ctx.j);
         if (!inner || !inner->isFieldPresent(sfFee))
             return beast::zero;
 
@@ -67,53 +547,36 @@ Import::makeTxConsequences(PreflightContext const& ctx)
 }
 
 std::pair<
-    std::unique_ptr<STTx const>,      // txn
-    std::unique_ptr<STObject const>>  // meta
+    std::shared_ptr<STTx const>,      // txn
+    std::shared_ptr<STObject const>>  // meta
 Import::getInnerTxn(
     STTx const& outer,
     beast::Journal const& j,
-    Json::Value const* xpop)
+    XPOPFields const* xpop)
 {
-    // parse blob as json
-
-    std::optional<Json::Value> xpop_storage;
+    std::optional<XPOPFields> xpop_storage;
 
     if (!xpop && outer.isFieldPresent(sfBlob))
     {
-        xpop_storage = syntaxCheckXPOP(outer.getFieldVL(sfBlob), j);
-        xpop = &(*xpop_storage);
-    }
-
-    if (!xpop)
-        return {};
-
-    // extract the transaction for which this xpop is a proof
-    auto rawTx = strUnHex((*xpop)[jss::transaction][jss::blob].asString());
-    auto meta = strUnHex((*xpop)[jss::transaction][jss::meta].asString());
-
-    if (!rawTx)
-    {
-        JLOG(j.warn()) << "Import: failed to deserialize tx blob inside xpop "
-                          "(invalid hex) "
-                       << outer.getTransactionID();
-        return {};
+        xpop_storage = readXPOP(outer.getFieldVL(sfBlob), j);
+        if (xpop_storage)
+            xpop = &(*xpop_storage);
     }
 
-    if (!meta)
-    {
-        JLOG(j.warn()) << "Import: failed to deserialize tx meta inside xpop "
-                          "(invalid hex) "
-                       << outer.getTransactionID();
+    if (!xpop)
         return {};
-    }
+
+    // the transaction for which this xpop is a proof
+    auto const& rawTx = xpop->txn;
+    auto const& meta = xpop->meta;
 
     try
     {
         return {
-            std::make_unique<STTx const>(
-                SerialIter{rawTx->data(), rawTx->size()}),
-            std::make_unique<STObject const>(
-                SerialIter(meta->data(), meta->size()), sfMetadata)};
+            std::make_shared<STTx const>(
+                SerialIter{rawTx.data(), rawTx.size()}),
+            std::make_shared<STObject const>(
+                SerialIter(meta.data(), meta.size()), sfMetadata)};
     }
     catch (std::exception& e)
     {
@@ -161,8 +624,33 @@ Import::preflight(PreflightContext const& ctx)
         return temMALFORMED;
     }
 
-    // parse blob as json
-    auto const xpop = syntaxCheckXPOP(tx.getFieldVL(sfBlob), ctx.j);
+    if (!ctx.rules.enabled(featureBinaryXPOP) && isBinaryXPOP(tx[sfBlob]))
+        return temDISABLED;
+
+    // a blob which passed before only needs the checks that do not depend
+    // on it alone
+    auto const key = xpopKey(tx);
+    if (auto const verified = ctx.app.getVerifiedXPOPs().fetch(key))
+    {
+        if (auto const ret = checkInnerTxn(ctx, *verified->txn);
+            !isTesSuccess(ret))
+            return ret;
+
+        if (auto const ret = checkUNLValidity(
+                ctx, verified->validFrom, verified->validUntil);
+            !isTesSuccess(ret))
+            return ret;
+
+        if (auto const ret =
+                checkQuorum(ctx, verified->quorum, verified->validationCount);
+            !isTesSuccess(ret))
+            return ret;
+
+        return preflight2(ctx);
+    }
+
+    // read the blob, in whichever form it is
+    auto const xpop = parseXPOP(tx, ctx.j);
 
     if (!xpop)
         return temMALFORMED;
@@ -171,9 +659,7 @@ Import::preflight(PreflightContext const& ctx)
     // from on-ledger object
     std::optional<PublicKey> masterVLKey;
     {
-        std::string strPk =
-            (*xpop)[jss::validation][jss::unl][jss::public_key].asString();
-        auto pkHex = strUnHex(strPk);
+        auto pkHex = strUnHex(xpop->unlPublicKey);
         if (!pkHex)
         {
             JLOG(ctx.j.warn())
@@ -241,15 +727,6 @@ Import::preflight(PreflightContext const& ctx)
         }
     }
 
-    // check if the account matches the account in the xpop, if not bail early
-    if (stpTrans->getAccountID(sfAccount) != tx.getAccountID(sfAccount))
-    {
-        JLOG(ctx.j.warn()) << "Import: import and txn inside xpop must be "
-                              "signed by the same account "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
     // ensure inner txn is for networkid = 0 (network id must therefore be
     // missing)
     if (stpTrans->isFieldPresent(sfNetworkID))
@@ -270,66 +747,8 @@ Import::preflight(PreflightContext const& ctx)
         return temMALFORMED;
     }
 
-    if (stpTrans->getFieldU32(sfOperationLimit) != ctx.app.config().NETWORK_ID)
-    {
-        JLOG(ctx.j.warn()) << "Import: Wrong network ID for OperationLimit in "
-                              "inner txn. outer txid: "
-                           << tx.getTransactionID();
-        return telWRONG_NETWORK;
-    }
-
-    // check if the inner transaction is signed using the same keying as the
-    // outer txn
-    {
-        auto outer = tx.getSigningPubKey();
-        auto inner = stpTrans->getSigningPubKey();
-
-        if (outer.empty() && inner.empty())
-        {
-            // check signer list
-            bool const outerHasSigners = tx.isFieldPresent(sfSigners);
-            bool const innerHasSigners = stpTrans->isFieldPresent(sfSigners);
-
-            if (outerHasSigners && innerHasSigners)
-            {
-                auto const& outerSigners = tx.getFieldArray(sfSigners);
-                auto const& innerSigners = stpTrans->getFieldArray(sfSigners);
-
-                bool ok = outerSigners.size() == innerSigners.size() &&
-                    innerSigners.size() > 1;
-                for (uint64_t i = 0; ok && i < outerSigners.size(); ++i)
-                {
-                    if (outerSigners[i].getAccountID(sfAccount) !=
-                            innerSigners[i].getAccountID(sfAccount) ||
-                        outerSigners[i].getFieldVL(sfSigningPubKey) !=
-                            innerSigners[i].getFieldVL(sfSigningPubKey))
-                        ok = false;
-                }
-
-                if (!ok)
-                {
-                    JLOG(ctx.j.warn()) << "Import: outer and inner txns were "
-                                          "(multi) signed with different keys. "
-                                       << tx.getTransactionID();
-                    return temMALFORMED;
-                }
-            }
-            else
-            {
-                JLOG(ctx.j.warn())
-                    << "Import: outer or inner txn was missing signers. "
-                    << tx.getTransactionID();
-                return temMALFORMED;
-            }
-        }
-        else if (outer != inner)
-        {
-            JLOG(ctx.j.warn()) << "Import: outer and inner txns were signed "
-                                  "with different keys. "
-                               << tx.getTransactionID();
-            return temMALFORMED;
-        }
-    }
+    if (auto const ret = checkInnerTxn(ctx, *stpTrans); !isTesSuccess(ret))
+        return ret;
 
     // check inner txns signature
     // we do this with a custom ruleset which should be kept up to date with
@@ -353,114 +772,9 @@ Import::preflight(PreflightContext const& ctx)
     // XPOP verify
     //
 
-    // check it was used to sign over the manifest
-    auto const m = deserializeManifest(base64_decode(
-        (*xpop)[jss::validation][jss::unl][jss::manifest].asString()));
-
-    if (!m)
-    {
-        JLOG(ctx.j.warn()) << "Import: failed to deserialize manifest on txid "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    // we will check the master key matches a known one in preclaim, because the
-    // import vl key might be from the on-ledger object
-    if (m->masterKey != masterVLKey)
-    {
-        JLOG(ctx.j.warn()) << "Import: manifest master key did not match top "
-                              "level master key in unl section of xpop "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    if (!m->verify())
-    {
-        JLOG(ctx.j.warn()) << "Import: manifest signature invalid "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    // manifest signing (ephemeral) key
-    auto const signingKey = m->signingKey;
-
-    // decode blob
-    auto const data =
-        base64_decode((*xpop)[jss::validation][jss::unl][jss::blob].asString());
-
-    Json::Reader r;
-    Json::Value list;
-    if (!r.parse(data, list))
-    {
-        JLOG(ctx.j.warn())
-            << "Import: unl blob was not valid json (after base64 decoding) "
-            << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    if (!list.isMember(jss::sequence) || !list[jss::sequence].isInt())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (sequence) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-    if (!list.isMember(jss::expiration) || !list[jss::expiration].isInt())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (expiration) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-    if (list.isMember(jss::effective) && !list[jss::effective].isInt())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (effective) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-    if (!list.isMember(jss::validators) || !list[jss::validators].isArray())
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob json (after base64 decoding) "
-                              "lacked required field (validators) and/or types "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    auto const validFrom = TimeKeeper::time_point{TimeKeeper::duration{
-        list.isMember(jss::effective) ? list[jss::effective].asUInt() : 0}};
-    auto const validUntil = TimeKeeper::time_point{
-        TimeKeeper::duration{list[jss::expiration].asUInt()}};
-    auto const now = ctx.app.timeKeeper().now();
-    if (validUntil <= validFrom)
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob validUntil <= validFrom "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    if (validUntil <= now)
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob expired "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    if (validFrom > now)
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob not yet valid "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
-    auto const sig =
-        strUnHex((*xpop)[jss::validation][jss::unl][jss::signature].asString());
-    if (!sig || !ripple::verify(signingKey, makeSlice(data), makeSlice(*sig)))
-    {
-        JLOG(ctx.j.warn()) << "Import: unl blob not signed correctly "
-                           << tx.getTransactionID();
+    auto const unl = verifyUNL(ctx, *xpop, *masterVLKey);
+    if (!unl)
         return temMALFORMED;
-    }
 
     auto const tx_hash =
         stpTrans->getTransactionID();  // sha512Half(HashPrefix::transactionID,
@@ -468,55 +782,21 @@ Import::preflight(PreflightContext const& ctx)
 
     JLOG(ctx.j.trace()) << "tx_hash (computed): " << tx_hash;
 
-    auto rawTx = strUnHex((*xpop)[jss::transaction][jss::blob].asString());
-    auto const tx_meta =
-        strUnHex((*xpop)[jss::transaction][jss::meta].asString());
-    Serializer s(rawTx->size() + tx_meta->size() + 40);
-    s.addVL(*rawTx);
-    s.addVL(*tx_meta);
+    auto const& rawTx = xpop->txn;
+    auto const& tx_meta = xpop->meta;
+    Serializer s(rawTx.size() + tx_meta.size() + 40);
+    s.addVL(rawTx);
+    s.addVL(tx_meta);
     s.addBitString(tx_hash);
 
     uint256 const computed_tx_hash_and_meta =
         sha512Half(HashPrefix::txNode, s.slice());
 
     // check if the proof is inside the proof tree/list
-    if (!([](Json::Value const& proof, std::string hash) -> bool {
-            auto const proofContains = [](Json::Value const* proof,
-                                          std::string hash,
-                                          int depth = 0,
-                                          auto proofContains =
-                                              nullptr) -> bool {
-                if (depth > 32)
-                    return false;
-
-                if (!proof->isObject() && !proof->isArray())
-                    return false;
-
-                if (proof->isMember(jss::children))
-                    proof = &((*proof)[jss::children]);
-
-                for (int x = 0; x < 16; ++x)
-                {
-                    Json::Value const* entry = proof->isObject()
-                        ? &((*proof)[std::string(1, "0123456789ABCDEF"[x])])
-                        : &((*proof)[x]);
-
-                    if (entry->isNull())
-                        continue;
-
-                    if ((entry->isString() && entry->asString() == hash) ||
-                        (entry->isObject() && entry->isMember(jss::hash) &&
-                         (*entry)[jss::hash] == hash) ||
-                        proofContains(entry, hash, depth + 1, proofContains))
-                        return true;
-                }
-
-                return false;
-            };
-
-            return proofContains(&proof, hash, 0, proofContains);
-        })((*xpop)[jss::transaction][jss::proof],
-           strHex(computed_tx_hash_and_meta)))
+    if (std::find(
+            xpop->proofHashes.begin(),
+            xpop->proofHashes.end(),
+            computed_tx_hash_and_meta) == xpop->proofHashes.end())
     {
         JLOG(ctx.j.warn())
             << "Import: xpop proof did not contain the specified txn hash "
@@ -525,71 +805,11 @@ Import::preflight(PreflightContext const& ctx)
         return temMALFORMED;
     }
 
-    // compute the merkel root over the proof
-    uint256 const computedTxRoot = ([](Json::Value const& proof) -> uint256 {
-        auto hashProof = [](Json::Value const& proof,
-                            int depth = 0,
-                            auto const& hashProof = nullptr) -> uint256 {
-            const uint256 nullhash;
-
-            if (depth > 32)
-                return nullhash;
-
-            if (!proof.isObject() && !proof.isArray())
-                return nullhash;
-
-            sha512_half_hasher h;
-            using beast::hash_append;
-            hash_append(h, ripple::HashPrefix::innerNode);
-
-            if (proof.isArray())
-            {
-                for (const auto& entry : proof)
-                {
-                    if (entry.isString())
-                    {
-                        uint256 hash;
-                        if (hash.parseHex(entry.asString()))
-                            hash_append(h, hash);
-                    }
-                    else
-                        hash_append(h, hashProof(entry, depth + 1, hashProof));
-                }
-            }
-            else if (proof.isObject())
-            {
-                for (int x = 0; x < 16; ++x)
-                {
-                    // Duplicate / Sanity
-                    std::string const nibble(1, "0123456789ABCDEF"[x]);
-                    if (!proof[jss::children].isMember(nibble))
-                        hash_append(h, nullhash);
-                    else if (
-                        proof[jss::children][nibble][jss::children].size() ==
-                        0u)
-                    {
-                        uint256 hash;
-                        if (hash.parseHex(
-                                proof[jss::children][nibble][jss::hash]
-                                    .asString()))
-                            hash_append(h, hash);
-                    }
-                    else
-                        hash_append(
-                            h,
-                            hashProof(
-                                proof[jss::children][nibble],
-                                depth + 1,
-                                hashProof));
-                }
-            }
-            return static_cast<uint256>(h);
-        };
-        return hashProof(proof, 0, hashProof);
-    })((*xpop)[jss::transaction][jss::proof]);
+    // the merkel root over the proof
+    uint256 const computedTxRoot = xpop->proofRoot;
 
-    auto const& lgr = (*xpop)[jss::ledger];
-    if (strHex(computedTxRoot) != lgr[jss::txroot])
+    auto const& lgr = xpop->ledger;
+    if (computedTxRoot != lgr.txroot)
     {
         JLOG(ctx.j.warn()) << "Import: computed txroot does not match xpop "
                               "txroot, invalid xpop. "
@@ -597,104 +817,24 @@ Import::preflight(PreflightContext const& ctx)
         return temMALFORMED;
     }
 
-    auto coins = parse_uint64(lgr[jss::coins].asString());
-    uint256 phash, acroot;
-
-    // Duplicate / Sanity - syntaxCheckXPOP
-    if (!coins || !phash.parseHex(lgr[jss::phash].asString()) ||
-        !acroot.parseHex(lgr[jss::acroot].asString()))
-    {
-        JLOG(ctx.j.warn()) << "Import: error parsing coins | phash | acroot in "
-                              "the ledger section of XPOP. "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
-
     // compute ledger
     uint256 computedLedgerHash = sha512Half(
         HashPrefix::ledgerMaster,
-        std::uint32_t(lgr[jss::index].asUInt()),
-        *coins,
-        phash,
+        lgr.index,
+        lgr.coins,
+        lgr.phash,
         computedTxRoot,
-        acroot,
-        std::uint32_t(lgr[jss::pclose].asUInt()),
-        std::uint32_t(lgr[jss::close].asUInt()),
-        std::uint8_t(lgr[jss::cres].asUInt()),
-        std::uint8_t(lgr[jss::flags].asUInt()));
+        lgr.acroot,
+        lgr.pclose,
+        lgr.close,
+        lgr.cres,
+        lgr.flags);
 
     //
     // validation section
     //
 
-    std::map<std::string /* nodepub */, std::string /* public key */>
-        validators;
-    std::map<std::string /* master pubkey */, std::string /* nodepub */>
-        validatorsMaster;
-
-    uint64_t totalValidatorCount{0};
-
-    // parse the validator list
-    for (auto const& val : list[jss::validators])
-    {
-        totalValidatorCount++;
-
-        if (!val.isObject() || !val.isMember(jss::validation_public_key) ||
-            !val[jss::validation_public_key].isString() ||
-            !val.isMember(jss::manifest) || !val[jss::manifest].isString())
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob contained invalid "
-                                  "validator entry, skipping "
-                               << tx.getTransactionID();
-            continue;
-        }
-
-        std::optional<Blob> const ret =
-            strUnHex(val[jss::validation_public_key].asString());
-
-        if (!ret || !publicKeyType(makeSlice(*ret)))
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob contained an invalid "
-                                  "validator key, skipping "
-                               << val[jss::validation_public_key].asString()
-                               << " " << tx.getTransactionID();
-            continue;
-        }
-
-        auto const m =
-            deserializeManifest(base64_decode(val[jss::manifest].asString()));
-
-        if (!m)
-        {
-            JLOG(ctx.j.warn())
-                << "Import: unl blob contained an invalid manifest, skipping "
-                << tx.getTransactionID();
-            continue;
-        }
-
-        if (strHex(m->masterKey) != val[jss::validation_public_key])
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob list entry manifest master "
-                                  "key did not match master key, skipping "
-                               << tx.getTransactionID();
-            continue;
-        }
-
-        if (!m->verify())
-        {
-            JLOG(ctx.j.warn()) << "Import: unl blob list entry manifest "
-                                  "signature invalid, skipping "
-                               << tx.getTransactionID();
-            continue;
-        }
-
-        std::string const nodepub =
-            toBase58(TokenType::NodePublic, m->signingKey);
-        std::string const nodemaster =
-            toBase58(TokenType::NodePublic, m->masterKey);
-        validators[nodepub] = strHex(m->signingKey);
-        validatorsMaster[nodemaster] = nodepub;
-    }
+    uint64_t const totalValidatorCount = unl->validatorCount;
 
     JLOG(ctx.j.trace()) << "totalValidatorCount: " << totalValidatorCount;
 
@@ -708,136 +848,20 @@ Import::preflight(PreflightContext const& ctx)
     }
 
     // count how many validations this ledger hash has
-
-    uint64_t validationCount{0};
-    {
-        auto const& data = (*xpop)[jss::validation][jss::data];
-        std::set<std::string> used_key;
-        for (const auto& key : data.getMemberNames())
-        {
-            auto nodepub = key;
-            auto const datakey = nodepub;
-
-            // if the specified node address (nodepub) is in the master address
-            // => regular address list then make a note and replace it with the
-            // regular address
-            auto regular = validatorsMaster.find(nodepub);
-            if (regular != validatorsMaster.end() &&
-                validators.find(regular->second) != validators.end())
-            {
-                used_key.emplace(nodepub);
-                nodepub = regular->second;
-            }
-
-            auto const signingKey = validators.find(nodepub);
-            if (signingKey == validators.end())
-            {
-                JLOG(ctx.j.trace()) << "Import: validator nodepub " << nodepub
-                                    << " did not appear in validator list but "
-                                       "did appear in data section "
-                                    << tx.getTransactionID();
-                continue;
-            }
-
-            if (used_key.find(nodepub) != used_key.end())
-            {
-                JLOG(ctx.j.trace())
-                    << "Import: validator nodepub " << nodepub
-                    << " key appears more than once in data section "
-                    << tx.getTransactionID();
-                continue;
-            }
-
-            used_key.emplace(nodepub);
-
-            // process the validation message
-            try
-            {
-                std::unique_ptr<STValidation> val;
-                auto const valBlob = strUnHex(data[datakey].asString());
-
-                if (!valBlob)
-                {
-                    JLOG(ctx.j.warn())
-                        << "Import: validation inside xpop was not valid hex "
-                        << "nodepub: " << nodepub
-                        << " txid: " << tx.getTransactionID();
-                    continue;
-                }
-
-                SerialIter sit(makeSlice(*valBlob));
-                val = std::make_unique<STValidation>(
-                    std::ref(sit),
-                    [](PublicKey const& pk) { return calcNodeID(pk); },
-                    false);
-
-                if (val->getLedgerHash() != computedLedgerHash)
-                {
-                    JLOG(ctx.j.warn()) << "Import: validation message was not "
-                                          "for computed ledger hash "
-                                       << computedLedgerHash << " it was for "
-                                       << val->getLedgerHash();
-                    continue;
-                }
-
-                if (!(strHex(val->getSignerPublic()) == signingKey->second))
-                {
-                    JLOG(ctx.j.warn())
-                        << "Import: validation inside xpop was not signed with "
-                           "a signing key we recognise "
-                        << "despite being listed against a nodepub we "
-                           "recognise. "
-                        << "nodepub: " << nodepub
-                        << ". txid: " << tx.getTransactionID();
-                    continue;
-                }
-
-                // signature check is expensive hence done after checking
-                // everything else
-                if (!val->isValid())
-                {
-                    JLOG(ctx.j.warn()) << "Import: validation inside xpop was "
-                                          "not correctly signed "
-                                       << "nodepub: " << nodepub
-                                       << " txid: " << tx.getTransactionID();
-                    continue;
-                }
-
-                validationCount++;
-            }
-            catch (...)
-            {
-                JLOG(ctx.j.warn()) << "Import: validation inside xpop was not "
-                                      "able to be parsed "
-                                   << "nodepub: " << nodepub
-                                   << " txid: " << tx.getTransactionID();
-                continue;
-            }
-        }
-    }
+    uint64_t const validationCount = countXPOPValidations(
+        xpop->validations,
+        *unl,
+        computedLedgerHash,
+        ctx.app.getVerifyPool(),
+        ctx.j,
+        tx.getTransactionID());
 
     JLOG(ctx.j.trace()) << "quorum: " << quorum
                         << " validation count: " << validationCount;
 
-    // check if the validation count is adequate
-    auto hasInsufficientQuorum =
-        [&ctx](uint64_t quorum, uint64_t validationCount) {
-            if (ctx.rules.enabled(fixXahauV1))
-            {
-                return quorum > validationCount;
-            }
-            else
-            {
-                return quorum >= validationCount;
-            }
-        };
-    if (hasInsufficientQuorum(quorum, validationCount))
-    {
-        JLOG(ctx.j.warn()) << "Import: xpop did not contain an 80% quorum for "
-                              "the txn it purports to prove. "
-                           << tx.getTransactionID();
-        return temMALFORMED;
-    }
+    if (auto const ret = checkQuorum(ctx, quorum, validationCount);
+        !isTesSuccess(ret))
+        return ret;
 
     // Duplicate / Sanity
     if (!stpTrans->isFieldPresent(sfSequence) ||
@@ -857,6 +881,16 @@ Import::preflight(PreflightContext const& ctx)
         return temBAD_FEE;
     }
 
+    auto verified = std::make_shared<VerifiedXPOP const>(VerifiedXPOP{
+        xpop,
+        stpTrans,
+        meta,
+        unl->validFrom,
+        unl->validUntil,
+        quorum,
+        validationCount});
+    ctx.app.getVerifiedXPOPs().canonicalize_replace_client(key, verified);
+
     return preflight2(ctx);
 }
 
@@ -869,8 +903,9 @@ Import::preclaim(PreclaimContext const& ctx)
     if (!ctx.tx.isFieldPresent(sfBlob))
         return tefINTERNAL;
 
-    // parse blob as json
-    auto const xpop = syntaxCheckXPOP(ctx.tx.getFieldVL(sfBlob), ctx.j);
+    // parse blob as json, unless preflight already has
+    auto const verified = findVerified(ctx.app, ctx.tx);
+    auto const xpop = verified ? verified->xpop : parseXPOP(ctx.tx, ctx.j);
 
     if (!xpop)
     {
@@ -879,7 +914,9 @@ Import::preclaim(PreclaimContext const& ctx)
         return tefINTERNAL;
     }
 
-    auto const [stpTrans, meta] = getInnerTxn(ctx.tx, ctx.j, &(*xpop));
+    auto const [stpTrans, meta] = verified
+        ? std::make_pair(verified->txn, verified->meta)
+        : getInnerTxn(ctx.tx, ctx.j, &(*xpop));
 
     if (!stpTrans || !meta || !stpTrans->isFieldPresent(sfSequence))
     {
@@ -920,8 +957,7 @@ Import::preclaim(PreclaimContext const& ctx)
     }
 
     // check master VL key
-    std::string strPk =
-        (*xpop)[jss::validation][jss::unl][jss::public_key].asString();
+    std::string const& strPk = xpop->unlPublicKey;
 
     if (auto const& found = ctx.app.config().IMPORT_VL_KEYS.find(strPk);
         found != ctx.app.config().IMPORT_VL_KEYS.end())
@@ -1123,7 +1159,9 @@ Import::doApply()
     //
     // Before starting decode and validate XPOP, update ImportVL seq
     //
-    auto const xpop = syntaxCheckXPOP(ctx_.tx.getFieldVL(sfBlob), ctx_.journal);
+    auto const verified = findVerified(ctx_.app, ctx_.tx);
+    auto const xpop =
+        verified ? verified->xpop : parseXPOP(ctx_.tx, ctx_.journal);
 
     if (!xpop)
         return tefINTERNAL;
@@ -1167,7 +1205,9 @@ Import::doApply()
         }
     }
 
-    auto const [stpTrans, meta] = getInnerTxn(ctx_.tx, ctx_.journal, &(*xpop));
+    auto const [stpTrans, meta] = verified
+        ? std::make_pair(verified->txn, verified->meta)
+        : getInnerTxn(ctx_.tx, ctx_.journal, &(*xpop));
 
     if (!stpTrans || !stpTrans->isFieldPresent(sfSequence) ||
         !stpTrans->isFieldPresent(sfFee) || !meta ||
@@ -21,13 +21,91 @@
 #define RIPPLE_TX_IMPORT_H_INCLUDED
 
 #include <ripple/app/tx/impl/Transactor.h>
+#include <ripple/basics/Blob.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/chrono.h>
 #include <ripple/core/Config.h>
+#include <ripple/json/json_value.h>
 #include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/PublicKey.h>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace ripple {
 
+class VerifyPool;
+struct XPOPFields;
+
+/** The UNL section of an XPOP, once the publisher manifest and the signature
+    over the blob have been checked.
+
+    Most XPOPs from a network carry one of a few UNL blobs, so these are kept
+    apart from the XPOPs and shared by all of them until the list expires.
+*/
+struct VerifiedUNL
+{
+    // the publisher's master key, from the manifest
+    PublicKey masterKey;
+
+    // when the list may be used
+    NetClock::time_point validFrom;
+    NetClock::time_point validUntil;
+
+    // every entry on the list, including those which were skipped
+    std::uint64_t validatorCount = 0;
+
+    // nodepub => signing key, in hex
+    std::map<std::string, std::string> validators;
+
+    // master nodepub => nodepub
+    std::map<std::string, std::string> validatorsMaster;
+};
+
+/** An XPOP which passed Import::preflight.
+
+    Everything preflight checks that depends only on the XPOP, the manifest,
+    UNL blob, inner transaction, merkle proof and validation signatures, is
+    checked once per blob. What depends on the outer transaction, the clock,
+    the network id or the rules is checked again against what is kept here.
+*/
+struct VerifiedXPOP
+{
+    std::shared_ptr<XPOPFields const> xpop;
+    std::shared_ptr<STTx const> txn;
+    std::shared_ptr<STObject const> meta;
+
+    // when the UNL blob may be used
+    NetClock::time_point validFrom;
+    NetClock::time_point validUntil;
+
+    // 80% of the validators on the UNL, and how many validated the ledger
+    std::uint64_t quorum = 0;
+    std::uint64_t validationCount = 0;
+};
+
+/** Count the validations in the data section of an XPOP which are for the
+    ledger, from a validator on the UNL, and correctly signed.
+
+    Each validator counts once. The signatures are checked last and together,
+    on the pool, since they are most of the cost of an XPOP.
+
+    @param data The validations of the XPOP, by the nodepub they are listed
+                against.
+    @param ledgerHash The hash of the ledger the XPOP proves.
+*/
+std::uint64_t
+countXPOPValidations(
+    std::vector<std::pair<std::string, Blob>> const& data,
+    VerifiedUNL const& unl,
+    uint256 const& ledgerHash,
+    VerifyPool& pool,
+    beast::Journal const& j,
+    uint256 const& txID);
+
 class Import : public Transactor
 {
 public:
@@ -74,11 +152,11 @@ public:
     static constexpr ConsequencesFactoryType ConsequencesFactory{Custom};
 
     static std::
-        pair<std::unique_ptr<STTx const>, std::unique_ptr<STObject const>>
+        pair<std::shared_ptr<STTx const>, std::shared_ptr<STObject const>>
         getInnerTxn(
             STTx const& outer,
             beast::Journal const& j,
-            Json::Value const* xpop = 0);
+            XPOPFields const* xpop = 0);
 
     explicit Import(ApplyContext& ctx) : Transactor(ctx)
     {
@@ -21,6 +21,8 @@
 
 #include <ripple/app/hook/Enum.h>
 #include <ripple/app/hook/Guard.h>
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/app/hook/ValidationCache.h>
 #include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerMaster.h>
@@ -238,6 +240,78 @@ SetHook::inferOperation(STObject const& hookSetObj)
         : hsoUPDATE;
 }
 
+// Check the guards of a CreateCode and smoke test it in wasmedge. May throw
+// overflow_error
+hook::CodeValidation
+validateCreateCode(SetHookCtx& ctx, Slice const& hook, uint64_t rulesVersion)
+{
+    // RH NOTE: validateGuards has a generic non-rippled specific
+    // interface so it can be used in other projects (i.e. tooling).
+    // As such the calling here is a bit convoluted.
+
+    std::optional<std::reference_wrapper<std::basic_ostream<char>>> logger;
+    std::ostringstream loggerStream;
+    std::string hsacc{""};
+    if (ctx.j.trace())
+    {
+        logger = loggerStream;
+        std::stringstream ss;
+        ss << HS_ACC();
+        hsacc = ss.str();
+    }
+
+    hook::CodeValidation validation;
+    validation.wce = validateGuards(
+        {hook.data(), hook.size()},  // wasm to verify
+        logger,
+        hsacc,
+        rulesVersion);
+
+    if (ctx.j.trace())
+    {
+        // clunky but to get the stream to accept the output
+        // correctly we will split on new line and feed each line
+        // one by one into the trace stream beast::Journal should be
+        // updated to inherit from basic_ostream<char> then this
+        // wouldn't be necessary.
+
+        // is this a needless copy or does the compiler do copy
+        // elision here?
+        std::string s = loggerStream.str();
+
+        char* data = s.data();
+        size_t len = s.size();
+
+        char* last = data;
+        size_t i = 0;
+        for (; i < len; ++i)
+        {
+            if (data[i] == '\n')
+            {
+                data[i] = '\0';
+                ctx.j.trace() << last;
+                last = data + i;
+            }
+        }
+
+        if (last < data + i)
+            ctx.j.trace() << last;
+    }
+
+    if (!validation.wce)
+        return validation;
+
+    JLOG(ctx.j.trace()) << "HookSet(" << hook::log::WASM_SMOKE_TEST << ")["
+                        << HS_ACC()
+                        << "]: Trying to wasm instantiate proposed hook "
+                        << "size = " << hook.size();
+
+    validation.wasmError =
+        hook::HookExecutor::validateWasm(hook.data(), (size_t)hook.size());
+
+    return validation;
+}
+
 // This is a context-free validation, it does not take into account the current
 // state of the ledger returns  < valid, instruction count > may throw
 // overflow_error
@@ -457,85 +531,41 @@ SetHook::validateHookSetEntry(SetHookCtx& ctx, STObject const& hookSetObj)
                 if (!hookSetObj.isFieldPresent(sfCreateCode))
                     return {};
 
-                Blob hook = hookSetObj.getFieldVL(sfCreateCode);
+                Slice const hook = hook::peekFieldVL(hookSetObj, sfCreateCode);
 
-                // RH NOTE: validateGuards has a generic non-rippled specific
-                // interface so it can be used in other projects (i.e. tooling).
-                // As such the calling here is a bit convoluted.
+                // validation depends on nothing but the code and the guard
+                // rules, so each CreateCode is only checked once per process
+                auto const hookHash = ripple::sha512Half_s(hook);
+                uint64_t const rulesVersion =
+                    ctx.rules.enabled(featureHooksUpdate1) ? 1 : 0;
+                auto& cache = ctx.app.getHookValidationCache();
 
-                std::optional<std::reference_wrapper<std::basic_ostream<char>>>
-                    logger;
-                std::ostringstream loggerStream;
-                std::string hsacc{""};
-                if (ctx.j.trace())
-                {
-                    logger = loggerStream;
-                    std::stringstream ss;
-                    ss << HS_ACC();
-                    hsacc = ss.str();
-                }
+                // a traced validation runs again so what the guard checker
+                // found is logged
+                std::optional<hook::CodeValidation> validation;
+                if (!ctx.j.trace())
+                    validation = cache.get(hookHash, rulesVersion);
 
-                auto result = validateGuards(
-                    hook,  // wasm to verify
-                    logger,
-                    hsacc,
-                    ctx.rules.enabled(featureHooksUpdate1) ? 1 : 0);
-
-                if (ctx.j.trace())
+                if (!validation)
                 {
-                    // clunky but to get the stream to accept the output
-                    // correctly we will split on new line and feed each line
-                    // one by one into the trace stream beast::Journal should be
-                    // updated to inherit from basic_ostream<char> then this
-                    // wouldn't be necessary.
-
-                    // is this a needless copy or does the compiler do copy
-                    // elision here?
-                    std::string s = loggerStream.str();
-
-                    char* data = s.data();
-                    size_t len = s.size();
-
-                    char* last = data;
-                    size_t i = 0;
-                    for (; i < len; ++i)
-                    {
-                        if (data[i] == '\n')
-                        {
-                            data[i] = '\0';
-                            ctx.j.trace() << last;
-                            last = data + i;
-                        }
-                    }
-
-                    if (last < data + i)
-                        ctx.j.trace() << last;
+                    validation = validateCreateCode(ctx, hook, rulesVersion);
+                    cache.insert(hookHash, rulesVersion, *validation);
                 }
 
-                if (!result)
+                if (!validation->wce)
                     return false;
 
-                JLOG(ctx.j.trace())
-                    << "HookSet(" << hook::log::WASM_SMOKE_TEST << ")["
-                    << HS_ACC()
-                    << "]: Trying to wasm instantiate proposed hook "
-                    << "size = " << hook.size();
-
-                std::optional<std::string> result2 =
-                    hook::HookExecutor::validateWasm(
-                        hook.data(), (size_t)hook.size());
-
-                if (result2)
+                if (validation->wasmError)
                 {
                     JLOG(ctx.j.trace())
                         << "HookSet(" << hook::log::WASM_TEST_FAILURE << ")["
                         << HS_ACC()
                         << "Tried to set a hook with invalid code. VM error: "
-                        << *result2;
+                        << *validation->wasmError;
                     return false;
                 }
 
-                return *result;
+                return *validation->wce;
             }
         }
 
@@ -1793,9 +1823,20 @@ SetHook::setHook()
         // execution to here means we will enact changes to the ledger:
 
         // do any pending insertions
+        auto& moduleCache = ctx_.app.getHookModuleCache();
         for (auto const& [_, s] : slesToInsert)
+        {
             view().insert(s);
 
+            // get new definitions compiled before their first execution
+            if (s->getType() == ltHOOK_DEFINITION &&
+                moduleCache.aotOnInstall() && !(ctx_.flags() & tapDRY_RUN))
+                moduleCache.compileAsync(
+                    ctx_.app.getJobQueue(),
+                    s->getFieldH256(sfHookHash),
+                    hook::peekFieldVL(*s, sfCreateCode));
+        }
+
         // do any pending updates
         for (auto const& [_, s] : slesToUpdate)
             view().update(s);
@@ -1817,7 +1858,14 @@ SetHook::setHook()
             {
                 uint64_t refCount = sle->getFieldU64(sfReferenceCount);
                 if (refCount <= 0)
+                {
+                    // the definition is going away, so is its loaded module
+                    if (sle->getType() == ltHOOK_DEFINITION &&
+                        !(ctx_.flags() & tapDRY_RUN))
+                        ctx_.app.getHookModuleCache().erase(
+                            sle->getFieldH256(sfHookHash));
                     view().erase(sle);
+                }
             }
             else
                 view().erase(sle);
@@ -0,0 +1,470 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/TraceSink.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/misc/TxQ.h>
+#include <ripple/app/tx/SpeculativeApply.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/VerifyPool.h>
+#include <ripple/protocol/Indexes.h>
+#include <optional>
+
+namespace ripple {
+
+// Forwards reads to the snapshot, noting what was read
+class SpeculativeApply::Recorder : public ReadView
+{
+    ReadView const& base_;
+
+    hash_set<uint256> mutable keys_;
+    std::vector<std::pair<uint256, std::optional<uint256>>> mutable ranges_;
+    hash_set<uint256> mutable txs_;
+    bool mutable ordered_ = false;
+
+public:
+    explicit Recorder(ReadView const& base) : base_(base)
+    {
+    }
+
+    Recorder(Recorder const&) = delete;
+    Recorder&
+    operator=(Recorder const&) = delete;
+
+    void
+    note(uint256 const& key)
+    {
+        keys_.insert(key);
+    }
+
+    /** The keys of the entries read. */
+    hash_set<uint256> const&
+    keys() const
+    {
+        return keys_;
+    }
+
+    /** The open intervals of keys walked. */
+    std::vector<std::pair<uint256, std::optional<uint256>>> const&
+    ranges() const
+    {
+        return ranges_;
+    }
+
+    /** The transactions looked up. */
+    hash_set<uint256> const&
+    txs() const
+    {
+        return txs_;
+    }
+
+    /** Whether the state or the transactions were iterated over. */
+    bool
+    ordered() const
+    {
+        return ordered_;
+    }
+
+    //
+    // ReadView
+    //
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    bool
+    open() const override
+    {
+        return base_.open();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    bool
+    exists(Keylet const& k) const override
+    {
+        keys_.insert(k.key);
+        return base_.exists(k);
+    }
+
+    std::optional<key_type>
+    succ(key_type const& key, std::optional<key_type> const& last = std::nullopt)
+        const override
+    {
+        ranges_.emplace_back(key, last);
+        return base_.succ(key, last);
+    }
+
+    std::shared_ptr<SLE const>
+    read(Keylet const& k) const override
+    {
+        keys_.insert(k.key);
+        return base_.read(k);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        ordered_ = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        ordered_ = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound(uint256 const& key) const override
+    {
+        ordered_ = true;
+        return base_.slesUpperBound(key);
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        ordered_ = true;
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        ordered_ = true;
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists(key_type const& key) const override
+    {
+        txs_.insert(key);
+        return base_.txExists(key);
+    }
+
+    tx_type
+    txRead(key_type const& key) const override
+    {
+        txs_.insert(key);
+        return base_.txRead(key);
+    }
+};
+
+struct SpeculativeApply::Speculation
+{
+    // the txCount of the view the transaction was applied to
+    std::size_t index = 0;
+    ApplyFlags flags = tapNONE;
+
+    std::unique_ptr<Recorder> reads;
+    std::optional<OpenView> view;
+    std::pair<TER, bool> result{tefINTERNAL, false};
+    // published if the result is committed
+    std::vector<hook::TraceSink::Record> traces;
+
+    // whether the run completed and its writes are known
+    bool ran = false;
+};
+
+namespace {
+
+// set while a speculative run is applied on this thread, to note that it read
+// outside its view
+thread_local bool* unrecordedRead = nullptr;
+
+// whether the transaction is worth running speculatively: it likely runs
+// hooks, and its result depends on nothing but the entries it reads
+bool
+speculate(ReadView const& view, STTx const& tx)
+{
+    if (isPseudoTx(tx))
+        return false;
+
+    // these read the total coins, which every transaction changes
+    auto const type = tx.getTxnType();
+    if (type == ttIMPORT || type == ttGENESIS_MINT)
+        return false;
+
+    // this reads the close time of the last validated ledger
+    if (type == ttCLAIM_REWARD)
+        return false;
+
+    // the module cache upkeep of a dry run SetHook is not made up for
+    if (type == ttHOOK_SET)
+        return false;
+
+    if (view.exists(keylet::hook(tx.getAccountID(sfAccount))))
+        return true;
+
+    return tx.isFieldPresent(sfDestination) &&
+        view.exists(keylet::hook(tx.getAccountID(sfDestination)));
+}
+
+}  // namespace
+
+SpeculativeApply::SpeculativeApply(
+    Application& app,
+    OpenView const& view,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+    ApplyFlags flags,
+    beast::Journal j)
+    : app_(app), j_(j), snapshot_(view)
+{
+    // an open view records no metadata
+    if (snapshot_.open())
+        return;
+
+    std::vector<std::pair<Speculation*, STTx const*>> runs;
+    for (std::size_t i = 0;
+         i < txs.size() && runs.size() < maxSpeculations;
+         ++i)
+    {
+        if (!speculate(snapshot_, *txs[i]))
+            continue;
+
+        auto [it, inserted] = speculations_.emplace(
+            txs[i]->getTransactionID(), std::make_unique<Speculation>());
+        if (!inserted)
+            continue;
+
+        // assuming every transaction before it applies
+        it->second->index = snapshot_.txCount() + i;
+        it->second->flags = flags;
+        runs.emplace_back(it->second.get(), txs[i].get());
+    }
+
+    app_.getSpeculationPool().forEach(runs.size(), [&](std::size_t i) {
+        run(*runs[i].first, *runs[i].second);
+    });
+
+    JLOG(j_.debug()) << "Speculatively applied " << runs.size() << " of "
+                     << txs.size() << " transactions";
+}
+
+SpeculativeApply::~SpeculativeApply() = default;
+
+void
+SpeculativeApply::unrecorded()
+{
+    if (unrecordedRead)
+        *unrecordedRead = true;
+}
+
+void
+SpeculativeApply::run(Speculation& s, STTx const& tx)
+{
+    bool unrecorded = false;
+    unrecordedRead = &unrecorded;
+
+    try
+    {
+        // a dry run drops its traces unless they are captured
+        std::optional<hook::TraceSink::Capture> traces;
+        if (app_.getHookTraceSink().enabled())
+            traces.emplace();
+
+        s.reads = std::make_unique<Recorder>(snapshot_);
+        s.view.emplace(s.reads.get(), s.index);
+        s.result = ripple::apply(app_, *s.view, tx, s.flags | tapDRY_RUN, j_);
+        unrecordedRead = nullptr;
+
+        if (traces)
+            s.traces = traces->release();
+
+        // what it read outside the snapshot can't be checked at its turn
+        if (unrecorded)
+        {
+            JLOG(j_.trace()) << "Speculative apply of "
+                             << tx.getTransactionID()
+                             << " read outside its view";
+            return;
+        }
+
+        // what the run wrote counts as read: an entry may be inserted
+        // without looking for it first
+        if (s.result.second)
+        {
+            auto const meta = s.view->txRead(tx.getTransactionID()).second;
+            if (!meta)
+                return;
+
+            for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+                s.reads->note(node.getFieldH256(sfLedgerIndex));
+        }
+
+        s.ran = true;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.warn()) << "Speculative apply of " << tx.getTransactionID()
+                        << " throws: " << e.what();
+    }
+
+    unrecordedRead = nullptr;
+}
+
+bool
+SpeculativeApply::valid(
+    Speculation const& s,
+    OpenView const& view,
+    ApplyFlags flags) const
+{
+    if (!s.ran || blind_ || s.flags != flags || view.txCount() != s.index)
+        return false;
+
+    auto const& reads = *s.reads;
+
+    if (reads.ordered() && !appliedTxs_.empty())
+        return false;
+
+    for (auto const& id : reads.txs())
+        if (appliedTxs_.count(id))
+            return false;
+
+    if (written_.size() < reads.keys().size())
+    {
+        for (auto const& key : written_)
+            if (reads.keys().count(key))
+                return false;
+    }
+    else
+    {
+        for (auto const& key : reads.keys())
+            if (written_.count(key))
+                return false;
+    }
+
+    for (auto const& [first, last] : reads.ranges())
+    {
+        auto const it = structural_.upper_bound(first);
+        if (it != structural_.end() && (!last || *it < *last))
+            return false;
+    }
+
+    return true;
+}
+
+std::pair<TER, bool>
+SpeculativeApply::apply(OpenView& view, STTx const& tx, ApplyFlags flags)
+{
+    auto const txID = tx.getTransactionID();
+
+    if (auto const it = speculations_.find(txID); it != speculations_.end())
+    {
+        auto const s = std::move(it->second);
+        speculations_.erase(it);
+
+        if (valid(*s, view, flags))
+        {
+            ++committed_;
+            app_.getHookTraceSink().replay(s->traces);
+            if (s->result.second)
+            {
+                s->view->apply(view);
+                applied(view, txID);
+                emitted(view, txID);
+            }
+            return s->result;
+        }
+
+        ++reapplied_;
+    }
+
+    auto const result = ripple::apply(app_, view, tx, flags, j_);
+    if (result.second)
+        applied(view, txID);
+    return result;
+}
+
+void
+SpeculativeApply::applied(OpenView const& view, uint256 const& txID)
+{
+    appliedTxs_.insert(txID);
+
+    auto const meta = view.txRead(txID).second;
+    if (!meta)
+    {
+        blind_ = true;
+        return;
+    }
+
+    for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+    {
+        auto const key = node.getFieldH256(sfLedgerIndex);
+        written_.insert(key);
+        if (node.getFName() != sfModifiedNode)
+            structural_.insert(key);
+    }
+}
+
+void
+SpeculativeApply::emitted(OpenView const& view, uint256 const& txID)
+{
+    auto const meta = view.txRead(txID).second;
+    if (!meta)
+        return;
+
+    for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+    {
+        if (node.getFieldU16(sfLedgerEntryType) != ltEMITTED_TXN)
+            continue;
+
+        auto const key = node.getFieldH256(sfLedgerIndex);
+
+        if (node.getFName() == sfDeletedNode)
+        {
+            app_.getTxQ().emittedTxns().erase(key);
+            continue;
+        }
+
+        if (node.getFName() != sfCreatedNode)
+            continue;
+
+        auto const sle = view.read(Keylet{ltEMITTED_TXN, key});
+        if (!sle)
+            continue;
+
+        Serializer s;
+        sle->peekAtField(sfEmittedTxn).add(s);
+        SerialIter sit(s.slice());
+        auto const stx = std::make_shared<STTx const>(std::ref(sit));
+
+        app_.getHashRouter().setFlags(stx->getTransactionID(), SF_EMITTED);
+        app_.getTxQ().emittedTxns().insert(key, stx);
+    }
+}
+
+}  // namespace ripple
@@ -18,7 +18,9 @@
 //==============================================================================
 
 #include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/StatePrefetcher.h>
 #include <ripple/app/hook/applyHook.h>
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
@@ -1179,6 +1181,32 @@ Transactor::executeHookChain(
     auto const& hooks = hookSLE->getFieldArray(sfHooks);
     uint8_t hook_no = 0;
 
+    // start loading the state the chain is likely to read so that it arrives
+    // while the hooks are being instantiated
+    if (auto& prefetcher = ctx_.app.getHookStatePrefetcher();
+        prefetcher.enabled())
+    {
+        if (auto const ledger = ctx_.app.getLedgerMaster().getClosedLedger())
+        {
+            std::set<uint256> namespaces;
+            for (auto const& hookObj : hooks)
+            {
+                if (!hookObj.isFieldPresent(sfHookHash))
+                    continue;
+
+                if (hookObj.isFieldPresent(sfHookNamespace))
+                    namespaces.insert(hookObj.getFieldH256(sfHookNamespace));
+                else if (auto const hookDef = ctx_.view().read(
+                             keylet::hookDefinition(
+                                 hookObj.getFieldH256(sfHookHash))))
+                    namespaces.insert(hookDef->getFieldH256(sfHookNamespace));
+            }
+
+            for (auto const& ns : namespaces)
+                prefetcher.prefetch(ledger, account, ns);
+        }
+    }
+
     for (auto const& hookObj : hooks)
     {
         hook_no++;
@@ -1232,7 +1260,7 @@ Transactor::executeHookChain(
                  : hookDef->getFieldH256(sfHookNamespace));
 
         // gather parameters
-        std::map<std::vector<uint8_t>, std::vector<uint8_t>> parameters;
+        hook::HookParameters parameters;
         if (hook::gatherHookParameters(hookDef, hookObj, parameters, j_))
         {
             JLOG(j_.warn())
@@ -1248,7 +1276,7 @@ Transactor::executeHookChain(
                 hookDef->getFieldH256(sfHookSetTxnID),
                 hookHash,
                 ns,
-                hookDef->getFieldVL(sfCreateCode),
+                hook::peekFieldVL(*hookDef, sfCreateCode),
                 parameters,
                 hookParamOverrides,
                 stateMap,
@@ -1376,7 +1404,7 @@ Transactor::doHookCallback(
                  ? hookObj.getFieldH256(sfHookNamespace)
                  : hookDef->getFieldH256(sfHookNamespace));
 
-        std::map<std::vector<uint8_t>, std::vector<uint8_t>> parameters;
+        hook::HookParameters parameters;
         if (hook::gatherHookParameters(hookDef, hookObj, parameters, j_))
         {
             JLOG(j_.warn())
@@ -1395,7 +1423,7 @@ Transactor::doHookCallback(
                 hookDef->getFieldH256(sfHookSetTxnID),
                 callbackHookHash,
                 ns,
-                hookDef->getFieldVL(sfCreateCode),
+                hook::peekFieldVL(*hookDef, sfCreateCode),
                 parameters,
                 {},
                 stateMap,
@@ -1646,7 +1674,7 @@ Transactor::doAgainAsWeak(
                  ? hookObj.getFieldH256(sfHookNamespace)
                  : hookDef->getFieldH256(sfHookNamespace));
 
-        std::map<std::vector<uint8_t>, std::vector<uint8_t>> parameters;
+        hook::HookParameters parameters;
         if (hook::gatherHookParameters(hookDef, hookObj, parameters, j_))
         {
             JLOG(j_.warn())
@@ -1660,7 +1688,7 @@ Transactor::doAgainAsWeak(
                 hookDef->getFieldH256(sfHookSetTxnID),
                 hookHash,
                 ns,
-                hookDef->getFieldVL(sfCreateCode),
+                hook::peekFieldVL(*hookDef, sfCreateCode),
                 parameters,
                 {},
                 stateMap,
@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/tx/SpeculativeApply.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/app/tx/applySteps.h>
 #include <ripple/basics/Log.h>
@@ -159,7 +160,8 @@ applyTransaction(
     STTx const& txn,
     bool retryAssured,
     ApplyFlags flags,
-    beast::Journal j)
+    beast::Journal j,
+    SpeculativeApply* speculation)
 {
     // Returns false if the transaction has need not be retried.
     if (retryAssured)
@@ -172,7 +174,8 @@ applyTransaction(
     try
     {
 #endif
-        auto const result = apply(app, view, txn, flags, j);
+        auto const result = speculation ? speculation->apply(view, txn, flags)
+                                        : apply(app, view, txn, flags, j);
         if (result.second)
         {
             JLOG(j.debug())
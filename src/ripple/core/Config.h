@@ -240,6 +240,26 @@ public:
     // Enable the experimental Ledger Replay functionality
     bool LEDGER_REPLAY = false;
 
+    // Hook execution: how many parsed and validated hook modules to keep
+    std::size_t HOOK_MODULE_CACHE_SIZE = 64;
+
+    // Hook execution: where to keep natively compiled hooks, empty disables
+    // ahead-of-time compilation. Hooks are compiled when their definition is
+    // installed, or when they are first executed if HOOK_AOT_ON_INSTALL is off
+    std::string HOOK_AOT_PATH;
+    bool HOOK_AOT_ON_INSTALL = true;
+
+    // Hook execution: how many recently touched state keys per namespace to
+    // prefetch before a hook chain runs, 0 disables prefetching
+    std::size_t HOOK_STATE_PREFETCH_KEYS = 0;
+
+    // Hook execution: time hooks and host functions, see hook_profile
+    bool HOOK_PROFILE = false;
+
+    // Hook execution: how many threads pre-apply the transactions of a
+    // consensus ledger speculatively, 0 applies them one by one only
+    std::size_t HOOK_SPECULATIVE_THREADS = 0;
+
     // Work queue limits
     int MAX_TRANSACTIONS = 1000;
     static constexpr int MAX_JOB_QUEUE_TX = 1000;
@@ -50,8 +50,10 @@ enum JobType {
     jtCLIENT_SHARD,       // Client request for shard archiving
     jtCLIENT_RPC,         // Client RPC request
     jtCLIENT_WEBSOCKET,   // Client websocket request
+    jtHOOK_DRY_RUN,       // Dry run of a transaction's hooks for a client
     jtRPC,                // A websocket command from the client
     jtSWEEP,              // Sweep for stale structures
+    jtHOOK_COMPILE,       // Compile a hook to native code
     jtVALIDATION_ut,      // A validation from an untrusted source
     jtMANIFEST,           // A validator's manifest
     jtUPDATE_PF,          // Update pathfinding requests
@@ -87,6 +87,7 @@ private:
         add(jtCLIENT_SHARD,      "clientShardArchive",   maxLimit,  2000ms,  5000ms);
         add(jtCLIENT_RPC,        "clientRPC",            maxLimit,  2000ms,  5000ms);
         add(jtCLIENT_WEBSOCKET,  "clientWebsocket",      maxLimit,  2000ms,  5000ms);
+        add(jtHOOK_DRY_RUN,      "hookDryRun",                  2,  2000ms,  5000ms);
         add(jtRPC,               "RPC",                  maxLimit,     0ms,     0ms);
         add(jtUPDATE_PF,         "updatePaths",                 1,     0ms,     0ms);
         add(jtTRANSACTION,       "transaction",          maxLimit,   250ms,  1000ms);
@@ -100,6 +101,7 @@ private:
         add(jtACCEPT,            "acceptLedger",         maxLimit,     0ms,     0ms);
         add(jtPROPOSAL_t,        "trustedProposal",      maxLimit,   100ms,   500ms);
         add(jtSWEEP,             "sweep",                       1,     0ms,     0ms);
+        add(jtHOOK_COMPILE,      "hookCompile",                 1,     0ms,     0ms);
         add(jtNETOP_CLUSTER,     "clusterReport",               1,  9999ms,  9999ms);
         add(jtNETOP_TIMER,       "heartbeat",                   1,   999ms,   999ms);
         add(jtADMIN,             "administration",       maxLimit,     0ms,     0ms);
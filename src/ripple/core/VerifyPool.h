@@ -0,0 +1,120 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_CORE_VERIFYPOOL_H_INCLUDED
+#define RIPPLE_CORE_VERIFYPOOL_H_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/**
+ * A few threads which help a caller through a batch of independent checks,
+ * such as the signatures of the validations in an XPOP.
+ *
+ * The caller works through its own batch alongside the pool's threads, so a
+ * batch always finishes, even when every thread in the pool is helping with
+ * another one. That makes it safe to use from a job: nothing waits for a job
+ * queue thread to become free.
+ */
+class VerifyPool
+{
+private:
+    struct Batch
+    {
+        std::function<void(std::size_t)> f;
+        std::size_t const size;
+
+        // under VerifyPool::mutex_
+        std::size_t next = 0;
+        std::size_t done = 0;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable work_;
+    std::condition_variable done_;
+    std::deque<std::shared_ptr<Batch>> batches_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+
+    void
+    run(std::string const& name);
+
+    // claim and run items of the batch until none are left
+    void
+    help(std::unique_lock<std::mutex>& lock, std::shared_ptr<Batch> const& b);
+
+    void
+    submit(std::size_t n, std::function<void(std::size_t)> f);
+
+public:
+    /** @param threads How many threads help callers; 0 runs every batch on
+                       the thread which submits it.
+        @param name The name the threads go by.
+    */
+    VerifyPool(std::size_t threads, std::string const& name);
+
+    VerifyPool(VerifyPool const&) = delete;
+    VerifyPool&
+    operator=(VerifyPool const&) = delete;
+
+    ~VerifyPool();
+
+    /** The number of threads which help callers. */
+    std::size_t
+    size() const
+    {
+        return threads_.size();
+    }
+
+    /** Call f(i) for every i in [0, n) and return once every call has.
+
+        The calls run on this thread and on the pool's, in no particular
+        order. f must not throw, and two calls must not write to the same
+        memory.
+    */
+    template <class F>
+    void
+    forEach(std::size_t n, F&& f)
+    {
+        if (n == 0)
+            return;
+
+        if (n == 1 || threads_.empty())
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                f(i);
+            return;
+        }
+
+        submit(n, std::forward<F>(f));
+    }
+};
+
+}  // namespace ripple
+
+#endif
@@ -711,6 +711,31 @@ Config::loadFromString(std::string const& fileContents)
     if (getSingleSection(secConfig, SECTION_LEDGER_REPLAY, strTemp, j_))
         LEDGER_REPLAY = beast::lexicalCastThrow<bool>(strTemp);
 
+    if (exists(SECTION_HOOKS))
+    {
+        auto const sec = section(SECTION_HOOKS);
+        HOOK_MODULE_CACHE_SIZE =
+            sec.value_or("module_cache_size", HOOK_MODULE_CACHE_SIZE);
+        HOOK_AOT_PATH = sec.value_or("aot_path", HOOK_AOT_PATH);
+        HOOK_STATE_PREFETCH_KEYS =
+            sec.value_or("state_prefetch", HOOK_STATE_PREFETCH_KEYS);
+        HOOK_PROFILE = sec.value_or("profile", HOOK_PROFILE);
+        HOOK_SPECULATIVE_THREADS =
+            sec.value_or("speculative_apply", HOOK_SPECULATIVE_THREADS);
+
+        if (auto const when = sec.get("aot_compile"))
+        {
+            if (boost::iequals(*when, "install"))
+                HOOK_AOT_ON_INSTALL = true;
+            else if (boost::iequals(*when, "execution"))
+                HOOK_AOT_ON_INSTALL = false;
+            else
+                Throw<std::runtime_error>(
+                    "Invalid " SECTION_HOOKS
+                    " aot_compile: must be 'install' or 'execution'");
+        }
+    }
+
     if (exists(SECTION_REDUCE_RELAY))
     {
         auto sec = section(SECTION_REDUCE_RELAY);
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/core/VerifyPool.h>
+#include <algorithm>
+
+namespace ripple {
+
+VerifyPool::VerifyPool(std::size_t threads, std::string const& name)
+{
+    threads_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        threads_.emplace_back(
+            &VerifyPool::run, this, name + " #" + std::to_string(i + 1));
+}
+
+VerifyPool::~VerifyPool()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    work_.notify_all();
+
+    for (auto& t : threads_)
+        t.join();
+}
+
+void
+VerifyPool::help(
+    std::unique_lock<std::mutex>& lock,
+    std::shared_ptr<Batch> const& b)
+{
+    while (b->next < b->size)
+    {
+        auto const i = b->next++;
+
+        // the last item claimed: nobody else needs to pick this batch up
+        if (b->next == b->size)
+        {
+            auto const it = std::find(batches_.begin(), batches_.end(), b);
+            if (it != batches_.end())
+                batches_.erase(it);
+        }
+
+        lock.unlock();
+        b->f(i);
+        lock.lock();
+
+        if (++b->done == b->size)
+            done_.notify_all();
+    }
+}
+
+void
+VerifyPool::submit(std::size_t n, std::function<void(std::size_t)> f)
+{
+    auto const b = std::make_shared<Batch>(Batch{std::move(f), n});
+
+    std::unique_lock lock(mutex_);
+    batches_.push_back(b);
+
+    // the caller takes one item itself
+    if (n - 1 >= threads_.size())
+        work_.notify_all();
+    else
+        for (std::size_t i = 0; i < n - 1; ++i)
+            work_.notify_one();
+
+    help(lock, b);
+
+    // items the pool's threads claimed may still be running
+    done_.wait(lock, [&] { return b->done == b->size; });
+}
+
+void
+VerifyPool::run(std::string const& name)
+{
+    beast::setCurrentThreadName(name);
+
+    std::unique_lock lock(mutex_);
+    for (;;)
+    {
+        work_.wait(lock, [this] { return stopping_ || !batches_.empty(); });
+
+        if (stopping_)
+            return;
+
+        // keep a reference: the batch leaves the queue once fully claimed
+        auto const b = batches_.front();
+        help(lock, b);
+    }
+}
+
+}  // namespace ripple
@@ -42,6 +42,10 @@ enum ApplyFlags : std::uint32_t {
 
     // Transaction is being tested against preflight before emission
     tapPREFLIGHT_EMIT = 0x800,
+
+    // Transaction is applied to a throwaway view, to see what it and its
+    // hooks would do, and must leave nothing behind outside of the view
+    tapDRY_RUN = 0x1000,
 };
 
 constexpr ApplyFlags
@@ -324,6 +328,25 @@ public:
     }
     /** @} */
 
+    /** Insert entries to a directory, as dirInsert would one by one
+
+        Each page is read and written once, however many of the entries
+        land on it.
+
+        @param directory the base of the directory
+        @param keys the entries to insert, in order
+        @param describe callback to add required entries to a new page
+
+        @return a \c std::optional which, if insertion was successful,
+                will contain the page number each entry was stored in. If
+                the entries don't all fit, none are inserted.
+    */
+    std::optional<std::vector<std::uint64_t>>
+    dirInsert(
+        Keylet const& directory,
+        std::vector<uint256> const& keys,
+        std::function<void(std::shared_ptr<SLE> const&)> const& describe);
+
     /** Remove an entry from a directory
 
         @param directory the base of the directory
@@ -358,6 +381,27 @@ public:
     }
     /** @} */
 
+    /** Remove entries from a directory, as dirRemove would one by one
+
+        Each page is read and written once, however many of the entries
+        are removed from it. Only the removals which leave a page empty are
+        made one by one, in the order given, so pages are unlinked and
+        deleted just as they would be by dirRemove.
+
+        @param directory the base of the directory
+        @param entries the page number and key of each entry, in order
+        @param keepRoot if deleting the last entry, don't
+                        delete the root page (i.e. the directory itself).
+
+        @return \c true if every entry was found and deleted and
+                \c false, with nothing deleted, otherwise.
+    */
+    bool
+    dirRemove(
+        Keylet const& directory,
+        std::vector<std::pair<std::uint64_t, uint256>> const& entries,
+        bool keepRoot);
+
     /** Remove the specified directory, invoking the callback for every node. */
     bool
     dirDelete(
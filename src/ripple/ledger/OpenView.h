@@ -97,6 +97,8 @@ private:
     detail::RawStateTable items_;
     std::shared_ptr<void const> hold_;
     bool open_ = true;
+    // transactions taken to precede those in txs_
+    std::size_t baseTxCount_ = 0;
 
 public:
     OpenView() = delete;
@@ -170,6 +172,18 @@ public:
     */
     OpenView(ReadView const* base, std::shared_ptr<void const> hold = nullptr);
 
+    /** Construct a view which takes a transaction after others.
+
+        Effects:
+
+            As for a new last closed ledger, except that
+            txCount transactions are taken to precede the
+            ones inserted into this view: their metadata
+            has the index it would have in a view which
+            holds those transactions too.
+    */
+    OpenView(ReadView const* base, std::size_t txCount);
+
     /** Returns true if this reflects an open ledger. */
     bool
     open() const override
@@ -177,7 +191,8 @@ public:
         return open_;
     }
 
-    /** Return the number of tx inserted since creation.
+    /** Return the number of tx inserted since creation,
+        plus any taken to precede them.
 
         This is used to set the "apply ordinal"
         when calculating transaction metadata.
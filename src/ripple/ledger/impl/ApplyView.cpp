@@ -20,7 +20,10 @@
 #include <ripple/basics/contract.h>
 #include <ripple/ledger/ApplyView.h>
 #include <ripple/protocol/Protocol.h>
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <set>
 
 namespace ripple {
 
@@ -123,6 +126,122 @@ ApplyView::dirAdd(
     return page;
 }
 
+std::optional<std::vector<std::uint64_t>>
+ApplyView::dirInsert(
+    Keylet const& directory,
+    std::vector<uint256> const& keys,
+    std::function<void(std::shared_ptr<SLE> const&)> const& describe)
+{
+    std::vector<std::uint64_t> pages;
+    pages.reserve(keys.size());
+
+    if (keys.empty())
+        return pages;
+
+    std::uint64_t page = 0;
+    auto root = peek(directory);
+    auto node = root;
+
+    // whether node is yet to be inserted
+    bool fresh = false;
+
+    if (!root)
+    {
+        // No root, make it.
+        root = std::make_shared<SLE>(directory);
+        root->setFieldH256(sfRootIndex, directory.key);
+        describe(root);
+        node = root;
+        fresh = true;
+    }
+    else
+    {
+        page = root->getFieldU64(sfIndexPrevious);
+
+        if (page)
+        {
+            node = peek(keylet::page(directory, page));
+            if (!node)
+                LogicError("Directory chain: root back-pointer broken.");
+        }
+    }
+
+    auto indexes = node->getFieldV256(sfIndexes);
+
+    // We can't be sure if the last page is already sorted because it may be
+    // a legacy page we haven't yet touched. It is sorted on first use.
+    bool sorted = fresh;
+
+    auto const write = [&]() {
+        node->setFieldV256(sfIndexes, indexes);
+        if (fresh)
+            insert(node);
+        else
+            update(node);
+    };
+
+    // Check whether we'd run out of pages before changing anything, so the
+    // directory is left as it was if we would.
+    if (!rules().enabled(fixPageCap))
+    {
+        std::size_t const room = indexes.size() < dirNodeMaxEntries
+            ? dirNodeMaxEntries - indexes.size()
+            : 0;
+
+        if (keys.size() > room &&
+            page + (keys.size() - room + dirNodeMaxEntries - 1) /
+                    dirNodeMaxEntries >=
+                dirNodeMaxPages)
+            return std::nullopt;
+    }
+
+    for (auto const& key : keys)
+    {
+        // If there's no space, we start a new page:
+        if (indexes.size() >= dirNodeMaxEntries)
+        {
+            ++page;
+
+            // Link the new page to the chain first:
+            node->setFieldU64(sfIndexNext, page);
+            root->setFieldU64(sfIndexPrevious, page);
+            write();
+            if (node != root)
+                update(root);
+
+            node = std::make_shared<SLE>(keylet::page(directory, page));
+            node->setFieldH256(sfRootIndex, directory.key);
+
+            // Save some space by not specifying the value 0 since
+            // it's the default.
+            if (page != 1)
+                node->setFieldU64(sfIndexPrevious, page - 1);
+            describe(node);
+
+            indexes.clear();
+            fresh = true;
+            sorted = true;
+        }
+
+        if (!sorted)
+        {
+            std::sort(indexes.begin(), indexes.end());
+            sorted = true;
+        }
+
+        auto pos = std::lower_bound(indexes.begin(), indexes.end(), key);
+
+        if (pos != indexes.end() && key == *pos)
+            LogicError("dirInsert: double insertion");
+
+        indexes.insert(pos, key);
+        pages.push_back(page);
+    }
+
+    write();
+    return pages;
+}
+
 bool
 ApplyView::emptyDirDelete(Keylet const& directory)
 {
@@ -336,6 +455,74 @@ ApplyView::dirRemove(
     return true;
 }
 
+bool
+ApplyView::dirRemove(
+    Keylet const& directory,
+    std::vector<std::pair<std::uint64_t, uint256>> const& entries,
+    bool keepRoot)
+{
+    // the keys to remove from each page, in order
+    std::map<std::uint64_t, std::vector<uint256>> byPage;
+    for (auto const& [page, key] : entries)
+        byPage[page].push_back(key);
+
+    // the removals which empty a page, left to dirRemove
+    std::set<std::pair<std::uint64_t, uint256>> last;
+
+    // the pages with what is left on them, written once every entry is found
+    std::vector<std::pair<std::shared_ptr<SLE>, STVector256>> updates;
+    updates.reserve(byPage.size());
+
+    for (auto const& [page, keys] : byPage)
+    {
+        auto node = peek(keylet::page(directory, page));
+
+        if (!node)
+            return false;
+
+        STVector256 indexes = node->getFieldV256(sfIndexes);
+
+        for (auto const& key : keys)
+        {
+            auto it = std::find(indexes.begin(), indexes.end(), key);
+
+            if (indexes.end() == it)
+                return false;
+
+            // We always preserve the relative order when we remove.
+            indexes.erase(it);
+        }
+
+        if (indexes.empty())
+        {
+            last.emplace(page, keys.back());
+
+            if (keys.size() == 1)
+                continue;
+
+            indexes.push_back(keys.back());
+        }
+
+        updates.emplace_back(std::move(node), std::move(indexes));
+    }
+
+    for (auto& [node, indexes] : updates)
+    {
+        node->setFieldV256(sfIndexes, indexes);
+        update(node);
+    }
+
+    // Each of these is the only entry left on its page, so can't be missing.
+    for (auto const& entry : entries)
+    {
+        if (last.count(entry) &&
+            !dirRemove(directory, entry.first, entry.second, keepRoot))
+            return false;
+    }
+
+    return true;
+}
+
 bool
 ApplyView::dirDelete(
     Keylet const& directory,
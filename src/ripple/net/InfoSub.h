@@ -177,6 +177,13 @@ public:
         virtual bool
         unsubConsensus(std::uint64_t uListener) = 0;
 
+        virtual bool
+        subHookTraces(ref ispListener) = 0;
+        virtual bool
+        unsubHookTraces(std::uint64_t uListener) = 0;
+        virtual void
+        pubHookTrace(Json::Value const& jvObj) = 0;
+
         // VFALCO TODO Remove
         //             This was added for one particular partner, it
         //             "pushes" subscription data to a particular URL.
@@ -52,6 +52,7 @@ InfoSub::~InfoSub()
     m_source.unsubValidations(mSeq);
     m_source.unsubPeerStatus(mSeq);
     m_source.unsubConsensus(mSeq);
+    m_source.unsubHookTraces(mSeq);
 
     // Use the internal unsubscribe so that it won't call
     // back to us and modify its own parameter
@@ -19,6 +19,7 @@
 
 #include <ripple/perflog/impl/PerfLogImp.h>
 
+#include <ripple/app/hook/Profiler.h>
 #include <ripple/basics/BasicConfig.h>
 #include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/beast/utility/Journal.h>
@@ -304,6 +305,8 @@ PerfLogImp::report()
     else
         app_.getNodeStore().getCountsJson(report[jss::nodestore]);
     report[jss::current_activities] = counters_.currentJson();
+    if (auto const& profiler = app_.getHookProfiler(); profiler.enabled())
+        report[jss::hooks] = profiler.json();
     app_.getOPs().stateAccounting(report);
 
     logFile_ << Json::Compact{std::move(report)} << std::endl;
@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_PROTOCOL_BINARYXPOP_H_INCLUDED
+#define RIPPLE_PROTOCOL_BINARYXPOP_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/json/json_value.h>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** The compact binary form of an XPOP.
+
+    It carries what the JSON form does, as raw bytes rather than hex and
+    base64 strings:
+
+        "XPOP" version:8
+        ledger:     index:32 coins:64 phash:256 txroot:256 acroot:256
+                    pclose:32 close:32 cres:8 flags:8
+        transaction: VL(blob) VL(meta) proof
+        unl:        VL(public_key) VL(manifest) VL(blob) VL(signature)
+                    version:32
+        validation: count:32 then count times VL(node public key)
+                    VL(validation)
+
+    Integers are big endian and VL is the length prefix of the serialized
+    format. A proof is one node, where each node starts with its kind:
+
+        hash:   0x01 hash:256                          (list form entry)
+        list:   0x02 followed by exactly 16 nodes      (list form)
+        tree:   0x03 hash:256 key:256 mask:16 then one tree node for each
+                set bit of the mask, lowest nibble first (tree form)
+
+    The manifest and UNL blob are the base64 decoded bytes, and nodes are
+    identified by their raw public key rather than in base58.
+*/
+struct BinaryXPOP
+{
+    static constexpr std::uint8_t version = 1;
+
+    struct Ledger
+    {
+        std::uint32_t index = 0;
+        std::uint64_t coins = 0;
+        uint256 phash;
+        uint256 txroot;
+        uint256 acroot;
+        std::uint32_t pclose = 0;
+        std::uint32_t close = 0;
+        std::uint8_t cres = 0;
+        std::uint8_t flags = 0;
+    };
+
+    Ledger ledger;
+
+    // these point into the buffer which was parsed
+    Slice txn;
+    Slice meta;
+    Slice proof;
+
+    Slice unlPublicKey;
+    Slice unlManifest;
+    Slice unlBlob;
+    Slice unlSignature;
+    std::uint32_t unlVersion = 0;
+
+    // node public key, validation
+    std::vector<std::pair<Slice, Slice>> validations;
+};
+
+/** Whether a blob is in the binary form rather than JSON. */
+bool
+isBinaryXPOP(Slice const& blob);
+
+/** Split an XPOP in the binary form into its fields, without copying them.
+
+    Checks the layout, proof structure and key types, but no hashes or
+    signatures. The result refers to blob, which must outlive it.
+*/
+std::optional<BinaryXPOP>
+parseBinaryXPOP(Slice const& blob, beast::Journal j);
+
+/** The root hash of the proof of a parsed binary XPOP, computed the way
+    Import computes it from the JSON form.
+*/
+uint256
+proofRoot(BinaryXPOP const& xpop);
+
+/** The hashes in the proof of a parsed binary XPOP among which Import looks
+    for the leaf of the transaction, the way it does in the JSON form.
+*/
+std::vector<uint256>
+proofHashes(BinaryXPOP const& xpop);
+
+/** The JSON form of a parsed binary XPOP. */
+Json::Value
+toJson(BinaryXPOP const& xpop);
+
+/** The binary form of an XPOP in the JSON form.
+
+    Members of the unl section other than those the binary form carries are
+    dropped, since Import does not read them.
+
+    @return The binary form, or nothing if a field is missing or does not
+            fit the binary form.
+*/
+std::optional<Blob>
+toBinaryXPOP(Json::Value const& xpop);
+
+}  // namespace ripple
+
+#endif
@@ -20,12 +20,17 @@
 #ifndef RIPPLE_PROTOCOL_IMPORT_H_INCLUDED
 #define RIPPLE_PROTOCOL_IMPORT_H_INCLUDED
 
-// #include <ripple/basics/Log.h>
 #include <ripple/app/misc/Manifest.h>
+#include <ripple/basics/Log.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/base64.h>
 #include <ripple/json/json_reader.h>
+#include <ripple/protocol/BinaryXPOP.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/jss.h>
 #include <charconv>
+#include <map>
 
 namespace ripple {
 
@@ -175,16 +180,13 @@ syntaxCheckXPOP(Blob const& blob, beast::Journal const& j)
     if (blob.empty())
         return {};
 
-    std::string strJson(blob.begin(), blob.end());
-    if (strJson.empty())
-        return {};
-
     try
     {
         Json::Value xpop;
         Json::Reader reader;
 
-        if (!reader.parse(strJson, xpop))
+        // the binary form is checked by parseBinaryXPOP
+        if (!reader.parse(std::string(blob.begin(), blob.end()), xpop))
         {
             JLOG(j.warn()) << "XPOP failed to parse string json";
             return {};
@@ -440,23 +442,273 @@ syntaxCheckXPOP(Blob const& blob, beast::Journal const& j)
     return {};
 }
 
+/** The fields of an XPOP which Import verifies, read once from whichever
+    form it came in.
+*/
+struct XPOPFields
+{
+    BinaryXPOP::Ledger ledger;
+
+    Blob txn;
+    Blob meta;
+
+    // the root the proof hashes to, and the hashes in it among which the
+    // leaf of the transaction is looked for
+    uint256 proofRoot;
+    std::vector<uint256> proofHashes;
+
+    // the publisher key in hex, as the JSON form gives it, and the manifest
+    // and blob base64 decoded
+    std::string unlPublicKey;
+    std::string unlManifest;
+    std::string unlBlob;
+    Blob unlSignature;
+
+    // nodepub => validation, in the order of the JSON form
+    std::vector<std::pair<std::string, Blob>> validations;
+};
+
+// the root hash of a proof in the JSON form
+inline uint256
+proofRoot(Json::Value const& proof, int depth = 0)
+{
+    const uint256 nullhash;
+
+    if (depth > 32)
+        return nullhash;
+
+    if (!proof.isObject() && !proof.isArray())
+        return nullhash;
+
+    sha512_half_hasher h;
+    using beast::hash_append;
+    hash_append(h, ripple::HashPrefix::innerNode);
+
+    if (proof.isArray())
+    {
+        for (const auto& entry : proof)
+        {
+            if (entry.isString())
+            {
+                uint256 hash;
+                if (hash.parseHex(entry.asString()))
+                    hash_append(h, hash);
+            }
+            else
+                hash_append(h, proofRoot(entry, depth + 1));
+        }
+    }
+    else if (proof.isObject())
+    {
+        for (int x = 0; x < 16; ++x)
+        {
+            // Duplicate / Sanity
+            std::string const nibble(1, "0123456789ABCDEF"[x]);
+            if (!proof[jss::children].isMember(nibble))
+                hash_append(h, nullhash);
+            else if (proof[jss::children][nibble][jss::children].size() == 0u)
+            {
+                uint256 hash;
+                if (hash.parseHex(
+                        proof[jss::children][nibble][jss::hash].asString()))
+                    hash_append(h, hash);
+            }
+            else
+                hash_append(
+                    h, proofRoot(proof[jss::children][nibble], depth + 1));
+        }
+    }
+    return static_cast<uint256>(h);
+}
+
+// the hashes in a proof in the JSON form which Import compares the leaf of
+// the transaction with: list entries, and the hash of every tree node below
+// the root, as upper case hex
+inline void
+addProofHashes(
+    Json::Value const& proof,
+    std::vector<uint256>& hashes,
+    int depth = 0)
+{
+    if (depth > 32)
+        return;
+
+    if (!proof.isObject() && !proof.isArray())
+        return;
+
+    Json::Value const* entries = &proof;
+    if (entries->isMember(jss::children))
+        entries = &((*entries)[jss::children]);
+
+    for (int x = 0; x < 16; ++x)
+    {
+        Json::Value const& entry = entries->isObject()
+            ? (*entries)[std::string(1, "0123456789ABCDEF"[x])]
+            : (*entries)[x];
+
+        if (entry.isNull())
+            continue;
+
+        Json::Value const* hash = &entry;
+        if (entry.isObject())
+            hash = &entry[jss::hash];
+
+        uint256 parsed;
+        if (hash->isString() && parsed.parseHex(hash->asString()) &&
+            strHex(parsed) == hash->asString())
+            hashes.push_back(parsed);
+
+        addProofHashes(entry, hashes, depth + 1);
+    }
+}
+
+// the fields of an XPOP in the JSON form which syntaxCheckXPOP accepted
+inline std::optional<XPOPFields>
+xpopFields(Json::Value const& xpop, beast::Journal const& j)
+{
+    try
+    {
+        XPOPFields fields;
+
+        auto const& lgr = xpop[jss::ledger];
+        auto& ledger = fields.ledger;
+        auto const coins = parse_uint64(lgr[jss::coins].asString());
+
+        // Import compares the txroot as it is given with the one it computes
+        if (!coins || !ledger.phash.parseHex(lgr[jss::phash].asString()) ||
+            !ledger.txroot.parseHex(lgr[jss::txroot].asString()) ||
+            strHex(ledger.txroot) != lgr[jss::txroot].asString() ||
+            !ledger.acroot.parseHex(lgr[jss::acroot].asString()))
+        {
+            JLOG(j.warn()) << "XPOP.ledger coins, phash, txroot or acroot "
+                              "could not be read";
+            return {};
+        }
+
+        ledger.index = lgr[jss::index].asUInt();
+        ledger.coins = *coins;
+        ledger.pclose = lgr[jss::pclose].asUInt();
+        ledger.close = lgr[jss::close].asUInt();
+        ledger.cres = static_cast<std::uint8_t>(lgr[jss::cres].asUInt());
+        ledger.flags = static_cast<std::uint8_t>(lgr[jss::flags].asUInt());
+
+        auto const& txn = xpop[jss::transaction];
+        auto const& unl = xpop[jss::validation][jss::unl];
+        auto rawTx = strUnHex(txn[jss::blob].asString());
+        auto meta = strUnHex(txn[jss::meta].asString());
+        auto signature = strUnHex(unl[jss::signature].asString());
+        if (!rawTx || !meta || !signature)
+        {
+            JLOG(j.warn()) << "XPOP.transaction blob or meta, or "
+                              "XPOP.validation.unl.signature was not hex";
+            return {};
+        }
+
+        fields.txn = std::move(*rawTx);
+        fields.meta = std::move(*meta);
+
+        fields.proofRoot = proofRoot(txn[jss::proof]);
+        addProofHashes(txn[jss::proof], fields.proofHashes);
+
+        fields.unlPublicKey = unl[jss::public_key].asString();
+        fields.unlManifest = base64_decode(unl[jss::manifest].asString());
+        fields.unlBlob = base64_decode(unl[jss::blob].asString());
+        fields.unlSignature = std::move(*signature);
+
+        auto const& data = xpop[jss::validation][jss::data];
+        for (auto const& key : data.getMemberNames())
+        {
+            auto val = strUnHex(data[key].asString());
+            if (!val)
+            {
+                JLOG(j.warn()) << "XPOP.validation.data entry was not hex";
+                return {};
+            }
+
+            fields.validations.emplace_back(key, std::move(*val));
+        }
+
+        return fields;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j.warn()) << "XPOP fields could not be read: " << e.what();
+    }
+
+    return {};
+}
+
+// the fields of an XPOP in the binary form which parseBinaryXPOP accepted
+inline XPOPFields
+xpopFields(BinaryXPOP const& xpop)
+{
+    XPOPFields fields;
+
+    fields.ledger = xpop.ledger;
+    fields.txn.assign(xpop.txn.begin(), xpop.txn.end());
+    fields.meta.assign(xpop.meta.begin(), xpop.meta.end());
+
+    fields.proofRoot = proofRoot(xpop);
+    fields.proofHashes = proofHashes(xpop);
+
+    fields.unlPublicKey = strHex(xpop.unlPublicKey);
+    fields.unlManifest.assign(xpop.unlManifest.begin(), xpop.unlManifest.end());
+    fields.unlBlob.assign(xpop.unlBlob.begin(), xpop.unlBlob.end());
+    fields.unlSignature.assign(
+        xpop.unlSignature.begin(), xpop.unlSignature.end());
+
+    // the JSON form holds one validation per nodepub, the last one given,
+    // in order
+    std::map<std::string, Slice> data;
+    for (auto const& [key, val] : xpop.validations)
+        data.insert_or_assign(
+            toBase58(TokenType::NodePublic, PublicKey(key)), val);
+
+    fields.validations.reserve(data.size());
+    for (auto const& [key, val] : data)
+        fields.validations.emplace_back(key, Blob(val.begin(), val.end()));
+
+    return fields;
+}
+
+/** Check an XPOP in either form and read the fields Import verifies.
+
+    The binary form is read as it is laid out, the JSON form as it is checked
+    by syntaxCheckXPOP. Does not check signatures etc.
+*/
+inline std::optional<XPOPFields>
+readXPOP(Blob const& blob, beast::Journal const& j)
+{
+    if (isBinaryXPOP(makeSlice(blob)))
+    {
+        auto const binary = parseBinaryXPOP(makeSlice(blob), j);
+        if (!binary)
+            return {};
+
+        return xpopFields(*binary);
+    }
+
+    auto const xpop = syntaxCheckXPOP(blob, j);
+    if (!xpop)
+        return {};
+
+    return xpopFields(*xpop, j);
+}
+
 // <sequence, master key>
 inline std::optional<std::pair<uint32_t, PublicKey>>
-getVLInfo(Json::Value const& xpop, beast::Journal const& j)
+getVLInfo(XPOPFields const& xpop, beast::Journal const& j)
 {
-    auto const data =
-        base64_decode(xpop[jss::validation][jss::unl][jss::blob].asString());
     Json::Reader r;
     Json::Value list;
-    if (!r.parse(data, list))
+    if (!r.parse(xpop.unlBlob, list))
     {
         JLOG(j.warn())
             << "Import: unl blob was not valid json (after base64 decoding)";
         return {};
     }
     auto const sequence = list[jss::sequence].asUInt();
-    auto const m = deserializeManifest(base64_decode(
-        xpop[jss::validation][jss::unl][jss::manifest].asString()));
+    auto const m = deserializeManifest(xpop.unlManifest);
     if (!m)
     {
         JLOG(j.warn()) << "Import: failed to deserialize manifest";
@@ -0,0 +1,568 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/basics/base64.h>
+#include <ripple/protocol/BinaryXPOP.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/PublicKey.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/protocol/tokens.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <limits>
+#include <string_view>
+
+namespace ripple {
+
+namespace {
+
+constexpr std::array<std::uint8_t, 4> magic{{'X', 'P', 'O', 'P'}};
+
+// the kinds of proof node
+constexpr std::uint8_t proofHash = 0x01;
+constexpr std::uint8_t proofList = 0x02;
+constexpr std::uint8_t proofTree = 0x03;
+
+// as deep as syntaxCheckProof lets a proof go
+constexpr int maxProofDepth = 64;
+
+// where a proof node is: each form only nests in itself, and the root of
+// the list form is not a hash
+enum class Within { root, list, tree };
+
+constexpr char const* nibbles = "0123456789ABCDEF";
+
+// the nibble a member of the children of a tree node is for, or -1
+int
+nibble(std::string const& name)
+{
+    if (name.size() != 1)
+        return -1;
+
+    auto const pos = std::string_view(nibbles).find(
+        static_cast<char>(std::toupper(static_cast<unsigned char>(name[0]))));
+    return pos == std::string_view::npos ? -1 : static_cast<int>(pos);
+}
+
+// the JSON form keeps these in signed integers
+bool
+fitsInt(std::uint32_t v)
+{
+    return v <=
+        static_cast<std::uint32_t>(std::numeric_limits<Json::Int>::max());
+}
+
+// step over one proof node, checking its structure
+bool
+skipProof(SerialIter& sit, Within within, int depth)
+{
+    if (depth > maxProofDepth)
+        return false;
+
+    auto const kind = sit.get8();
+
+    if (kind == proofHash && within == Within::list)
+    {
+        sit.skip(uint256::bytes);
+        return true;
+    }
+
+    if (kind == proofList && within != Within::tree)
+    {
+        for (int x = 0; x < 16; ++x)
+            if (!skipProof(sit, Within::list, depth + 1))
+                return false;
+        return true;
+    }
+
+    if (kind == proofTree && within != Within::list)
+    {
+        sit.skip(2 * uint256::bytes);
+        auto const mask = sit.get16();
+        for (int x = 0; x < 16; ++x)
+            if ((mask & (1 << x)) && !skipProof(sit, Within::tree, depth + 1))
+                return false;
+        return true;
+    }
+
+    return false;
+}
+
+// how deep Import walks a proof in the JSON form
+constexpr int maxImportDepth = 32;
+
+// the hash a proof node which skipProof accepted adds to its parent, the way
+// Import computes it from the JSON form: a tree node without children stands
+// for its hash, except at the root, and nodes too deep are zero
+uint256
+hashProof(SerialIter& sit, int depth, bool root = false)
+{
+    auto const kind = sit.get8();
+
+    if (kind == proofHash)
+        return sit.get256();
+
+    std::uint16_t mask = 0xFFFF;
+    if (kind == proofTree)
+    {
+        auto const hash = sit.get256();
+        sit.skip(uint256::bytes);
+        mask = sit.get16();
+        if (mask == 0 && !root)
+            return hash;
+    }
+
+    sha512_half_hasher h;
+    using beast::hash_append;
+    hash_append(h, HashPrefix::innerNode);
+    for (int x = 0; x < 16; ++x)
+        hash_append(
+            h, (mask & (1 << x)) ? hashProof(sit, depth + 1) : uint256{});
+
+    return depth > maxImportDepth ? uint256{} : static_cast<uint256>(h);
+}
+
+// the hashes of the children of a proof node which skipProof accepted, and
+// of theirs, as Import compares them in the JSON form
+void
+addHashes(SerialIter& sit, int depth, std::vector<uint256>& hashes)
+{
+    auto const kind = sit.get8();
+
+    if (kind == proofHash)
+    {
+        sit.skip(uint256::bytes);
+        return;
+    }
+
+    std::uint16_t mask = 0xFFFF;
+    if (kind == proofTree)
+    {
+        sit.skip(2 * uint256::bytes);
+        mask = sit.get16();
+    }
+
+    for (int x = 0; x < 16; ++x)
+    {
+        if (!(mask & (1 << x)))
+            continue;
+
+        // list nodes have no hash of their own
+        auto child = sit;
+        if (depth <= maxImportDepth && child.get8() != proofList)
+            hashes.push_back(child.get256());
+
+        addHashes(sit, depth + 1, hashes);
+    }
+}
+
+// a proof node which skipProof accepted, in the JSON form
+Json::Value
+proofJson(SerialIter& sit)
+{
+    auto const kind = sit.get8();
+
+    if (kind == proofHash)
+        return strHex(sit.get256());
+
+    if (kind == proofList)
+    {
+        Json::Value list{Json::arrayValue};
+        for (int x = 0; x < 16; ++x)
+            list.append(proofJson(sit));
+        return list;
+    }
+
+    Json::Value node{Json::objectValue};
+    node[jss::hash] = strHex(sit.get256());
+    node[jss::key] = strHex(sit.get256());
+
+    auto& children = node[jss::children] = Json::objectValue;
+    auto const mask = sit.get16();
+    for (int x = 0; x < 16; ++x)
+        if (mask & (1 << x))
+            children[std::string(1, nibbles[x])] = proofJson(sit);
+
+    return node;
+}
+
+bool
+addProof(Serializer& s, Json::Value const& proof, Within within, int depth)
+{
+    if (depth > maxProofDepth)
+        return false;
+
+    if (proof.isString() && within == Within::list)
+    {
+        uint256 hash;
+        if (!hash.parseHex(proof.asString()))
+            return false;
+
+        s.add8(proofHash);
+        s.addBitString(hash);
+        return true;
+    }
+
+    if (proof.isArray() && within != Within::tree)
+    {
+        if (proof.size() != 16)
+            return false;
+
+        s.add8(proofList);
+        for (auto const& entry : proof)
+            if (!addProof(s, entry, Within::list, depth + 1))
+                return false;
+        return true;
+    }
+
+    if (proof.isObject() && within != Within::list)
+    {
+        uint256 hash;
+        uint256 key;
+        if (!proof[jss::hash].isString() ||
+            !hash.parseHex(proof[jss::hash].asString()) ||
+            !proof[jss::key].isString() ||
+            !key.parseHex(proof[jss::key].asString()) ||
+            !proof[jss::children].isObject())
+            return false;
+
+        auto const& children = proof[jss::children];
+
+        // the members by nibble, whichever case they are in
+        std::array<Json::Value const*, 16> byNibble{};
+        std::uint16_t mask = 0;
+        for (auto const& name : children.getMemberNames())
+        {
+            auto const x = nibble(name);
+            if (x < 0 || byNibble[x])
+                return false;
+
+            byNibble[x] = &children[name];
+            mask |= 1 << x;
+        }
+
+        s.add8(proofTree);
+        s.addBitString(hash);
+        s.addBitString(key);
+        s.add16(mask);
+        for (auto const* child : byNibble)
+            if (child && !addProof(s, *child, Within::tree, depth + 1))
+                return false;
+        return true;
+    }
+
+    return false;
+}
+
+}  // namespace
+
+bool
+isBinaryXPOP(Slice const& blob)
+{
+    return blob.size() > magic.size() &&
+        std::equal(magic.begin(), magic.end(), blob.data());
+}
+
+std::optional<BinaryXPOP>
+parseBinaryXPOP(Slice const& blob, beast::Journal j)
+{
+    if (!isBinaryXPOP(blob))
+        return {};
+
+    try
+    {
+        SerialIter sit(blob);
+        sit.skip(magic.size());
+
+        if (auto const version = sit.get8(); version != BinaryXPOP::version)
+        {
+            JLOG(j.warn()) << "XPOP binary form version "
+                           << static_cast<int>(version) << " not supported";
+            return {};
+        }
+
+        BinaryXPOP xpop;
+
+        auto& ledger = xpop.ledger;
+        ledger.index = sit.get32();
+        ledger.coins = sit.get64();
+        ledger.phash = sit.get256();
+        ledger.txroot = sit.get256();
+        ledger.acroot = sit.get256();
+        ledger.pclose = sit.get32();
+        ledger.close = sit.get32();
+        ledger.cres = sit.get8();
+        ledger.flags = sit.get8();
+
+        if (!fitsInt(ledger.index) || !fitsInt(ledger.pclose) ||
+            !fitsInt(ledger.close))
+        {
+            JLOG(j.warn()) << "XPOP.ledger index, pclose or close out of "
+                              "range";
+            return {};
+        }
+
+        xpop.txn = sit.getSlice(sit.getVLDataLength());
+        xpop.meta = sit.getSlice(sit.getVLDataLength());
+
+        auto const proofStart = blob.size() - sit.getBytesLeft();
+        if (!skipProof(sit, Within::root, 0))
+        {
+            JLOG(j.warn()) << "XPOP.transaction.proof has wrong format";
+            return {};
+        }
+        xpop.proof = Slice(
+            blob.data() + proofStart,
+            blob.size() - sit.getBytesLeft() - proofStart);
+
+        xpop.unlPublicKey = sit.getSlice(sit.getVLDataLength());
+        xpop.unlManifest = sit.getSlice(sit.getVLDataLength());
+        xpop.unlBlob = sit.getSlice(sit.getVLDataLength());
+        xpop.unlSignature = sit.getSlice(sit.getVLDataLength());
+        xpop.unlVersion = sit.get32();
+
+        if (!publicKeyType(xpop.unlPublicKey))
+        {
+            JLOG(j.warn()) << "XPOP.validation.unl.public_key invalid key type";
+            return {};
+        }
+
+        if (!fitsInt(xpop.unlVersion))
+        {
+            JLOG(j.warn()) << "XPOP.validation.unl.version out of range";
+            return {};
+        }
+
+        // every entry takes at least two length bytes
+        auto const count = sit.get32();
+        if (count > static_cast<std::uint32_t>(sit.getBytesLeft()) / 2)
+        {
+            JLOG(j.warn()) << "XPOP.validation.data count out of range";
+            return {};
+        }
+
+        xpop.validations.reserve(count);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            auto const key = sit.getSlice(sit.getVLDataLength());
+            auto const val = sit.getSlice(sit.getVLDataLength());
+
+            if (!publicKeyType(key))
+            {
+                JLOG(j.warn()) << "XPOP.validation.data entry has invalid "
+                                  "key type";
+                return {};
+            }
+
+            xpop.validations.emplace_back(key, val);
+        }
+
+        if (!sit.empty())
+        {
+            JLOG(j.warn()) << "XPOP binary form has trailing bytes";
+            return {};
+        }
+
+        return xpop;
+    }
+    catch (std::exception const&)
+    {
+        JLOG(j.warn()) << "XPOP binary form was truncated";
+    }
+
+    return {};
+}
+
+uint256
+proofRoot(BinaryXPOP const& xpop)
+{
+    SerialIter sit(xpop.proof);
+    return hashProof(sit, 0, true);
+}
+
+std::vector<uint256>
+proofHashes(BinaryXPOP const& xpop)
+{
+    std::vector<uint256> hashes;
+    SerialIter sit(xpop.proof);
+    addHashes(sit, 0, hashes);
+    return hashes;
+}
+
+Json::Value
+toJson(BinaryXPOP const& xpop)
+{
+    Json::Value jv{Json::objectValue};
+
+    auto const& l = xpop.ledger;
+    auto& ledger = jv[jss::ledger] = Json::objectValue;
+    ledger[jss::index] = static_cast<Json::Int>(l.index);
+    ledger[jss::coins] = std::to_string(l.coins);
+    ledger[jss::phash] = strHex(l.phash);
+    ledger[jss::txroot] = strHex(l.txroot);
+    ledger[jss::acroot] = strHex(l.acroot);
+    ledger[jss::pclose] = static_cast<Json::Int>(l.pclose);
+    ledger[jss::close] = static_cast<Json::Int>(l.close);
+    ledger[jss::cres] = static_cast<Json::Int>(l.cres);
+    ledger[jss::flags] = static_cast<Json::Int>(l.flags);
+
+    auto& txn = jv[jss::transaction] = Json::objectValue;
+    txn[jss::blob] = strHex(xpop.txn);
+    txn[jss::meta] = strHex(xpop.meta);
+    SerialIter sit(xpop.proof);
+    txn[jss::proof] = proofJson(sit);
+
+    auto& validation = jv[jss::validation] = Json::objectValue;
+
+    auto& data = validation[jss::data] = Json::objectValue;
+    for (auto const& [key, val] : xpop.validations)
+        data[toBase58(TokenType::NodePublic, PublicKey(key))] = strHex(val);
+
+    auto& unl = validation[jss::unl] = Json::objectValue;
+    unl[jss::public_key] = strHex(xpop.unlPublicKey);
+    unl[jss::manifest] =
+        base64_encode(xpop.unlManifest.data(), xpop.unlManifest.size());
+    unl[jss::blob] = base64_encode(xpop.unlBlob.data(), xpop.unlBlob.size());
+    unl[jss::signature] = strHex(xpop.unlSignature);
+    unl[jss::version] = static_cast<Json::Int>(xpop.unlVersion);
+
+    return jv;
+}
+
+std::optional<Blob>
+toBinaryXPOP(Json::Value const& xpop)
+{
+    try
+    {
+        if (!xpop.isObject() || !xpop[jss::ledger].isObject() ||
+            !xpop[jss::transaction].isObject() ||
+            !xpop[jss::validation].isObject() ||
+            !xpop[jss::validation][jss::data].isObject() ||
+            !xpop[jss::validation][jss::unl].isObject())
+            return {};
+
+        auto const& ledger = xpop[jss::ledger];
+        auto const& txn = xpop[jss::transaction];
+        auto const& data = xpop[jss::validation][jss::data];
+        auto const& unl = xpop[jss::validation][jss::unl];
+
+        auto const u32 =
+            [](Json::Value const& v) -> std::optional<std::uint32_t> {
+            if (!v.isInt() || v.asInt() < 0)
+                return {};
+            return v.asInt();
+        };
+
+        // read the way Import reads it
+        auto const u64 =
+            [](Json::Value const& v) -> std::optional<std::uint64_t> {
+            if (!v.isInt() && !v.isString())
+                return {};
+
+            auto const str = v.asString();
+            std::uint64_t result;
+            auto const [_, ec] =
+                std::from_chars(str.data(), str.data() + str.size(), result);
+            if (ec != std::errc())
+                return {};
+            return result;
+        };
+
+        auto const index = u32(ledger[jss::index]);
+        auto const coins = u64(ledger[jss::coins]);
+        auto const pclose = u32(ledger[jss::pclose]);
+        auto const close = u32(ledger[jss::close]);
+        auto const cres = u32(ledger[jss::cres]);
+        auto const flags = u32(ledger[jss::flags]);
+        uint256 phash;
+        uint256 txroot;
+        uint256 acroot;
+        if (!index || !coins || !pclose || !close || !cres || *cres > 0xFF ||
+            !flags || *flags > 0xFF ||
+            !phash.parseHex(ledger[jss::phash].asString()) ||
+            !txroot.parseHex(ledger[jss::txroot].asString()) ||
+            !acroot.parseHex(ledger[jss::acroot].asString()))
+            return {};
+
+        auto const blob = strUnHex(txn[jss::blob].asString());
+        auto const meta = strUnHex(txn[jss::meta].asString());
+        auto const unlKey = strUnHex(unl[jss::public_key].asString());
+        auto const unlSig = strUnHex(unl[jss::signature].asString());
+        auto const unlVersion = u32(unl[jss::version]);
+        if (!blob || !meta || !unlKey || !unlSig || !unlVersion ||
+            !unl[jss::manifest].isString() || !unl[jss::blob].isString())
+            return {};
+
+        Serializer s;
+        s.addRaw(magic.data(), magic.size());
+        s.add8(BinaryXPOP::version);
+
+        s.add32(*index);
+        s.add64(*coins);
+        s.addBitString(phash);
+        s.addBitString(txroot);
+        s.addBitString(acroot);
+        s.add32(*pclose);
+        s.add32(*close);
+        s.add8(*cres);
+        s.add8(*flags);
+
+        s.addVL(*blob);
+        s.addVL(*meta);
+        if (!addProof(s, txn[jss::proof], Within::root, 0))
+            return {};
+
+        s.addVL(*unlKey);
+        s.addVL(makeSlice(base64_decode(unl[jss::manifest].asString())));
+        s.addVL(makeSlice(base64_decode(unl[jss::blob].asString())));
+        s.addVL(*unlSig);
+        s.add32(*unlVersion);
+
+        auto const names = data.getMemberNames();
+        s.add32(names.size());
+        for (auto const& name : names)
+        {
+            auto const key =
+                parseBase58<PublicKey>(TokenType::NodePublic, name);
+            auto const val = data[name].isString()
+                ? strUnHex(data[name].asString())
+                : std::nullopt;
+            if (!key || !val)
+                return {};
+
+            s.addVL(key->slice());
+            s.addVL(*val);
+        }
+
+        return s.getData();
+    }
+    catch (std::exception const&)
+    {
+    }
+
+    return {};
+}
+
+}  // namespace ripple
@@ -213,6 +213,8 @@ JSS(both_sides);             // in: Subscribe, Unsubscribe
 JSS(broadcast);              // out: SubmitTransaction
 JSS(build_path);             // in: TransactionSign
 JSS(build_version);          // out: NetworkOPs
+JSS(bytes);                  // out: HookProfile
+JSS(calls);                  // out: HookProfile
 JSS(cancel_after);           // out: AccountChannels
 JSS(can_delete);             // out: CanDelete
 JSS(changes);                // out: BookChanges
@@ -220,6 +222,7 @@ JSS(channel_id);             // out: AccountChannels
 JSS(channels);               // out: AccountChannels
 JSS(check);                  // in: AccountObjects
 JSS(check_nodes);            // in: LedgerCleaner
+JSS(chunk);                  // out: AccountNamespace
 JSS(clear);                  // in/out: FetchInfo
 JSS(close);                  // out: BookChanges
 JSS(close_flags);            // out: LedgerToJson
@@ -302,7 +305,9 @@ JSS(error_exception);       // out: Submit
 JSS(error_message);         // out: error
 JSS(escrow);                // in: LedgerEntry
 JSS(emitted_txn);           // in: LedgerEntry
+JSS(emitted_txns);          // out: HookDryRun
 JSS(expand);                // in: handler/Ledger
+JSS(executions);            // out: HookProfile
 JSS(expected_date);         // out: any (warnings)
 JSS(expected_date_UTC);     // out: any (warnings)
 JSS(expected_ledger_size);  // out: TxQ
@@ -334,6 +339,7 @@ JSS(frozen_balances);       // out: GatewayBalances
 JSS(full);                  // in: LedgerClearer, handlers/Ledger
 JSS(full_reply);            // out: PathFind
 JSS(fullbelow_size);        // out: GetCounts
+JSS(functions);             // out: HookProfile
 JSS(good);                  // out: RPCVersion
 JSS(hash);                  // out: NetworkOPs, InboundLedger,
                             //      LedgerToJson, STTx; field
@@ -347,7 +353,21 @@ JSS(highest_ticket);        // out: AccountInfo
 JSS(historical_perminute);  // historical_perminute.
 JSS(hook);                  // in: LedgerEntry
 JSS(hook_definition);       // in: LedgerEntry
+JSS(hook_executions);       // out: HookDryRun
+JSS(hook_hash);             // out: hook_traces stream
+JSS(hook_module_cache_size);  // out: GetCounts
+JSS(hook_module_evictions);   // out: GetCounts
+JSS(hook_module_hit_rate);    // out: GetCounts
 JSS(hook_state);            // in: LedgerEntry
+JSS(hook_state_changes);    // out: HookDryRun
+JSS(hook_state_prefetch_hit_rate);  // out: GetCounts
+JSS(hook_state_prefetches);         // out: GetCounts
+JSS(hook_traces);                   // out: HookDryRun
+JSS(hook_validation_cache_size);    // out: GetCounts
+JSS(hook_validation_hit_rate);      // out: GetCounts
+JSS(hooks);                 // out: HookProfile
+JSS(host_calls);            // out: HookProfile
+JSS(host_duration_us);      // out: HookProfile
 JSS(hostid);                // out: NetworkOPs
 JSS(hotwallet);             // in: GatewayBalances
 JSS(id);                    // websocket.
@@ -363,6 +383,7 @@ JSS(index);    // in: LedgerEntry, DownloadShard
                //      LedgerEntry, TxHistory, LedgerData
 JSS(info);     // out: ServerInfo, ConsensusInfo, FetchInfo
 JSS(initial_sync_duration_us);
+JSS(instructions);         // out: HookProfile
 JSS(internal_command);     // in: Internal
 JSS(invalid_API_version);  // out: Many, when a request has an invalid
                            //      version
@@ -515,6 +536,7 @@ JSS(open);                       // out: handlers/Ledger
 JSS(open_ledger_cost);           // out: SubmitTransaction
 JSS(open_ledger_fee);            // out: TxQ
 JSS(open_ledger_level);          // out: TxQ
+JSS(otxn_account);               // out: hook_traces stream
 JSS(owner);                      // in: LedgerEntry, out: NetworkOPs
 JSS(owner_funds);                // in/out: Ledger, NetworkOPs, AcceptedLedgerTx
 JSS(page_index);
@@ -633,6 +655,7 @@ JSS(status);                // error
 JSS(stop);                  // in: LedgerCleaner
 JSS(stop_history_tx_only);  // in: Unsubscribe, stop history tx stream
 JSS(storedSeqs);            // out: NodeToShardStatus
+JSS(stream);                // in: AccountNamespace
 JSS(streams);               // in: Subscribe, Unsubscribe
 JSS(strict);                // in: AccountCurrencies, AccountInfo
 JSS(sub_index);             // in: LedgerEntry
@@ -743,6 +766,8 @@ JSS(warning);          // rpc:
 JSS(warnings);         // out: server_info, server_state
 JSS(workers);
 JSS(write_load);   // out: GetCounts
+JSS(xpop);         // out: XPOP
+JSS(xpops);        // out: XPOP
 JSS(NegativeUNL);  // out: ValidatorList; ledger type
 #undef JSS
 
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_XPOPBUILDER_H_INCLUDED
+#define RIPPLE_RPC_XPOPBUILDER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <ripple/shamap/SHAMapNodeID.h>
+#include <map>
+#include <optional>
+
+namespace ripple {
+
+class SHAMap;
+struct LedgerInfo;
+
+namespace RPC {
+
+/**
+   Builds the transaction section of XPOPs for transactions in one ledger.
+
+   The proof of a transaction is the list form Import checks: at every level
+   from the root down, the sixteen child hashes of the inner node the path
+   passes through, with the child on the path replaced by the list one level
+   down. The deepest list holds the hash of the leaf itself.
+
+   Transactions in the same ledger share the top of their paths, so the child
+   hashes of an inner node are read once, the first time a path passes
+   through it, and reused for every later transaction. The nodes are read
+   from the map as they are, nothing is serialized.
+ */
+class XPOPProofs
+{
+    SHAMap const& txMap_;
+
+    // the child hashes of each inner node a path went through, as hex
+    std::map<SHAMapNodeID, Json::Value> inner_;
+
+public:
+    explicit XPOPProofs(SHAMap const& txMap);
+
+    /** The blob, meta and proof of a transaction, or nothing if the
+        transaction is not in the map.
+    */
+    std::optional<Json::Value>
+    transaction(uint256 const& txID);
+
+    /** The number of inner nodes read so far. */
+    std::size_t
+    innerNodes() const
+    {
+        return inner_.size();
+    }
+};
+
+/** The ledger section of an XPOP for transactions in the given ledger. */
+Json::Value
+xpopLedger(LedgerInfo const& info);
+
+}  // namespace RPC
+}  // namespace ripple
+
+#endif
@@ -27,9 +27,12 @@
 #include <ripple/protocol/jss.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/NamespaceStream.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 #include <ripple/rpc/impl/Tuning.h>
+#include <ripple/rpc/impl/WSInfoSub.h>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -44,7 +47,14 @@ namespace ripple {
       ledger_index: <string | unsigned integer> // optional
       limit: <integer> // optional
       marker: <opaque> // optional, resume previous query
+      stream: <bool> // optional, websocket only
+      binary: <bool> // optional, with stream
     }
+
+    With stream set, the result only names the ledger; the entries follow as
+    messages of type accountNamespace, each with up to limit entries, a chunk
+    number and the marker to resume from. The last chunk has no marker. A
+    namespace which does not exist is streamed as a single empty chunk.
 */
 
 Json::Value
@@ -84,7 +94,10 @@ doAccountNamespace(RPC::JsonContext& context)
     if (!ledger->exists(keylet::account(accountID)))
         return rpcError(rpcACT_NOT_FOUND);
 
-    if (!ledger->exists(keylet::hookStateDir(accountID, nsID)))
+    bool const stream =
+        params.isMember(jss::stream) && params[jss::stream].asBool();
+
+    if (!stream && !ledger->exists(keylet::hookStateDir(accountID, nsID)))
         return rpcError(rpcNAMESPACE_NOT_FOUND);
 
     unsigned int limit;
@@ -114,6 +127,54 @@ doAccountNamespace(RPC::JsonContext& context)
             return RPC::invalid_field_error(jss::marker);
     }
 
+    if (stream)
+    {
+        if (!isUnlimited(context.role))
+            return rpcError(rpcNO_PERMISSION);
+
+        auto const ws = std::dynamic_pointer_cast<WSInfoSub>(context.infoSub);
+        if (!ws)
+            return rpcError(rpcNOT_SUPPORTED);
+
+        // only a marker can name a position which isn't in the namespace
+        auto cursor = RPC::NamespaceCursor::start(
+            ledger, accountID, nsID, dirIndex, entryIndex);
+        if (!cursor)
+            return RPC::invalid_field_error(jss::marker);
+
+        Json::Value header{Json::objectValue};
+        header[jss::type] = "accountNamespace";
+        if (params.isMember(jss::id))
+            header[jss::id] = params[jss::id];
+        header[jss::account] = toBase58(accountID);
+        header[jss::namespace_id] = ns;
+        header[jss::ledger_hash] = to_string(ledger->info().hash);
+        header[jss::ledger_index] = ledger->info().seq;
+
+        // a chunk per limit entries, however much an unlimited caller asked
+        // for
+        limit = std::clamp(
+            limit,
+            RPC::Tuning::accountObjects.rmin,
+            RPC::Tuning::accountObjects.rmax);
+
+        // the chunks follow the response
+        ws->afterResponse(
+            [chunks = std::make_shared<RPC::NamespaceStream>(
+                 context.app,
+                 ws->session(),
+                 std::move(*cursor),
+                 std::move(header),
+                 limit,
+                 params[jss::binary].asBool())]() { chunks->pump(); });
+
+        result[jss::account] = toBase58(accountID);
+        result[jss::namespace_id] = ns;
+        result[jss::limit] = limit;
+        context.loadType = Resource::feeHighBurdenRPC;
+        return result;
+    }
+
     if (!RPC::getAccountNamespace(
             *ledger, accountID, nsID, dirIndex, entryIndex, limit, result))
     {
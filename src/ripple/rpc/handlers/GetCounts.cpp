@@ -17,6 +17,9 @@
 */
 //==============================================================================
 
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/app/hook/StatePrefetcher.h>
+#include <ripple/app/hook/ValidationCache.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
@@ -111,6 +114,22 @@ getCountsJson(Application& app, int minObjectCount)
     ret[jss::ledger_hit_rate] = app.getLedgerMaster().getCacheHitRate();
     ret[jss::AL_size] = Json::UInt(app.getAcceptedLedgerCache().size());
     ret[jss::AL_hit_rate] = app.getAcceptedLedgerCache().getHitRate();
+    ret[jss::hook_module_cache_size] =
+        Json::UInt(app.getHookModuleCache().size());
+    ret[jss::hook_module_hit_rate] = app.getHookModuleCache().getHitRate();
+    ret[jss::hook_module_evictions] =
+        std::to_string(app.getHookModuleCache().evictions());
+    ret[jss::hook_validation_cache_size] =
+        Json::UInt(app.getHookValidationCache().size());
+    ret[jss::hook_validation_hit_rate] =
+        app.getHookValidationCache().getHitRate();
+    if (auto const& prefetcher = app.getHookStatePrefetcher();
+        prefetcher.enabled())
+    {
+        ret[jss::hook_state_prefetches] =
+            std::to_string(prefetcher.prefetches());
+        ret[jss::hook_state_prefetch_hit_rate] = prefetcher.getHitRate();
+    }
 
     ret[jss::fullbelow_size] =
         static_cast<int>(app.getNodeFamily().getFullBelowCache(0)->size());
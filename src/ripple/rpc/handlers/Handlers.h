@@ -73,6 +73,10 @@ doGatewayBalances(RPC::JsonContext&);
 Json::Value
 doGetCounts(RPC::JsonContext&);
 Json::Value
+doHookDryRun(RPC::JsonContext&);
+Json::Value
+doHookProfile(RPC::JsonContext&);
+Json::Value
 doLedgerAccept(RPC::JsonContext&);
 Json::Value
 doLedgerCleaner(RPC::JsonContext&);
@@ -170,6 +174,8 @@ Json::Value
 doValidatorListSites(RPC::JsonContext&);
 Json::Value
 doValidatorInfo(RPC::JsonContext&);
+Json::Value
+doXPOP(RPC::JsonContext&);
 }  // namespace ripple
 
 #endif
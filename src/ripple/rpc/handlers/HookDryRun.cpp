@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/TraceSink.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/net/RPCErr.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STTx.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/resource/Fees.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/impl/RPCHelpers.h>
+#include <chrono>
+
+namespace ripple {
+
+namespace {
+
+// a dry run which waited longer than this for a thread is dropped: the
+// client has likely given up on it and the queue is busy
+constexpr std::chrono::seconds hookDryRunQueueLimit{5};
+
+Json::Value
+hookDryRun(
+    Application& app,
+    std::shared_ptr<ReadView const> const& ledger,
+    STTx const& tx)
+{
+    // an open ledger takes the transaction after its own, a closed one as
+    // the first of its successor
+    auto view = ledger->open()
+        ? OpenView(&*ledger, ledger)
+        : OpenView(open_ledger, &*ledger, ledger->rules(), ledger);
+
+    // the traces are returned to the client rather than published
+    hook::TraceSink::Capture traces;
+    auto const [ter, applied] =
+        apply(app, view, tx, tapDRY_RUN, app.journal("HookDryRun"));
+
+    Json::Value jvResult{Json::objectValue};
+    std::string token;
+    std::string human;
+    transResultInfo(ter, token, human);
+    jvResult[jss::engine_result] = token;
+    jvResult[jss::engine_result_code] = TERtoInt(ter);
+    jvResult[jss::engine_result_message] = human;
+    jvResult[jss::applied] = applied;
+    jvResult[jss::ledger_index] = view.info().seq;
+
+    auto& executions = jvResult[jss::hook_executions] = Json::arrayValue;
+    auto& stateChanges = jvResult[jss::hook_state_changes] = Json::arrayValue;
+    auto& emitted = jvResult[jss::emitted_txns] = Json::arrayValue;
+
+    for (auto const& [_, meta] : view.txs)
+    {
+        if (!meta)
+            continue;
+
+        if (meta->isFieldPresent(sfHookExecutions))
+            for (auto const& execution : meta->getFieldArray(sfHookExecutions))
+                executions.append(execution.getJson(JsonOptions::none));
+
+        for (auto const& node : meta->getFieldArray(sfAffectedNodes))
+            if (node.getFieldU16(sfLedgerEntryType) == ltHOOK_STATE)
+            {
+                Json::Value& change = stateChanges.append(Json::objectValue);
+                change[node.getFName().getJsonName()] =
+                    node.getJson(JsonOptions::none);
+            }
+
+        if (meta->isFieldPresent(sfHookEmissions))
+            for (auto const& emission : meta->getFieldArray(sfHookEmissions))
+                if (auto const sle = view.read(keylet::emittedTxn(
+                        emission.getFieldH256(sfEmittedTxnID))))
+                    emitted.append(sle->peekAtField(sfEmittedTxn)
+                                       .getJson(JsonOptions::none));
+    }
+
+    auto& jvTraces = jvResult[jss::hook_traces] = Json::arrayValue;
+    for (auto const& record : traces.records())
+        jvTraces.append(hook::TraceSink::json(record));
+
+    return jvResult;
+}
+
+}  // namespace
+
+// {
+//   tx_blob: <signed transaction, hex>
+//   ledger_hash: <ledger>     // optional, the snapshot to run against;
+//   ledger_index: <ledger>    // default: current
+// }
+//
+// Applies the transaction to a throwaway view of the ledger and returns what
+// its strong and weak hook chains did: each execution's result, return code
+// and string and instruction count, the hook state it changed, the
+// transactions it emitted and the traces it made. Nothing is committed, and
+// nothing outside the view is touched: the traces are not logged or sent to
+// the hook_traces stream, and the run is not profiled.
+//
+// Hooks are bounded by their instruction budget. Dry runs have their own job
+// type, which caps how many run at once and how long one may wait for a
+// thread.
+Json::Value
+doHookDryRun(RPC::JsonContext& context)
+{
+    context.loadType = Resource::feeHighBurdenRPC;
+
+    if (!context.params.isMember(jss::tx_blob))
+        return RPC::missing_field_error(jss::tx_blob);
+
+    auto const blob = strUnHex(context.params[jss::tx_blob].asString());
+    if (!blob || blob->empty())
+        return RPC::invalid_field_error(jss::tx_blob);
+
+    std::shared_ptr<STTx const> stpTrans;
+    try
+    {
+        SerialIter sitTrans(makeSlice(*blob));
+        stpTrans = std::make_shared<STTx const>(std::ref(sitTrans));
+    }
+    catch (std::exception& e)
+    {
+        Json::Value jvResult;
+        jvResult[jss::error] = "invalidTransaction";
+        jvResult[jss::error_exception] = e.what();
+        return jvResult;
+    }
+
+    std::shared_ptr<ReadView const> ledger;
+    auto jvResult = RPC::lookupLedger(ledger, context);
+    if (!ledger)
+        return jvResult;
+
+    // run on the dry run job and resume this coroutine with the result
+    // once done; see doRipplePathFind for how the two hand over
+    auto const queued = std::chrono::steady_clock::now();
+    bool const added = context.app.getJobQueue().addJob(
+        jtHOOK_DRY_RUN,
+        "HookDryRun",
+        [&app = context.app,
+         &jvResult,
+         ledger,
+         stpTrans,
+         queued,
+         coro = context.coro]() {
+            if (std::chrono::steady_clock::now() - queued >
+                hookDryRunQueueLimit)
+                jvResult = rpcError(rpcTOO_BUSY);
+            else
+                jvResult = hookDryRun(app, ledger, *stpTrans);
+
+            if (!coro->post())
+                coro->resume();
+        });
+
+    if (!added)
+        return rpcError(rpcTOO_BUSY);
+
+    context.coro->yield();
+    return jvResult;
+}
+
+}  // namespace ripple
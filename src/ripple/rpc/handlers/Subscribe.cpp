@@ -172,6 +172,14 @@ doSubscribe(RPC::JsonContext& context)
                     return rpcError(rpcREPORTING_UNSUPPORTED);
                 context.netOps.subConsensus(ispSub);
             }
+            else if (streamName == "hook_traces")
+            {
+                if (context.app.config().reporting())
+                    return rpcError(rpcREPORTING_UNSUPPORTED);
+                if (context.role != Role::ADMIN)
+                    return rpcError(rpcNO_PERMISSION);
+                context.netOps.subHookTraces(ispSub);
+            }
             else
             {
                 return rpcError(rpcSTREAM_MALFORMED);
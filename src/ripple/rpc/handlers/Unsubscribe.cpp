@@ -102,6 +102,10 @@ doUnsubscribe(RPC::JsonContext& context)
             {
                 context.netOps.unsubConsensus(ispSub->getSeq());
             }
+            else if (streamName == "hook_traces")
+            {
+                context.netOps.unsubHookTraces(ispSub->getSeq());
+            }
             else
             {
                 return rpcError(rpcSTREAM_MALFORMED);
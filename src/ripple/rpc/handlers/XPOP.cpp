@@ -0,0 +1,254 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/consensus/RCLValidations.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/TransactionMaster.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/misc/Manifest.h>
+#include <ripple/app/misc/Transaction.h>
+#include <ripple/app/misc/ValidatorList.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/BinaryXPOP.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+#include <ripple/rpc/XPOPBuilder.h>
+#include <map>
+
+namespace ripple {
+
+namespace {
+
+// the most transactions one request may ask for
+constexpr std::size_t maxXPOPTransactions = 256;
+
+bool
+isValidated(LedgerMaster& ledgerMaster, std::uint32_t seq, uint256 const& hash)
+{
+    if (!ledgerMaster.haveLedger(seq))
+        return false;
+
+    if (seq > ledgerMaster.getValidatedLedger()->info().seq)
+        return false;
+
+    return ledgerMaster.getHashBySeq(seq) == hash;
+}
+
+// the unl section: the list of the given publisher, or of the first one
+// with a list available
+std::optional<Json::Value>
+xpopUNL(ValidatorList& validators, std::optional<std::string> publisher)
+{
+    if (!publisher)
+    {
+        validators.for_each_available(
+            [&](std::string const&,
+                std::uint32_t,
+                std::map<std::size_t, ValidatorBlobInfo> const&,
+                PublicKey const& pubKey,
+                std::size_t,
+                uint256 const&) {
+                if (!publisher)
+                    publisher = strHex(pubKey);
+            });
+        if (!publisher)
+            return {};
+    }
+
+    // Import reads the version 1 layout: one blob and its signature
+    auto list = validators.getAvailable(*publisher, 1);
+    if (!list || !list->isObject())
+        return {};
+
+    Json::Value unl{Json::objectValue};
+    unl[jss::public_key] = (*list)[jss::public_key];
+    unl[jss::manifest] = (*list)[jss::manifest];
+    unl[jss::blob] = (*list)[jss::blob];
+    unl[jss::signature] = (*list)[jss::signature];
+    unl[jss::version] = 1;
+    return unl;
+}
+
+// the data section: the trusted validations this server holds for the
+// ledger, each under the master key of its validator
+Json::Value
+xpopValidations(Application& app, LedgerInfo const& info)
+{
+    Json::Value data{Json::objectValue};
+    for (auto const& val :
+         app.getValidations().getTrustedForLedger(info.hash, info.seq))
+    {
+        auto const master =
+            app.validatorManifests().getMasterKey(val->getSignerPublic());
+        data[toBase58(TokenType::NodePublic, master)] =
+            strHex(val->getSerialized());
+    }
+    return data;
+}
+
+}  // namespace
+
+// {
+//   tx_hash: <transaction hash>
+//   | transactions: [<transaction hash>, ...]
+//   pubkey_publisher: <hex public key>  // optional, the validator list to
+//                                       // attach; default: the first one
+//   binary: <bool>                      // optional, the compact binary form
+// }
+//
+// Builds XPOPs for transactions in validated ledgers. Transactions in the
+// same ledger are proven together: the ledger, its validations and the
+// inner nodes their proofs share are looked up once.
+Json::Value
+doXPOP(RPC::JsonContext& context)
+{
+    auto const& params = context.params;
+
+    bool const single = params.isMember(jss::tx_hash);
+    if (single == params.isMember(jss::transactions))
+        return RPC::make_param_error(
+            "Specify exactly one of tx_hash and transactions.");
+
+    std::vector<uint256> hashes;
+    if (single)
+    {
+        if (!params[jss::tx_hash].isString() ||
+            !hashes.emplace_back().parseHex(params[jss::tx_hash].asString()))
+            return RPC::invalid_field_error(jss::tx_hash);
+    }
+    else
+    {
+        auto const& txs = params[jss::transactions];
+        if (!txs.isArray() || txs.size() == 0 ||
+            txs.size() > maxXPOPTransactions)
+            return RPC::invalid_field_error(jss::transactions);
+
+        for (auto const& tx : txs)
+            if (!tx.isString() ||
+                !hashes.emplace_back().parseHex(tx.asString()))
+                return RPC::invalid_field_error(jss::transactions);
+    }
+
+    std::optional<std::string> publisher;
+    if (params.isMember(jss::pubkey_publisher))
+    {
+        if (!params[jss::pubkey_publisher].isString())
+            return RPC::invalid_field_error(jss::pubkey_publisher);
+        publisher = params[jss::pubkey_publisher].asString();
+    }
+
+    bool const binary =
+        params.isMember(jss::binary) && params[jss::binary].asBool();
+
+    auto const unl = xpopUNL(context.app.validators(), publisher);
+    if (!unl)
+        return RPC::make_error(
+            rpcNOT_READY, "No validator list available from the publisher.");
+
+    std::vector<Json::Value> entries(hashes.size());
+
+    // transactions by the validated ledger they are in
+    std::map<std::uint32_t, std::vector<std::size_t>> byLedger;
+    for (std::size_t i = 0; i < hashes.size(); ++i)
+    {
+        entries[i] = Json::objectValue;
+
+        auto ec{rpcSUCCESS};
+        auto const v = context.app.getMasterTransaction().fetch(hashes[i], ec);
+        auto const found = std::get_if<
+            std::pair<std::shared_ptr<Transaction>, std::shared_ptr<TxMeta>>>(
+            &v);
+        if (!found || !found->first || found->first->getLedger() == 0)
+        {
+            RPC::inject_error(rpcTXN_NOT_FOUND, entries[i]);
+            continue;
+        }
+
+        byLedger[found->first->getLedger()].push_back(i);
+    }
+
+    for (auto const& [seq, indexes] : byLedger)
+    {
+        auto const ledger = context.ledgerMaster.getLedgerBySeq(seq);
+        if (!ledger ||
+            !isValidated(context.ledgerMaster, seq, ledger->info().hash))
+        {
+            for (auto const i : indexes)
+                RPC::inject_error(rpcLGR_NOT_VALIDATED, entries[i]);
+            continue;
+        }
+
+        Json::Value validation{Json::objectValue};
+        validation[jss::data] = xpopValidations(context.app, ledger->info());
+        validation[jss::unl] = *unl;
+        if (validation[jss::data].size() == 0)
+        {
+            for (auto const i : indexes)
+                RPC::inject_error(
+                    rpcLGR_NOT_VALIDATED,
+                    "No validations stored for the ledger.",
+                    entries[i]);
+            continue;
+        }
+
+        auto const lgr = RPC::xpopLedger(ledger->info());
+        RPC::XPOPProofs proofs(ledger->txMap());
+
+        for (auto const i : indexes)
+        {
+            auto txn = proofs.transaction(hashes[i]);
+            if (!txn)
+            {
+                RPC::inject_error(rpcTXN_NOT_FOUND, entries[i]);
+                continue;
+            }
+
+            Json::Value xpop{Json::objectValue};
+            xpop[jss::ledger] = lgr;
+            xpop[jss::transaction] = std::move(*txn);
+            xpop[jss::validation] = validation;
+
+            entries[i][jss::ledger_index] = seq;
+            if (!binary)
+                entries[i][jss::xpop] = std::move(xpop);
+            else if (auto const blob = toBinaryXPOP(xpop))
+                entries[i][jss::xpop] = strHex(*blob);
+            else
+                RPC::inject_error(rpcINTERNAL, entries[i]);
+        }
+    }
+
+    if (single)
+    {
+        entries[0][jss::hash] = to_string(hashes[0]);
+        return std::move(entries[0]);
+    }
+
+    Json::Value result{Json::objectValue};
+    auto& xpops = result[jss::xpops] = Json::arrayValue;
+    for (std::size_t i = 0; i < hashes.size(); ++i)
+    {
+        entries[i][jss::hash] = to_string(hashes[i]);
+        xpops.append(std::move(entries[i]));
+    }
+    return result;
+}
+
+}  // namespace ripple
@@ -0,0 +1,263 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerToJson.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/impl/NamespaceStream.h>
+#include <ripple/server/WSSession.h>
+#include <boost/beast/core/multi_buffer.hpp>
+#include <algorithm>
+
+namespace ripple {
+namespace RPC {
+
+namespace {
+
+// a chunk, which tells the stream once the session starts writing the last
+// of it
+class ChunkMsg : public StreambufWSMsg<boost::beast::multi_buffer>
+{
+    std::function<void()> onSent_;
+
+public:
+    ChunkMsg(boost::beast::multi_buffer&& sb, std::function<void()> onSent)
+        : StreambufWSMsg(std::move(sb)), onSent_(std::move(onSent))
+    {
+    }
+
+    std::pair<boost::tribool, std::vector<boost::asio::const_buffer>>
+    prepare(std::size_t bytes, std::function<void(void)> resume) override
+    {
+        auto result = StreambufWSMsg::prepare(bytes, std::move(resume));
+        if (static_cast<bool>(result.first) && onSent_)
+            std::exchange(onSent_, nullptr)();
+        return result;
+    }
+};
+
+}  // namespace
+
+NamespaceCursor::NamespaceCursor(
+    std::shared_ptr<ReadView const> ledger,
+    Keylet const& root,
+    uint256 const& dirIndex,
+    std::shared_ptr<SLE const> dir,
+    std::size_t pos)
+    : ledger_(std::move(ledger))
+    , root_(root)
+    , dirIndex_(dirIndex)
+    , dir_(std::move(dir))
+    , pos_(pos)
+{
+    settle();
+}
+
+std::optional<NamespaceCursor>
+NamespaceCursor::start(
+    std::shared_ptr<ReadView const> ledger,
+    AccountID const& account,
+    uint256 const& ns,
+    uint256 const& dirIndex,
+    uint256 const& entryIndex)
+{
+    auto const root = keylet::hookStateDir(account, ns);
+
+    if (dirIndex.isZero())
+    {
+        auto dir = ledger->read(root);
+        return NamespaceCursor(
+            std::move(ledger), root, root.key, std::move(dir), 0);
+    }
+
+    auto dir = ledger->read({ltDIR_NODE, dirIndex});
+    if (!dir || dir->getFieldH256(sfRootIndex) != root.key)
+        return {};
+
+    auto const& indexes = dir->getFieldV256(sfIndexes);
+    auto const it = std::find(indexes.begin(), indexes.end(), entryIndex);
+    if (it == indexes.end())
+        return {};
+
+    auto const pos = std::distance(indexes.begin(), it);
+    return NamespaceCursor(
+        std::move(ledger), root, dirIndex, std::move(dir), pos);
+}
+
+void
+NamespaceCursor::settle()
+{
+    while (dir_ && pos_ >= dir_->getFieldV256(sfIndexes).size())
+    {
+        auto const next = dir_->getFieldU64(sfIndexNext);
+        if (next == 0)
+        {
+            dir_.reset();
+            return;
+        }
+
+        dirIndex_ = keylet::page(root_, next).key;
+        dir_ = ledger_->read({ltDIR_NODE, dirIndex_});
+        pos_ = 0;
+    }
+}
+
+std::optional<std::string>
+NamespaceCursor::marker() const
+{
+    if (!dir_)
+        return {};
+    return to_string(dirIndex_) + ',' +
+        to_string(dir_->getFieldV256(sfIndexes)[pos_]);
+}
+
+std::uint32_t
+NamespaceCursor::read(std::uint32_t limit, bool binary, Json::Value& entries)
+{
+    std::uint32_t n = 0;
+    while (dir_ && n < limit)
+    {
+        auto const sle =
+            ledger_->read(keylet::child(dir_->getFieldV256(sfIndexes)[pos_]));
+        ++pos_;
+        settle();
+
+        if (!sle)
+            continue;
+
+        if (binary)
+        {
+            Json::Value& entry = entries.append(Json::objectValue);
+            entry[jss::data] = serializeHex(*sle);
+            entry[jss::index] = to_string(sle->key());
+        }
+        else
+            entries.append(sle->getJson(JsonOptions::none));
+        ++n;
+    }
+    return n;
+}
+
+NamespaceStream::NamespaceStream(
+    Application& app,
+    std::weak_ptr<WSSession> session,
+    NamespaceCursor cursor,
+    Json::Value header,
+    std::uint32_t limit,
+    bool binary)
+    : app_(app)
+    , session_(std::move(session))
+    , cursor_(std::move(cursor))
+    , header_(std::move(header))
+    , limit_(limit)
+    , binary_(binary)
+{
+}
+
+void
+NamespaceStream::pump()
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (running_ || done_ || inFlight_ >= window)
+            return;
+        running_ = true;
+    }
+
+    if (!app_.getJobQueue().addJob(
+            jtCLIENT_WEBSOCKET,
+            "NamespaceStream",
+            [self = shared_from_this()]() { self->produce(); }))
+    {
+        // shutting down
+        std::lock_guard lock(mutex_);
+        running_ = false;
+        done_ = true;
+    }
+}
+
+void
+NamespaceStream::produce()
+{
+    for (;;)
+    {
+        std::uint32_t chunk;
+        {
+            std::lock_guard lock(mutex_);
+            if (done_ || inFlight_ >= window)
+            {
+                running_ = false;
+                return;
+            }
+            ++inFlight_;
+            chunk = chunks_++;
+        }
+
+        auto const session = session_.lock();
+        if (!session)
+        {
+            std::lock_guard lock(mutex_);
+            running_ = false;
+            done_ = true;
+            return;
+        }
+
+        Json::Value jv = header_;
+        jv[jss::chunk] = chunk;
+        cursor_.read(
+            limit_, binary_, jv[jss::namespace_entries] = Json::arrayValue);
+        if (auto const marker = cursor_.marker())
+            jv[jss::marker] = *marker;
+
+        boost::beast::multi_buffer sb;
+        Json::stream(jv, [&](void const* data, std::size_t n) {
+            sb.commit(boost::asio::buffer_copy(
+                sb.prepare(n), boost::asio::buffer(data, n)));
+        });
+
+        // the message holds the stream, and with it the ledger, until it is
+        // sent or the session drops it
+        session->send(std::make_shared<ChunkMsg>(
+            std::move(sb), [self = shared_from_this()]() { self->sent(); }));
+
+        if (cursor_.done())
+        {
+            std::lock_guard lock(mutex_);
+            running_ = false;
+            done_ = true;
+            return;
+        }
+    }
+}
+
+void
+NamespaceStream::sent()
+{
+    {
+        std::lock_guard lock(mutex_);
+        --inFlight_;
+    }
+    pump();
+}
+
+}  // namespace RPC
+}  // namespace ripple
@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_RPC_NAMESPACESTREAM_H_INCLUDED
+#define RIPPLE_RPC_NAMESPACESTREAM_H_INCLUDED
+
+#include <ripple/json/json_value.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/Keylet.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace ripple {
+
+class Application;
+struct WSSession;
+
+namespace RPC {
+
+/**
+   Walks the entries of a hook state namespace directory, page by page, in
+   the order account_namespace pages through them.
+
+   Positions are the same "<page>,<entry>" markers account_namespace hands
+   out, so a walk can resume where a paged query stopped and the other way
+   round.
+ */
+class NamespaceCursor
+{
+    std::shared_ptr<ReadView const> ledger_;
+    Keylet root_;
+
+    // the page being read, and the next entry on it; no page once the walk
+    // is over
+    uint256 dirIndex_;
+    std::shared_ptr<SLE const> dir_;
+    std::size_t pos_ = 0;
+
+    NamespaceCursor(
+        std::shared_ptr<ReadView const> ledger,
+        Keylet const& root,
+        uint256 const& dirIndex,
+        std::shared_ptr<SLE const> dir,
+        std::size_t pos);
+
+    // move past the end of empty pages
+    void
+    settle();
+
+public:
+    /** Start at an entry of the namespace, or at its first entry if
+        dirIndex is zero. A namespace which does not exist has no entries.
+
+        @return Nothing if the position is not in the namespace.
+    */
+    static std::optional<NamespaceCursor>
+    start(
+        std::shared_ptr<ReadView const> ledger,
+        AccountID const& account,
+        uint256 const& ns,
+        uint256 const& dirIndex = {},
+        uint256 const& entryIndex = {});
+
+    /** Whether every entry has been read. */
+    bool
+    done() const
+    {
+        return !dir_;
+    }
+
+    /** The marker of the next entry, or nothing if done. */
+    std::optional<std::string>
+    marker() const;
+
+    /** Append up to limit entries to entries, as the JSON account_namespace
+        returns or, if binary, as their index and serialized hex.
+
+        @return The number of entries appended.
+    */
+    std::uint32_t
+    read(std::uint32_t limit, bool binary, Json::Value& entries);
+};
+
+/**
+   Sends a namespace to a websocket client, as a series of messages of up to
+   limit entries each.
+
+   Chunks are read from the ledger on the job queue. At most window chunks
+   are waiting in the session's send queue at any time: the next is only
+   read once the client has taken one, so a slow client slows the walk down
+   rather than filling the server's memory or overrunning the queue limit.
+
+   Every chunk carries the marker of the entry after it. A client which
+   loses the connection resumes by asking for the same ledger_hash from the
+   last marker it received.
+ */
+class NamespaceStream : public std::enable_shared_from_this<NamespaceStream>
+{
+public:
+    static constexpr std::size_t window = 4;
+
+private:
+    Application& app_;
+    std::weak_ptr<WSSession> session_;
+    NamespaceCursor cursor_;
+    Json::Value const header_;
+    std::uint32_t const limit_;
+    bool const binary_;
+
+    std::mutex mutex_;
+    std::size_t inFlight_ = 0;
+    std::uint32_t chunks_ = 0;
+    bool running_ = false;
+    bool done_ = false;
+
+    // read chunks until the window is full or the walk is over
+    void
+    produce();
+
+    void
+    sent();
+
+public:
+    /** @param header The fields every chunk starts with. */
+    NamespaceStream(
+        Application& app,
+        std::weak_ptr<WSSession> session,
+        NamespaceCursor cursor,
+        Json::Value header,
+        std::uint32_t limit,
+        bool binary);
+
+    /** Schedule reading the next chunks, unless already scheduled or the
+        window is full.
+    */
+    void
+    pump();
+};
+
+}  // namespace RPC
+}  // namespace ripple
+
+#endif
@@ -352,6 +352,8 @@ ServerHandlerImp::onWSMessage(
                 sb.prepare(n), boost::asio::buffer(s.c_str(), n)));
             session->send(
                 std::make_shared<StreambufWSMsg<decltype(sb)>>(std::move(sb)));
+            std::static_pointer_cast<WSInfoSub>(session->appDefined)
+                ->responded();
             session->complete();
         });
     if (postResult == nullptr)
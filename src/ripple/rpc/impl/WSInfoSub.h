@@ -26,8 +26,11 @@
 #include <ripple/rpc/Role.h>
 #include <ripple/server/WSSession.h>
 #include <boost/utility/string_view.hpp>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace ripple {
 
@@ -37,6 +40,9 @@ class WSInfoSub : public InfoSub
     std::string user_;
     std::string fwdfor_;
 
+    std::mutex deferredMutex_;
+    std::vector<std::function<void()>> deferred_;
+
 public:
     WSInfoSub(Source& source, std::shared_ptr<WSSession> const& ws)
         : InfoSub(source), ws_(ws)
@@ -67,6 +73,36 @@ public:
         return fwdfor_;
     }
 
+    /** The session, while it is open. */
+    std::weak_ptr<WSSession>
+    session() const
+    {
+        return ws_;
+    }
+
+    /** Run f once the response to the request being handled is queued to
+        be sent, so that whatever f sends follows the response.
+    */
+    void
+    afterResponse(std::function<void()> f)
+    {
+        std::lock_guard lock(deferredMutex_);
+        deferred_.push_back(std::move(f));
+    }
+
+    /** The response to the request being handled is queued. */
+    void
+    responded()
+    {
+        std::vector<std::function<void()>> deferred;
+        {
+            std::lock_guard lock(deferredMutex_);
+            deferred.swap(deferred_);
+        }
+        for (auto const& f : deferred)
+            f();
+    }
+
     void
     send(Json::Value const& jv, bool) override
     {
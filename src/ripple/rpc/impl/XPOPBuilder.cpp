@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/XPOPBuilder.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
+
+namespace ripple {
+namespace RPC {
+
+XPOPProofs::XPOPProofs(SHAMap const& txMap) : txMap_(txMap)
+{
+}
+
+std::optional<Json::Value>
+XPOPProofs::transaction(uint256 const& txID)
+{
+    auto const item = txMap_.peekItem(txID);
+    auto const path = txMap_.getInnerPath(txID);
+
+    if (!item || !path || path->empty())
+        return {};
+
+    // the leaf itself is not needed, its hash is one of the children of
+    // the deepest inner node
+    auto const depth = path->size();
+    std::vector<Json::Value const*> levels(depth);
+
+    for (std::size_t d = 0; d < depth; ++d)
+    {
+        auto const id = SHAMapNodeID::createID(d, txID);
+        auto it = inner_.find(id);
+        if (it == inner_.end())
+        {
+            auto const& inner = *(*path)[d];
+            Json::Value children{Json::arrayValue};
+            for (int branch = 0; branch < 16; ++branch)
+                children.append(
+                    strHex(inner.getChildHash(branch).as_uint256()));
+
+            it = inner_.emplace(id, std::move(children)).first;
+        }
+        levels[d] = &it->second;
+    }
+
+    // nest the lists from the bottom up
+    Json::Value proof = *levels[depth - 1];
+    for (auto d = depth - 1; d-- > 0;)
+    {
+        Json::Value outer = *levels[d];
+        outer[selectBranch(SHAMapNodeID::createID(d, txID), txID)] =
+            std::move(proof);
+        proof = std::move(outer);
+    }
+
+    SerialIter sit(item->slice());
+    auto const blob = sit.getVL();
+    auto const meta = sit.getVL();
+
+    Json::Value jv{Json::objectValue};
+    jv[jss::blob] = strHex(blob);
+    jv[jss::meta] = strHex(meta);
+    jv[jss::proof] = std::move(proof);
+    return jv;
+}
+
+Json::Value
+xpopLedger(LedgerInfo const& info)
+{
+    Json::Value jv{Json::objectValue};
+    jv[jss::index] = static_cast<Json::Int>(info.seq);
+    // the other fields are ints to Import, coins do not fit one
+    jv[jss::coins] = std::to_string(info.drops.drops());
+    jv[jss::phash] = strHex(info.parentHash);
+    jv[jss::txroot] = strHex(info.txHash);
+    jv[jss::acroot] = strHex(info.accountHash);
+    jv[jss::pclose] = static_cast<Json::Int>(
+        info.parentCloseTime.time_since_epoch().count());
+    jv[jss::close] =
+        static_cast<Json::Int>(info.closeTime.time_since_epoch().count());
+    jv[jss::cres] = static_cast<Json::Int>(info.closeTimeResolution.count());
+    jv[jss::flags] = static_cast<Json::Int>(info.closeFlags);
+    return jv;
+}
+
+}  // namespace RPC
+}  // namespace ripple
@@ -286,6 +286,22 @@ public:
         bool fatLeaves,
         std::uint32_t depth) const;
 
+    /** Start loading the nodes on the path to a key in the background.
+
+        Nodes that are not in memory are requested from the node store
+        with asyncFetch; each inner node that arrives continues the walk.
+        Nothing is returned, the fetched nodes end up in the tree node
+        cache where a later lookup of the key will find them.
+
+        @param key the key of the leaf
+        @param owner kept alive until the last fetch completes, it must
+                     keep this map alive
+    */
+    void
+    prefetchPath(
+        uint256 const& key,
+        std::shared_ptr<void const> const& owner) const;
+
     /**
      * Get the proof path of the key. The proof path is every node on the path
      * from leaf to root. Sibling hashes are stored in the parent nodes.
@@ -295,6 +311,15 @@ public:
     std::optional<std::vector<Blob>>
     getProofPath(uint256 const& key) const;
 
+    /**
+     * Get the inner nodes on the path to a leaf, from the root down. Unlike
+     * getProofPath nothing is serialized, the nodes are shared with the map.
+     * @param key  key of the leaf
+     * @return the inner nodes if the leaf is found
+     */
+    std::optional<std::vector<std::shared_ptr<SHAMapInnerNode const>>>
+    getInnerPath(uint256 const& key) const;
+
     /**
      * Verify the proof path
      * @param rootHash  root hash of the map
@@ -470,6 +495,13 @@ private:
         bool& pending,
         descendCallback&&) const;
 
+    void
+    prefetchFrom(
+        SHAMapInnerNode* node,
+        SHAMapNodeID nodeID,
+        uint256 const& key,
+        std::shared_ptr<void const> const& owner) const;
+
     std::pair<SHAMapTreeNode*, SHAMapNodeID>
     descend(
         SHAMapInnerNode* parent,
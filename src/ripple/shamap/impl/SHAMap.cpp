@@ -469,6 +469,59 @@ SHAMap::descendAsync(
     return ptr.get();
 }
 
+void
+SHAMap::prefetchPath(
+    uint256 const& key,
+    std::shared_ptr<void const> const& owner) const
+{
+    if (backed_ && root_ && root_->isInner())
+        prefetchFrom(
+            static_cast<SHAMapInnerNode*>(root_.get()),
+            SHAMapNodeID{},
+            key,
+            owner);
+}
+
+void
+SHAMap::prefetchFrom(
+    SHAMapInnerNode* node,
+    SHAMapNodeID nodeID,
+    uint256 const& key,
+    std::shared_ptr<void const> const& owner) const
+{
+    while (node)
+    {
+        auto const branch = selectBranch(nodeID, key);
+        if (node->isEmptyBranch(branch))
+            return;
+
+        nodeID = nodeID.getChildNodeID(branch);
+
+        bool pending = false;
+        auto const child = descendAsync(
+            node,
+            branch,
+            nullptr,
+            pending,
+            [this, nodeID, key, owner](
+                std::shared_ptr<SHAMapTreeNode> fetched, SHAMapHash const&) {
+                // fetched holds the (detached) node while its children are
+                // requested, they are found through the node cache later
+                if (fetched && fetched->isInner())
+                    prefetchFrom(
+                        static_cast<SHAMapInnerNode*>(fetched.get()),
+                        nodeID,
+                        key,
+                        owner);
+            });
+
+        if (pending || !child || !child->isInner())
+            return;
+
+        node = static_cast<SHAMapInnerNode*>(child);
+    }
+}
+
 template <class Node>
 std::shared_ptr<Node>
 SHAMap::unshareNode(std::shared_ptr<Node> node, SHAMapNodeID const& nodeID)
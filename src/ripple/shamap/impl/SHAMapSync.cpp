@@ -822,6 +822,28 @@ SHAMap::getProofPath(uint256 const& key) const
     return path;
 }
 
+std::optional<std::vector<std::shared_ptr<SHAMapInnerNode const>>>
+SHAMap::getInnerPath(uint256 const& key) const
+{
+    SharedPtrNodeStack stack;
+    walkTowardsKey(key, &stack);
+
+    if (stack.empty())
+        return {};
+
+    if (auto const& node = stack.top().first; !node || node->isInner() ||
+        std::static_pointer_cast<SHAMapLeafNode>(node)->peekItem()->key() !=
+            key)
+        return {};
+    stack.pop();
+
+    std::vector<std::shared_ptr<SHAMapInnerNode const>> path(stack.size());
+    for (auto it = path.rbegin(); it != path.rend(); ++it, stack.pop())
+        *it = std::static_pointer_cast<SHAMapInnerNode const>(
+            stack.top().first);
+    return path;
+}
+
 bool
 SHAMap::verifyProofPath(
     uint256 const& rootHash,
@@ -0,0 +1,415 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/misc/EmittedTxnIndex.h>
+#include <ripple/ledger/ApplyViewImpl.h>
+#include <ripple/ledger/Sandbox.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/st.h>
+#include <algorithm>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+struct EmittedTxnIndex_test : public beast::unit_test::suite
+{
+    // an emitted AccountSet, told apart from the others by its nonce
+    static std::shared_ptr<STTx const>
+    emitted(
+        AccountID const& account,
+        std::uint32_t nonce,
+        LedgerIndex firstLedger,
+        LedgerIndex lastLedger)
+    {
+        return std::make_shared<STTx const>(ttACCOUNT_SET, [&](auto& obj) {
+            obj[sfAccount] = account;
+            obj[sfSequence] = 0;
+            obj[sfFee] = XRPAmount{10};
+            obj.setFieldVL(sfSigningPubKey, Slice{});
+            obj[sfFirstLedgerSequence] = firstLedger;
+            obj[sfLastLedgerSequence] = lastLedger;
+
+            STObject details{sfEmitDetails};
+            details[sfEmitGeneration] = 1;
+            details[sfEmitBurden] = 1;
+            details[sfEmitParentTxnID] = uint256{1};
+            details[sfEmitNonce] = uint256{nonce};
+            details[sfEmitHookHash] = uint256{2};
+            obj.emplace_back(std::move(details));
+        });
+    }
+
+    // add an ltEMITTED_TXN to the emitted directory, as finalizeHookResult
+    static uint256
+    emit(ApplyView& sb, std::shared_ptr<STTx const> const& txn)
+    {
+        auto const key = keylet::emittedTxn(txn->getTransactionID());
+        auto sle = std::make_shared<SLE>(key);
+
+        Serializer s;
+        txn->add(s);
+        SerialIter sit(s.slice());
+        sle->emplace_back(STObject(sit, sfEmittedTxn));
+
+        auto const page =
+            sb.dirInsert(keylet::emittedDir(), key, [&](SLE::ref dir) {
+                (*dir)[sfFlags] = lsfEmittedDir;
+            });
+        (*sle)[sfOwnerNode] = *page;
+        sb.insert(sle);
+        return key.key;
+    }
+
+    static void
+    unemit(ApplyView& sb, uint256 const& key)
+    {
+        auto const sle = sb.peek(Keylet{ltEMITTED_TXN, key});
+        sb.dirRemove(
+            keylet::emittedDir(), sle->getFieldU64(sfOwnerNode), key, false);
+        sb.erase(sle);
+    }
+
+    static bool
+    holds(
+        std::vector<std::shared_ptr<EmittedTxnIndex::Emission const>> const&
+            emissions,
+        std::shared_ptr<STTx const> const& txn)
+    {
+        return std::any_of(
+            emissions.begin(), emissions.end(), [&](auto const& emission) {
+                return emission->txnID == txn->getTransactionID();
+            });
+    }
+
+    // a ledger after parent holding one transaction, whose metadata shows
+    // what f did
+    static std::shared_ptr<Ledger const>
+    child(
+        std::shared_ptr<Ledger const> const& parent,
+        std::uint32_t sequence,
+        std::function<void(ApplyView&)> const& f)
+    {
+        auto const next = std::make_shared<Ledger>(
+            *parent, parent->info().closeTime + std::chrono::seconds{10});
+        {
+            OpenView accum(&*next);
+            ApplyViewImpl view(&accum, tapNONE);
+            f(view);
+
+            STTx const tx(ttACCOUNT_SET, [&](auto& obj) {
+                obj[sfAccount] = AccountID{1};
+                obj[sfSequence] = sequence;
+                obj[sfFee] = XRPAmount{10};
+                obj.setFieldVL(sfSigningPubKey, Slice{});
+            });
+            view.apply(
+                accum,
+                tx,
+                tesSUCCESS,
+                beast::Journal{beast::Journal::getNullSink()});
+            accum.apply(*next);
+        }
+        next->setImmutable();
+        return next;
+    }
+
+    // the open view on a ledger that TxQ::accept is given
+    static OpenView
+    openOn(std::shared_ptr<Ledger const> const& ledger)
+    {
+        return OpenView(open_ledger, &*ledger, ledger->rules());
+    }
+
+    static std::vector<uint256>
+    ids(std::vector<std::shared_ptr<STTx const>> const& txns)
+    {
+        std::vector<uint256> ret;
+        for (auto const& txn : txns)
+            ret.push_back(txn->getTransactionID());
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    static std::vector<uint256>
+    ids(std::vector<std::shared_ptr<EmittedTxnIndex::Emission const>> const&
+            emissions)
+    {
+        std::vector<uint256> ret;
+        for (auto const& emission : emissions)
+            ret.push_back(emission->txnID);
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    void
+    testDue()
+    {
+        testcase("Due");
+
+        using namespace jtx;
+        Env env{*this};
+        Account const alice{"alice"};
+
+        Sandbox sb(env.closed().get(), tapNONE);
+        auto const seq = sb.seq();
+
+        auto const ready = emitted(alice, 1, seq, seq + 4);
+        auto const held = emitted(alice, 2, seq + 1, seq + 4);
+        auto const expired = emitted(alice, 3, seq - 1, seq - 1);
+        auto const lastChance = emitted(alice, 4, seq, seq);
+        for (auto const& txn : {ready, held, expired, lastChance})
+            emit(sb, txn);
+
+        EmittedTxnIndex index{env.journal};
+        auto const due = index.update(sb, nullptr);
+
+        BEAST_EXPECT(index.size() == 4);
+        BEAST_EXPECT(due.added.size() == 4);
+        BEAST_EXPECT(due.ready.size() == 2);
+        BEAST_EXPECT(holds(due.ready, ready));
+        BEAST_EXPECT(holds(due.ready, lastChance));
+        BEAST_EXPECT(due.expired.size() == 1);
+        BEAST_EXPECT(holds(due.expired, expired));
+
+        // the blob is what the emitted directory holds
+        for (auto const& emission : due.ready)
+        {
+            auto const sle = sb.read(keylet::emittedTxn(emission->txnID));
+            Serializer s;
+            sle->peekAtField(sfEmittedTxn).add(s);
+            BEAST_EXPECT(s.slice() == emission->blob->slice());
+        }
+
+        // nothing is reparsed: the same emissions come back
+        auto const again = index.update(sb, nullptr);
+        BEAST_EXPECT(again.added.empty());
+        BEAST_EXPECT(again.ready.size() == 2);
+        for (auto const& emission : again.ready)
+            BEAST_EXPECT(std::find(
+                             due.ready.begin(), due.ready.end(), emission) !=
+                         due.ready.end());
+    }
+
+    void
+    testReconcile()
+    {
+        testcase("Reconcile");
+
+        using namespace jtx;
+        Env env{*this};
+        Account const alice{"alice"};
+
+        Sandbox sb(env.closed().get(), tapNONE);
+        auto const seq = sb.seq();
+
+        auto const kept = emitted(alice, 1, seq, seq + 4);
+        auto const applied = emitted(alice, 2, seq, seq + 4);
+        auto const keptKey = emit(sb, kept);
+        auto const appliedKey = emit(sb, applied);
+
+        EmittedTxnIndex index{env.journal};
+        BEAST_EXPECT(index.update(sb, nullptr).ready.size() == 2);
+
+        // an entry removed from the directory without the index being told
+        // is dropped by the next update
+        unemit(sb, appliedKey);
+        auto due = index.update(sb, nullptr);
+        BEAST_EXPECT(index.size() == 1);
+        BEAST_EXPECT(due.ready.size() == 1 && holds(due.ready, kept));
+
+        // an emission noted for a view that never closed is not taken up
+        auto const orphan = emitted(alice, 3, seq, seq + 4);
+        index.insert(
+            keylet::emittedTxn(orphan->getTransactionID()).key, orphan);
+        BEAST_EXPECT(index.size() == 1);
+        due = index.update(sb, nullptr);
+        BEAST_EXPECT(index.size() == 1);
+        BEAST_EXPECT(!holds(due.ready, orphan));
+
+        // nor is an erase the ledger did not keep
+        index.erase(keptKey);
+        due = index.update(sb, nullptr);
+        BEAST_EXPECT(index.size() == 1);
+        BEAST_EXPECT(holds(due.ready, kept));
+
+        // and an emission the index is told of is used as is
+        auto const fresh = emitted(alice, 4, seq, seq + 4);
+        auto const freshKey = emit(sb, fresh);
+        index.insert(freshKey, fresh);
+        due = index.update(sb, nullptr);
+        BEAST_EXPECT(index.size() == 2);
+        BEAST_EXPECT(std::any_of(
+            due.ready.begin(), due.ready.end(), [&](auto const& emission) {
+                return emission->txn == fresh;
+            }));
+
+        index.erase(freshKey);
+        unemit(sb, freshKey);
+        unemit(sb, keptKey);
+        due = index.update(sb, nullptr);
+        BEAST_EXPECT(index.size() == 0);
+        BEAST_EXPECT(due.added.empty());
+    }
+
+    void
+    testIncremental()
+    {
+        testcase("Incremental");
+
+        using namespace jtx;
+        Env env{*this};
+        Account const alice{"alice"};
+
+        auto const genesis = env.app().getLedgerMaster().getClosedLedger();
+        // the sequence of a view on the first ledger after it
+        auto const seq = genesis->seq() + 2;
+
+        EmittedTxnIndex index{env.journal};
+
+        auto const now = emitted(alice, 1, seq, seq + 4);
+        auto const later = emitted(alice, 2, seq + 1, seq + 4);
+        auto const expired = emitted(alice, 3, seq - 1, seq - 1);
+        uint256 nowKey, laterKey, expiredKey;
+        auto const first = child(genesis, 1, [&](ApplyView& view) {
+            nowKey = emit(view, now);
+            laterKey = emit(view, later);
+            expiredKey = emit(view, expired);
+        });
+
+        // the first update reads the directory
+        auto due = index.update(openOn(first), &*first);
+        BEAST_EXPECT(index.resyncs() == 1);
+        BEAST_EXPECT(index.size() == 3);
+        BEAST_EXPECT(due.added.size() == 3);
+        BEAST_EXPECT(ids(due.ready) == ids({now}));
+        BEAST_EXPECT(ids(due.expired) == ids({expired}));
+
+        // the next ledger applies one emission, fails another and holds a
+        // new one, which the index learns from its metadata alone
+        auto const next = emitted(alice, 4, seq + 1, seq + 4);
+        uint256 nextKey;
+        auto const second = child(first, 2, [&](ApplyView& view) {
+            unemit(view, nowKey);
+            unemit(view, expiredKey);
+            nextKey = emit(view, next);
+        });
+
+        due = index.update(openOn(second), &*second);
+        BEAST_EXPECT(index.resyncs() == 1);
+        BEAST_EXPECT(index.size() == 2);
+        BEAST_EXPECT(due.added == ids({next}));
+        BEAST_EXPECT(ids(due.ready) == ids({later, next}));
+        BEAST_EXPECT(due.expired.empty());
+
+        // an emission into a view on the same ledger is taken from what the
+        // index was told
+        auto const open = emitted(alice, 5, seq + 1, seq + 4);
+        {
+            auto view = openOn(second);
+            Sandbox sb(&view, tapNONE);
+            index.insert(emit(sb, open), open);
+            sb.apply(view);
+
+            due = index.update(view, &*second);
+            BEAST_EXPECT(index.resyncs() == 1);
+            BEAST_EXPECT(index.size() == 3);
+            BEAST_EXPECT(due.added == ids({open}));
+            BEAST_EXPECT(ids(due.ready) == ids({later, next, open}));
+        }
+
+        // and dropped when the next ledger does not hold it
+        auto const third = child(second, 3, [&](ApplyView& view) {
+            unemit(view, laterKey);
+            unemit(view, nextKey);
+        });
+
+        due = index.update(openOn(third), &*third);
+        BEAST_EXPECT(index.resyncs() == 1);
+        BEAST_EXPECT(index.size() == 0);
+        BEAST_EXPECT(due.ready.empty());
+
+        // a ledger on another branch is read whole
+        auto const fork = child(first, 4, [](ApplyView&) {});
+        due = index.update(openOn(fork), &*fork);
+        BEAST_EXPECT(index.resyncs() == 2);
+        BEAST_EXPECT(index.size() == 3);
+        BEAST_EXPECT(due.added.size() == 3);
+
+        // as is a view on an unknown ledger
+        due = index.update(openOn(fork), nullptr);
+        BEAST_EXPECT(index.resyncs() == 3);
+        BEAST_EXPECT(index.size() == 3);
+        BEAST_EXPECT(due.added.empty());
+    }
+
+    void
+    testMalformed()
+    {
+        testcase("Malformed");
+
+        using namespace jtx;
+        Env env{*this};
+        Account const alice{"alice"};
+
+        Sandbox sb(env.closed().get(), tapNONE);
+        auto const seq = sb.seq();
+
+        // an emitted transaction without its ledger window is never due
+        auto const windowless =
+            std::make_shared<STTx const>(ttACCOUNT_SET, [&](auto& obj) {
+                obj[sfAccount] = alice.id();
+                obj[sfSequence] = 0;
+                obj[sfFee] = XRPAmount{10};
+                obj.setFieldVL(sfSigningPubKey, Slice{});
+            });
+        emit(sb, windowless);
+        emit(sb, emitted(alice, 1, seq, seq + 4));
+
+        EmittedTxnIndex index{env.journal};
+        auto const due = index.update(sb, nullptr);
+        BEAST_EXPECT(index.size() == 2);
+        BEAST_EXPECT(due.added.size() == 1);
+        BEAST_EXPECT(due.ready.size() == 1);
+        BEAST_EXPECT(due.expired.empty());
+
+        // nor is it recorded when emitted
+        EmittedTxnIndex told{env.journal};
+        told.insert(
+            keylet::emittedTxn(windowless->getTransactionID()).key,
+            windowless);
+        BEAST_EXPECT(told.size() == 0);
+    }
+
+    void
+    run() override
+    {
+        testDue();
+        testReconcile();
+        testIncremental();
+        testMalformed();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(EmittedTxnIndex, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
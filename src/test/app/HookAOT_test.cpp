@@ -0,0 +1,242 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/jss.h>
+#include <test/app/SetHook_wasm.h>
+#include <test/jtx.h>
+#include <test/jtx/hook.h>
+#include <boost/filesystem.hpp>
+
+namespace ripple {
+namespace test {
+
+class HookAOT_test : public beast::unit_test::suite
+{
+private:
+    void static overrideFlag(Json::Value& jv)
+    {
+        jv[jss::Flags] = hsfOVERRIDE;
+    }
+
+    // Every hook in the SetHook corpus is installed and triggered on two
+    // otherwise identical ledgers, one interpreting the hook and one running
+    // it natively. Results and instruction counts must not differ.
+    void
+    testDifferential(FeatureBitset features)
+    {
+        testcase("AOT compiled hooks match the interpreter");
+        using namespace jtx;
+
+        auto const dir = boost::filesystem::temp_directory_path() /
+            boost::filesystem::unique_path("hookaot-%%%%-%%%%-%%%%");
+
+        Env interp{*this, features};
+        Env aot{
+            *this,
+            envconfig([&](std::unique_ptr<Config> cfg) {
+                cfg->HOOK_AOT_PATH = dir.string();
+                return cfg;
+            }),
+            features};
+
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        for (auto* env : {&interp, &aot})
+        {
+            env->fund(XRP(100000), alice, bob);
+            env->close();
+        }
+
+        auto& cache = aot.app().getHookModuleCache();
+        BEAST_EXPECT(cache.aotEnabled());
+
+        std::size_t compared = 0;
+        for (auto const& [_, code] : wasm)
+        {
+            auto const hookHash = sha512Half_s(makeSlice(code));
+
+            // the corpus also holds hooks that are meant to be rejected, both
+            // sides have to reject them alike
+            for (auto* env : {&interp, &aot})
+                (*env)(
+                    ripple::test::jtx::hook(
+                        alice, {{hso(code, overrideFlag)}}, 0),
+                    fee(XRP(100)),
+                    ter(std::ignore));
+
+            BEAST_EXPECT(interp.ter() == aot.ter());
+            if (interp.ter() != tesSUCCESS || aot.ter() != tesSUCCESS)
+                continue;
+
+            BEAST_EXPECT(cache.compile(hookHash, makeSlice(code)));
+            auto const module = cache.fetch(hookHash, makeSlice(code));
+            BEAST_EXPECT(module && (*module)->native());
+
+            for (auto* env : {&interp, &aot})
+                (*env)(pay(bob, alice, XRP(1)), fee(XRP(1)), ter(std::ignore));
+
+            BEAST_EXPECT(interp.ter() == aot.ter());
+
+            auto const interpMeta = interp.meta();
+            auto const aotMeta = aot.meta();
+            if (!BEAST_EXPECT(!interpMeta == !aotMeta) || !interpMeta)
+                continue;
+
+            if (!BEAST_EXPECT(
+                    interpMeta->isFieldPresent(sfHookExecutions) ==
+                    aotMeta->isFieldPresent(sfHookExecutions)) ||
+                !interpMeta->isFieldPresent(sfHookExecutions))
+                continue;
+
+            auto const& interpExec =
+                interpMeta->getFieldArray(sfHookExecutions);
+            auto const& aotExec = aotMeta->getFieldArray(sfHookExecutions);
+            if (!BEAST_EXPECT(interpExec.size() == aotExec.size()))
+                continue;
+
+            for (std::size_t i = 0; i < interpExec.size(); ++i)
+            {
+                BEAST_EXPECT(
+                    interpExec[i].getFieldU8(sfHookResult) ==
+                    aotExec[i].getFieldU8(sfHookResult));
+                BEAST_EXPECT(
+                    interpExec[i].getFieldU64(sfHookInstructionCount) ==
+                    aotExec[i].getFieldU64(sfHookInstructionCount));
+                BEAST_EXPECT(interpExec[i] == aotExec[i]);
+            }
+
+            ++compared;
+        }
+
+        BEAST_EXPECT(compared > 0);
+
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(dir, ec);
+    }
+
+    // An artifact is only loaded if it is tagged as compiled from the hook's
+    // code by this compiler with this configuration. Otherwise the hook is
+    // interpreted until it is compiled again.
+    void
+    testStale(FeatureBitset features)
+    {
+        testcase("Stale AOT artifacts are not loaded");
+        using namespace jtx;
+
+        auto const dir = boost::filesystem::temp_directory_path() /
+            boost::filesystem::unique_path("hookaot-%%%%-%%%%-%%%%");
+
+        Env env{*this, features};
+        auto const makeCache = [&]() {
+            return std::make_unique<hook::ModuleCache>(
+                16, dir.string(), false, env.journal);
+        };
+
+        auto const artifact = [&dir](uint256 const& hookHash) {
+            return dir / (to_string(hookHash) + ".v1.so");
+        };
+        auto const tag = [&dir](uint256 const& hookHash) {
+            return dir / (to_string(hookHash) + ".v1.tag");
+        };
+
+        // two hooks which compile
+        std::vector<Slice> codes;
+        std::vector<uint256> hashes;
+        {
+            auto cache = makeCache();
+            for (auto const& [_, code] : wasm)
+            {
+                if (codes.size() == 2)
+                    break;
+
+                auto const hookHash = sha512Half_s(makeSlice(code));
+                if (cache->compile(hookHash, makeSlice(code)))
+                {
+                    codes.push_back(makeSlice(code));
+                    hashes.push_back(hookHash);
+                }
+            }
+        }
+        if (!BEAST_EXPECT(codes.size() == 2))
+            return;
+
+        // their artifacts are loaded by a fresh cache
+        for (std::size_t i = 0; i < 2; ++i)
+        {
+            auto cache = makeCache();
+            auto const module = cache->fetch(hashes[i], codes[i]);
+            BEAST_EXPECT(module && (*module)->native());
+            BEAST_EXPECT(!cache->stale(hashes[i]));
+        }
+
+        // the second hook's artifact and tag replaced by the first's are
+        // not loaded for it, and compiling it again replaces them
+        {
+            boost::filesystem::copy_file(
+                artifact(hashes[0]),
+                artifact(hashes[1]),
+                boost::filesystem::copy_options::overwrite_existing);
+            boost::filesystem::copy_file(
+                tag(hashes[0]),
+                tag(hashes[1]),
+                boost::filesystem::copy_options::overwrite_existing);
+
+            auto cache = makeCache();
+            auto module = cache->fetch(hashes[1], codes[1]);
+            BEAST_EXPECT(module && !(*module)->native());
+            BEAST_EXPECT(cache->stale(hashes[1]));
+
+            BEAST_EXPECT(cache->compile(hashes[1], codes[1]));
+            BEAST_EXPECT(!cache->stale(hashes[1]));
+
+            module = cache->fetch(hashes[1], codes[1]);
+            BEAST_EXPECT(module && (*module)->native());
+        }
+
+        // nor is an artifact with no tag
+        {
+            boost::filesystem::remove(tag(hashes[0]));
+
+            auto cache = makeCache();
+            auto const module = cache->fetch(hashes[0], codes[0]);
+            BEAST_EXPECT(module && !(*module)->native());
+            BEAST_EXPECT(cache->stale(hashes[0]));
+        }
+
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(dir, ec);
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace test::jtx;
+        testDifferential(supported_amendments());
+        testStale(supported_amendments());
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookAOT, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/applyHook.h>
+#include <ripple/app/tx/impl/ApplyContext.h>
+#include <ripple/ledger/OpenView.h>
+#include <test/jtx.h>
+#include <chrono>
+
+namespace ripple {
+namespace test {
+
+// Measures the per-execution cost of setting up the Hook Api "env" import
+// module: building it from scratch, as every execution used to, against
+// binding a context to the module each thread keeps.
+class HookAPIModule_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class F>
+    void
+    time(std::string const& what, std::size_t iterations, F&& f)
+    {
+        auto const start = clock_type::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+            f();
+        auto const elapsed = std::chrono::duration_cast<
+            std::chrono::duration<double, std::micro>>(
+            clock_type::now() - start);
+
+        log << what << ": " << elapsed.count() / iterations << " us/call"
+            << std::endl;
+    }
+
+    void
+    testSetupCost()
+    {
+        testcase("Hook Api import module setup cost");
+        using namespace jtx;
+
+        Env env{*this};
+        auto const alice = Account{"alice"};
+        env.fund(XRP(1000), alice);
+        env.close();
+
+        OpenView ov{*env.current()};
+        STTx const tx{ttACCOUNT_SET, [&](STObject& obj) {
+                          obj.setAccountID(sfAccount, alice.id());
+                      }};
+        ApplyContext applyCtx{
+            env.app(),
+            ov,
+            tx,
+            tesSUCCESS,
+            env.current()->fees().base,
+            tapNONE};
+
+        hook::HookStateMap stateMap;
+        hook::HookParameters const params;
+        hook::HookContext hookCtx{
+            .applyCtx = applyCtx,
+            .result = {
+                .accountKeylet = keylet::account(alice.id()),
+                .ownerDirKeylet = keylet::ownerDir(alice.id()),
+                .hookKeylet = keylet::hook(alice.id()),
+                .account = alice.id(),
+                .otxnAccount = alice.id(),
+                .stateMap = stateMap,
+                .hookParams = params}};
+
+        std::size_t const iterations = 10000;
+
+        time("build per execution", iterations, []() {
+            hook::HookAPIModule module;
+        });
+
+        time("bind thread module", iterations, [&]() {
+            hook::HookAPIModule::Binding binding{hookCtx};
+        });
+
+        pass();
+    }
+
+public:
+    void
+    run() override
+    {
+        testSetupCost();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(HookAPIModule, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
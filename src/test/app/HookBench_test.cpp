@@ -0,0 +1,324 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/Enum.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/jss.h>
+#include <test/app/SetHook_wasm.h>
+#include <test/jtx.h>
+#include <test/jtx/hook.h>
+#include <test/unit_test/BenchRounds.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+
+// Allocation counting replaces the global operator new for the whole test
+// binary, so it is only compiled in on request:
+//   -DHOOK_BENCH_COUNT_ALLOCATIONS
+#ifdef HOOK_BENCH_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::uint64_t> hookBenchAllocations{0};
+}
+
+void*
+operator new(std::size_t size)
+{
+    hookBenchAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+namespace ripple {
+namespace test {
+
+// Drives payments through every hook of the SetHook corpus that installs and
+// reports, per hook and per class of Hook API the hooks import, the wall clock
+// cost of an execution and how it relates to the instructions counted for it.
+//
+// Run with --unittest=HookBench --unittest-arg=<transactions per hook>
+class HookBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // close the ledger every so often so the open ledger stays small, this is
+    // not part of the measurement
+    static constexpr std::size_t closeInterval = 256;
+
+    struct Sample
+    {
+        double nsPerTxn = 0;
+        double allocationsPerTxn = 0;
+        std::uint64_t instructions = 0;  // of the last execution
+    };
+
+    struct ClassTotals
+    {
+        std::size_t hooks = 0;
+        double nsPerExecution = 0;
+        double allocationsPerExecution = 0;
+    };
+
+    static std::uint64_t
+    allocations()
+    {
+#ifdef HOOK_BENCH_COUNT_ALLOCATIONS
+        return hookBenchAllocations.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    // The allocation count as reported, "n/a" when counting is not compiled in
+    static std::string
+    allocationsText(double n)
+    {
+#ifdef HOOK_BENCH_COUNT_ALLOCATIONS
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1) << n;
+        return ss.str();
+#else
+        (void)n;
+        return "n/a";
+#endif
+    }
+
+    static void
+    overrideFlag(Json::Value& jv)
+    {
+        jv[jss::Flags] = hsfOVERRIDE;
+    }
+
+    // The API classes a hook exercises, going by the names it imports from
+    // the "env" module.
+    static std::set<std::string>
+    apiClasses(std::vector<uint8_t> const& code)
+    {
+        static std::vector<std::pair<std::string, std::string>> const prefixes{
+            {"state", "state"},
+            {"slot", "slot"},
+            {"float_", "float"},
+            {"emit", "emit"},
+            {"etxn_", "emit"},
+            {"sto_", "sto"}};
+
+        std::set<std::string> ret;
+        std::size_t i = 8;  // past the magic and version
+
+        auto leb = [&]() -> std::optional<std::uint32_t> {
+            std::uint32_t v = 0;
+            for (int shift = 0; i < code.size() && shift < 35; shift += 7)
+            {
+                auto const b = code[i++];
+                v |= static_cast<std::uint32_t>(b & 0x7FU) << shift;
+                if (!(b & 0x80U))
+                    return v;
+            }
+            return std::nullopt;
+        };
+
+        auto name = [&]() -> std::optional<std::string> {
+            auto const len = leb();
+            if (!len || i + *len > code.size())
+                return std::nullopt;
+            std::string s(code.begin() + i, code.begin() + i + *len);
+            i += *len;
+            return s;
+        };
+
+        while (i < code.size())
+        {
+            auto const id = code[i++];
+            auto const size = leb();
+            if (!size || i + *size > code.size())
+                break;
+
+            if (id != 2)  // only the import section is of interest
+            {
+                i += *size;
+                continue;
+            }
+
+            auto count = leb();
+            for (std::uint32_t n = 0; count && n < *count; ++n)
+            {
+                auto const module = name();
+                auto const field = name();
+                if (!module || !field || i >= code.size())
+                    return ret;
+
+                // hooks only import functions, which is all that is expected
+                if (code[i++] != 0 || !leb())
+                    return ret;
+
+                for (auto const& [prefix, cls] : prefixes)
+                    if (*module == "env" && field->rfind(prefix, 0) == 0)
+                        ret.insert(cls);
+            }
+            break;
+        }
+
+        return ret;
+    }
+
+    // Time `count` payments from bob to alice, which has whatever hook is
+    // installed on it at the time.
+    Sample
+    drive(
+        jtx::Env& env,
+        jtx::Account const& alice,
+        jtx::Account const& bob,
+        std::size_t count)
+    {
+        using namespace jtx;
+
+        clock_type::duration elapsed{};
+        std::uint64_t allocated = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (i && i % closeInterval == 0)
+                env.close();
+
+            auto const allocs = allocations();
+            auto const start = clock_type::now();
+            env(pay(bob, alice, XRP(1)), fee(XRP(1)), ter(std::ignore));
+            elapsed += clock_type::now() - start;
+            allocated += allocations() - allocs;
+        }
+
+        Sample ret;
+        ret.nsPerTxn =
+            std::chrono::duration<double, std::nano>(elapsed).count() / count;
+        ret.allocationsPerTxn = static_cast<double>(allocated) / count;
+
+        if (auto const meta = env.meta();
+            meta && meta->isFieldPresent(sfHookExecutions))
+        {
+            for (auto const& exec : meta->getFieldArray(sfHookExecutions))
+                ret.instructions += exec.getFieldU64(sfHookInstructionCount);
+        }
+
+        env.close();
+        return ret;
+    }
+
+    void
+    testCorpus(std::size_t count)
+    {
+        testcase("Hook execution cost over the SetHook corpus");
+        using namespace jtx;
+
+        Env env{*this, supported_amendments()};
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        env.fund(XRP(100000000), alice, bob);
+        env.close();
+
+        // the cost of the same payment without any hook to run
+        auto const baseline = drive(env, alice, bob, count);
+        log << std::fixed << std::setprecision(1)
+            << "baseline payment: " << baseline.nsPerTxn << " ns/txn, "
+            << allocationsText(baseline.allocationsPerTxn)
+            << " allocations/txn" << std::endl;
+
+        std::map<std::string, ClassTotals> classes;
+        std::size_t measured = 0;
+
+        for (auto const& [_, code] : wasm)
+        {
+            // the corpus also holds hooks that are meant to be rejected
+            env(ripple::test::jtx::hook(alice, {{hso(code, overrideFlag)}}, 0),
+                fee(XRP(100)),
+                ter(std::ignore));
+            if (env.ter() != tesSUCCESS)
+                continue;
+            env.close();
+
+            auto const sample = drive(env, alice, bob, count);
+            auto const ns = std::max(0.0, sample.nsPerTxn - baseline.nsPerTxn);
+            auto const allocs = std::max(
+                0.0, sample.allocationsPerTxn - baseline.allocationsPerTxn);
+            auto const cls = apiClasses(code);
+
+            log << to_string(sha512Half_s(makeSlice(code))).substr(0, 16)
+                << ": " << ns << " ns/execution, " << allocationsText(allocs)
+                << " allocations/execution, " << sample.instructions
+                << " instructions";
+            if (sample.instructions)
+                log << ", " << (ns / sample.instructions) << " ns/instruction";
+            for (auto const& c : cls)
+                log << " " << c;
+            log << std::endl;
+
+            for (auto const& c : cls.empty() ? std::set<std::string>{"other"}
+                                             : cls)
+            {
+                auto& totals = classes[c];
+                ++totals.hooks;
+                totals.nsPerExecution += ns;
+                totals.allocationsPerExecution += allocs;
+            }
+
+            ++measured;
+        }
+
+        for (auto const& [c, totals] : classes)
+            log << "class " << c << ": " << totals.hooks << " hooks, "
+                << totals.nsPerExecution / totals.hooks << " ns/execution, "
+                << allocationsText(
+                       totals.allocationsPerExecution / totals.hooks)
+                << " allocations/execution" << std::endl;
+
+        BEAST_EXPECT(measured > 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testCorpus(benchRounds(*this, 1000));
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(HookBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,332 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/Guard.h>
+#include <test/app/SetHook_wasm.h>
+#include <test/jtx.h>
+#include <test/unit_test/BenchRounds.h>
+#include <chrono>
+#include <iomanip>
+
+namespace ripple {
+namespace test {
+
+// Hand assembled modules for the guard checker.
+namespace guard_wasm {
+
+using Bytes = std::vector<uint8_t>;
+
+void
+leb(Bytes& out, uint64_t v)
+{
+    do
+    {
+        uint8_t b = v & 0x7FU;
+        v >>= 7;
+        out.push_back(v ? b | 0x80U : b);
+    } while (v);
+}
+
+void
+section(Bytes& out, uint8_t type, Bytes const& payload)
+{
+    out.push_back(type);
+    leb(out, payload.size());
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+// A module importing only _g and exporting hook() as the first of its
+// functions, whose bodies (without locals or the final end) are given.
+Bytes
+module(std::vector<Bytes> const& bodies)
+{
+    Bytes out{0x00U, 0x61U, 0x73U, 0x6DU, 0x01U, 0x00U, 0x00U, 0x00U};
+
+    // 0: _g (i32, i32) -> i32, 1: hook (i32) -> i64
+    section(
+        out,
+        1,
+        {0x02U,
+         0x60U,
+         0x02U,
+         0x7FU,
+         0x7FU,
+         0x01U,
+         0x7FU,
+         0x60U,
+         0x01U,
+         0x7FU,
+         0x01U,
+         0x7EU});
+    section(
+        out, 2, {0x01U, 0x03U, 'e', 'n', 'v', 0x02U, '_', 'g', 0x00U, 0x00U});
+
+    Bytes funcs;
+    leb(funcs, bodies.size());
+    funcs.insert(funcs.end(), bodies.size(), 0x01U);
+    section(out, 3, funcs);
+
+    section(out, 7, {0x01U, 0x04U, 'h', 'o', 'o', 'k', 0x00U, 0x01U});
+
+    Bytes code;
+    leb(code, bodies.size());
+    for (auto const& body : bodies)
+    {
+        Bytes fn{0x00U};  // no locals
+        fn.insert(fn.end(), body.begin(), body.end());
+        fn.insert(fn.end(), {0x42U, 0x00U, 0x0BU});  // i64.const 0, end
+        leb(code, fn.size());
+        code.insert(code.end(), fn.begin(), fn.end());
+    }
+    section(out, 10, code);
+    return out;
+}
+
+// the _g(id, maxiter) call every loop has to open with
+void
+guard(Bytes& body, uint32_t id, uint32_t maxiter)
+{
+    body.push_back(0x41U);
+    leb(body, id);
+    body.push_back(0x41U);
+    leb(body, maxiter);
+    body.insert(body.end(), {0x10U, 0x00U, 0x1AU});  // call _g, drop
+}
+
+// straight line code of wide constants, close to the instruction limit
+Bytes
+straightLine(std::size_t pairs)
+{
+    Bytes body;
+    for (std::size_t n = 0; n < pairs; ++n)
+    {
+        body.push_back(0x42U);  // i64.const with a 10 byte leb
+        for (int b = 0; b < 9; ++b)
+            body.push_back(0xFFU);
+        body.push_back(0x00U);
+        body.push_back(0x1AU);  // drop
+    }
+    return body;
+}
+
+// guarded loops nested depth deep
+Bytes
+nestedLoops(std::size_t depth)
+{
+    Bytes body;
+    for (std::size_t n = 0; n < depth; ++n)
+    {
+        body.insert(body.end(), {0x03U, 0x40U});  // loop
+        guard(body, n + 1, 1);
+    }
+    body.insert(body.end(), depth, 0x0BU);
+    return body;
+}
+
+// one after another, each only a guard deep
+Bytes
+sequentialLoops(std::size_t count)
+{
+    Bytes body;
+    for (std::size_t n = 0; n < count; ++n)
+    {
+        body.insert(body.end(), {0x03U, 0x40U});
+        guard(body, n + 1, 2);
+        body.push_back(0x0BU);
+    }
+    return body;
+}
+
+// blocks nested far beyond the limit, rejected only once all are read
+Bytes
+nestedBlocks(std::size_t depth)
+{
+    Bytes body;
+    for (std::size_t n = 0; n < depth; ++n)
+        body.insert(body.end(), {0x02U, 0x40U});
+    body.insert(body.end(), depth, 0x0BU);
+    return body;
+}
+
+}  // namespace guard_wasm
+
+// The inputs the validator is checked and timed against, with whether
+// validateGuards should accept each.
+struct GuardInputs
+{
+    struct Input
+    {
+        std::string name;
+        guard_wasm::Bytes wasm;
+        bool valid;
+    };
+
+    std::vector<Input> large;
+    std::vector<Input> adversarial;
+
+    GuardInputs()
+    {
+        using namespace guard_wasm;
+
+        // four functions of 40002 instructions, each just under the limit
+        large.push_back(
+            {"large",
+             module(
+                 {straightLine(20000),
+                  straightLine(20000),
+                  straightLine(20000),
+                  straightLine(20000)}),
+             true});
+
+        adversarial.push_back(
+            {"16 nested loops", module({nestedLoops(16)}), true});
+        adversarial.push_back(
+            {"17 nested loops", module({nestedLoops(17)}), false});
+        adversarial.push_back(
+            {"1000 sequential loops", module({sequentialLoops(1000)}), true});
+        adversarial.push_back(
+            {"100000 nested blocks", module({nestedBlocks(100000)}), false});
+
+        // the largest of the corpus cut short at every 64th byte
+        auto const& biggest = std::max_element(
+            wasm.begin(), wasm.end(), [](auto const& a, auto const& b) {
+                return a.second.size() < b.second.size();
+            })->second;
+        for (std::size_t cut = 8; cut < biggest.size(); cut += 64)
+            adversarial.push_back(
+                {"truncated at " + std::to_string(cut),
+                 Bytes(biggest.begin(), biggest.begin() + cut),
+                 false});
+    }
+};
+
+// validateGuards, where a truncated hook's length_error counts as rejection
+static std::optional<std::pair<uint64_t, uint64_t>>
+checkGuards(guard_wasm::Bytes const& wasm, GuardScratch& scratch)
+{
+    try
+    {
+        return validateGuards(wasm, {}, "", 1, scratch);
+    }
+    catch (std::length_error const&)
+    {
+        return {};
+    }
+}
+
+class HookGuard_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        testcase("generated inputs");
+
+        // the scratch space carries nothing from one hook to the next
+        GuardInputs const inputs;
+        GuardScratch scratch;
+        for (auto const* set : {&inputs.large, &inputs.adversarial})
+            for (auto const& input : *set)
+                BEAST_EXPECTS(
+                    checkGuards(input.wasm, scratch).has_value() ==
+                        input.valid,
+                    input.name);
+
+        testcase("worst case execution");
+
+        // loops guarded at 1 do not multiply the instructions inside them
+        auto const nested = checkGuards(inputs.adversarial[0].wasm, scratch);
+        BEAST_EXPECT(nested && nested->first == 50);
+
+        // each loop of the sequence runs twice
+        auto const sequential =
+            checkGuards(inputs.adversarial[2].wasm, scratch);
+        BEAST_EXPECT(sequential && sequential->first == 5002);
+    }
+};
+
+// Run with --unittest=HookGuardBench --unittest-arg=<rounds>
+class HookGuardBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    GuardScratch scratch_;
+
+    // validate every input rounds times, reporting the combined throughput
+    void
+    measure(
+        std::string const& name,
+        std::vector<std::reference_wrapper<guard_wasm::Bytes const>> const&
+            inputs,
+        std::size_t rounds)
+    {
+        std::size_t bytes = 0;
+        for (auto const& w : inputs)
+            bytes += w.get().size();
+
+        std::size_t accepted = 0;
+        auto const start = clock_type::now();
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (auto const& w : inputs)
+                accepted += checkGuards(w.get(), scratch_).has_value();
+        auto const secs =
+            std::chrono::duration<double>(clock_type::now() - start).count();
+
+        log << name << " (" << inputs.size() << " hooks, " << bytes
+            << " bytes, " << accepted / rounds << " accepted): "
+            << secs * 1e6 / rounds << " us/round, "
+            << bytes * rounds / secs / 1e6 << " MB/s" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        auto const rounds = benchRounds(*this, 100);
+
+        GuardInputs const inputs;
+        log << std::fixed << std::setprecision(1);
+
+        std::vector<std::reference_wrapper<guard_wasm::Bytes const>> set;
+        for (auto const& [_, w] : wasm)
+            set.push_back(w);
+        measure("SetHook corpus", set, rounds);
+
+        for (auto const& input : inputs.large)
+            measure(input.name, {input.wasm}, rounds);
+
+        set.clear();
+        for (auto const& input : inputs.adversarial)
+        {
+            if (input.name.rfind("truncated", 0) == 0)
+                set.push_back(input.wasm);
+            else
+                measure(input.name, {input.wasm}, rounds);
+        }
+        measure("truncated", set, rounds);
+
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookGuard, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(HookGuardBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,744 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/STOIndex.h>
+#include <ripple/protocol/Indexes.h>
+#include <test/app/SetHook_wasm.h>
+#include <test/jtx.h>
+#include <test/jtx/hook.h>
+#include <test/unit_test/BenchRounds.h>
+#include <chrono>
+#include <iomanip>
+
+namespace ripple {
+namespace test {
+
+// Serialized transactions and ledger entries of the kinds hooks commonly
+// pull apart with the sto_* APIs.
+struct STOBlobs
+{
+    struct Blob
+    {
+        std::string name;
+        ripple::Blob bytes;
+        std::shared_ptr<STObject const> object;  // what was serialized
+    };
+
+    std::vector<Blob> blobs;
+
+    void
+    add(std::string name, std::shared_ptr<STObject const> const& object)
+    {
+        if (!object)
+            return;
+        Serializer s;
+        object->add(s);
+        blobs.push_back({std::move(name), s.peekData(), object});
+    }
+
+    explicit STOBlobs(jtx::Env& env)
+    {
+        using namespace jtx;
+
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        auto const gw = Account{"gateway"};
+        auto const USD = gw["USD"];
+
+        env.fund(XRP(100000), alice, bob, gw);
+        env.close();
+
+        env(trust(alice, USD(1000)));
+        add("TrustSet", env.tx());
+        env(pay(gw, alice, USD(100)));
+        env.close();
+
+        env(pay(bob, alice, XRP(10)));
+        add("Payment", env.tx());
+
+        auto const offerSeq = env.seq(alice);
+        env(offer(alice, XRP(10), USD(10)));
+        add("OfferCreate", env.tx());
+        env.close();
+
+        // the corpus also holds hooks that are meant to be rejected
+        for (auto const& [_, code] : wasm)
+        {
+            env(ripple::test::jtx::hook(alice, {{hso(code)}}, 0),
+                fee(XRP(100)),
+                ter(std::ignore));
+            if (env.ter() != tesSUCCESS)
+                continue;
+            add("SetHook", env.tx());
+            env.close();
+            break;
+        }
+
+        add("AccountRoot", env.le(keylet::account(alice.id())));
+        add("RippleState", env.le(keylet::line(alice, USD.issue())));
+        add("Offer", env.le(keylet::offer(alice.id(), offerSeq)));
+
+        if (auto const hook = env.le(keylet::hook(alice.id())))
+        {
+            add("Hook", hook);
+            for (auto const& h : hook->getFieldArray(sfHooks))
+                if (h.isFieldPresent(sfHookHash))
+                    add("HookDefinition",
+                        env.le(keylet::hookDefinition(
+                            h.getFieldH256(sfHookHash))));
+        }
+    }
+};
+
+// The parser and lookups of the sto_* Hook APIs as they were before the
+// index, copied verbatim but for the debug output, to check the index
+// against.
+namespace sto_reference {
+
+enum parse_error : int32_t {
+    pe_unexpected_end = -1,
+    pe_unknown_type_early = -2,  // detected early
+    pe_unknown_type_late = -3,   // end of function
+    pe_excessive_nesting = -4,
+    pe_excessive_size = -5
+};
+
+inline int32_t
+get_stobject_length(
+    unsigned char const* start,   // in - begin iterator
+    unsigned char const* maxptr,  // in - end iterator
+    int& type,                    // out - populated by serialized type code
+    int& field,                   // out - populated by serialized field code
+    int& payload_start,  // out - the start of actual payload data for this type
+    int& payload_length,  // out - the length of actual payload data for this
+                          // type
+    int recursion_depth = 0)  // used internally
+{
+    if (recursion_depth > 10)
+        return pe_excessive_nesting;
+
+    unsigned char const* end = maxptr;
+    unsigned char const* upto = start;
+    int high = *upto >> 4;
+    int low = *upto & 0xF;
+
+    upto++;
+    if (upto >= end)
+        return pe_unexpected_end;
+    if (high > 0 && low > 0)
+    {
+        // common type common field
+        type = high;
+        field = low;
+    }
+    else if (high > 0)
+    {
+        // common type, uncommon field
+        type = high;
+        field = *upto++;
+    }
+    else if (low > 0)
+    {
+        // common field, uncommon type
+        field = low;
+        type = *upto++;
+    }
+    else
+    {
+        // uncommon type and field
+        type = *upto++;
+        if (upto >= end)
+            return pe_unexpected_end;
+        field = *upto++;
+    }
+
+    if (upto >= end)
+        return pe_unexpected_end;
+
+    if (type < 1 || type > 19 || (type >= 9 && type <= 13))
+        return pe_unknown_type_early;
+
+    bool is_vl = (type == 8 /*ACCID*/ || type == 7 || type == 18 || type == 19);
+
+    int length = -1;
+    if (is_vl)
+    {
+        length = *upto++;
+        if (upto >= end)
+            return pe_unexpected_end;
+
+        if (length < 193)
+        {
+            // do nothing
+        }
+        else if (length > 192 && length < 241)
+        {
+            length -= 193;
+            length *= 256;
+            length += *upto++ + 193;
+            if (upto > end)
+                return pe_unexpected_end;
+        }
+        else
+        {
+            int b2 = *upto++;
+            if (upto >= end)
+                return pe_unexpected_end;
+            length -= 241;
+            length *= 65536;
+            length += 12481 + (b2 * 256) + *upto++;
+            if (upto >= end)
+                return pe_unexpected_end;
+        }
+    }
+    else if ((type >= 1 && type <= 5) || type == 16 || type == 17)
+    {
+        length =
+            (type == 1
+                 ? 2
+                 : (type == 2
+                        ? 4
+                        : (type == 3
+                               ? 8
+                               : (type == 4
+                                      ? 16
+                                      : (type == 5
+                                             ? 32
+                                             : (type == 16
+                                                    ? 1
+                                                    : (type == 17 ? 20
+                                                                  : -1)))))));
+    }
+    else if (type == 6) /* AMOUNT */
+    {
+        length = (*upto >> 6 == 1) ? 8 : 48;
+        if (upto >= end)
+            return pe_unexpected_end;
+    }
+
+    if (length > -1)
+    {
+        payload_start = upto - start;
+        payload_length = length;
+        return length + (upto - start);
+    }
+
+    if (type == 15 || type == 14) /* Object / Array */
+    {
+        payload_start = upto - start;
+
+        for (int i = 0; i < 1024; ++i)
+        {
+            int subfield = -1, subtype = -1, payload_start_ = -1,
+                payload_length_ = -1;
+            int32_t sublength = get_stobject_length(
+                upto,
+                end,
+                subtype,
+                subfield,
+                payload_start_,
+                payload_length_,
+                recursion_depth + 1);
+            if (sublength < 0)
+                return pe_unexpected_end;
+            upto += sublength;
+            if (upto >= end)
+                return pe_unexpected_end;
+
+            if ((*upto == 0xE1U && type == 0xEU) ||
+                (*upto == 0xF1U && type == 0xFU))
+            {
+                payload_length = upto - start - payload_start;
+                upto++;
+                return (upto - start);
+            }
+        }
+        return pe_excessive_size;
+    }
+
+    return pe_unknown_type_late;
+}
+
+// sto_subfield on the whole of b
+inline int64_t
+sto_subfield(ripple::Blob const& b, uint32_t field_id)
+{
+    using namespace hook_api;
+
+    if (b.size() < 2)
+        return TOO_SMALL;
+
+    unsigned char const* start = b.data();
+    unsigned char const* upto = start;
+    unsigned char const* end = start + b.size();
+
+    for (int i = 0; i < 1024 && upto < end; ++i)
+    {
+        int type = -1, field = -1, payload_start = -1, payload_length = -1;
+        int32_t length = get_stobject_length(
+            upto, end, type, field, payload_start, payload_length, 0);
+        if (length < 0)
+            return PARSE_ERROR;
+        if ((type << 16) + field == field_id)
+        {
+            if (type == 0xF)  // we return arrays fully formed
+                return (((int64_t)(upto - start))
+                        << 32) /* start of the object */
+                    + (uint32_t)(length);
+
+            // return pointers to all other objects as payloads
+            return (((int64_t)(upto - start + payload_start))
+                    << 32U) /* start of the object */
+                + (uint32_t)(payload_length);
+        }
+        upto += length;
+    }
+
+    if (upto != end)
+        return PARSE_ERROR;
+
+    return DOESNT_EXIST;
+}
+
+// sto_subarray on the whole of b
+inline int64_t
+sto_subarray(ripple::Blob const& b, uint32_t index_id)
+{
+    using namespace hook_api;
+
+    if (b.size() < 2)
+        return TOO_SMALL;
+
+    unsigned char const* start = b.data();
+    unsigned char const* upto = start;
+    unsigned char const* end = start + b.size();
+
+    // unwrap the array if it is wrapped,
+    // by removing a byte from the start and end
+    if ((*upto & 0xF0U) == 0xF0U)
+    {
+        upto++;
+        end--;
+    }
+
+    if (upto >= end)
+        return PARSE_ERROR;
+
+    for (int i = 0; i < 1024 && upto < end; ++i)
+    {
+        int type = -1, field = -1, payload_start = -1, payload_length = -1;
+        int32_t length = get_stobject_length(
+            upto, end, type, field, payload_start, payload_length, 0);
+        if (length < 0)
+            return PARSE_ERROR;
+
+        if (i == index_id)
+            return (((int64_t)(upto - start)) << 32U) /* start of the object */
+                + (int64_t)(length);
+        upto += length;
+    }
+
+    if (upto != end)
+        return PARSE_ERROR;
+
+    return DOESNT_EXIST;
+}
+
+}  // namespace sto_reference
+
+class HookSTOIndex_test : public beast::unit_test::suite
+{
+    // the fields a scan from the start of the buffer with the original
+    // parser reads
+    static std::vector<hook::STOIndex::Field>
+    scan(ripple::Blob const& b, bool& error, std::size_t& end)
+    {
+        std::vector<hook::STOIndex::Field> ret;
+        auto const* start = b.data();
+        auto const* upto = start;
+        auto const* last = start + b.size();
+
+        error = false;
+        for (int i = 0; i < 1024 && upto < last; ++i)
+        {
+            int type = -1, field = -1, payloadStart = -1, payloadLength = -1;
+            auto const length = sto_reference::get_stobject_length(
+                upto, last, type, field, payloadStart, payloadLength);
+            if (length < 0)
+            {
+                error = true;
+                break;
+            }
+
+            std::uint32_t const offset = upto - start;
+            ret.push_back(
+                {static_cast<std::uint32_t>((type << 16) + field),
+                 offset,
+                 static_cast<std::uint32_t>(length),
+                 offset + payloadStart,
+                 static_cast<std::uint32_t>(payloadLength)});
+            upto += length;
+        }
+
+        end = upto - start;
+        return ret;
+    }
+
+    static bool
+    same(hook::STOIndex::Field const* a, hook::STOIndex::Field const* b)
+    {
+        if (!a || !b)
+            return a == b;
+        return a->id == b->id && a->offset == b->offset &&
+            a->length == b->length && a->payloadOffset == b->payloadOffset &&
+            a->payloadLength == b->payloadLength;
+    }
+
+    // what sto_subfield now returns for b
+    static std::int64_t
+    subfield(ripple::Blob const& b, std::uint32_t id)
+    {
+        if (b.size() < 2)
+            return hook_api::TOO_SMALL;
+        return hook::STOIndex{b.data(), b.size()}.subfield(id);
+    }
+
+    // and sto_subarray, which leaves out the wrapping of an array
+    static std::int64_t
+    subarray(ripple::Blob const& b, std::uint32_t position)
+    {
+        if (b.size() < 2)
+            return hook_api::TOO_SMALL;
+        std::uint32_t const skip = (b[0] & 0xF0U) == 0xF0U ? 1 : 0;
+        if (b.size() == skip * 2)
+            return hook_api::PARSE_ERROR;
+        return hook::STOIndex{b.data() + skip, b.size() - skip * 2}.subarray(
+            position, skip);
+    }
+
+    // compare the index of b to the original parser and lookups
+    void
+    expectScanned(ripple::Blob const& b)
+    {
+        using hook::STOIndex;
+
+        bool error = false;
+        std::size_t end = 0;
+        auto const fields = scan(b, error, end);
+        STOIndex const index{b.data(), b.size()};
+
+        BEAST_EXPECT(index.fields().size() == fields.size());
+        BEAST_EXPECT(index.parseError() == error);
+        BEAST_EXPECT(index.end() == end);
+        BEAST_EXPECT(index.valid() == (!error && end == b.size()));
+
+        for (std::size_t i = 0;
+             i < std::min(fields.size(), index.fields().size());
+             ++i)
+            BEAST_EXPECT(same(&index.fields()[i], &fields[i]));
+
+        // every id present, and the ids either side of them
+        std::vector<std::uint32_t> ids{0, 0xFFFFFFFFU};
+        for (auto const& f : fields)
+        {
+            ids.push_back(f.id - 1);
+            ids.push_back(f.id);
+            ids.push_back(f.id + 1);
+        }
+
+        for (auto const id : ids)
+        {
+            STOIndex::Field const* first = nullptr;
+            STOIndex::Field const* notLess = nullptr;
+            for (auto const& f : fields)
+            {
+                if (!first && f.id == id)
+                    first = &f;
+                if (!notLess && f.id >= id)
+                    notLess = &f;
+            }
+
+            BEAST_EXPECT(same(index.find(id), first));
+            BEAST_EXPECT(same(index.lowerBound(id), notLess));
+            BEAST_EXPECT(subfield(b, id) == sto_reference::sto_subfield(b, id));
+        }
+
+        // every position, and those past the end
+        for (std::uint32_t i = 0; i < fields.size() + 2; ++i)
+            BEAST_EXPECT(subarray(b, i) == sto_reference::sto_subarray(b, i));
+    }
+
+    void
+    testOffsets()
+    {
+        testcase("Offsets of a hand built object");
+
+        using namespace hook_api;
+        auto const at = [](std::int64_t offset, std::int64_t length) {
+            return (offset << 32) + length;
+        };
+
+        // TransactionType, Flags and Account
+        ripple::Blob b{
+            0x12, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x01, 0x81, 20};
+        b.resize(30, 0xAB);
+
+        for (auto const& sto : {subfield, sto_reference::sto_subfield})
+        {
+            BEAST_EXPECT(sto(b, 0x10002U) == at(1, 2));
+            BEAST_EXPECT(sto(b, 0x20002U) == at(4, 4));
+            BEAST_EXPECT(sto(b, 0x80001U) == at(10, 20));
+            BEAST_EXPECT(sto(b, 0x20003U) == DOESNT_EXIST);
+
+            // cut short, the fields before the cut are still found, as is
+            // the one it cuts, but a field that isn't there can't be told
+            // from one that was cut off
+            ripple::Blob const cut{b.begin(), b.end() - 1};
+            BEAST_EXPECT(sto(cut, 0x10002U) == at(1, 2));
+            BEAST_EXPECT(sto(cut, 0x80001U) == at(10, 20));
+            BEAST_EXPECT(sto(cut, 0x20003U) == PARSE_ERROR);
+
+            // an unknown type stops the scan where it is
+            auto bad = b;
+            bad[3] = 0x92;
+            BEAST_EXPECT(sto(bad, 0x10002U) == at(1, 2));
+            BEAST_EXPECT(sto(bad, 0x20002U) == PARSE_ERROR);
+            BEAST_EXPECT(sto(bad, 0x80001U) == PARSE_ERROR);
+
+            BEAST_EXPECT(sto(ripple::Blob{0x12}, 0x10002U) == TOO_SMALL);
+        }
+
+        // Memos holding one Memo with a one byte MemoType
+        ripple::Blob const memos{0xF9, 0xEA, 0x7C, 0x01, 0xAB, 0xE1, 0xF1};
+
+        for (auto const& sto : {subfield, sto_reference::sto_subfield})
+            BEAST_EXPECT(sto(memos, 0xF0009U) == at(0, 7));
+
+        for (auto const& sto : {subarray, sto_reference::sto_subarray})
+        {
+            BEAST_EXPECT(sto(memos, 0) == at(1, 5));
+            BEAST_EXPECT(sto(memos, 1) == DOESNT_EXIST);
+
+            // the Memo without its end marker
+            ripple::Blob const open{0xF9, 0xEA, 0x7C, 0x01, 0xAB, 0xF1};
+            BEAST_EXPECT(sto(open, 0) == PARSE_ERROR);
+
+            // nothing but the wrapping
+            BEAST_EXPECT(sto(ripple::Blob{0xF9, 0xF1}, 0) == PARSE_ERROR);
+        }
+    }
+
+    void
+    testObjects(STOBlobs const& corpus)
+    {
+        testcase("Index of well formed objects");
+
+        for (auto const& blob : corpus.blobs)
+        {
+            auto const& b = blob.bytes;
+            hook::STOIndex const index{b.data(), b.size()};
+
+            BEAST_EXPECT(index.valid());
+            expectScanned(b);
+
+            std::size_t count = 0;
+            for (auto const& field : *blob.object)
+            {
+                if (field.getSType() == STI_NOTPRESENT ||
+                    !field.getFName().shouldInclude(true))
+                    continue;
+                ++count;
+
+                auto const* f = index.find(field.getFName().fieldCode);
+                if (!BEAST_EXPECT(f))
+                    continue;
+
+                // the payload is what the field serializes, less the length
+                // prefix for variable length fields
+                Serializer s;
+                field.add(s);
+                BEAST_EXPECT(f->payloadLength <= s.size());
+                BEAST_EXPECT(s.size() - f->payloadLength <= 3);
+                BEAST_EXPECT(std::equal(
+                    b.begin() + f->payloadOffset,
+                    b.begin() + f->payloadOffset + f->payloadLength,
+                    s.end() - f->payloadLength));
+            }
+            BEAST_EXPECT(index.fields().size() == count);
+        }
+    }
+
+    void
+    testMalformed(STOBlobs const& corpus)
+    {
+        testcase("Index of malformed objects");
+
+        for (auto const& blob : corpus.blobs)
+        {
+            auto const& b = blob.bytes;
+
+            // objects cut short anywhere
+            for (std::size_t n = 1; n < b.size(); ++n)
+                expectScanned(ripple::Blob{b.begin(), b.begin() + n});
+
+            // and with any one byte changed
+            for (std::size_t i = 0; i < b.size(); i += 7)
+            {
+                auto c = b;
+                c[i] ^= 0xA5U;
+                expectScanned(c);
+            }
+        }
+
+        // fields out of canonical order, and repeated
+        auto const& b = corpus.blobs.front().bytes;
+        hook::STOIndex const index{b.data(), b.size()};
+        if (BEAST_EXPECT(index.fields().size() > 2))
+        {
+            auto const& first = index.fields()[0];
+            auto const& second = index.fields()[1];
+            ripple::Blob shuffled{
+                b.begin() + second.offset,
+                b.begin() + second.offset + second.length};
+            shuffled.insert(
+                shuffled.end(),
+                b.begin() + first.offset,
+                b.begin() + first.offset + first.length);
+            shuffled.insert(
+                shuffled.end(),
+                b.begin() + second.offset,
+                b.begin() + second.offset + second.length);
+            expectScanned(shuffled);
+        }
+    }
+
+    void
+    testCache(STOBlobs const& corpus)
+    {
+        testcase("Index cache");
+
+        hook::STOIndexCache cache;
+        auto b = corpus.blobs.front().bytes;
+
+        auto const* first = &cache.get(100, b.data(), b.size());
+        BEAST_EXPECT(first->valid());
+
+        // the same buffer at the same place is not parsed again
+        BEAST_EXPECT(&cache.get(100, b.data(), b.size()) == first);
+
+        // the same bytes elsewhere in memory are indexed separately
+        BEAST_EXPECT(&cache.get(200, b.data(), b.size()) != first);
+
+        // as is the buffer once the hook has rewritten it
+        b[0] = 0;
+        auto const& rewritten = cache.get(100, b.data(), b.size());
+        BEAST_EXPECT(&rewritten != first);
+        BEAST_EXPECT(!rewritten.valid());
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+        Env env{*this, supported_amendments()};
+        STOBlobs const corpus{env};
+        BEAST_EXPECT(corpus.blobs.size() == 9);
+
+        testOffsets();
+        testObjects(corpus);
+        testMalformed(corpus);
+        testCache(corpus);
+    }
+};
+
+// Compares looking up every field of real transactions and ledger entries by
+// scanning from the start, as sto_subfield did, to looking it up in the index.
+//
+// Run with --unittest=HookSTOIndexBench --unittest-arg=<rounds>
+class HookSTOIndexBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    static std::int64_t
+    indexFor(
+        hook::STOIndexCache& cache,
+        ripple::Blob const& b,
+        std::uint32_t id)
+    {
+        return cache.get(0, b.data(), b.size()).subfield(id);
+    }
+
+public:
+    void
+    run() override
+    {
+        auto const rounds = benchRounds(*this, 10000);
+
+        using namespace jtx;
+        Env env{*this, supported_amendments()};
+        STOBlobs const corpus{env};
+
+        log << std::fixed << std::setprecision(1);
+
+        for (auto const& blob : corpus.blobs)
+        {
+            auto const& b = blob.bytes;
+            hook::STOIndex const fields{b.data(), b.size()};
+
+            std::int64_t check = 0;
+            auto const scanStart = clock_type::now();
+            for (std::size_t r = 0; r < rounds; ++r)
+                for (auto const& f : fields.fields())
+                    check += sto_reference::sto_subfield(b, f.id);
+            auto const scanElapsed = clock_type::now() - scanStart;
+
+            // a fresh cache per round, as each hook execution has its own
+            auto const indexStart = clock_type::now();
+            for (std::size_t r = 0; r < rounds; ++r)
+            {
+                hook::STOIndexCache cache;
+                for (auto const& f : fields.fields())
+                    check -= indexFor(cache, b, f.id);
+            }
+            auto const indexElapsed = clock_type::now() - indexStart;
+
+            BEAST_EXPECT(check == 0);
+
+            auto const lookups =
+                static_cast<double>(rounds * fields.fields().size());
+            auto const ns = [&](clock_type::duration d) {
+                return std::chrono::duration<double, std::nano>(d).count() /
+                    lookups;
+            };
+
+            log << blob.name << " (" << b.size() << " bytes, "
+                << fields.fields().size() << " fields): scan "
+                << ns(scanElapsed) << " ns/lookup, index "
+                << ns(indexElapsed) << " ns/lookup" << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookSTOIndex, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(HookSTOIndexBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
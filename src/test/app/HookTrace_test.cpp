@@ -0,0 +1,329 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/TraceSink.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/jss.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class HookTrace_test : public beast::unit_test::suite
+{
+    using TraceSink = hook::TraceSink;
+    using Record = TraceSink::Record;
+
+    static AccountID
+    account(std::uint8_t n)
+    {
+        AccountID id;
+        std::memset(id.data(), n, id.size());
+        return id;
+    }
+
+    // a record as the host functions fill it in, after they strip a
+    // trailing \0 from the message
+    static Record
+    record(
+        TraceSink::Kind kind,
+        std::string_view message,
+        std::string_view data = {},
+        std::int64_t number = 0,
+        bool asHex = false)
+    {
+        Record r;
+        r.hookHash = uint256{1};
+        r.account = account(1);
+        r.otxnAccount = account(2);
+        r.txID = uint256{3};
+        r.kind = kind;
+        r.hasMessage = !message.empty();
+        if (!message.empty() && message.back() == '\0')
+            message.remove_suffix(1);
+        r.messageSize = message.size();
+        std::memcpy(r.message.data(), message.data(), message.size());
+        r.dataSize = data.size();
+        std::memcpy(r.data.data(), data.data(), data.size());
+        r.number = number;
+        r.asHex = asHex;
+        return r;
+    }
+
+    static void
+    fillFrom(Record& to, Record const& from)
+    {
+        to.hookHash = from.hookHash;
+        to.account = from.account;
+        to.otxnAccount = from.otxnAccount;
+        to.txID = from.txID;
+        to.kind = from.kind;
+        to.hasMessage = from.hasMessage;
+        to.asHex = from.asHex;
+        to.messageSize = from.messageSize;
+        to.message = from.message;
+        to.dataSize = from.dataSize;
+        to.data = from.data;
+        to.number = from.number;
+    }
+
+    void
+    testText()
+    {
+        testcase("Text");
+
+        using namespace std::literals;
+        using Kind = TraceSink::Kind;
+        std::string const acc =
+            "HookTrace[" + toBase58(account(1)) + "-" + toBase58(account(2));
+
+        // trace
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::text, "msg", "data")) ==
+            acc + "]: msg: data");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::text, "msg\0"sv, "data")) ==
+            acc + "]: msg: data");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::text, "msg", "\x01\xAB", 0, true)) ==
+            acc + "]: msg: 01AB");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::text, "", "h\0i\0"sv)) ==
+            acc + "]: hi");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::text, "\0"sv, "")) == acc + "]: : ");
+        BEAST_EXPECT(TraceSink::text(record(Kind::text, "", "")).empty());
+
+        // trace_num
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::number, "n", {}, -42)) ==
+            acc + "]: n: -42");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::number, "", {}, 7)) == acc + "]: 7");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::number, "\0"sv, {}, 7)) ==
+            acc + "]: 7");
+
+        // trace_float
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::xfl, "f", {}, 0)) ==
+            acc + "]:f: Float 0*10^(0) <ZERO>");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::xfl, "f", {}, -1)) ==
+            acc + "]:f: Float <INVALID>");
+        // 1 and -1
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::xfl, "", {}, 6089866696204910592LL)) ==
+            acc + "]:: Float 1000000000000000*10^(-15)");
+        BEAST_EXPECT(
+            TraceSink::text(record(Kind::xfl, "", {}, 1478180677777522688LL)) ==
+            acc + "]:: Float -1000000000000000*10^(-15)");
+
+        auto const jv = TraceSink::json(record(Kind::number, "n", {}, 5));
+        BEAST_EXPECT(jv[jss::type] == "hookTrace");
+        BEAST_EXPECT(jv[jss::hook_hash] == to_string(uint256{1}));
+        BEAST_EXPECT(jv[jss::account] == toBase58(account(1)));
+        BEAST_EXPECT(jv[jss::otxn_account] == toBase58(account(2)));
+        BEAST_EXPECT(jv[jss::hash] == to_string(uint256{3}));
+        BEAST_EXPECT(jv[jss::message] == "n");
+        BEAST_EXPECT(jv[jss::value] == "5");
+    }
+
+    void
+    testDisabled()
+    {
+        testcase("Disabled");
+
+        StreamSink sink{beast::severities::kDebug};
+        TraceSink traces{beast::Journal{sink}};
+
+        BEAST_EXPECT(!traces.enabled());
+        traces.setStreaming(true);
+        BEAST_EXPECT(traces.enabled());
+        traces.setStreaming(false);
+        BEAST_EXPECT(!traces.enabled());
+
+        StreamSink traceSink{beast::severities::kTrace};
+        TraceSink logged{beast::Journal{traceSink}};
+        BEAST_EXPECT(logged.enabled());
+
+        // not started: the writer drains what it wrote
+        auto const r = record(TraceSink::Kind::number, "n", {}, 1);
+        BEAST_EXPECT(
+            logged.write([&](Record& to) { fillFrom(to, r); }));
+        BEAST_EXPECT(
+            traceSink.messages().str() == TraceSink::text(r) + "\n");
+    }
+
+    void
+    testCapture()
+    {
+        testcase("Capture");
+
+        StreamSink sink{beast::severities::kTrace};
+        TraceSink traces{beast::Journal{sink}};
+        auto const r = record(TraceSink::Kind::number, "n", {}, 1);
+
+        std::vector<Record> kept;
+        {
+            TraceSink::Capture capture;
+            BEAST_EXPECT(TraceSink::capturing());
+            BEAST_EXPECT(traces.write([&](Record& to) { fillFrom(to, r); }));
+            BEAST_EXPECT(capture.records().size() == 1);
+            kept = capture.release();
+        }
+        BEAST_EXPECT(!TraceSink::capturing());
+
+        // nothing reached the journal until the records are replayed
+        BEAST_EXPECT(sink.messages().str().empty());
+        traces.replay(kept);
+        BEAST_EXPECT(sink.messages().str() == TraceSink::text(r) + "\n");
+    }
+
+    void
+    testFull()
+    {
+        testcase("Full");
+
+        StreamSink sink{beast::severities::kWarning};
+        TraceSink traces{beast::Journal{sink}};
+        traces.setStreaming(true);
+
+        // hold the drain thread in the first record it publishes
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool publishing = false;
+        bool release = false;
+        std::size_t published = 0;
+
+        traces.start([&](Json::Value const&) {
+            std::unique_lock lock(mutex);
+            if (!publishing)
+            {
+                publishing = true;
+                cv.notify_all();
+                cv.wait(lock, [&] { return release; });
+            }
+            ++published;
+        });
+
+        auto const r = record(TraceSink::Kind::number, "n", {}, 1);
+        auto const write = [&] {
+            return traces.write([&](Record& to) { fillFrom(to, r); });
+        };
+
+        BEAST_EXPECT(write());
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return publishing; });
+        }
+
+        // the record being published still holds its cell
+        for (std::size_t i = 1; i < TraceSink::capacity; ++i)
+            BEAST_EXPECT(write());
+        BEAST_EXPECT(!write());
+        BEAST_EXPECT(traces.dropped() == 1);
+
+        {
+            std::lock_guard lock(mutex);
+            release = true;
+        }
+        cv.notify_all();
+        traces.stop();
+
+        BEAST_EXPECT(published == TraceSink::capacity);
+        BEAST_EXPECT(
+            sink.messages().str().find("1 traces dropped") !=
+            std::string::npos);
+    }
+
+    void
+    testWriters()
+    {
+        testcase("Writers");
+
+        StreamSink sink{beast::severities::kWarning};
+        TraceSink traces{beast::Journal{sink}};
+        traces.setStreaming(true);
+
+        constexpr std::size_t writers = 4;
+        constexpr std::int64_t perWriter = 20000;
+
+        // only the drain thread publishes
+        std::vector<std::int64_t> last(writers, -1);
+        std::size_t published = 0;
+        bool ordered = true;
+        traces.start([&](Json::Value const& jv) {
+            auto const writer = std::stoul(jv[jss::message].asString());
+            auto const n = std::stoll(jv[jss::value].asString());
+            ordered = ordered && n > last[writer];
+            last[writer] = n;
+            ++published;
+        });
+
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < writers; ++w)
+        {
+            threads.emplace_back([&traces, w] {
+                auto const message = std::to_string(w);
+                for (std::int64_t n = 0; n < perWriter; ++n)
+                {
+                    traces.write([&](Record& r) {
+                        r.kind = TraceSink::Kind::number;
+                        r.number = n;
+                        r.messageSize = message.size();
+                        std::memcpy(
+                            r.message.data(), message.data(), message.size());
+                    });
+                }
+            });
+        }
+
+        for (auto& t : threads)
+            t.join();
+        traces.stop();
+
+        log << "  published " << published << ", dropped " << traces.dropped()
+            << std::endl;
+        BEAST_EXPECT(published + traces.dropped() == writers * perWriter);
+        BEAST_EXPECT(ordered);
+    }
+
+public:
+    void
+    run() override
+    {
+        testText();
+        testDisabled();
+        testCapture();
+        testFull();
+        testWriters();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookTrace, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
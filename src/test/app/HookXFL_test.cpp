@@ -0,0 +1,866 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/XFL.h>
+#include <ripple/basics/IOUAmount.h>
+#include <ripple/basics/Number.h>
+#include <ripple/beast/unit_test.h>
+#include <test/unit_test/BenchRounds.h>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cfenv>
+#include <chrono>
+#include <iomanip>
+#include <random>
+
+namespace ripple {
+namespace test {
+
+// The float_* kernels as they were before XFL.h, which the kernels there
+// must match exactly.
+namespace xfl_reference {
+
+using namespace hook_api;
+using hook_float::get_exponent;
+using hook_float::get_mantissa;
+using hook_float::is_negative;
+using hook_float::maxExponent;
+using hook_float::maxMantissa;
+using hook_float::minExponent;
+using hook_float::minMantissa;
+using hook_float::power_of_ten;
+using hook_float::set_exponent;
+using hook_float::set_mantissa;
+using hook_float::set_sign;
+
+#define RETURN_IF_INVALID_FLOAT(float1)                             \
+    {                                                               \
+        if (float1 < 0)                                             \
+            return hook_api::INVALID_FLOAT;                         \
+        if (float1 != 0)                                            \
+        {                                                           \
+            uint64_t mantissa = get_mantissa(float1);               \
+            int32_t exponent = get_exponent(float1);                \
+            if (mantissa < minMantissa || mantissa > maxMantissa || \
+                exponent > maxExponent || exponent < minExponent)   \
+                return INVALID_FLOAT;                               \
+        }                                                           \
+    }
+
+inline int64_t
+make_float(ripple::IOUAmount& amt)
+{
+    int64_t man_out = amt.mantissa();
+    int64_t float_out = 0;
+    bool neg = man_out < 0;
+    if (neg)
+        man_out *= -1;
+
+    float_out = set_sign(float_out, neg);
+    float_out = set_mantissa(float_out, (uint64_t)man_out);
+    float_out = set_exponent(float_out, amt.exponent());
+    return float_out;
+}
+
+inline int64_t
+make_float(uint64_t mantissa, int32_t exponent, bool neg)
+{
+    return hook_float::make_float(mantissa, exponent, neg);
+}
+
+template <typename T>
+inline int64_t
+normalize_xfl(T& man, int32_t& exp, bool neg = false)
+{
+    if (man == 0)
+        return 0;
+
+    if (man == std::numeric_limits<int64_t>::min())
+        man++;
+
+    constexpr bool sman = std::is_same<T, int64_t>::value;
+    static_assert(sman || std::is_same<T, uint64_t>());
+
+    if constexpr (sman)
+    {
+        if (man < 0)
+        {
+            man *= -1LL;
+            neg = true;
+        }
+    }
+
+    // mantissa order
+    std::feclearexcept(FE_ALL_EXCEPT);
+    int32_t mo = log10(man);
+    // defensively ensure log10 produces a sane result; we'll borrow the
+    // overflow error code if it didn't
+    if (std::fetestexcept(FE_INVALID))
+        return XFL_OVERFLOW;
+
+    int32_t adjust = 15 - mo;
+
+    if (adjust > 0)
+    {
+        // defensive check
+        if (adjust > 18)
+            return 0;
+        man *= power_of_ten[adjust];
+        exp -= adjust;
+    }
+    else if (adjust < 0)
+    {
+        // defensive check
+        if (-adjust > 18)
+            return XFL_OVERFLOW;
+        man /= power_of_ten[-adjust];
+        exp -= adjust;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    // even after adjustment the mantissa can be outside the range by one place
+    // improving the math above would probably alleviate the need for these
+    // branches
+    if (man < minMantissa)
+    {
+        if (man == minMantissa - 1LL)
+            man += 1LL;
+        else
+        {
+            man *= 10LL;
+            exp--;
+        }
+    }
+
+    if (man > maxMantissa)
+    {
+        if (man == maxMantissa + 1LL)
+            man -= 1LL;
+        else
+        {
+            man /= 10LL;
+            exp++;
+        }
+    }
+
+    if (exp < minExponent)
+    {
+        man = 0;
+        exp = 0;
+        return 0;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    if (exp > maxExponent)
+        return XFL_OVERFLOW;
+
+    int64_t ret = make_float((uint64_t)man, exp, neg);
+    if constexpr (sman)
+    {
+        if (neg)
+            man *= -1LL;
+    }
+
+    return ret;
+}
+
+inline int64_t
+float_multiply_internal_parts(
+    uint64_t man1,
+    int32_t exp1,
+    bool neg1,
+    uint64_t man2,
+    int32_t exp2,
+    bool neg2)
+{
+    using namespace boost::multiprecision;
+    cpp_int mult = cpp_int(man1) * cpp_int(man2);
+    mult /= power_of_ten[15];
+    uint64_t man_out = static_cast<uint64_t>(mult);
+    if (mult > man_out)
+        return XFL_OVERFLOW;
+
+    int32_t exp_out = exp1 + exp2 + 15;
+    bool neg_out = (neg1 && !neg2) || (!neg1 && neg2);
+    int64_t ret = normalize_xfl(man_out, exp_out, neg_out);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+    if (ret == EXPONENT_OVERSIZED)
+        return XFL_OVERFLOW;
+    return ret;
+}
+
+inline int64_t
+float_multiply(int64_t float1, int64_t float2)
+{
+    RETURN_IF_INVALID_FLOAT(float1);
+    RETURN_IF_INVALID_FLOAT(float2);
+
+    if (float1 == 0 || float2 == 0)
+        return 0;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    bool neg1 = is_negative(float1);
+    uint64_t man2 = get_mantissa(float2);
+    int32_t exp2 = get_exponent(float2);
+    bool neg2 = is_negative(float2);
+
+    return float_multiply_internal_parts(man1, exp1, neg1, man2, exp2, neg2);
+}
+
+const int64_t float_one_internal = make_float(1000000000000000ull, -15, false);
+
+inline int64_t
+float_divide_internal(int64_t float1, int64_t float2, bool hasFix)
+{
+    RETURN_IF_INVALID_FLOAT(float1);
+    RETURN_IF_INVALID_FLOAT(float2);
+    if (float2 == 0)
+        return DIVISION_BY_ZERO;
+    if (float1 == 0)
+        return 0;
+
+    // special case: division by 1
+    // RH TODO: add more special cases (division by power of 10)
+    if (float2 == float_one_internal)
+        return float1;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    bool neg1 = is_negative(float1);
+    uint64_t man2 = get_mantissa(float2);
+    int32_t exp2 = get_exponent(float2);
+    bool neg2 = is_negative(float2);
+
+    int64_t tmp1 = normalize_xfl(man1, exp1);
+    int64_t tmp2 = normalize_xfl(man2, exp2);
+
+    if (tmp1 < 0 || tmp2 < 0)
+        return INVALID_FLOAT;
+
+    if (tmp1 == 0)
+        return 0;
+
+    while (man2 > man1)
+    {
+        man2 /= 10;
+        exp2++;
+    }
+
+    if (man2 == 0)
+        return DIVISION_BY_ZERO;
+
+    while (man2 < man1)
+    {
+        if (man2 * 10 > man1)
+            break;
+        man2 *= 10;
+        exp2--;
+    }
+
+    uint64_t man3 = 0;
+    int32_t exp3 = exp1 - exp2;
+
+    while (man2 > 0)
+    {
+        int i = 0;
+        if (hasFix)
+        {
+            for (; man1 >= man2; man1 -= man2, ++i)
+                ;
+        }
+        else
+        {
+            for (; man1 > man2; man1 -= man2, ++i)
+                ;
+        }
+
+        man3 *= 10;
+        man3 += i;
+        man2 /= 10;
+        if (man2 == 0)
+            break;
+        exp3--;
+    }
+
+    bool neg3 = !((neg1 && neg2) || (!neg1 && !neg2));
+
+    return normalize_xfl(man3, exp3, neg3);
+}
+
+inline int64_t
+float_sum(int64_t float1, int64_t float2)
+{
+    RETURN_IF_INVALID_FLOAT(float1);
+    RETURN_IF_INVALID_FLOAT(float2);
+
+    if (float1 == 0)
+        return float2;
+    if (float2 == 0)
+        return float1;
+
+    int64_t man1 =
+        (int64_t)(get_mantissa(float1)) * (is_negative(float1) ? -1LL : 1LL);
+    int32_t exp1 = get_exponent(float1);
+    int64_t man2 =
+        (int64_t)(get_mantissa(float2)) * (is_negative(float2) ? -1LL : 1LL);
+    int32_t exp2 = get_exponent(float2);
+
+    try
+    {
+        ripple::IOUAmount amt1{man1, exp1};
+        ripple::IOUAmount amt2{man2, exp2};
+        amt1 += amt2;
+        int64_t result = make_float(amt1);
+        if (result == EXPONENT_UNDERSIZED)
+        {
+            // this is an underflow e.g. as a result of subtracting an xfl from
+            // itself and thus not an error, just return canonical 0
+            return 0;
+        }
+        return result;
+    }
+    catch (std::overflow_error& e)
+    {
+        return XFL_OVERFLOW;
+    }
+}
+
+inline int64_t
+double_to_xfl(double x)
+{
+    if ((x) == 0)
+        return 0;
+    bool neg = x < 0;
+    double absresult = neg ? -x : x;
+
+    // first compute the base 10 order of the float
+    int32_t exp_out = (int32_t)log10(absresult);
+
+    // next adjust it into the valid mantissa range (this means dividing by its
+    // order and multiplying by 10**15)
+    absresult *= pow(10, -exp_out + 15);
+
+    // after adjustment the value may still fall below the minMantissa
+    int64_t result = (int64_t)absresult;
+    if (result < minMantissa)
+    {
+        if (result == minMantissa - 1LL)
+            result += 1LL;
+        else
+        {
+            result *= 10LL;
+            exp_out--;
+        }
+    }
+
+    // likewise the value can fall above the maxMantissa
+    if (result > maxMantissa)
+    {
+        if (result == maxMantissa + 1LL)
+            result -= 1LL;
+        else
+        {
+            result /= 10LL;
+            exp_out++;
+        }
+    }
+
+    exp_out -= 15;
+    int64_t ret = make_float(result, exp_out, neg);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+
+    return ret;
+}
+
+inline int64_t
+float_log(int64_t float1)
+{
+    RETURN_IF_INVALID_FLOAT(float1);
+
+    if (float1 == 0)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1);
+    double result = log10(inp) + exp1;
+
+    return double_to_xfl(result);
+}
+
+inline int64_t
+float_root(int64_t float1, uint32_t n)
+{
+    RETURN_IF_INVALID_FLOAT(float1);
+    if (float1 == 0)
+        return 0;
+
+    if (n < 2)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1)*pow(10, exp1);
+    double result = pow(inp, ((double)1.0f) / ((double)(n)));
+
+    return double_to_xfl(result);
+}
+
+#undef RETURN_IF_INVALID_FLOAT
+
+}  // namespace xfl_reference
+
+// Operands for the float kernels: every combination of mantissas at and
+// around the edges of the mantissa range, exponents at and around the edges
+// of the exponent range and both signs, plus random floats.
+struct XFLOperands
+{
+    std::vector<int64_t> edges;
+    std::vector<int64_t> random;
+    std::vector<int64_t> invalid;
+
+    XFLOperands()
+    {
+        using namespace hook_float;
+
+        std::vector<uint64_t> const mantissas{
+            1000000000000000ULL,
+            1000000000000001ULL,
+            1000000000000009ULL,
+            1000000000000010ULL,
+            1000000000000099ULL,
+            1000000000099999ULL,
+            1234567890123456ULL,
+            1999999999999999ULL,
+            2000000000000000ULL,
+            3162277660168379ULL,
+            3333333333333333ULL,
+            4999999999999999ULL,
+            5000000000000000ULL,
+            5000000000000001ULL,
+            6666666666666667ULL,
+            9000000000000000ULL,
+            9999999999999990ULL,
+            9999999999999998ULL,
+            9999999999999999ULL};
+        std::vector<int32_t> const exponents{
+            -96, -95, -94, -81, -80, -50, -17, -16, -15, -14,
+            -1,  0,   1,   15,  16,  40,  64,  78,  79,  80};
+
+        for (auto const m : mantissas)
+            for (auto const e : exponents)
+                for (bool const neg : {false, true})
+                    edges.push_back(make_float(m, e, neg));
+
+        std::mt19937_64 rng{0x58464CULL};
+        std::uniform_int_distribution<uint64_t> man{
+            minMantissa, maxMantissa};
+        std::uniform_int_distribution<int32_t> exp{minExponent, maxExponent};
+        for (int i = 0; i < 20000; ++i)
+            random.push_back(make_float(man(rng), exp(rng), rng() & 1));
+
+        invalid = {
+            -1,
+            std::numeric_limits<int64_t>::min(),
+            1,                                 // mantissa too small
+            (int64_t)(1ULL << 54) - 1,         // mantissa too large
+            (int64_t)(0x01ULL << 54) + minMantissa,  // exponent too small
+            (int64_t)(0xFFULL << 54) + minMantissa,  // exponent too large
+        };
+    }
+};
+
+class HookXFL_test : public beast::unit_test::suite
+{
+    // compare a kernel with its reference over operands, logging the first
+    // difference
+    template <class Kernel, class Reference>
+    void
+    compare(
+        std::string const& name,
+        std::vector<std::pair<int64_t, int64_t>> const& operands,
+        Kernel&& kernel,
+        Reference&& reference)
+    {
+        std::size_t mismatches = 0;
+        for (auto const& [a, b] : operands)
+        {
+            auto const got = kernel(a, b);
+            auto const expected = reference(a, b);
+            if (got != expected && mismatches++ == 0)
+                log << name << "(" << a << ", " << b << ") = " << got
+                    << ", expected " << expected << std::endl;
+        }
+        BEAST_EXPECTS(mismatches == 0, name);
+    }
+
+    // every pair of edge operands, the invalid operands against a few valid
+    // ones, and consecutive random operands
+    static std::vector<std::pair<int64_t, int64_t>>
+    pairs(XFLOperands const& ops)
+    {
+        std::vector<std::pair<int64_t, int64_t>> out;
+        for (auto const a : ops.edges)
+        {
+            out.emplace_back(a, 0);
+            out.emplace_back(0, a);
+            for (auto const b : ops.edges)
+                out.emplace_back(a, b);
+        }
+        for (auto const a : ops.invalid)
+            for (auto const b : {int64_t{0}, ops.edges[0], ops.random[0]})
+            {
+                out.emplace_back(a, b);
+                out.emplace_back(b, a);
+            }
+        for (std::size_t i = 1; i < ops.random.size(); ++i)
+        {
+            out.emplace_back(ops.random[i - 1], ops.random[i]);
+            // close exponents, so that sums interact
+            auto const e = hook_float::get_exponent(ops.random[i]);
+            out.emplace_back(
+                ops.random[i],
+                hook_float::set_exponent(
+                    ops.random[i - 1], e - (int32_t)(i % 20)));
+        }
+        return out;
+    }
+
+    void
+    testNormalize()
+    {
+        testcase("normalize_xfl");
+
+        std::vector<int64_t> mantissas{
+            0,
+            1,
+            -1,
+            std::numeric_limits<int64_t>::min(),
+            std::numeric_limits<int64_t>::min() + 1,
+            std::numeric_limits<int64_t>::max()};
+        std::vector<uint64_t> umantissas{
+            std::numeric_limits<uint64_t>::max(), 1ULL << 63};
+
+        // every value within 2000 of a power of ten, and within 2000 of each
+        // power of ten's rounding edge as a double
+        for (int k = 0; k < 20; ++k)
+        {
+            uint64_t const p = hook_float::power_of_ten_u64[k];
+            for (int64_t d = -2000; d <= 2000; ++d)
+            {
+                uint64_t const u = p + d;
+                if ((d < 0 && p < (uint64_t)-d))
+                    continue;
+                umantissas.push_back(u);
+                if (u <= (uint64_t)std::numeric_limits<int64_t>::max())
+                {
+                    mantissas.push_back((int64_t)u);
+                    mantissas.push_back(-(int64_t)u);
+                }
+            }
+        }
+
+        std::mt19937_64 rng{0x4E4F524DULL};
+        for (int i = 0; i < 100000; ++i)
+        {
+            auto const r = rng();
+            auto const v = r >> (rng() % 64);
+            umantissas.push_back(v);
+            mantissas.push_back((int64_t)v * ((r & 1) ? -1 : 1));
+        }
+
+        std::vector<int32_t> const exponents{
+            -200, -112, -111, -97, -96, -30, -15, 0, 15, 64, 65, 80, 81, 200};
+
+        std::size_t mismatches = 0;
+        auto check = [&](auto const m, int32_t const e) {
+            auto m1 = m, m2 = m;
+            int32_t e1 = e, e2 = e;
+            auto const got = hook_float::normalize_xfl(m1, e1);
+            auto const expected = xfl_reference::normalize_xfl(m2, e2);
+            if ((got != expected || m1 != m2 || e1 != e2) && mismatches++ == 0)
+                log << "normalize_xfl(" << m << ", " << e << ") = " << got
+                    << " " << m1 << " " << e1 << ", expected " << expected
+                    << " " << m2 << " " << e2 << std::endl;
+        };
+        for (auto const e : exponents)
+        {
+            for (auto const m : mantissas)
+                check(m, e);
+            for (auto const m : umantissas)
+                check(m, e);
+        }
+        BEAST_EXPECT(mismatches == 0);
+
+        // the decimal order is exact for every power of ten and its neighbours
+        for (int k = 0; k < 20; ++k)
+        {
+            uint64_t const p = hook_float::power_of_ten_u64[k];
+            BEAST_EXPECT(hook_float::decimal_order(p) == k);
+            BEAST_EXPECT(hook_float::decimal_order(p + 1) == k);
+            if (k > 0)
+                BEAST_EXPECT(hook_float::decimal_order(p - 1) == k - 1);
+        }
+        BEAST_EXPECT(
+            hook_float::decimal_order(std::numeric_limits<uint64_t>::max()) ==
+            19);
+    }
+
+    void
+    testArithmetic(XFLOperands const& ops)
+    {
+        testcase("float_multiply, float_divide and float_sum");
+
+        auto const operands = pairs(ops);
+
+        compare(
+            "float_multiply",
+            operands,
+            hook_float::float_multiply_internal,
+            xfl_reference::float_multiply);
+
+        for (bool const hasFix : {false, true})
+            compare(
+                hasFix ? "float_divide" : "float_divide before fix",
+                operands,
+                [&](int64_t a, int64_t b) {
+                    return hook_float::float_divide_internal(a, b, hasFix);
+                },
+                [&](int64_t a, int64_t b) {
+                    return xfl_reference::float_divide_internal(a, b, hasFix);
+                });
+
+        for (bool const switchover : {false, true})
+        {
+            auto const saved = getSTNumberSwitchover();
+            setSTNumberSwitchover(switchover);
+
+            for (auto const mode :
+                 {Number::to_nearest,
+                  Number::towards_zero,
+                  Number::downward,
+                  Number::upward})
+            {
+                auto const savedMode = Number::setround(mode);
+                compare(
+                    "float_sum switchover " + std::to_string(switchover) +
+                        " round " + std::to_string(mode),
+                    operands,
+                    hook_float::float_sum_internal,
+                    xfl_reference::float_sum);
+                Number::setround(savedMode);
+
+                // rounding only matters once Number does the sum
+                if (!switchover)
+                    break;
+            }
+
+            setSTNumberSwitchover(saved);
+        }
+    }
+
+    void
+    testTranscendental(XFLOperands const& ops)
+    {
+        testcase("float_log and float_root");
+
+        std::vector<std::pair<int64_t, int64_t>> operands;
+        for (auto const* set : {&ops.edges, &ops.random, &ops.invalid})
+            for (auto const a : *set)
+                for (int64_t const n : {0, 1, 2, 3, 5, 7, 10, 100})
+                    operands.emplace_back(a, n);
+        operands.emplace_back(0, 2);
+
+        compare(
+            "float_log",
+            operands,
+            [](int64_t a, int64_t) {
+                return hook_float::float_log_internal(a);
+            },
+            [](int64_t a, int64_t) { return xfl_reference::float_log(a); });
+
+        compare(
+            "float_root",
+            operands,
+            [](int64_t a, int64_t n) {
+                return hook_float::float_root_internal(a, n);
+            },
+            [](int64_t a, int64_t n) {
+                return xfl_reference::float_root(a, n);
+            });
+    }
+
+public:
+    void
+    run() override
+    {
+        XFLOperands const ops;
+        testNormalize();
+        testArithmetic(ops);
+        testTranscendental(ops);
+    }
+};
+
+// Run with --unittest=HookXFLBench --unittest-arg=<rounds>
+class HookXFLBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class F>
+    double
+    nsPerOp(
+        std::vector<int64_t> const& operands,
+        std::size_t rounds,
+        int64_t& check,
+        F&& f)
+    {
+        auto const start = clock_type::now();
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 1; i < operands.size(); ++i)
+                check += f(operands[i - 1], operands[i]);
+        return std::chrono::duration<double, std::nano>(
+                   clock_type::now() - start)
+                   .count() /
+            (rounds * (operands.size() - 1));
+    }
+
+    template <class Kernel, class Reference>
+    void
+    measure(
+        std::string const& name,
+        std::vector<int64_t> const& operands,
+        std::size_t rounds,
+        Kernel&& kernel,
+        Reference&& reference)
+    {
+        int64_t check = 0;
+        auto const kernelNs = nsPerOp(operands, rounds, check, kernel);
+        auto const referenceNs = nsPerOp(operands, rounds, check, reference);
+        BEAST_EXPECT(check != 1);  // keep the results alive
+        log << name << ": " << kernelNs << " ns/op, previously "
+            << referenceNs << " ns/op" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        auto const rounds = benchRounds(*this, 10);
+
+        XFLOperands const ops;
+        auto const& operands = ops.random;
+        log << std::fixed << std::setprecision(1);
+
+        measure(
+            "normalize_xfl",
+            operands,
+            rounds,
+            [](int64_t a, int64_t b) {
+                int64_t man = (a ^ b) >> (b & 63);
+                int32_t exp = -15;
+                return hook_float::normalize_xfl(man, exp);
+            },
+            [](int64_t a, int64_t b) {
+                int64_t man = (a ^ b) >> (b & 63);
+                int32_t exp = -15;
+                return xfl_reference::normalize_xfl(man, exp);
+            });
+
+        measure(
+            "float_multiply",
+            operands,
+            rounds,
+            hook_float::float_multiply_internal,
+            xfl_reference::float_multiply);
+
+        measure(
+            "float_divide",
+            operands,
+            rounds,
+            [](int64_t a, int64_t b) {
+                return hook_float::float_divide_internal(a, b, true);
+            },
+            [](int64_t a, int64_t b) {
+                return xfl_reference::float_divide_internal(a, b, true);
+            });
+
+        // sums of operands of nearby exponents, which is where the work is
+        std::vector<int64_t> near;
+        for (auto const f : operands)
+            near.push_back(hook_float::set_exponent(
+                f, (int32_t)(f % 8) - 15));
+
+        for (bool const switchover : {false, true})
+        {
+            auto const saved = getSTNumberSwitchover();
+            setSTNumberSwitchover(switchover);
+            measure(
+                switchover ? "float_sum" : "float_sum before switchover",
+                near,
+                rounds,
+                hook_float::float_sum_internal,
+                xfl_reference::float_sum);
+            setSTNumberSwitchover(saved);
+        }
+
+        measure(
+            "float_log",
+            operands,
+            rounds,
+            [](int64_t a, int64_t) {
+                return hook_float::float_log_internal(a);
+            },
+            [](int64_t a, int64_t) { return xfl_reference::float_log(a); });
+
+        measure(
+            "float_root",
+            operands,
+            rounds,
+            [](int64_t a, int64_t) {
+                return hook_float::float_root_internal(a, 3);
+            },
+            [](int64_t a, int64_t) { return xfl_reference::float_root(a, 3); });
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookXFL, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(HookXFLBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -1545,7 +1545,7 @@ class Import_test : public beast::unit_test::suite
             tmpXpop[jss::validation][jss::unl][jss::blob] = "YmFkSnNvbg==";
             std::string strJson = writer.write(tmpXpop);
             Blob raw(strJson.begin(), strJson.end());
-            auto const xpop = syntaxCheckXPOP(raw, env.journal);
+            auto const xpop = readXPOP(raw, env.journal);
             BEAST_EXPECT(getVLInfo(*xpop, env.journal).has_value() == false);
         }
 
@@ -1555,7 +1555,7 @@ class Import_test : public beast::unit_test::suite
             tmpXpop[jss::validation][jss::unl][jss::manifest] = "YmFkSnNvbg==";
             std::string strJson = writer.write(tmpXpop);
             Blob raw(strJson.begin(), strJson.end());
-            auto const xpop = syntaxCheckXPOP(raw, env.journal);
+            auto const xpop = readXPOP(raw, env.journal);
             BEAST_EXPECT(getVLInfo(*xpop, env.journal).has_value() == false);
         }
 
@@ -1564,7 +1564,7 @@ class Import_test : public beast::unit_test::suite
             Json::Value tmpXpop = xpop;
             std::string strJson = writer.write(tmpXpop);
             Blob raw(strJson.begin(), strJson.end());
-            auto const xpop = syntaxCheckXPOP(raw, env.journal);
+            auto const xpop = readXPOP(raw, env.journal);
             auto const [seq, masterKey] = *getVLInfo(*xpop, env.journal);
             BEAST_EXPECT(std::to_string(seq) == "2");
             BEAST_EXPECT(
@@ -5986,6 +5986,184 @@ class Import_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testVerifiedXPOPCache(FeatureBitset features)
+    {
+        testcase("verified xpop cache");
+
+        using namespace test::jtx;
+        using namespace std::literals;
+
+        test::jtx::Env env{
+            *this, network::makeNetworkVLConfig(21337, keys), features};
+
+        auto const alice = Account("alice");
+        auto const bob = Account("bob");
+        env.memoize(alice);
+        env.memoize(bob);
+
+        auto& cache = env.app().getVerifiedXPOPs();
+        auto const xpopJson = import::loadXpop(ImportTCAccountSet::w_seed);
+
+        auto const importTx = [&](Account const& account,
+                                  Json::Value const& xpop) {
+            Json::Value tx = import::import(account, xpop);
+            tx[jss::Sequence] = 0;
+            tx[jss::Fee] = 0;
+            return tx;
+        };
+
+        // an xpop which fails verification is not kept
+        {
+            Json::Value tmpXpop = xpopJson;
+            tmpXpop[jss::transaction][jss::blob] = "DEADBEEF";
+            tmpXpop[jss::transaction][jss::meta] = "DEADBEEF";
+            env(importTx(alice, tmpXpop), alice, ter(temMALFORMED));
+            BEAST_EXPECT(cache.getCacheSize() == 0);
+        }
+
+        // nor is one imported by the wrong account
+        env(importTx(bob, xpopJson), bob, ter(temMALFORMED));
+        BEAST_EXPECT(cache.getCacheSize() == 0);
+
+        Json::Value const tx = importTx(alice, xpopJson);
+        env(tx, alice, ter(tesSUCCESS));
+
+        auto const key =
+            sha512Half(makeSlice(*strUnHex(tx[jss::Blob].asString())));
+        auto const verified = cache.fetch(key);
+        BEAST_REQUIRE(verified);
+        BEAST_EXPECT(verified->txn->getAccountID(sfAccount) == alice.id());
+        BEAST_EXPECT(verified->meta->isFieldPresent(sfTransactionResult));
+        BEAST_EXPECT(verified->validationCount >= verified->quorum);
+
+        // what depends on the outer txn is still checked for a cached xpop
+        env(importTx(bob, xpopJson), bob, ter(temMALFORMED));
+
+        // and so is the clock
+        env.timeKeeper().set(verified->validUntil);
+        env(importTx(alice, xpopJson), alice, ter(temMALFORMED));
+    }
+
+    void
+    testVerifiedUNLCache(FeatureBitset features)
+    {
+        testcase("verified unl cache");
+
+        using namespace test::jtx;
+        using namespace std::literals;
+
+        test::jtx::Env env{
+            *this, network::makeNetworkVLConfig(21337, keys), features};
+
+        auto const alice = Account("alice");
+        env.memoize(alice);
+
+        auto& unls = env.app().getVerifiedUNLs();
+        auto& xpops = env.app().getVerifiedXPOPs();
+
+        auto const importTx = [&](Json::Value const& xpop) {
+            Json::Value tx = import::import(alice, xpop);
+            tx[jss::Sequence] = 0;
+            tx[jss::Fee] = 0;
+            return tx;
+        };
+
+        // these xpops carry the same unl section
+        auto const regularKey = import::loadXpop(ImportTCSetRegularKey::w_seed);
+        auto const signerList =
+            import::loadXpop(ImportTCSignersListSet::w_seed);
+        auto const flags = import::loadXpop(ImportTCAccountSet::w_flags);
+
+        auto const& unl = regularKey[jss::validation][jss::unl];
+        auto const key = sha512Half(
+            unl[jss::manifest].asString(),
+            unl[jss::blob].asString(),
+            unl[jss::signature].asString());
+
+        env(importTx(regularKey), alice, ter(tesSUCCESS));
+        BEAST_EXPECT(unls.getCacheSize() == 1);
+        BEAST_EXPECT(xpops.getCacheSize() == 1);
+
+        auto const verified = unls.fetch(key);
+        BEAST_REQUIRE(verified);
+        BEAST_EXPECT(verified->validatorCount > 0);
+        BEAST_EXPECT(
+            verified->validators.size() == verified->validatorsMaster.size());
+
+        // a second xpop is verified against the same entry
+        env(importTx(signerList), alice, ter(std::ignore));
+        BEAST_EXPECT(unls.getCacheSize() == 1);
+        BEAST_EXPECT(xpops.getCacheSize() == 2);
+
+        // the entry is dropped once the list expires
+        env.timeKeeper().set(verified->validUntil);
+        env(importTx(flags), alice, ter(temMALFORMED));
+        BEAST_EXPECT(!unls.fetch(key));
+        BEAST_EXPECT(xpops.getCacheSize() == 2);
+    }
+
+    void
+    testBinaryXPOP(FeatureBitset features)
+    {
+        testcase("binary xpop");
+
+        using namespace test::jtx;
+        using namespace std::literals;
+
+        auto const alice = Account("alice");
+        auto const xpopJson = import::loadXpop(ImportTCAccountSet::w_seed);
+        auto const binary = toBinaryXPOP(xpopJson);
+        BEAST_REQUIRE(binary);
+
+        // an import which creates alice
+        auto const importTx = [&](std::optional<Blob> const& blob) {
+            Json::Value tx = import::import(alice, xpopJson);
+            if (blob)
+                tx[jss::Blob] = strHex(*blob);
+            tx[jss::Sequence] = 0;
+            tx[jss::Fee] = 0;
+            return tx;
+        };
+
+        // most of what is left is the signed UNL blob, which is the same
+        auto const jsonBlob =
+            strUnHex(importTx(std::nullopt)[jss::Blob].asString());
+        BEAST_EXPECT(binary->size() < jsonBlob->size() * 2 / 3);
+
+        {
+            test::jtx::Env env{
+                *this,
+                network::makeNetworkVLConfig(21337, keys),
+                features - featureBinaryXPOP};
+            env.memoize(alice);
+
+            env(importTx(binary), alice, ter(temDISABLED));
+            env(importTx(std::nullopt), alice, ter(tesSUCCESS));
+        }
+
+        {
+            test::jtx::Env env{
+                *this, network::makeNetworkVLConfig(21337, keys), features};
+            env.memoize(alice);
+            auto const feeDrops = env.current()->fees().base;
+
+            env(importTx(binary), alice, ter(tesSUCCESS));
+            env.close();
+            BEAST_EXPECT(env.le(keylet::account(alice)) != nullptr);
+
+            // the inner txn was imported, whichever form it comes in
+            env(import::import(alice, xpopJson),
+                alice,
+                fee(feeDrops * 10),
+                ter(tefPAST_IMPORT_SEQ));
+
+            Json::Value tx = import::import(alice, xpopJson);
+            tx[jss::Blob] = strHex(*binary);
+            env(tx, alice, fee(feeDrops * 10), ter(tefPAST_IMPORT_SEQ));
+        }
+    }
+
 public:
     void
     run() override
@@ -6026,6 +6204,9 @@ public:
         testMaxSupply(features);
         testMinMax(features);
         testHalving(features - featureOwnerPaysFee);
+        testVerifiedXPOPCache(features);
+        testVerifiedUNLCache(features);
+        testBinaryXPOP(features);
     }
 };
 
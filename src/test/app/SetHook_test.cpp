@@ -17,10 +17,16 @@
 */
 //==============================================================================
 #include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/ModuleCache.h>
+#include <ripple/app/hook/StatePrefetcher.h>
+#include <ripple/app/hook/ValidationCache.h>
+#include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/tx/impl/ApplyContext.h>
 #include <ripple/app/tx/impl/SetHook.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/json_writer.h>
+#include <ripple/ledger/OpenView.h>
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/protocol/jss.h>
 #include <test/app/SetHook_wasm.h>
@@ -2101,6 +2107,552 @@ public:
         env.close();
     }
 
+    void
+    testModuleCache(FeatureBitset features)
+    {
+        testcase("Test hook module cache");
+        using namespace jtx;
+        Env env{*this, features};
+
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        env.fund(XRP(10000), alice);
+        env.fund(XRP(10000), bob);
+
+        auto& cache = env.app().getHookModuleCache();
+
+        env(ripple::test::jtx::hook(alice, {{hso(accept_wasm)}}, 0),
+            M("Install Accept Hook"),
+            HSFEE);
+        env.close();
+
+        // first execution loads the module, later ones reuse it
+        env(pay(bob, alice, XRP(1)), M("Test Accept Hook"), fee(XRP(1)));
+        auto const misses = cache.misses();
+        auto const hits = cache.hits();
+        BEAST_EXPECT(cache.size() == 1);
+
+        env(pay(bob, alice, XRP(1)), M("Test Accept Hook"), fee(XRP(1)));
+        env.close();
+        BEAST_EXPECT(cache.misses() == misses);
+        BEAST_EXPECT(cache.hits() > hits);
+
+        // deleting the last reference to the definition evicts the module
+        env(ripple::test::jtx::hook(alice, {{hso_delete()}}, 0),
+            M("Delete Accept Hook"),
+            HSFEE);
+        env.close();
+        BEAST_EXPECT(cache.size() == 0);
+    }
+
+    void
+    testValidationCache(FeatureBitset features)
+    {
+        testcase("Test hook validation cache");
+        using namespace jtx;
+        Env env{*this, features};
+
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        env.fund(XRP(10000), alice);
+        env.fund(XRP(10000), bob);
+
+        auto& cache = env.app().getHookValidationCache();
+
+        // the code is validated once, the definition is created from the
+        // cached result
+        env(ripple::test::jtx::hook(alice, {{hso(accept_wasm)}}, 0),
+            M("Install Accept Hook"),
+            HSFEE);
+        env.close();
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.misses() == 1);
+        auto const hits = cache.hits();
+        BEAST_EXPECT(hits > 0);
+
+        // installing the same code again skips validation
+        env(ripple::test::jtx::hook(bob, {{hso(accept_wasm)}}, 0),
+            M("Install Accept Hook again"),
+            HSFEE);
+        env.close();
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.misses() == 1);
+        BEAST_EXPECT(cache.hits() > hits);
+
+        // rejected code is remembered too
+        std::vector<uint8_t> const bad(64, 0);
+        env(ripple::test::jtx::hook(bob, {{hso(bad)}}, 0),
+            M("Install bad code"),
+            HSFEE,
+            ter(temMALFORMED));
+        BEAST_EXPECT(cache.size() == 2);
+        BEAST_EXPECT(cache.misses() == 2);
+
+        env(ripple::test::jtx::hook(alice, {{hso(bad)}}, 0),
+            M("Install bad code again"),
+            HSFEE,
+            ter(temMALFORMED));
+        BEAST_EXPECT(cache.size() == 2);
+        BEAST_EXPECT(cache.misses() == 2);
+    }
+
+    void
+    testStateBatch(FeatureBitset features)
+    {
+        testcase("Test batched hook state commit");
+        using namespace jtx;
+        Env env{*this, features};
+
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        auto const carol = Account{"carol"};
+        env.fund(XRP(100000), alice, bob);
+        env.fund(env.current()->fees().accountReserve(2), carol);
+        env.close();
+
+        uint256 const ns1{1}, ns2{2}, ns3{3};
+        auto const value = [](std::uint32_t i) {
+            return std::string("value ") + std::to_string(i);
+        };
+
+        std::uint32_t seq = 0;
+        auto const accountSet = [&seq](Account const& account) {
+            return STTx{ttACCOUNT_SET, [&](STObject& obj) {
+                            obj.setAccountID(sfAccount, account.id());
+                            obj.setFieldU32(sfSequence, ++seq);
+                        }};
+        };
+
+        // the views hold the same entries and transactions, byte for byte
+        auto const same = [](ReadView const& a, ReadView const& b) {
+            auto ia = a.sles.begin();
+            auto ib = b.sles.begin();
+            for (; ia != a.sles.end() && ib != b.sles.end(); ++ia, ++ib)
+                if ((*ia)->getSerializer().peekData() !=
+                    (*ib)->getSerializer().peekData())
+                    return false;
+            if (ia != a.sles.end() || ib != b.sles.end())
+                return false;
+
+            auto ta = a.txs.begin();
+            auto tb = b.txs.begin();
+            for (; ta != a.txs.end() && tb != b.txs.end(); ++ta, ++tb)
+                if (ta->second->getSerializer().peekData() !=
+                    tb->second->getSerializer().peekData())
+                    return false;
+            return ta == a.txs.end() && tb == b.txs.end();
+        };
+
+        // commit stateMap in a transaction on view, with the batched path
+        // or calling setHookState for each entry as finalizeHookState did.
+        // What is written is applied whatever the result, as the Transactor
+        // does.
+        auto const commit = [&](OpenView& view,
+                                STTx const& tx,
+                                hook::HookStateMap const& stateMap,
+                                bool batched) {
+            ApplyContext applyCtx{
+                env.app(),
+                view,
+                tx,
+                tesSUCCESS,
+                view.fees().base,
+                tapNONE};
+
+            TER result = tesSUCCESS;
+            if (batched)
+                result = hook::finalizeHookState(
+                    stateMap, applyCtx, tx.getTransactionID());
+            else
+            {
+                std::uint32_t changeCount = 0;
+                for (auto const& [entryKey, entry] :
+                     stateMap.modifiedEntries())
+                {
+                    if (++changeCount > hook_api::max_state_modifications + 1)
+                    {
+                        result = tecHOOK_REJECTED;
+                        break;
+                    }
+
+                    auto const& [acc, ns, key] = *entryKey;
+                    result = hook::setHookState(
+                        applyCtx, acc, ns, key, entry->value());
+                    if (!isTesSuccess(result))
+                        break;
+                }
+            }
+
+            applyCtx.apply(result);
+            return result;
+        };
+
+        // commit stateMap both ways on top of parent, expecting result
+        auto const compare = [&](ReadView const& parent,
+                                 Account const& account,
+                                 hook::HookStateMap const& stateMap,
+                                 TER result) {
+            auto const tx = accountSet(account);
+            OpenView serial{&parent};
+            OpenView batched{&parent};
+            BEAST_EXPECT(commit(serial, tx, stateMap, false) == result);
+            BEAST_EXPECT(commit(batched, tx, stateMap, true) == result);
+            BEAST_EXPECT(same(serial, batched));
+        };
+
+        // state spread over several pages of a directory
+        OpenView base{&*env.closed()};
+        BEAST_REQUIRE(!base.open());
+        {
+            hook::HookStateMap stateMap;
+            for (std::uint32_t i = 2; i <= 160; i += 2)
+                stateMap.insert(
+                    alice.id(), ns1, uint256{i}, true, makeSlice(value(i)));
+            for (std::uint32_t i = 1; i <= 40; ++i)
+                stateMap.insert(
+                    alice.id(), ns2, uint256{i}, true, makeSlice(value(i)));
+            for (std::uint32_t i = 1; i <= 5; ++i)
+                stateMap.insert(
+                    bob.id(), ns1, uint256{i}, true, makeSlice(value(i)));
+            BEAST_EXPECT(
+                commit(base, accountSet(alice), stateMap, false) ==
+                tesSUCCESS);
+        }
+
+        auto const dir = keylet::hookStateDir(alice.id(), ns1);
+        auto const page1 = base.read(keylet::page(dir, 1));
+        BEAST_REQUIRE(page1);
+        BEAST_REQUIRE(base.read(keylet::page(dir, 2)));
+
+        // empty the middle page, remove and change some more entries
+        // elsewhere and add enough for a new page, keys of the added entries
+        // interleaved with those of the removed ones; remove a namespace and
+        // create it again; create a namespace; change another account's
+        // state and remove what does not exist
+        std::string const empty;
+        hook::HookStateMap stateMap;
+        for (auto const& index : page1->getFieldV256(sfIndexes))
+            stateMap.insert(
+                alice.id(),
+                ns1,
+                base.read(keylet::unchecked(index))
+                    ->getFieldH256(sfHookStateKey),
+                true,
+                makeSlice(empty));
+        for (std::uint32_t i = 2; i <= 160; i += 2)
+        {
+            if (stateMap.find(alice.id(), ns1, uint256{i}))
+                continue;
+            if (i % 3 == 0)
+                stateMap.insert(
+                    alice.id(), ns1, uint256{i}, true, makeSlice(empty));
+            else if (i % 5 == 0)
+                stateMap.insert(
+                    alice.id(), ns1, uint256{i}, true, makeSlice(value(0)));
+        }
+        for (std::uint32_t i = 101; i <= 199; i += 2)
+            stateMap.insert(
+                alice.id(), ns1, uint256{i}, true, makeSlice(value(i)));
+        for (std::uint32_t i = 1; i <= 40; ++i)
+            stateMap.insert(
+                alice.id(), ns2, uint256{i}, true, makeSlice(empty));
+        stateMap.insert(
+            alice.id(), ns2, uint256{200}, true, makeSlice(value(0)));
+        for (std::uint32_t i = 1; i <= 3; ++i)
+            stateMap.insert(
+                alice.id(), ns3, uint256{i}, true, makeSlice(value(i)));
+        for (std::uint32_t i = 1; i <= 5; ++i)
+            stateMap.insert(
+                bob.id(), ns1, uint256{i}, true, makeSlice(value(0)));
+        stateMap.insert(bob.id(), ns1, uint256{99}, true, makeSlice(empty));
+
+        auto const tx = accountSet(alice);
+        {
+            OpenView serial{&base};
+            OpenView batched{&base};
+            BEAST_EXPECT(commit(serial, tx, stateMap, false) == tesSUCCESS);
+            BEAST_EXPECT(commit(batched, tx, stateMap, true) == tesSUCCESS);
+            BEAST_EXPECT(same(serial, batched));
+
+            // the middle page is gone and a fourth one was added
+            BEAST_EXPECT(!batched.exists(keylet::page(dir, 1)));
+            BEAST_EXPECT(batched.exists(keylet::page(dir, 3)));
+        }
+
+        // both fail alike, leaving what was written before the failure,
+        // when the reserve runs out part way
+        {
+            hook::HookStateMap stateMap;
+            for (std::uint32_t i = 1; i <= 5; ++i)
+                stateMap.insert(
+                    carol.id(), ns1, uint256{i}, true, makeSlice(value(i)));
+            compare(base, carol, stateMap, tecINSUFFICIENT_RESERVE);
+        }
+
+        // when an entry is too large
+        {
+            std::string const large(hook::maxHookStateDataSize() + 1, 'x');
+            hook::HookStateMap stateMap;
+            stateMap.insert(
+                bob.id(), ns1, uint256{1}, true, makeSlice(value(9)));
+            stateMap.insert(
+                bob.id(), ns1, uint256{2}, true, makeSlice(empty));
+            stateMap.insert(
+                bob.id(), ns2, uint256{1}, true, makeSlice(value(1)));
+            stateMap.insert(bob.id(), ns2, uint256{2}, true, makeSlice(large));
+            stateMap.insert(
+                bob.id(), ns2, uint256{3}, true, makeSlice(value(3)));
+            compare(base, bob, stateMap, temHOOK_DATA_TOO_LARGE);
+        }
+
+        // and when there are too many changes
+        {
+            hook::HookStateMap stateMap;
+            std::uint32_t const count = hook_api::max_state_modifications + 10;
+            for (std::uint32_t i = 1; i <= count; ++i)
+                stateMap.insert(
+                    bob.id(), ns3, uint256{i}, true, makeSlice(value(i)));
+            compare(base, bob, stateMap, tecHOOK_REJECTED);
+        }
+
+        // a directory with its last page one entry short of full at the
+        // last page number allowed, so only one more entry fits unless pages
+        // aren't capped
+        OpenView full{&base};
+        {
+            auto const dir = keylet::hookStateDir(bob.id(), ns3);
+            auto const last = dirNodeMaxPages - 1;
+
+            auto root = std::make_shared<SLE>(dir);
+            root->setFieldH256(sfRootIndex, dir.key);
+            root->setAccountID(sfOwner, bob.id());
+            root->setFieldV256(sfIndexes, STVector256{});
+            root->setFieldU64(sfIndexNext, last);
+            root->setFieldU64(sfIndexPrevious, last);
+            full.rawInsert(root);
+
+            STVector256 indexes;
+            for (std::uint32_t i = 1; i < dirNodeMaxEntries; ++i)
+                indexes.push_back(uint256{i});
+
+            auto page = std::make_shared<SLE>(keylet::page(dir, last));
+            page->setFieldH256(sfRootIndex, dir.key);
+            page->setAccountID(sfOwner, bob.id());
+            page->setFieldV256(sfIndexes, indexes);
+            full.rawInsert(page);
+        }
+
+        // both fill it alike, writing the entries which fit before failing
+        {
+            hook::HookStateMap stateMap;
+            stateMap.insert(
+                bob.id(), ns1, uint256{1}, true, makeSlice(value(9)));
+            stateMap.insert(
+                bob.id(), ns1, uint256{50}, true, makeSlice(value(50)));
+            for (std::uint32_t i = 1; i <= 3; ++i)
+                stateMap.insert(
+                    bob.id(), ns3, uint256{i}, true, makeSlice(value(i)));
+            compare(
+                full,
+                bob,
+                stateMap,
+                features[fixPageCap] ? TER{tesSUCCESS} : TER{tecDIR_FULL});
+        }
+    }
+
+    void
+    testStatePrefetch(FeatureBitset features)
+    {
+        testcase("Test hook state prefetch");
+        using namespace jtx;
+        Env env{*this, envconfig([](std::unique_ptr<Config> cfg) {
+                    cfg->HOOK_STATE_PREFETCH_KEYS = 2;
+                    return cfg;
+                }),
+                features};
+
+        auto const alice = Account{"alice"};
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        auto& prefetcher = env.app().getHookStatePrefetcher();
+        BEAST_EXPECT(prefetcher.enabled());
+
+        uint256 const ns{1};
+        uint256 const k1{1}, k2{2}, k3{3};
+
+        // the first touch of a key is a miss, later touches are hits
+        prefetcher.touched(alice.id(), ns, k1);
+        prefetcher.touched(alice.id(), ns, k1);
+        BEAST_EXPECT(prefetcher.misses() == 1);
+        BEAST_EXPECT(prefetcher.hits() == 1);
+
+        // only the most recently touched keys are remembered
+        prefetcher.touched(alice.id(), ns, k2);
+        prefetcher.touched(alice.id(), ns, k3);
+        prefetcher.touched(alice.id(), ns, k1);
+        BEAST_EXPECT(prefetcher.misses() == 4);
+
+        // the directory and both remembered keys are requested
+        auto const before = prefetcher.prefetches();
+        prefetcher.prefetch(
+            env.app().getLedgerMaster().getClosedLedger(), alice.id(), ns);
+        BEAST_EXPECT(prefetcher.prefetches() == before + 3);
+    }
+
+    void
+    testProfiler(FeatureBitset features)
+    {
+        testcase("Test hook profiler");
+        using namespace jtx;
+        Env env{*this, envconfig([](std::unique_ptr<Config> cfg) {
+                    cfg->HOOK_PROFILE = true;
+                    return cfg;
+                }),
+                features};
+
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        env.fund(XRP(10000), alice);
+        env.fund(XRP(10000), bob);
+
+        env(ripple::test::jtx::hook(alice, {{hso(accept_wasm)}}, 0),
+            M("Install Accept Hook"),
+            HSFEE);
+        env.close();
+
+        env(pay(bob, alice, XRP(1)), M("Test Accept Hook"), fee(XRP(1)));
+        env(pay(bob, alice, XRP(1)), M("Test Accept Hook"), fee(XRP(1)));
+        env.close();
+
+        auto const& hookHash = accept_hash_str;
+        auto const jv = env.rpc("hook_profile")[jss::result];
+        BEAST_EXPECT(jv[jss::enabled].asBool());
+        BEAST_EXPECT(jv[jss::hooks].isMember(hookHash));
+        BEAST_EXPECT(
+            jv[jss::hooks][hookHash][jss::executions].asString() == "2");
+        BEAST_EXPECT(
+            jv[jss::hooks][hookHash][jss::instructions].asString() != "0");
+
+        // the accept hook calls nothing but _g and accept
+        BEAST_EXPECT(jv[jss::functions].isMember("accept"));
+        BEAST_EXPECT(
+            jv[jss::functions]["accept"][jss::calls].asString() == "2");
+    }
+
+    void
+    testCostLimit(FeatureBitset features)
+    {
+        testcase("Test hook cost limit");
+        using namespace jtx;
+        Env env{*this, features};
+
+        auto const alice = Account{"alice"};
+        env.fund(XRP(10000), alice);
+        env.close();
+
+        // (func hook (param i32) (result i64) loop br 0 end i64.const 0)
+        // the guard checker would never let this be installed
+        std::vector<uint8_t> const spin{
+            0x00U, 0x61U, 0x73U, 0x6DU, 0x01U, 0x00U, 0x00U, 0x00U, 0x01U,
+            0x06U, 0x01U, 0x60U, 0x01U, 0x7FU, 0x01U, 0x7EU, 0x03U, 0x02U,
+            0x01U, 0x00U, 0x07U, 0x08U, 0x01U, 0x04U, 0x68U, 0x6FU, 0x6FU,
+            0x6BU, 0x00U, 0x00U, 0x0AU, 0x0BU, 0x01U, 0x09U, 0x00U, 0x03U,
+            0x40U, 0x0CU, 0x00U, 0x0BU, 0x42U, 0x00U, 0x0BU};
+
+        auto const module = hook::HookModule::load(makeSlice(spin));
+        BEAST_REQUIRE(module);
+
+        OpenView ov{*env.current()};
+        STTx const tx{ttACCOUNT_SET, [&](STObject& obj) {
+                          obj.setAccountID(sfAccount, alice.id());
+                      }};
+        ApplyContext applyCtx{
+            env.app(),
+            ov,
+            tx,
+            tesSUCCESS,
+            env.current()->fees().base,
+            tapNONE};
+
+        hook::HookStateMap stateMap;
+        hook::HookParameters const params;
+        hook::HookContext hookCtx{
+            .applyCtx = applyCtx,
+            .result = {
+                .accountKeylet = keylet::account(alice.id()),
+                .ownerDirKeylet = keylet::ownerDir(alice.id()),
+                .hookKeylet = keylet::hook(alice.id()),
+                .account = alice.id(),
+                .otxnAccount = alice.id(),
+                .stateMap = stateMap,
+                .hookParams = params}};
+        hookCtx.costLimit = 1000;
+
+        // the spin is cut short as soon as the budget runs out
+        hook::HookExecutor executor{hookCtx};
+        executor.executeWasm(**module, false, 0, env.journal);
+        BEAST_EXPECT(
+            hookCtx.result.exitType == hook_api::ExitType::COST_LIMIT);
+        BEAST_EXPECT(hookCtx.result.instructionCount == 1000);
+    }
+
+    void
+    testSerializationCache(FeatureBitset features)
+    {
+        testcase("Test slot and otxn serialization cache");
+        using namespace jtx;
+        Env env{*this, features};
+
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        env(pay(alice, bob, XRP(1)), memo("data", "format", "type"));
+        auto const tx = env.tx();
+        BEAST_REQUIRE(tx);
+
+        // each field as otxn_field used to serialize it
+        hook::SerializedFields const fields{*tx};
+        std::size_t count = 0;
+        for (auto const& field : *tx)
+        {
+            if (field.getSType() == STI_NOTPRESENT)
+                continue;
+            ++count;
+
+            Serializer s;
+            field.add(s);
+            auto const found = fields.find(field.getFName().fieldCode);
+            if (BEAST_EXPECT(found))
+            {
+                BEAST_EXPECT(found->first == s.slice());
+                BEAST_EXPECT(found->second == field.getSType());
+            }
+        }
+        BEAST_EXPECT(count > 5);
+        BEAST_EXPECT(!fields.find(sfHookHash.fieldCode));
+
+        auto const sle = env.le(keylet::account(alice.id()));
+        BEAST_REQUIRE(sle);
+
+        hook::SlotEntry slot{.storage = sle, .entry = sle.get()};
+        auto const whole = slot.serialize();
+        BEAST_EXPECT(whole == sle->getSerializer().slice());
+
+        // serialized once, however often it is asked for
+        BEAST_EXPECT(slot.serialize().data() == whole.data());
+
+        // a copy pointed at a field serializes the field instead
+        auto sub = slot;
+        sub.entry = &sle->peekAtField(sfBalance);
+        Serializer balance;
+        sle->peekAtField(sfBalance).add(balance);
+        BEAST_EXPECT(sub.serialize() == balance.slice());
+        BEAST_EXPECT(slot.serialize().data() == whole.data());
+    }
+
     void
     testGuards(FeatureBitset features)
     {
@@ -11976,6 +12528,13 @@ public:
         testWasm(features);
         test_accept(features);
         test_rollback(features);
+        testModuleCache(features);
+        testValidationCache(features);
+        testStateBatch(features);
+        testStatePrefetch(features);
+        testProfiler(features);
+        testCostLimit(features);
+        testSerializationCache(features);
 
         testGuards(features);
 
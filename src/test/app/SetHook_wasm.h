@@ -8,7 +8,7 @@
 #include <vector>
 namespace ripple {
 namespace test {
-std::map<std::string, std::vector<uint8_t>> wasm = {
+inline std::map<std::string, std::vector<uint8_t>> wasm = {
     /* ==== WASM: 0 ==== */
     {R"[test.hook](
                 (module
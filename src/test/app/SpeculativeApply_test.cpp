@@ -0,0 +1,358 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/BuildLedger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerReplay.h>
+#include <ripple/app/tx/SpeculativeApply.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/protocol/jss.h>
+#include <test/app/SetHook_wasm.h>
+#include <test/jtx.h>
+#include <test/jtx/WSClient.h>
+#include <test/jtx/envconfig.h>
+#include <map>
+
+namespace ripple {
+namespace test {
+
+class SpeculativeApply_test : public beast::unit_test::suite
+{
+    // the code of a hook of SetHook_test, by a line of its source
+    static std::vector<uint8_t> const&
+    testHook(std::string const& line)
+    {
+        for (auto const& [source, code] : wasm)
+            if (source.find(line) != std::string::npos)
+                return code;
+        Throw<std::runtime_error>("no test hook has: " + line);
+    }
+
+    // the transactions of a ledger in the order they were applied in
+    static std::vector<std::shared_ptr<STTx const>>
+    appliedTxs(ReadView const& ledger)
+    {
+        std::map<std::uint32_t, std::shared_ptr<STTx const>> ordered;
+        for (auto const& [tx, meta] : ledger.txs)
+            ordered.emplace(meta->getFieldU32(sfTransactionIndex), tx);
+
+        std::vector<std::shared_ptr<STTx const>> txs;
+        for (auto& [_, tx] : ordered)
+            txs.push_back(std::move(tx));
+        return txs;
+    }
+
+    struct Speculated
+    {
+        std::size_t committed = 0;
+        std::size_t reapplied = 0;
+    };
+
+    // check that the last closed ledger, which consensus built with
+    // speculation, is the one applying its transactions one by one builds,
+    // and the one speculating on them in that same order builds
+    Speculated
+    replay(jtx::Env& env)
+    {
+        auto& ledgerMaster = env.app().getLedgerMaster();
+        auto const closed = ledgerMaster.getClosedLedger();
+        auto const parent =
+            ledgerMaster.getLedgerByHash(closed->info().parentHash);
+        if (!BEAST_EXPECT(parent != nullptr))
+            return {};
+
+        auto const txs = appliedTxs(*closed);
+        BEAST_EXPECT(!txs.empty());
+
+        {
+            auto const replayed = buildLedger(
+                LedgerReplay(parent, closed), tapNONE, env.app(), env.journal);
+            BEAST_EXPECT(replayed->info().hash == closed->info().hash);
+        }
+
+        Speculated ret;
+        auto const built =
+            std::make_shared<Ledger>(*parent, closed->info().closeTime);
+        {
+            OpenView accum(&*built);
+            SpeculativeApply speculation(
+                env.app(), accum, txs, tapNONE, env.journal);
+
+            for (auto const& tx : txs)
+                BEAST_EXPECT(
+                    applyTransaction(
+                        env.app(),
+                        accum,
+                        *tx,
+                        false,
+                        tapNONE,
+                        env.journal,
+                        &speculation) == ApplyResult::Success);
+
+            ret.committed = speculation.committed();
+            ret.reapplied = speculation.reapplied();
+
+            accum.apply(*built);
+        }
+        built->updateSkipList();
+
+        BEAST_EXPECT(
+            built->stateMap().getHash().as_uint256() ==
+            closed->info().accountHash);
+        BEAST_EXPECT(
+            built->txMap().getHash().as_uint256() == closed->info().txHash);
+        return ret;
+    }
+
+    void
+    testReplay()
+    {
+        testcase("Replay");
+
+        using namespace jtx;
+
+        Env env = [&] {
+            auto c = envconfig();
+            auto& sectionNode = c->section(ConfigSection::nodeDatabase());
+            sectionNode.set("type", "memory");
+            c->overwrite(SECTION_RELATIONAL_DB, "backend", "sqlite");
+            c->HOOK_SPECULATIVE_THREADS = 3;
+            return Env(*this, std::move(c));
+        }();
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        Account const carol{"carol"};
+        Account const dave{"dave"};
+        Account const erin{"erin"};
+        Account const frank{"frank"};
+        Account const gina{"gina"};
+        Account const hank{"hank"};
+        env.fund(XRP(10000), alice, bob, carol, dave, erin, frank, gina, hank);
+        env.close();
+
+        env(stateHook(bob), fee(XRP(1)));
+        env(stateHook(carol), fee(XRP(1)));
+        // sets a key in its own namespace and another in a second one
+        env(hook(
+                frank,
+                {{hso(testHook(
+                    "put the second state object on a different ns"))}},
+                0),
+            fee(XRP(100)));
+        // emits a payment to its "bob" parameter, getting its fee from the
+        // open ledger
+        env(hook(
+                gina,
+                {{hso(testHook("on callback we emit 2 more txns"))}},
+                0),
+            fee(XRP(100)));
+        // walks the ledger for an entry in a range of keys
+        env(hook(
+                hank,
+                {{hso(testHook("ASSERT(ledger_keylet(SBUF(out), SBUF(first), "
+                               "SBUF(last)) == 34);"))}},
+                0),
+            fee(XRP(100)));
+        env.close();
+
+        {
+            // two payments which run bob's hook and depend on each other,
+            // one which runs carol's and depends on neither, and one which
+            // runs no hook at all
+            env(pay(alice, bob, XRP(1)), fee(XRP(1)));
+            env(pay(dave, bob, XRP(1)), fee(XRP(1)));
+            env(pay(erin, carol, XRP(1)), fee(XRP(1)));
+            env(pay(alice, dave, XRP(1)));
+            env.close();
+
+            // carol's payment holds whatever the order, one of bob's has to
+            // be applied again after the other
+            auto const speculated = replay(env);
+            BEAST_EXPECT(speculated.committed >= 1);
+            BEAST_EXPECT(speculated.reapplied >= 1);
+        }
+
+        {
+            // two payments which write the same keys in both of frank's
+            // namespaces
+            env(pay(alice, frank, XRP(1)), fee(XRP(1)));
+            env(pay(dave, frank, XRP(1)), fee(XRP(1)));
+            env(pay(erin, carol, XRP(1)), fee(XRP(1)));
+            env.close();
+
+            auto const speculated = replay(env);
+            BEAST_EXPECT(speculated.committed >= 1);
+            BEAST_EXPECT(speculated.reapplied >= 1);
+        }
+
+        {
+            Json::Value invoke;
+            invoke[jss::TransactionType] = "Invoke";
+            invoke[jss::Account] = gina.human();
+            invoke[jss::HookParameters][0U][jss::HookParameter]
+                  [jss::HookParameterName] = strHex(std::string("bob"));
+            invoke[jss::HookParameters][0U][jss::HookParameter]
+                  [jss::HookParameterValue] = strHex(bob.id());
+
+            env(invoke, fee(XRP(1)));
+            env(pay(erin, carol, XRP(1)), fee(XRP(1)));
+            env.close();
+
+            // gina's hook read the open ledger, which is not part of the
+            // snapshot, so it is applied again whatever the order
+            auto const speculated = replay(env);
+            BEAST_EXPECT(speculated.committed >= 1);
+            BEAST_EXPECT(speculated.reapplied >= 1);
+        }
+
+        {
+            // along with what gina emitted: a walk over the keys an account
+            // created in the same ledger falls in, and carol's hook again
+            env(pay(alice, Account{"ivy"}, XRP(1000)));
+            env(pay(dave, hank, XRP(1)), fee(XRP(1)));
+            env(pay(erin, carol, XRP(1)), fee(XRP(1)));
+            env.close();
+
+            auto const speculated = replay(env);
+            BEAST_EXPECT(speculated.committed >= 1);
+        }
+
+        {
+            // payments which fail with a tec, claiming only their fee
+            env(pay(bob, Account{"jo"}, XRP(1)),
+                fee(XRP(1)),
+                ter(tecNO_DST_INSUF_NATIVE));
+            env(pay(carol, Account{"jo"}, XRP(1)),
+                fee(XRP(1)),
+                ter(tecNO_DST_INSUF_NATIVE));
+            env.close();
+
+            auto const speculated = replay(env);
+            BEAST_EXPECT(speculated.committed >= 1);
+        }
+    }
+
+    void
+    testOpenView()
+    {
+        testcase("Open view");
+
+        using namespace jtx;
+
+        Env env{*this};
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        env(stateHook(bob), fee(XRP(1)));
+        env.close();
+
+        // an open view records no metadata, so nothing is run ahead and
+        // every transaction is just applied
+        auto const jt = env.jt(pay(alice, bob, XRP(1)), fee(XRP(1)));
+        OpenView view(&*env.current());
+        SpeculativeApply speculation(
+            env.app(), view, {jt.stx}, tapNONE, env.journal);
+
+        BEAST_EXPECT(speculation.apply(view, *jt.stx, tapNONE).second);
+        BEAST_EXPECT(speculation.committed() == 0);
+        BEAST_EXPECT(speculation.reapplied() == 0);
+        BEAST_EXPECT(view.txCount() == 1);
+    }
+
+    void
+    testTraces()
+    {
+        testcase("Traces");
+
+        using namespace std::chrono_literals;
+        using namespace jtx;
+
+        Env env = [&] {
+            auto c = envconfig();
+            c->HOOK_SPECULATIVE_THREADS = 3;
+            return Env(*this, std::move(c));
+        }();
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        Account const carol{"carol"};
+        env.fund(XRP(10000), alice, bob, carol);
+        env.close();
+
+        env(traceHook(bob), fee(XRP(1)));
+        env.close();
+
+        auto wsc = makeWSClient(env.app().config());
+        {
+            Json::Value stream;
+            stream[jss::streams] = Json::arrayValue;
+            stream[jss::streams].append("hook_traces");
+            auto const jv = wsc->invoke("subscribe", stream);
+            BEAST_EXPECT(jv[jss::status] == "success");
+        }
+
+        auto const isTrace = [](Json::Value const& jv) {
+            return jv[jss::type] == "hookTrace";
+        };
+
+        // both write bob's account, so the second is applied again
+        auto const first = env.jt(pay(alice, bob, XRP(1)), fee(XRP(1)));
+        auto const second = env.jt(pay(carol, bob, XRP(1)), fee(XRP(1)));
+
+        auto const parent = env.app().getLedgerMaster().getClosedLedger();
+        auto const built = std::make_shared<Ledger>(
+            *parent, env.app().timeKeeper().closeTime());
+        OpenView accum(&*built);
+        SpeculativeApply speculation(
+            env.app(), accum, {first.stx, second.stx}, tapNONE, env.journal);
+
+        // the runs published nothing
+        auto jvo = wsc->getMsg(100ms);
+        BEAST_EXPECTS(!jvo, "getMsg: " + to_string(jvo.value()));
+
+        // the committed run and the one applied again publish once each
+        BEAST_EXPECT(speculation.apply(accum, *first.stx, tapNONE).second);
+        BEAST_EXPECT(speculation.apply(accum, *second.stx, tapNONE).second);
+        BEAST_EXPECT(speculation.committed() == 1);
+        BEAST_EXPECT(speculation.reapplied() == 1);
+
+        BEAST_EXPECT(wsc->findMsg(5s, isTrace));
+        BEAST_EXPECT(wsc->findMsg(5s, isTrace));
+        jvo = wsc->getMsg(100ms);
+        BEAST_EXPECTS(!jvo, "getMsg: " + to_string(jvo.value()));
+    }
+
+public:
+    void
+    run() override
+    {
+        testReplay();
+        testOpenView();
+        testTraces();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SpeculativeApply, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
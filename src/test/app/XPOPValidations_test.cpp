@@ -0,0 +1,189 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/tx/impl/Import.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/VerifyPool.h>
+#include <ripple/protocol/STValidation.h>
+#include <ripple/protocol/SecretKey.h>
+#include <ripple/protocol/tokens.h>
+#include <test/jtx.h>
+#include <test/unit_test/BenchRounds.h>
+#include <chrono>
+#include <iomanip>
+#include <iterator>
+#include <map>
+
+namespace ripple {
+namespace test {
+
+// The UNL and validation sections of an XPOP signed by generated
+// validators, which is as much as countXPOPValidations reads.
+struct XPOPValidations
+{
+    uint256 const ledgerHash{42};
+    VerifiedUNL unl;
+    std::map<std::string, Blob> data;
+
+    // nodepub => key pair, for each validator on the list
+    std::map<std::string, std::pair<PublicKey, SecretKey>> keys;
+
+    explicit XPOPValidations(std::size_t validators)
+    {
+        unl.validatorCount = validators;
+        for (std::size_t i = 0; i < validators; ++i)
+        {
+            auto const [pk, sk] = randomKeyPair(KeyType::secp256k1);
+            auto const nodepub = toBase58(TokenType::NodePublic, pk);
+            unl.validators[nodepub] = strHex(pk);
+            keys.emplace(nodepub, std::make_pair(pk, sk));
+            add(nodepub, pk, sk, ledgerHash);
+        }
+    }
+
+    void
+    add(std::string const& nodepub,
+        PublicKey const& pk,
+        SecretKey const& sk,
+        uint256 const& hash)
+    {
+        STValidation const val(
+            NetClock::time_point{},
+            pk,
+            sk,
+            calcNodeID(pk),
+            [&](STValidation& v) {
+                v.setFieldH256(sfLedgerHash, hash);
+                v.setFieldU32(sfLedgerSequence, 1);
+                v.setFlag(vfFullValidation);
+            });
+        data[nodepub] = val.getSerialized();
+    }
+
+    // replace the validation of the i'th validator on the list with one
+    // signed by some other key
+    void
+    forge(std::size_t i)
+    {
+        auto const& [nodepub, kp] = *std::next(keys.begin(), i);
+        add(nodepub, kp.first, randomSecretKey(), ledgerHash);
+    }
+
+    // replace the validation of the i'th validator on the list with one
+    // for another ledger
+    void
+    other(std::size_t i)
+    {
+        auto const& [nodepub, kp] = *std::next(keys.begin(), i);
+        add(nodepub, kp.first, kp.second, ~ledgerHash);
+    }
+
+    std::uint64_t
+    count(VerifyPool& pool) const
+    {
+        return countXPOPValidations(
+            {data.begin(), data.end()},
+            unl,
+            ledgerHash,
+            pool,
+            beast::Journal{beast::Journal::getNullSink()},
+            uint256{});
+    }
+};
+
+class XPOPValidations_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        testcase("serial and parallel");
+
+        VerifyPool serial(0, "verify test");
+        VerifyPool parallel(3, "verify test");
+
+        XPOPValidations xpop(35);
+        BEAST_EXPECT(xpop.count(serial) == 35);
+        BEAST_EXPECT(xpop.count(parallel) == 35);
+
+        // forged signatures
+        xpop.forge(0);
+        xpop.forge(17);
+        xpop.forge(34);
+        BEAST_EXPECT(xpop.count(serial) == 32);
+        BEAST_EXPECT(xpop.count(parallel) == 32);
+
+        // a validation for another ledger, and one from a validator which
+        // is not on the list, are not counted either
+        {
+            auto const [pk, sk] = randomKeyPair(KeyType::secp256k1);
+            xpop.add(
+                toBase58(TokenType::NodePublic, pk), pk, sk, xpop.ledgerHash);
+        }
+        xpop.other(5);
+        BEAST_EXPECT(xpop.count(serial) == 31);
+        BEAST_EXPECT(xpop.count(parallel) == 31);
+    }
+};
+
+// Run with --unittest=XPOPValidationsBench --unittest-arg=<rounds>
+class XPOPValidationsBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    void
+    measure(
+        XPOPValidations const& xpop,
+        std::size_t threads,
+        std::size_t rounds)
+    {
+        VerifyPool pool(threads, "verify bench");
+
+        std::uint64_t counted = 0;
+        auto const start = clock_type::now();
+        for (std::size_t r = 0; r < rounds; ++r)
+            counted += xpop.count(pool);
+        auto const secs =
+            std::chrono::duration<double>(clock_type::now() - start).count();
+
+        BEAST_EXPECT(counted == rounds * xpop.unl.validatorCount);
+        log << xpop.unl.validatorCount << " validations, " << threads
+            << " pool threads: " << secs * 1e6 / rounds << " us/xpop"
+            << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        auto const rounds = benchRounds(*this, 200);
+
+        log << std::fixed << std::setprecision(1);
+
+        XPOPValidations const xpop(35);
+        for (std::size_t threads : {0, 1, 3, 7})
+            measure(xpop, threads, rounds);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(XPOPValidations, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(XPOPValidationsBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -9,7 +9,7 @@ echo '
 #include <vector>
 namespace ripple {
 namespace test {
-std::map<std::string, std::vector<uint8_t>> wasm = {' > SetHook_wasm.h
+inline std::map<std::string, std::vector<uint8_t>> wasm = {' > SetHook_wasm.h
 COUNTER="0"
 cat SetHook_test.cpp | tr '\n' '\f' | 
         grep -Po 'R"\[test\.hook\](.*?)\[test\.hook\]"' | 
@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/core/VerifyPool.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class VerifyPool_test : public beast::unit_test::suite
+{
+    // every index is called exactly once, whatever the pool size
+    void
+    testOnce(std::size_t threads)
+    {
+        VerifyPool pool(threads, "verify test");
+        BEAST_EXPECT(pool.size() == threads);
+
+        for (std::size_t n : {0, 1, 2, 3, 35, 1000})
+        {
+            std::vector<std::atomic<int>> calls(n);
+            pool.forEach(n, [&](std::size_t i) { ++calls[i]; });
+
+            bool once = true;
+            for (auto const& c : calls)
+                once = once && c == 1;
+            BEAST_EXPECTS(
+                once, std::to_string(threads) + "/" + std::to_string(n));
+        }
+    }
+
+    void
+    testInline()
+    {
+        testcase("Inline");
+
+        // without threads the caller does all of the work
+        VerifyPool pool(0, "verify test");
+        auto const caller = std::this_thread::get_id();
+        bool inline_ = true;
+        pool.forEach(10, [&](std::size_t) {
+            inline_ = inline_ && std::this_thread::get_id() == caller;
+        });
+        BEAST_EXPECT(inline_);
+    }
+
+    void
+    testCallers()
+    {
+        testcase("Callers");
+
+        // more callers than threads: each finishes its own batch
+        VerifyPool pool(2, "verify test");
+
+        constexpr std::size_t callers = 6;
+        constexpr std::size_t rounds = 200;
+        constexpr std::size_t n = 35;
+
+        std::atomic<std::size_t> total{0};
+        std::vector<std::thread> threads;
+        for (std::size_t c = 0; c < callers; ++c)
+        {
+            threads.emplace_back([&] {
+                for (std::size_t r = 0; r < rounds; ++r)
+                {
+                    std::vector<std::uint8_t> seen(n, 0);
+                    pool.forEach(n, [&](std::size_t i) { seen[i] = 1; });
+
+                    std::size_t count = 0;
+                    for (auto s : seen)
+                        count += s;
+                    total += count;
+                }
+            });
+        }
+
+        for (auto& t : threads)
+            t.join();
+
+        BEAST_EXPECT(total == callers * rounds * n);
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("Once");
+        for (std::size_t threads : {0, 1, 3, 8})
+            testOnce(threads);
+
+        testInline();
+        testCallers();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(VerifyPool, core, ripple);
+
+}  // namespace test
+}  // namespace ripple
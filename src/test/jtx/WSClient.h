@@ -33,6 +33,12 @@ namespace test {
 class WSClient : public AbstractClient
 {
 public:
+    /** Send a request without waiting for the response, which is then
+        retrieved as a message like any other.
+    */
+    virtual void
+    send(std::string const& cmd, Json::Value const& params) = 0;
+
     /** Retrieve a message. */
     virtual std::optional<Json::Value>
     getMsg(
@@ -43,6 +43,18 @@ hso(std::string const& wasmHex, void (*f)(Json::Value& jv) = 0);
 Json::Value
 hso_delete(void (*f)(Json::Value& jv) = 0);
 
+// the namespace the hook set by stateHook writes to
+constexpr char const* stateHookNamespace =
+    "CAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFE";
+
+/** Set a hook which sets "key" to "value" in stateHookNamespace. */
+Json::Value
+stateHook(Account const& account);
+
+/** Set a hook which traces "trace" as message and data, then accepts. */
+Json::Value
+traceHook(Account const& account);
+
 }  // namespace jtx
 }  // namespace test
 }  // namespace ripple
@@ -166,28 +166,33 @@ public:
         cleanup();
     }
 
-    Json::Value
-    invoke(std::string const& cmd, Json::Value const& params) override
+    void
+    send(std::string const& cmd, Json::Value const& params) override
     {
         using boost::asio::buffer;
-        using namespace std::chrono_literals;
 
+        Json::Value jp;
+        if (params)
+            jp = params;
+        if (rpc_version_ == 2)
         {
-            Json::Value jp;
-            if (params)
-                jp = params;
-            if (rpc_version_ == 2)
-            {
-                jp[jss::method] = cmd;
-                jp[jss::jsonrpc] = "2.0";
-                jp[jss::ripplerpc] = "2.0";
-                jp[jss::id] = 5;
-            }
-            else
-                jp[jss::command] = cmd;
-            auto const s = to_string(jp);
-            ws_.write_some(true, buffer(s));
+            jp[jss::method] = cmd;
+            jp[jss::jsonrpc] = "2.0";
+            jp[jss::ripplerpc] = "2.0";
+            jp[jss::id] = 5;
         }
+        else
+            jp[jss::command] = cmd;
+        auto const s = to_string(jp);
+        ws_.write_some(true, buffer(s));
+    }
+
+    Json::Value
+    invoke(std::string const& cmd, Json::Value const& params) override
+    {
+        using namespace std::chrono_literals;
+
+        send(cmd, params);
 
         auto jv = findMsg(5s, [&](Json::Value const& jval) {
             return jval[jss::type] == jss::response;
@@ -102,6 +102,38 @@ hso(std::string const& wasmHex, void (*f)(Json::Value& jv))
     return jv;
 }
 
+Json::Value
+stateHook(Account const& account)
+{
+    std::string const createCodeHex =
+        "0061736D01000000011B0460027F7F017F60047F7F7F7F017E60037F7F7E01"
+        "7E60017F017E02270303656E76025F67000003656E760973746174655F7365"
+        "74000103656E76066163636570740002030201030503010002062B077F0141"
+        "9088040B7F004180080B7F00418A080B7F004180080B7F00419088040B7F00"
+        "41000B7F0041010B07080104686F6F6B00030AE7800001E3800002017F017E"
+        "230041106B220124002001200036020C41012200200010001A200141800828"
+        "0000360208200141046A410022002F0088083B010020012000280084083602"
+        "004100200020014106200141086A4104100110022102200141106A24002002"
+        "0B0B1001004180080B096B65790076616C7565";
+    Json::Value jv = hook(account, {{hso(createCodeHex)}}, 0);
+    jv[jss::Hooks][0U][jss::Hook][jss::HookNamespace] = stateHookNamespace;
+    return jv;
+}
+
+Json::Value
+traceHook(Account const& account)
+{
+    // (func hook (param i32) (result i64)
+    //   _g(1, 1), trace("trace", "trace", 0), accept(0, 0, 0))
+    std::string const createCodeHex =
+        "0061736D01000000011C0460027F7F017F60057F7F7F7F7F017E60037F7F7E01"
+        "7E60017F017E02230303656E76025F67000003656E7605747261636500010365"
+        "6E7606616363657074000203020103050301000107080104686F6F6B00030A20"
+        "011E004101410110001A4100410541004105410010011A41004100420010020B"
+        "0B0B010041000B057472616365";
+    return hook(account, {{hso(createCodeHex)}}, 0);
+}
+
 }  // namespace jtx
 }  // namespace test
 }  // namespace ripple
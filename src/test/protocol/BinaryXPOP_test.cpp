@@ -0,0 +1,255 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/protocol/BinaryXPOP.h>
+#include <ripple/protocol/Import.h>
+#include <ripple/protocol/jss.h>
+#include <test/app/Import_json.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class BinaryXPOP_test : public beast::unit_test::suite
+{
+    beast::Journal const j{beast::Journal::getNullSink()};
+
+    static Json::Value
+    load(std::string const& xpop)
+    {
+        return jtx::import::loadXpop(xpop);
+    }
+
+    // the fields of the JSON form which the binary form carries
+    static Json::Value
+    carried(Json::Value xpop)
+    {
+        auto& unl = xpop[jss::validation][jss::unl];
+        Json::Value kept{Json::objectValue};
+        for (auto const& name :
+             {"public_key", "manifest", "blob", "signature", "version"})
+            kept[name] = unl[name];
+        unl = kept;
+        return xpop;
+    }
+
+    static bool
+    same(XPOPFields const& a, XPOPFields const& b)
+    {
+        auto const& x = a.ledger;
+        auto const& y = b.ledger;
+        return x.index == y.index && x.coins == y.coins &&
+            x.phash == y.phash && x.txroot == y.txroot &&
+            x.acroot == y.acroot && x.pclose == y.pclose &&
+            x.close == y.close && x.cres == y.cres && x.flags == y.flags &&
+            a.txn == b.txn && a.meta == b.meta &&
+            a.proofRoot == b.proofRoot && a.proofHashes == b.proofHashes &&
+            a.unlPublicKey == b.unlPublicKey &&
+            a.unlManifest == b.unlManifest && a.unlBlob == b.unlBlob &&
+            a.unlSignature == b.unlSignature &&
+            a.validations == b.validations;
+    }
+
+    void
+    roundTrip(std::string const& name, Json::Value const& xpop)
+    {
+        auto const binary = toBinaryXPOP(xpop);
+        if (!BEAST_EXPECTS(binary.has_value(), name))
+            return;
+
+        auto const parsed = parseBinaryXPOP(makeSlice(*binary), j);
+        if (!BEAST_EXPECTS(parsed.has_value(), name))
+            return;
+
+        // JSON to binary and back loses nothing Import reads
+        auto const json = toJson(*parsed);
+        BEAST_EXPECTS(json == carried(xpop), name);
+        BEAST_EXPECTS(toBinaryXPOP(json) == binary, name);
+
+        // Import reads the same fields from either form
+        auto const text = Json::FastWriter().write(xpop);
+        auto const fromJson = readXPOP(Blob(text.begin(), text.end()), j);
+        auto const fromBinary = readXPOP(*binary, j);
+        if (BEAST_EXPECTS(fromJson && fromBinary, name))
+            BEAST_EXPECTS(same(*fromJson, *fromBinary), name);
+
+        // and the JSON check is only for the JSON form
+        BEAST_EXPECTS(!syntaxCheckXPOP(*binary, j), name);
+
+        // the parsed fields point into the binary form
+        auto const inside = [&](Slice const& s) {
+            return s.data() >= binary->data() &&
+                s.data() + s.size() <= binary->data() + binary->size();
+        };
+        BEAST_EXPECT(inside(parsed->txn) && inside(parsed->meta));
+        BEAST_EXPECT(inside(parsed->proof) && inside(parsed->unlBlob));
+        BEAST_EXPECT(
+            parsed->validations.size() ==
+            xpop[jss::validation][jss::data].size());
+    }
+
+    void
+    testRoundTrip()
+    {
+        testcase("round trip");
+
+        roundTrip("min", load(ImportTCAccountSet::min));
+        roundTrip("max", load(ImportTCAccountSet::max));
+        roundTrip("w_seed", load(ImportTCAccountSet::w_seed));
+        roundTrip("w_regular_key", load(ImportTCSetRegularKey::w_seed));
+        roundTrip("w_signers", load(ImportTCSignersListSet::w_signers));
+
+        // the proof of a real XPOP hashes to its txroot, in either form
+        {
+            auto const binary = toBinaryXPOP(load(ImportTCAccountSet::w_seed));
+            auto const fields = binary ? readXPOP(*binary, j) : std::nullopt;
+            if (BEAST_EXPECT(fields.has_value()))
+            {
+                BEAST_EXPECT(fields->proofRoot == fields->ledger.txroot);
+                BEAST_EXPECT(!fields->proofHashes.empty());
+            }
+        }
+
+        // the list form of the proof, nested
+        auto xpop = load(ImportTCAccountSet::w_seed);
+        Json::Value proof{Json::arrayValue};
+        for (int x = 0; x < 16; ++x)
+            proof.append(to_string(uint256{static_cast<std::uint64_t>(x)}));
+        Json::Value nested = proof;
+        proof[3] = nested;
+        xpop[jss::transaction][jss::proof] = proof;
+        roundTrip("list proof", xpop);
+
+        // coins may be a number in the JSON form
+        xpop = load(ImportTCAccountSet::w_seed);
+        xpop[jss::ledger][jss::coins] = 12345;
+        auto const binary = toBinaryXPOP(xpop);
+        if (!BEAST_EXPECT(binary.has_value()))
+            return;
+        auto const parsed = parseBinaryXPOP(makeSlice(*binary), j);
+        if (!BEAST_EXPECT(parsed.has_value()))
+            return;
+        BEAST_EXPECT(parsed->ledger.coins == 12345);
+    }
+
+    void
+    testConvert()
+    {
+        testcase("convert");
+
+        auto const xpop = load(ImportTCAccountSet::w_seed);
+        auto const fails = [&](auto const& change) {
+            Json::Value bad = xpop;
+            change(bad);
+            return !toBinaryXPOP(bad);
+        };
+
+        BEAST_EXPECT(fails([](Json::Value& x) { x = Json::arrayValue; }));
+        BEAST_EXPECT(fails(
+            [](Json::Value& x) { x[jss::ledger][jss::index] = "149"; }));
+        BEAST_EXPECT(
+            fails([](Json::Value& x) { x[jss::ledger][jss::cres] = 256; }));
+        BEAST_EXPECT(
+            fails([](Json::Value& x) { x[jss::ledger][jss::phash] = "00"; }));
+        BEAST_EXPECT(fails(
+            [](Json::Value& x) { x[jss::transaction][jss::blob] = "XY"; }));
+        BEAST_EXPECT(fails([](Json::Value& x) {
+            x[jss::transaction][jss::proof][jss::children]["G"] =
+                x[jss::transaction][jss::proof][jss::children]["1"];
+        }));
+        BEAST_EXPECT(fails([](Json::Value& x) {
+            x[jss::transaction][jss::proof][jss::children]["c"] =
+                x[jss::transaction][jss::proof][jss::children]["1"];
+        }));
+        BEAST_EXPECT(fails([](Json::Value& x) {
+            x[jss::transaction][jss::proof] = Json::arrayValue;
+        }));
+        BEAST_EXPECT(fails([](Json::Value& x) {
+            x[jss::validation][jss::data]["notakey"] = "00";
+        }));
+        BEAST_EXPECT(fails([](Json::Value& x) {
+            x[jss::validation][jss::unl].removeMember(jss::version);
+        }));
+    }
+
+    void
+    testParse()
+    {
+        testcase("parse");
+
+        auto const binary = *toBinaryXPOP(load(ImportTCAccountSet::w_seed));
+        BEAST_EXPECT(isBinaryXPOP(makeSlice(binary)));
+        BEAST_EXPECT(parseBinaryXPOP(makeSlice(binary), j).has_value());
+
+        // JSON is never taken for the binary form
+        std::string const json = "{\"ledger\":{}}";
+        BEAST_EXPECT(!isBinaryXPOP(makeSlice(json)));
+        BEAST_EXPECT(!parseBinaryXPOP(makeSlice(json), j));
+
+        // nor is any prefix of the binary form
+        bool truncated = true;
+        for (std::size_t n = 0; n < binary.size(); ++n)
+            truncated = truncated &&
+                !parseBinaryXPOP(Slice(binary.data(), n), j);
+        BEAST_EXPECT(truncated);
+
+        auto const fails = [&](auto const& change) {
+            Blob bad = binary;
+            change(bad);
+            return !parseBinaryXPOP(makeSlice(bad), j) && !readXPOP(bad, j);
+        };
+
+        // trailing bytes
+        BEAST_EXPECT(fails([](Blob& b) { b.push_back(0); }));
+
+        // an unknown version
+        BEAST_EXPECT(fails([](Blob& b) { b[4] = BinaryXPOP::version + 1; }));
+
+        // an index the JSON form cannot hold
+        BEAST_EXPECT(fails([](Blob& b) { b[5] = 0x80; }));
+
+        // the proof follows the ledger, txn and meta, which are short
+        // enough here for one byte lengths
+        std::size_t const txn = 5 + 4 + 8 + 3 * 32 + 4 + 4 + 1 + 1;
+        std::size_t const meta = txn + 1 + binary[txn];
+        std::size_t const tag = meta + 1 + binary[meta];
+        if (!BEAST_EXPECT(binary[txn] < 193 && binary[meta] < 193))
+            return;
+        if (!BEAST_EXPECT(binary[tag] == 0x03))
+            return;
+        BEAST_EXPECT(fails([&](Blob& b) { b[tag] = 0x01; }));
+        BEAST_EXPECT(fails([&](Blob& b) { b[tag] = 0x04; }));
+    }
+
+public:
+    void
+    run() override
+    {
+        testRoundTrip();
+        testConvert();
+        testParse();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BinaryXPOP, protocol, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -17,9 +17,16 @@
 */
 //==============================================================================
 
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/ledger/ApplyViewImpl.h>
+#include <ripple/ledger/View.h>
 #include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
 #include <ripple/protocol/jss.h>
+#include <ripple/rpc/impl/NamespaceStream.h>
 #include <test/jtx.h>
+#include <test/jtx/WSClient.h>
+#include <set>
 
 namespace ripple {
 namespace test {
@@ -134,37 +141,7 @@ public:
                      0xCAU, 0xFEU, 0xCAU, 0xFEU, 0xCAU, 0xFEU, 0xCAU, 0xFFU})
                     .data());
 
-            // Lambda to create a hook.
-            auto setHook = [](test::jtx::Account const& account) {
-                std::string const createCodeHex =
-                    "0061736D01000000011B0460027F7F017F60047F7F7F7F017E60037F7F"
-                    "7E01"
-                    "7E60017F017E02270303656E76025F67000003656E760973746174655F"
-                    "7365"
-                    "74000103656E76066163636570740002030201030503010002062B077F"
-                    "0141"
-                    "9088040B7F004180080B7F00418A080B7F004180080B7F00419088040B"
-                    "7F00"
-                    "41000B7F0041010B07080104686F6F6B00030AE7800001E3800002017F"
-                    "017E"
-                    "230041106B220124002001200036020C41012200200010001A20014180"
-                    "0828"
-                    "0000360208200141046A410022002F0088083B01002001200028008408"
-                    "3602"
-                    "004100200020014106200141086A4104100110022102200141106A2400"
-                    "2002"
-                    "0B0B1001004180080B096B65790076616C7565";
-                std::string ns_str =
-                    "CAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECAFECA"
-                    "FECA"
-                    "FE";
-                Json::Value jv =
-                    ripple::test::jtx::hook(account, {{hso(createCodeHex)}}, 0);
-                jv[jss::Hooks][0U][jss::Hook][jss::HookNamespace] = ns_str;
-                return jv;
-            };
-
-            env(setHook(bob), fee(XRP(1)), ter(tesSUCCESS));
+            env(stateHook(bob), fee(XRP(1)), ter(tesSUCCESS));
             env.close();
 
             env(pay(alice, bob, XRP(1)), fee(XRP(1)), ter(tesSUCCESS));
@@ -235,12 +212,225 @@ public:
         }
     }
 
+    void
+    testCursor()
+    {
+        testcase("cursor");
+
+        using namespace jtx;
+        Env env(*this);
+
+        Account const alice{"alice"};
+        env.fund(XRP(1000), alice);
+        env.close();
+
+        uint256 const ns{0xCAFE};
+        uint256 const other{0xBEEF};
+
+        // enough entries for four directory pages
+        auto const closed = env.closed();
+        auto const view = std::make_shared<ApplyViewImpl>(&*closed, tapNONE);
+        std::size_t const count = 100;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint256 const key{i + 1};
+            auto const state = keylet::hookState(alice.id(), key, ns);
+            auto const sle = std::make_shared<SLE>(state);
+            sle->setFieldVL(sfHookStateData, Blob{std::uint8_t(i)});
+            sle->setFieldH256(sfHookStateKey, key);
+            auto const page = view->dirInsert(
+                keylet::hookStateDir(alice.id(), ns),
+                state.key,
+                describeOwnerDir(alice.id()));
+            if (!BEAST_EXPECT(page.has_value()))
+                return;
+            sle->setFieldU64(sfOwnerNode, *page);
+            view->insert(sle);
+        }
+
+        // a namespace which doesn't exist has no entries
+        {
+            auto const empty =
+                RPC::NamespaceCursor::start(view, alice.id(), other);
+            BEAST_EXPECT(empty.has_value() && empty->done());
+        }
+
+        // the whole namespace, seven entries at a time
+        auto cursor = RPC::NamespaceCursor::start(view, alice.id(), ns);
+        if (!BEAST_EXPECT(cursor.has_value()))
+            return;
+
+        std::vector<std::string> indexes;
+        std::vector<std::string> markers;
+        while (!cursor->done())
+        {
+            Json::Value entries{Json::arrayValue};
+            auto const n = cursor->read(7, false, entries);
+            BEAST_EXPECT(n == entries.size());
+            BEAST_EXPECT(n == 7 || cursor->done());
+            for (auto const& entry : entries)
+                indexes.push_back(entry[jss::index].asString());
+            if (auto const marker = cursor->marker())
+                markers.push_back(*marker);
+        }
+        BEAST_EXPECT(indexes.size() == count);
+        BEAST_EXPECT(
+            std::set<std::string>(indexes.begin(), indexes.end()).size() ==
+            count);
+        BEAST_EXPECT(!cursor->marker().has_value());
+
+        // resume from every marker, including those on later pages
+        std::set<std::string> pages;
+        for (std::size_t m = 0; m < markers.size(); ++m)
+        {
+            auto const comma = markers[m].find(',');
+            uint256 dirIndex, entryIndex;
+            if (!BEAST_EXPECT(
+                    comma != std::string::npos &&
+                    dirIndex.parseHex(markers[m].substr(0, comma)) &&
+                    entryIndex.parseHex(markers[m].substr(comma + 1))))
+                return;
+            pages.insert(markers[m].substr(0, comma));
+
+            auto resumed = RPC::NamespaceCursor::start(
+                view, alice.id(), ns, dirIndex, entryIndex);
+            if (!BEAST_EXPECT(resumed.has_value()))
+                return;
+
+            Json::Value entries{Json::arrayValue};
+            BEAST_EXPECT(
+                resumed->read(count, false, entries) == count - 7 * (m + 1));
+            BEAST_EXPECT(entries[0u][jss::index] == indexes[7 * (m + 1)]);
+
+            // a position in another namespace is not in this one
+            BEAST_EXPECT(!RPC::NamespaceCursor::start(
+                              view, alice.id(), other, dirIndex, entryIndex)
+                              .has_value());
+            BEAST_EXPECT(!RPC::NamespaceCursor::start(
+                              view, alice.id(), ns, dirIndex, uint256{1})
+                              .has_value());
+        }
+        BEAST_EXPECT(pages.size() == 4);
+
+        // binary entries carry the index and the serialized entry
+        cursor = RPC::NamespaceCursor::start(view, alice.id(), ns);
+        Json::Value entries{Json::arrayValue};
+        BEAST_EXPECT(cursor->read(1, true, entries) == 1);
+        BEAST_EXPECT(entries[0u][jss::index] == indexes[0]);
+        auto const data = strUnHex(entries[0u][jss::data].asString());
+        if (!BEAST_EXPECT(data.has_value()))
+            return;
+        SerialIter sit(makeSlice(*data));
+        uint256 index;
+        BEAST_EXPECT(index.parseHex(indexes[0]));
+        STLedgerEntry const sle(sit, index);
+        BEAST_EXPECT(sle.getType() == ltHOOK_STATE);
+    }
+
+    void
+    testStream()
+    {
+        testcase("stream");
+
+        using namespace jtx;
+        using namespace std::chrono_literals;
+        Env env(*this);
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        env.fund(XRP(1000), alice, bob);
+        env.close();
+
+        env(stateHook(bob), fee(XRP(1)), ter(tesSUCCESS));
+        env.close();
+        env(pay(alice, bob, XRP(1)), fee(XRP(1)), ter(tesSUCCESS));
+        env.close();
+
+        Json::Value params;
+        params[jss::account] = bob.human();
+        params[jss::namespace_id] = stateHookNamespace;
+        params[jss::stream] = true;
+
+        // only over a websocket
+        {
+            auto const resp =
+                env.rpc("json", "account_namespace", to_string(params));
+            BEAST_EXPECT(resp[jss::result][jss::error] == "notSupported");
+        }
+
+        auto wsc = makeWSClient(env.app().config(), true, 1);
+        params[jss::id] = 7;
+
+        // the response comes first, then the chunks
+        wsc->send("account_namespace", params);
+        auto const resp = wsc->getMsg(5s);
+        if (!BEAST_EXPECT(resp && (*resp)[jss::type] == jss::response))
+            return;
+        BEAST_EXPECT((*resp)[jss::status] == "success");
+        auto const& result = (*resp)[jss::result];
+        BEAST_EXPECT(result.isMember(jss::ledger_hash));
+
+        auto const chunk = wsc->getMsg(5s);
+        if (!BEAST_EXPECT(chunk && (*chunk)[jss::type] == "accountNamespace"))
+            return;
+        BEAST_EXPECT((*chunk)[jss::id] == 7);
+        BEAST_EXPECT((*chunk)[jss::chunk] == 0);
+        BEAST_EXPECT((*chunk)[jss::ledger_hash] == result[jss::ledger_hash]);
+        BEAST_EXPECT((*chunk)[jss::namespace_entries].size() == 1);
+        BEAST_EXPECT(!chunk->isMember(jss::marker));
+        BEAST_EXPECT(
+            (*chunk)[jss::namespace_entries][0u][sfHookStateData.jsonName] ==
+            strHex(std::string("value")));
+
+        // resuming needs a position in the namespace
+        auto const marker = to_string(uint256{1}) + "," + to_string(uint256{2});
+        {
+            auto p = params;
+            p[jss::marker] = marker;
+            BEAST_EXPECT(
+                wsc->invoke("account_namespace", p)[jss::error] ==
+                "invalidParams");
+        }
+
+        // a namespace which doesn't exist is streamed as one empty chunk
+        params[jss::account] = alice.human();
+        wsc->send("account_namespace", params);
+        {
+            auto const resp = wsc->getMsg(5s);
+            BEAST_EXPECT(resp && (*resp)[jss::status] == "success");
+
+            auto const chunk = wsc->getMsg(5s);
+            if (BEAST_EXPECT(
+                    chunk && (*chunk)[jss::type] == "accountNamespace"))
+            {
+                BEAST_EXPECT((*chunk)[jss::chunk] == 0);
+                BEAST_EXPECT((*chunk)[jss::namespace_entries].size() == 0);
+                BEAST_EXPECT(!chunk->isMember(jss::marker));
+            }
+        }
+
+        // but resuming in it needs a position in it too
+        params[jss::marker] = marker;
+        BEAST_EXPECT(
+            wsc->invoke("account_namespace", params)[jss::error] ==
+            "invalidParams");
+
+        // without stream a namespace which doesn't exist is an error
+        params.removeMember(jss::stream);
+        params.removeMember(jss::marker);
+        BEAST_EXPECT(
+            wsc->invoke("account_namespace", params)[jss::error] ==
+            "namespaceNotFound");
+    }
+
     void
     run() override
     {
         using namespace test::jtx;
         FeatureBitset const all{supported_amendments()};
         testErrors(all);
+        testCursor();
+        testStream();
     }
 };
 
@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/Enum.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+#include <test/jtx/WSClient.h>
+
+namespace ripple {
+namespace test {
+
+class HookDryRun_test : public beast::unit_test::suite
+{
+    static Json::Value
+    dryRun(jtx::Env& env, jtx::JTx const& jt, Json::Value params = {})
+    {
+        params[jss::tx_blob] = strHex(jt.stx->getSerializer().slice());
+        return env.rpc("json", "hook_dry_run", to_string(params))[jss::result];
+    }
+
+    void
+    testDryRun()
+    {
+        testcase("Dry run");
+
+        using namespace jtx;
+        Env env{*this};
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+        auto const before = env.closed()->info().seq;
+
+        env(stateHook(bob), fee(XRP(1)));
+        env.close();
+
+        auto const jt = env.jt(pay(alice, bob, XRP(1)), fee(XRP(1)));
+        auto const seq = env.seq(alice);
+
+        auto const jv = dryRun(env, jt);
+        BEAST_EXPECT(jv[jss::engine_result] == "tesSUCCESS");
+        BEAST_EXPECT(jv[jss::applied].asBool());
+
+        auto const& executions = jv[jss::hook_executions];
+        if (BEAST_EXPECT(executions.size() == 1))
+        {
+            auto const& execution = executions[0u];
+            BEAST_EXPECT(
+                execution[sfHookResult.jsonName].asUInt() == hook_api::ACCEPT);
+            BEAST_EXPECT(execution[sfHookAccount.jsonName] == bob.human());
+            BEAST_EXPECT(execution[sfHookStateChangeCount.jsonName] == 1);
+            BEAST_EXPECT(execution[sfHookInstructionCount.jsonName].isString());
+        }
+
+        auto const& changes = jv[jss::hook_state_changes];
+        if (BEAST_EXPECT(changes.size() == 1))
+            BEAST_EXPECT(changes[0u].isMember(sfCreatedNode.jsonName));
+
+        BEAST_EXPECT(jv[jss::emitted_txns].size() == 0);
+
+        // nothing was committed: the state is not there and the transaction
+        // still applies
+        BEAST_EXPECT(env.seq(alice) == seq);
+        {
+            Json::Value params;
+            params[jss::account] = bob.human();
+            params[jss::namespace_id] = stateHookNamespace;
+            auto const resp =
+                env.rpc("json", "account_namespace", to_string(params));
+            BEAST_EXPECT(
+                resp[jss::result][jss::error_message] ==
+                "Namespace not found.");
+        }
+
+        // against a ledger from before the hook was set
+        {
+            Json::Value params;
+            params[jss::ledger_index] = before;
+            auto const jv = dryRun(env, jt, params);
+            BEAST_EXPECT(jv[jss::engine_result] == "tesSUCCESS");
+            BEAST_EXPECT(jv[jss::hook_executions].size() == 0);
+            BEAST_EXPECT(jv[jss::hook_state_changes].size() == 0);
+        }
+
+        env(jt);
+        env.close();
+        BEAST_EXPECT(env.seq(alice) == seq + 1);
+    }
+
+    void
+    testTraces()
+    {
+        testcase("Traces");
+
+        using namespace std::chrono_literals;
+        using namespace jtx;
+        Env env{*this, envconfig([](std::unique_ptr<Config> cfg) {
+                    cfg->HOOK_PROFILE = true;
+                    return cfg;
+                })};
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        env(traceHook(bob), fee(XRP(1)));
+        env.close();
+
+        auto wsc = makeWSClient(env.app().config());
+        {
+            Json::Value stream;
+            stream[jss::streams] = Json::arrayValue;
+            stream[jss::streams].append("hook_traces");
+            auto const jv = wsc->invoke("subscribe", stream);
+            BEAST_EXPECT(jv[jss::status] == "success");
+        }
+
+        auto const isTrace = [](Json::Value const& jv) {
+            return jv[jss::type] == "hookTrace" && jv[jss::message] == "trace";
+        };
+        auto const executions = [&](std::string const& hookHash) {
+            auto const jv = env.rpc("hook_profile")[jss::result];
+            return jv[jss::hooks][hookHash][jss::executions];
+        };
+
+        auto const jt = env.jt(pay(alice, bob, XRP(1)), fee(XRP(1)));
+
+        // the trace is returned, but not published or profiled
+        auto const jv = dryRun(env, jt);
+        BEAST_EXPECT(jv[jss::engine_result] == "tesSUCCESS");
+        if (!BEAST_EXPECT(jv[jss::hook_executions].size() == 1))
+            return;
+        auto const hookHash =
+            jv[jss::hook_executions][0u][sfHookHash.jsonName].asString();
+
+        auto const& traces = jv[jss::hook_traces];
+        if (BEAST_EXPECT(traces.size() == 1))
+        {
+            BEAST_EXPECT(isTrace(traces[0u]));
+            BEAST_EXPECT(traces[0u][jss::hook_hash] == hookHash);
+            BEAST_EXPECT(traces[0u][jss::value] == "trace");
+        }
+
+        auto const jvo = wsc->getMsg(100ms);
+        BEAST_EXPECTS(!jvo, "getMsg: " + to_string(jvo.value()));
+        BEAST_EXPECT(executions(hookHash).isNull());
+
+        // applying it for real does both
+        env(jt);
+        env.close();
+        BEAST_EXPECT(wsc->findMsg(5s, isTrace));
+        BEAST_EXPECT(executions(hookHash) == "1");
+    }
+
+    void
+    testErrors()
+    {
+        testcase("Errors");
+
+        using namespace jtx;
+        Env env{*this};
+
+        auto const dryRun = [&](Json::Value const& params) {
+            return env.rpc("json", "hook_dry_run", to_string(params))
+                [jss::result];
+        };
+
+        BEAST_EXPECT(
+            dryRun(Json::objectValue)[jss::error_message] ==
+            "Missing field 'tx_blob'.");
+        {
+            Json::Value params;
+            params[jss::tx_blob] = "not hex";
+            BEAST_EXPECT(dryRun(params)[jss::error] == "invalidParams");
+        }
+        {
+            Json::Value params;
+            params[jss::tx_blob] = "DEADBEEF";
+            BEAST_EXPECT(dryRun(params)[jss::error] == "invalidTransaction");
+        }
+        {
+            Json::Value params;
+            params[jss::tx_blob] =
+                strHex(env.jt(noop(env.master)).stx->getSerializer().slice());
+            params[jss::ledger_index] = 1000;
+            BEAST_EXPECT(dryRun(params)[jss::error] == "lgrNotFound");
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testDryRun();
+        testTraces();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookDryRun, rpc, ripple);
+
+}  // namespace test
+}  // namespace ripple
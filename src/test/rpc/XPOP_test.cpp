@@ -0,0 +1,370 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/basics/base64.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/BinaryXPOP.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/Import.h>
+#include <ripple/protocol/STValidation.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/XPOPBuilder.h>
+#include <test/jtx.h>
+#include <test/jtx/TrustedPublisherServer.h>
+
+namespace ripple {
+namespace test {
+
+class XPOP_test : public beast::unit_test::suite
+{
+    // the root of a list proof, as Import computes it
+    static uint256
+    root(Json::Value const& proof)
+    {
+        sha512_half_hasher h;
+        using beast::hash_append;
+        hash_append(h, HashPrefix::innerNode);
+        for (auto const& entry : proof)
+        {
+            if (entry.isString())
+            {
+                uint256 hash;
+                if (hash.parseHex(entry.asString()))
+                    hash_append(h, hash);
+            }
+            else
+                hash_append(h, root(entry));
+        }
+        return static_cast<uint256>(h);
+    }
+
+    static bool
+    contains(Json::Value const& proof, std::string const& hash)
+    {
+        for (auto const& entry : proof)
+            if (entry.isString() ? entry.asString() == hash
+                                 : contains(entry, hash))
+                return true;
+        return false;
+    }
+
+    void
+    testProofs()
+    {
+        testcase("Proofs");
+
+        using namespace jtx;
+        Env env{*this};
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 40; ++i)
+        {
+            accounts.emplace_back("a" + std::to_string(i));
+            env.fund(XRP(1000), accounts.back());
+        }
+        env.close();
+
+        std::vector<uint256> hashes;
+        for (auto const& account : accounts)
+        {
+            env(pay(account, env.master, XRP(1)));
+            hashes.push_back(env.tx()->getTransactionID());
+        }
+        env.close();
+
+        auto const ledger = env.app().getLedgerMaster().getClosedLedger();
+        auto const& info = ledger->info();
+
+        RPC::XPOPProofs proofs(ledger->txMap());
+        std::size_t pathNodes = 0;
+        for (auto const& hash : hashes)
+        {
+            auto const txn = proofs.transaction(hash);
+            if (!BEAST_EXPECT(txn.has_value()))
+                return;
+
+            auto const blob = strUnHex((*txn)[jss::blob].asString());
+            auto const meta = strUnHex((*txn)[jss::meta].asString());
+            if (!BEAST_EXPECT(blob && meta))
+                return;
+
+            Serializer s;
+            s.addVL(*blob);
+            s.addVL(*meta);
+            s.addBitString(hash);
+            auto const leaf = sha512Half(HashPrefix::txNode, s.slice());
+
+            auto const& proof = (*txn)[jss::proof];
+            BEAST_EXPECT(syntaxCheckProof(proof, env.journal));
+            BEAST_EXPECT(contains(proof, strHex(leaf)));
+            BEAST_EXPECT(root(proof) == info.txHash);
+
+            for (auto const* p = &proof; p; ++pathNodes)
+            {
+                Json::Value const* next = nullptr;
+                for (auto const& entry : *p)
+                    if (entry.isArray())
+                        next = &entry;
+                p = next;
+            }
+        }
+
+        // the root, at least, is shared by every proof
+        BEAST_EXPECT(proofs.innerNodes() < pathNodes);
+        BEAST_EXPECT(proofs.innerNodes() <= pathNodes - hashes.size() + 1);
+
+        BEAST_EXPECT(!proofs.transaction(uint256{1}).has_value());
+
+        // the ledger section hashes to the ledger
+        auto const lgr = RPC::xpopLedger(info);
+        BEAST_EXPECT(lgr[jss::index].isInt());
+        BEAST_EXPECT(lgr[jss::close].isInt());
+        BEAST_EXPECT(lgr[jss::coins].isString());
+        uint256 const hash = sha512Half(
+            HashPrefix::ledgerMaster,
+            std::uint32_t(lgr[jss::index].asUInt()),
+            *parse_uint64(lgr[jss::coins].asString()),
+            info.parentHash,
+            info.txHash,
+            info.accountHash,
+            std::uint32_t(lgr[jss::pclose].asUInt()),
+            std::uint32_t(lgr[jss::close].asUInt()),
+            std::uint8_t(lgr[jss::cres].asUInt()),
+            std::uint8_t(lgr[jss::flags].asUInt()));
+        BEAST_EXPECT(hash == info.hash);
+        BEAST_EXPECT(lgr[jss::phash] == strHex(info.parentHash));
+        BEAST_EXPECT(lgr[jss::txroot] == strHex(info.txHash));
+        BEAST_EXPECT(lgr[jss::acroot] == strHex(info.accountHash));
+    }
+
+    void
+    testImport()
+    {
+        testcase("Import");
+
+        using namespace jtx;
+
+        // the network the transactions are imported into
+        std::uint32_t const networkID = 21337;
+
+        Env env{*this};
+
+        std::vector<Account> const accounts{
+            Account{"alice"}, Account{"bob"}, Account{"carol"}};
+        for (auto const& account : accounts)
+            env.fund(XRP(1000), account);
+        env.close();
+
+        // every account burns for an import in the same ledger
+        std::vector<uint256> hashes;
+        for (auto const& account : accounts)
+        {
+            Json::Value jv = noop(account);
+            jv[sfOperationLimit.jsonName] = networkID;
+            env(jv);
+            hashes.push_back(env.tx()->getTransactionID());
+        }
+        env.close();
+
+        auto const ledger = env.app().getLedgerMaster().getClosedLedger();
+        auto const& info = ledger->info();
+        auto const now = env.timeKeeper().now();
+        auto const expiration = now + std::chrono::hours{24 * 365};
+
+        // a list of validators which all validated the ledger
+        Json::Value data{Json::objectValue};
+        std::string list = "{\"sequence\":1,\"expiration\":" +
+            std::to_string(expiration.time_since_epoch().count()) +
+            ",\"validators\":[";
+        for (int i = 0; i < 5; ++i)
+        {
+            auto const masterSecret = randomSecretKey();
+            auto const masterPublic =
+                derivePublicKey(KeyType::ed25519, masterSecret);
+            auto const signing = randomKeyPair(KeyType::secp256k1);
+
+            list += "{\"validation_public_key\":\"" + strHex(masterPublic) +
+                "\",\"manifest\":\"" +
+                TrustedPublisherServer::makeManifestString(
+                    masterPublic,
+                    masterSecret,
+                    signing.first,
+                    signing.second,
+                    1) +
+                "\"},";
+
+            STValidation const val(
+                now,
+                signing.first,
+                signing.second,
+                calcNodeID(masterPublic),
+                [&](STValidation& v) {
+                    v.setFieldH256(sfLedgerHash, info.hash);
+                    v.setFieldU32(sfLedgerSequence, info.seq);
+                    v.setFlag(vfFullValidation);
+                });
+            data[toBase58(TokenType::NodePublic, masterPublic)] =
+                strHex(val.getSerialized());
+        }
+        list.back() = ']';
+        list += "}";
+
+        auto const publisherSecret = randomSecretKey();
+        auto const publisherPublic =
+            derivePublicKey(KeyType::ed25519, publisherSecret);
+        auto const listKeys = randomKeyPair(KeyType::secp256k1);
+
+        Json::Value unl{Json::objectValue};
+        unl[jss::public_key] = strHex(publisherPublic);
+        unl[jss::manifest] = TrustedPublisherServer::makeManifestString(
+            publisherPublic,
+            publisherSecret,
+            listKeys.first,
+            listKeys.second,
+            1);
+        unl[jss::blob] = base64_encode(list);
+        unl[jss::signature] =
+            strHex(sign(listKeys.first, listKeys.second, makeSlice(list)));
+        unl[jss::version] = 1;
+
+        RPC::XPOPProofs proofs(ledger->txMap());
+        std::vector<Json::Value> xpops;
+        for (auto const& hash : hashes)
+        {
+            auto txn = proofs.transaction(hash);
+            if (!BEAST_EXPECT(txn.has_value()))
+                return;
+
+            Json::Value xpop{Json::objectValue};
+            xpop[jss::ledger] = RPC::xpopLedger(info);
+            xpop[jss::transaction] = std::move(*txn);
+            xpop[jss::validation][jss::data] = data;
+            xpop[jss::validation][jss::unl] = unl;
+            xpops.push_back(std::move(xpop));
+        }
+
+        // every xpop imports, in either form
+        for (bool const binary : {false, true})
+        {
+            Env dest{
+                *this,
+                network::makeNetworkVLConfig(
+                    networkID, {strHex(publisherPublic)})};
+
+            for (std::size_t i = 0; i < accounts.size(); ++i)
+            {
+                dest.memoize(accounts[i]);
+
+                Json::Value tx = import::import(accounts[i], xpops[i]);
+                if (binary)
+                {
+                    auto const blob = toBinaryXPOP(xpops[i]);
+                    if (!BEAST_EXPECT(blob.has_value()))
+                        return;
+                    tx[jss::Blob] = strHex(*blob);
+                }
+                tx[jss::Sequence] = 0;
+                tx[jss::Fee] = 0;
+                dest(tx, accounts[i], ter(tesSUCCESS));
+            }
+            dest.close();
+
+            for (auto const& account : accounts)
+            {
+                auto const sle = dest.le(keylet::account(account));
+                if (BEAST_EXPECT(sle != nullptr))
+                    BEAST_EXPECT(
+                        sle->getFieldU32(sfImportSequence) ==
+                        env.seq(account) - 1);
+            }
+        }
+    }
+
+    void
+    testErrors()
+    {
+        testcase("Errors");
+
+        using namespace jtx;
+        Env env{*this};
+        env(noop(env.master));
+        auto const txHash = to_string(env.tx()->getTransactionID());
+        env.close();
+
+        auto const xpop = [&](Json::Value const& params) {
+            return env.rpc("json", "xpop", to_string(params))[jss::result];
+        };
+
+        {
+            auto const jv = xpop(Json::objectValue);
+            BEAST_EXPECT(jv[jss::error] == "invalidParams");
+        }
+        {
+            Json::Value params;
+            params[jss::tx_hash] = txHash;
+            params[jss::transactions] = Json::arrayValue;
+            params[jss::transactions].append(txHash);
+            BEAST_EXPECT(xpop(params)[jss::error] == "invalidParams");
+        }
+        {
+            Json::Value params;
+            params[jss::tx_hash] = "DEADBEEF";
+            BEAST_EXPECT(xpop(params)[jss::error] == "invalidParams");
+        }
+        {
+            Json::Value params;
+            params[jss::transactions] = Json::arrayValue;
+            BEAST_EXPECT(xpop(params)[jss::error] == "invalidParams");
+        }
+
+        // a standalone server has no validator list to attach
+        {
+            Json::Value params;
+            params[jss::tx_hash] = txHash;
+            BEAST_EXPECT(xpop(params)[jss::error] == "notReady");
+        }
+
+        // admin only
+        {
+            Env user{*this, envconfig(no_admin)};
+            Json::Value params;
+            params[jss::tx_hash] = txHash;
+            BEAST_EXPECT(user.rpc("json", "xpop", to_string(params))
+                             [jss::result]
+                                 .isNull());
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testProofs();
+        testImport();
+        testErrors();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(XPOP, rpc, ripple);
+
+}  // namespace test
+}  // namespace ripple
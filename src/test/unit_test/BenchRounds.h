@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2024 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef TEST_UNIT_TEST_BENCH_ROUNDS_H
+#define TEST_UNIT_TEST_BENCH_ROUNDS_H
+
+#include <ripple/beast/unit_test.h>
+#include <charconv>
+#include <cstddef>
+#include <string>
+
+namespace ripple {
+namespace test {
+
+// The number of rounds a manual benchmark suite runs, which is given as
+//   --unittest-arg=<rounds>
+// Without an argument the suite runs `fallback` rounds. An argument that is
+// not a positive number fails the suite, which then runs `fallback` rounds.
+inline std::size_t
+benchRounds(beast::unit_test::suite& suite, std::size_t fallback)
+{
+    auto const& s = suite.arg();
+    if (s.empty())
+        return fallback;
+
+    std::size_t rounds = 0;
+    auto const end = s.data() + s.size();
+    auto const [ptr, ec] = std::from_chars(s.data(), end, rounds);
+    if (ec != std::errc{} || ptr != end || rounds == 0)
+    {
+        suite.fail(
+            "--unittest-arg=" + s + " is not a positive number of rounds");
+        return fallback;
+    }
+
+    return rounds;
+}
+
+}  // namespace test
+}  // namespace ripple
+
+#endif